@@ -25,9 +25,7 @@ BlockChainServer::~BlockChainServer()
 void BlockChainServer::Initialize()
 {
 	const FullBlock& genesisBlock = m_config.GetEnvironment().GetGenesisBlock();
-	BlockIndex* pGenesisIndex = new BlockIndex(genesisBlock.GetHash(), 0, nullptr);
-
-	m_pChainStore = new ChainStore(m_config, pGenesisIndex);
+	m_pChainStore = new ChainStore(m_config, BlockIndex(genesisBlock.GetHash(), 0));
 	m_pChainStore->Load();
 
 	m_pHeaderMMR = HeaderMMRAPI::OpenHeaderMMR(m_config);
@@ -37,6 +35,10 @@ void BlockChainServer::Initialize()
 	m_pChainState->Initialize(genesisBlock.GetBlockHeader());
 	m_pTransactionPool = new TransactionPool();
 
+	m_pTxHashSetArchiver = new TxHashSetArchiver(m_config, *m_pChainState);
+	m_pChainCompactor = new ChainCompactor(*m_pChainState, *m_pTxHashSetArchiver);
+	m_pChainCompactor->Start();
+
 	m_initialized = true;
 }
 
@@ -46,6 +48,13 @@ void BlockChainServer::Shutdown()
 	{
 		m_initialized = false;
 
+		m_pChainCompactor->Stop();
+		delete m_pChainCompactor;
+		m_pChainCompactor = nullptr;
+
+		delete m_pTxHashSetArchiver;
+		m_pTxHashSetArchiver = nullptr;
+
 		m_pChainState->FlushAll();
 
 		delete m_pChainState;
@@ -84,7 +93,9 @@ EBlockChainStatus BlockChainServer::AddCompactBlock(const CompactBlock& compactB
 {
 	const CBigInteger<32>& hash = compactBlock.GetHash();
 
-	if (m_pChainState->HasBlockBeenValidated(hash))
+	// No need to hydrate a block that's already confirmed.
+	std::shared_ptr<const BlockHeader> pConfirmedHeader = m_pChainState->GetBlockHeaderByHeight(compactBlock.GetBlockHeader().GetHeight(), EChainType::CONFIRMED);
+	if (pConfirmedHeader != nullptr && pConfirmedHeader->GetHash() == hash)
 	{
 		return EBlockChainStatus::ALREADY_EXISTS;
 	}
@@ -98,29 +109,34 @@ EBlockChainStatus BlockChainServer::AddCompactBlock(const CompactBlock& compactB
 	return EBlockChainStatus::TRANSACTIONS_MISSING;
 }
 
+bool BlockChainServer::HasOrphan(const Hash& blockHash) const
+{
+	return m_pChainState->HasOrphan(blockHash);
+}
+
 EBlockChainStatus BlockChainServer::ProcessTransactionHashSet(const Hash& blockHash, const std::string& path)
 {
+	if (!TxHashSetProcessor(m_config, *this, *m_pChainState, m_database.GetBlockDB()).ProcessTxHashSet(blockHash, path))
 	{
-		LockedChainState lockedState = m_pChainState->GetLocked();
-		ITxHashSet* pExistingTxHashSet = lockedState.GetTxHashSet();
-		lockedState.UpdateTxHashSet(nullptr);
-
-		TxHashSetAPI::Close(pExistingTxHashSet);
+		return EBlockChainStatus::INVALID;
 	}
 
-	ITxHashSet* pNewTxHashSet = TxHashSetProcessor(m_config, *this, *m_pChainState, m_database.GetBlockDB()).ProcessTxHashSet(blockHash, path);
+	return EBlockChainStatus::SUCCESS;
+}
 
-	LockedChainState lockedState = m_pChainState->GetLocked();
-	if (pNewTxHashSet != nullptr)
-	{
-		lockedState.UpdateTxHashSet(pNewTxHashSet);
-		return EBlockChainStatus::SUCCESS;
-	}
-	else
+std::unique_ptr<ITxHashSetDownload> BlockChainServer::StartTxHashSetDownload(const Hash& blockHash)
+{
+	return TxHashSetProcessor(m_config, *this, *m_pChainState, m_database.GetBlockDB()).StartDownload(blockHash);
+}
+
+EBlockChainStatus BlockChainServer::FinishTxHashSetDownload(const Hash& blockHash, std::unique_ptr<ITxHashSetDownload> pDownload)
+{
+	if (!TxHashSetProcessor(m_config, *this, *m_pChainState, m_database.GetBlockDB()).FinishDownload(blockHash, *pDownload))
 	{
-		lockedState.UpdateTxHashSet(nullptr);
 		return EBlockChainStatus::INVALID;
 	}
+
+	return EBlockChainStatus::SUCCESS;
 }
 
 EBlockChainStatus BlockChainServer::AddTransaction(const Transaction& transaction)
@@ -150,7 +166,7 @@ std::vector<BlockHeader> BlockChainServer::GetBlockHeadersByHash(const std::vect
 	std::vector<BlockHeader> headers;
 	for (const CBigInteger<32>& hash : hashes)
 	{
-		std::unique_ptr<BlockHeader> pHeader = m_pChainState->GetBlockHeaderByHash(hash);
+		std::shared_ptr<const BlockHeader> pHeader = m_pChainState->GetBlockHeaderByHash(hash);
 		if (pHeader != nullptr)
 		{
 			headers.push_back(*pHeader);
@@ -160,12 +176,31 @@ std::vector<BlockHeader> BlockChainServer::GetBlockHeadersByHash(const std::vect
 	return headers;
 }
 
+std::unique_ptr<BlockHeader> BlockChainServer::GetTxHashSetArchive(std::string& zipPathOut) const
+{
+	return m_pTxHashSetArchiver->GetArchive(zipPathOut);
+}
+
 std::unique_ptr<BlockHeader> BlockChainServer::GetBlockHeaderByHeight(const uint64_t height, const EChainType chainType) const
 {
-	return m_pChainState->GetBlockHeaderByHeight(height, chainType);
+	std::shared_ptr<const BlockHeader> pHeader = m_pChainState->GetBlockHeaderByHeight(height, chainType);
+
+	return (pHeader != nullptr) ? std::make_unique<BlockHeader>(*pHeader) : std::unique_ptr<BlockHeader>(nullptr);
 }
 
 std::unique_ptr<BlockHeader> BlockChainServer::GetBlockHeaderByHash(const CBigInteger<32>& hash) const
+{
+	std::shared_ptr<const BlockHeader> pHeader = m_pChainState->GetBlockHeaderByHash(hash);
+
+	return (pHeader != nullptr) ? std::make_unique<BlockHeader>(*pHeader) : std::unique_ptr<BlockHeader>(nullptr);
+}
+
+std::shared_ptr<const BlockHeader> BlockChainServer::GetSharedBlockHeaderByHeight(const uint64_t height, const EChainType chainType) const
+{
+	return m_pChainState->GetBlockHeaderByHeight(height, chainType);
+}
+
+std::shared_ptr<const BlockHeader> BlockChainServer::GetSharedBlockHeaderByHash(const CBigInteger<32>& hash) const
 {
 	return m_pChainState->GetBlockHeaderByHash(hash);
 }
@@ -3,6 +3,8 @@
 #include "BlockStore.h"
 #include "ChainState.h"
 #include "ChainStore.h"
+#include "ChainCompactor.h"
+#include "TxHashSetArchiver.h"
 #include "TransactionPool.h"
 
 #include <BlockChainServer.h>
@@ -30,15 +32,21 @@ public:
 
 	virtual EBlockChainStatus AddBlock(const FullBlock& block) override final;
 	virtual EBlockChainStatus AddCompactBlock(const CompactBlock& block) override final;
+	virtual bool HasOrphan(const Hash& blockHash) const override final;
 
 	virtual EBlockChainStatus AddBlockHeader(const BlockHeader& blockHeader) override final;
 	virtual EBlockChainStatus AddBlockHeaders(const std::vector<BlockHeader>& blockHeaders) override final;
 
 	virtual EBlockChainStatus ProcessTransactionHashSet(const Hash& blockHash, const std::string& path) override final;
+	virtual std::unique_ptr<ITxHashSetDownload> StartTxHashSetDownload(const Hash& blockHash) override final;
+	virtual EBlockChainStatus FinishTxHashSetDownload(const Hash& blockHash, std::unique_ptr<ITxHashSetDownload> pDownload) override final;
 	virtual EBlockChainStatus AddTransaction(const Transaction& transaction) override final;
+	virtual std::unique_ptr<BlockHeader> GetTxHashSetArchive(std::string& zipPathOut) const override final;
 
 	virtual std::unique_ptr<BlockHeader> GetBlockHeaderByHeight(const uint64_t height, const EChainType chainType) const override final;
 	virtual std::unique_ptr<BlockHeader> GetBlockHeaderByHash(const CBigInteger<32>& hash) const override final;
+	virtual std::shared_ptr<const BlockHeader> GetSharedBlockHeaderByHeight(const uint64_t height, const EChainType chainType) const override final;
+	virtual std::shared_ptr<const BlockHeader> GetSharedBlockHeaderByHash(const CBigInteger<32>& hash) const override final;
 	virtual std::unique_ptr<BlockHeader> GetBlockHeaderByCommitment(const Hash& outputCommitment) const override final;
 	virtual std::vector<BlockHeader> GetBlockHeadersByHash(const std::vector<CBigInteger<32>>& hashes) const override final;
 
@@ -47,6 +55,8 @@ private:
 	BlockStore* m_pBlockStore;
 	ChainState* m_pChainState;
 	ChainStore* m_pChainStore;
+	ChainCompactor* m_pChainCompactor;
+	TxHashSetArchiver* m_pTxHashSetArchiver;
 	IHeaderMMR* m_pHeaderMMR;
 	TransactionPool* m_pTransactionPool;
 	const Config& m_config;
@@ -1,34 +1,29 @@
 #pragma once
 
 #include <Hash.h>
-#include <Core/ChainType.h>
-#include <Core/BlockHeader.h>
+#include <stdint.h>
+#include <array>
+#include <algorithm>
 
+//
+// The hash of a block at a given height. Stored by value (the hash isn't heap-allocated), so indices can be kept in dense arrays.
+//
 class BlockIndex
 {
 public:
-	BlockIndex(const Hash& hash, const uint64_t height, BlockIndex* pPrevious)
-		: m_hash(hash), m_height(height), m_pPrevious(pPrevious), m_chainTypeMask(0)
+	BlockIndex(const Hash& hash, const uint64_t height)
+		: m_height(height)
 	{
-
+		std::copy(hash.GetData().cbegin(), hash.GetData().cend(), m_hash.begin());
 	}
 
-	inline const Hash& GetHash() const { return m_hash; }
+	inline Hash GetHash() const { return Hash(m_hash.data()); }
 	inline uint64_t GetHeight() const { return m_height; }
-	inline BlockIndex* GetPrevious() const { return m_pPrevious; }
-
-	inline void AddChainType(const EChainType chainType) { m_chainTypeMask = ChainType::AddChainType(m_chainTypeMask, chainType); }
-	inline void RemoveChainType(const EChainType chainType) { m_chainTypeMask = ChainType::RemoveChainType(m_chainTypeMask, chainType); }
 
-	inline bool IsSync() const { return ChainType::IsSync(m_chainTypeMask); }
-	inline bool IsCandidate() const { return ChainType::IsCandidate(m_chainTypeMask); }
-	inline bool IsConfirmed() const { return ChainType::IsConfirmed(m_chainTypeMask); }
-	inline bool IsInAllChains() const { return ChainType::IsAll(m_chainTypeMask); }
-	inline bool IsSafeToDelete() const { return ChainType::IsNone(m_chainTypeMask); }
+	inline bool operator==(const BlockIndex& rhs) const { return m_height == rhs.m_height && m_hash == rhs.m_hash; }
+	inline bool operator!=(const BlockIndex& rhs) const { return !(*this == rhs); }
 
 private:
-	Hash m_hash;
+	std::array<unsigned char, 32> m_hash;
 	uint64_t m_height;
-	BlockIndex* m_pPrevious; // TODO: Storing this is probably not necessary
-	uint8_t m_chainTypeMask;
 };
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include "BlockIndexArena.h"
+
+#include <algorithm>
+
+BlockIndexArena::BlockIndexArena(const BlockIndex& genesisIndex)
+	: m_indices({ genesisIndex }), m_numShared({ 1, 1, 1 })
+{
+
+}
+
+bool BlockIndexArena::Share(const EChainType chainType, const BlockIndex& blockIndex)
+{
+	uint64_t& numShared = m_numShared[(size_t)chainType];
+	if (blockIndex.GetHeight() != numShared)
+	{
+		return false;
+	}
+
+	if (numShared < m_indices.size())
+	{
+		// Another chain already shares this height.
+		if (m_indices[numShared] != blockIndex)
+		{
+			return false;
+		}
+	}
+	else
+	{
+		m_indices.push_back(blockIndex);
+	}
+
+	numShared++;
+	return true;
+}
+
+void BlockIndexArena::Unshare(const EChainType chainType, const uint64_t numShared)
+{
+	uint64_t& currentShared = m_numShared[(size_t)chainType];
+	currentShared = std::min(currentShared, std::max(numShared, (uint64_t)1));
+
+	const uint64_t maxShared = *std::max_element(m_numShared.cbegin(), m_numShared.cend());
+	while (m_indices.size() > maxShared)
+	{
+		m_indices.pop_back();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "BlockIndex.h"
+
+#include <Core/ChainType.h>
+#include <stdint.h>
+#include <deque>
+#include <array>
+
+//
+// A dense, height-indexed array of the block indices the chains have in common (normally all of them, aside from the tips).
+// Each chain shares the first GetNumShared() heights of the arena, and keeps any blocks above those in its own side-table (see Chain).
+//
+// The arena only ever grows or shrinks at the end, and a deque never moves its elements when that happens,
+// so references to indices a chain still shares stay valid.
+//
+class BlockIndexArena
+{
+public:
+	BlockIndexArena(const BlockIndex& genesisIndex);
+
+	inline const BlockIndex& GetByHeight(const uint64_t height) const { return m_indices[height]; }
+	inline uint64_t GetNumShared(const EChainType chainType) const { return m_numShared[(size_t)chainType]; }
+
+	//
+	// Extends the heights shared by the chain by one, if the index is already at that height or the height isn't used yet.
+	// Returns false if another chain shares a different index at that height, in which case the chain must keep it in its side-table.
+	//
+	bool Share(const EChainType chainType, const BlockIndex& blockIndex);
+
+	//
+	// Reduces the heights shared by the chain, and releases any indices no chain shares any more.
+	//
+	void Unshare(const EChainType chainType, const uint64_t numShared);
+
+private:
+	std::deque<BlockIndex> m_indices;
+
+	// Indexed by EChainType. The arena never holds more indices than the largest of these.
+	std::array<uint64_t, 3> m_numShared;
+};
\ No newline at end of file
@@ -1,17 +1,18 @@
 #include "BlockStore.h"
 
+#include <Consensus/BlockTime.h>
+#include <Infrastructure/Logger.h>
+#include <StringUtil.h>
+
 BlockStore::BlockStore(const Config& config, IBlockDB& blockDB)
-	: m_config(config), m_blockDB(blockDB)
+	: m_config(config), m_blockDB(blockDB), m_highestHeight(0), m_headerCache((uint64_t)config.GetChainConfig().GetHeaderCacheMB() * 1024 * 1024)
 {
 
 }
 
 BlockStore::~BlockStore()
 {
-	for (auto iter = m_blockHeadersByHash.begin(); iter != m_blockHeadersByHash.end(); iter++)
-	{
-		delete iter->second;
-	}
+	LoggerAPI::LogInfo(StringUtil::Format("BlockStore::~BlockStore - Header cache hits: %llu, misses: %llu", m_headerCache.GetHits(), m_headerCache.GetMisses()));
 }
 
 void BlockStore::LoadHeaders(const std::vector<Hash>& hashes)
@@ -19,31 +20,43 @@ void BlockStore::LoadHeaders(const std::vector<Hash>& hashes)
 	std::vector<BlockHeader*> blockHeaders = m_blockDB.LoadBlockHeaders(hashes);
 	for (BlockHeader* pBlockHeader : blockHeaders)
 	{
-		const Hash& hash = pBlockHeader->GetHash();
-		m_blockHeadersByHash.insert({ hash, pBlockHeader });
+		PinHeader(std::shared_ptr<const BlockHeader>(pBlockHeader));
 	}
+
+	DemoteOldHeaders();
 }
 
-std::unique_ptr<BlockHeader> BlockStore::GetBlockHeaderByHash(const Hash& hash)
+std::shared_ptr<const BlockHeader> BlockStore::GetBlockHeaderByHash(const Hash& hash)
 {
-	auto iter = m_blockHeadersByHash.find(hash);
-	if (iter != m_blockHeadersByHash.cend())
+	auto iter = m_pinnedHeaders.find(hash);
+	if (iter != m_pinnedHeaders.cend())
 	{
-		return std::make_unique<BlockHeader>(*iter->second);
+		return iter->second;
 	}
 
-	return m_blockDB.GetBlockHeader(hash); // TODO: Cache this
+	std::shared_ptr<const BlockHeader> pHeader = m_headerCache.Get(hash);
+	if (pHeader == nullptr)
+	{
+		pHeader = std::shared_ptr<const BlockHeader>(m_blockDB.GetBlockHeader(hash));
+		if (pHeader != nullptr)
+		{
+			m_headerCache.Put(pHeader);
+		}
+	}
+
+	return pHeader;
 }
 
 bool BlockStore::AddHeader(const BlockHeader& blockHeader)
 {
 	const Hash& hash = blockHeader.GetHash();
 
-	auto iter = m_blockHeadersByHash.find(hash);
-	if (iter == m_blockHeadersByHash.cend())
+	auto iter = m_pinnedHeaders.find(hash);
+	if (iter == m_pinnedHeaders.cend())
 	{
-		m_blockHeadersByHash[hash] = new BlockHeader(blockHeader);
+		PinHeader(std::make_shared<const BlockHeader>(blockHeader));
 		m_blockDB.AddBlockHeader(blockHeader);
+		DemoteOldHeaders();
 
 		return true;
 	}
@@ -53,21 +66,49 @@ bool BlockStore::AddHeader(const BlockHeader& blockHeader)
 
 void BlockStore::AddHeaders(const std::vector<BlockHeader>& blockHeaders)
 {
-	std::vector<BlockHeader*> blockHeadersToAdd;
+	std::vector<const BlockHeader*> blockHeadersToAdd;
 	blockHeadersToAdd.reserve(blockHeaders.size());
 
 	for (const BlockHeader& blockHeader : blockHeaders)
 	{
 		const Hash& hash = blockHeader.GetHash();
 
-		auto iter = m_blockHeadersByHash.find(hash);
-		if (iter == m_blockHeadersByHash.cend())
+		auto iter = m_pinnedHeaders.find(hash);
+		if (iter == m_pinnedHeaders.cend())
 		{
-			BlockHeader* pHeader = new BlockHeader(blockHeader);
-			m_blockHeadersByHash[hash] = pHeader;
-			blockHeadersToAdd.push_back(pHeader);
+			std::shared_ptr<const BlockHeader> pHeader = std::make_shared<const BlockHeader>(blockHeader);
+			PinHeader(pHeader);
+			blockHeadersToAdd.push_back(pHeader.get());
 		}
 	}
 
 	m_blockDB.AddBlockHeaders(blockHeadersToAdd);
+
+	// Demoted only once the headers are in the database, since the cache may evict them right away.
+	DemoteOldHeaders();
+}
+
+void BlockStore::PinHeader(const std::shared_ptr<const BlockHeader>& pHeader)
+{
+	m_pinnedHeaders[pHeader->GetHash()] = pHeader;
+	m_pinnedHashesByHeight.insert({ pHeader->GetHeight(), pHeader->GetHash() });
+	m_highestHeight = std::max(m_highestHeight, pHeader->GetHeight());
+}
+
+void BlockStore::DemoteOldHeaders()
+{
+	const uint64_t horizon = std::max(m_highestHeight, (uint64_t)Consensus::CUT_THROUGH_HORIZON) - (uint64_t)Consensus::CUT_THROUGH_HORIZON;
+
+	auto iter = m_pinnedHashesByHeight.begin();
+	while (iter != m_pinnedHashesByHeight.end() && iter->first < horizon)
+	{
+		auto headerIter = m_pinnedHeaders.find(iter->second);
+		if (headerIter != m_pinnedHeaders.end())
+		{
+			m_headerCache.Put(headerIter->second);
+			m_pinnedHeaders.erase(headerIter);
+		}
+
+		iter = m_pinnedHashesByHeight.erase(iter);
+	}
 }
\ No newline at end of file
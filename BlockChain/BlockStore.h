@@ -1,10 +1,21 @@
 #pragma once
 
+#include "HeaderCache.h"
+
 #include <Config/Config.h>
 #include <Database/BlockDb.h>
 #include <Core/BlockHeader.h>
 #include <map>
+#include <memory>
 
+//
+// Headers are immutable once stored, so they're shared rather than copied.
+// The handles returned stay valid for as long as they're held, even if the BlockStore is destroyed.
+//
+// Headers are kept in two tiers in front of the block database:
+// 1. Headers within the cut-through horizon of the highest header added are pinned in memory, since they're needed to validate new blocks and reorgs.
+// 2. Older headers are demoted to a HeaderCache, bounded by the configured memory budget, so memory use stays flat as the chain grows.
+//
 // TODO: Move to Database
 class BlockStore
 {
@@ -13,16 +24,30 @@ public:
 	~BlockStore();
 
 	void LoadHeaders(const std::vector<Hash>& hashes);
-	std::unique_ptr<BlockHeader> GetBlockHeaderByHash(const Hash& hash);
 
+	//
+	// Safe to call concurrently, as long as the caller holds at least a shared chain state lock.
+	//
+	std::shared_ptr<const BlockHeader> GetBlockHeaderByHash(const Hash& hash);
+
+	//
+	// WARNING: Caller must hold the chain state write lock.
+	//
 	bool AddHeader(const BlockHeader& blockHeader);
 	void AddHeaders(const std::vector<BlockHeader>& blockHeaders);
 
 	inline IBlockDB& GetBlockDB() { return m_blockDB; }
 
 private:
+	void PinHeader(const std::shared_ptr<const BlockHeader>& pHeader);
+	void DemoteOldHeaders();
+
 	const Config& m_config;
 	IBlockDB& m_blockDB;
 
-	std::map<Hash, BlockHeader*> m_blockHeadersByHash;
+	std::map<Hash, std::shared_ptr<const BlockHeader>> m_pinnedHeaders;
+	std::multimap<uint64_t, Hash> m_pinnedHashesByHeight;
+	uint64_t m_highestHeight;
+
+	HeaderCache m_headerCache;
 };
\ No newline at end of file
@@ -1,38 +1,50 @@
 #include "Chain.h"
 
-Chain::Chain(const EChainType chainType, BlockIndex* pGenesisBlock)
-	: m_chainType(chainType), m_height(0)
+#include <algorithm>
+
+Chain::Chain(const EChainType chainType, BlockIndexArena& arena)
+	: m_chainType(chainType), m_arena(arena), m_height(0), m_firstDirtyHeight(0)
 {
-	pGenesisBlock->AddChainType(m_chainType);
-	m_indices.push_back(pGenesisBlock);
+
 }
 
-BlockIndex* Chain::GetByHeight(const uint64_t height)
+const BlockIndex* Chain::GetByHeight(const uint64_t height) const
 {
-	if (m_height >= height)
+	if (height > m_height)
+	{
+		return nullptr;
+	}
+
+	const uint64_t numShared = m_arena.GetNumShared(m_chainType);
+	if (height < numShared)
 	{
-		return m_indices[height];
+		return &m_arena.GetByHeight(height);
 	}
 
-	return nullptr;
+	return &m_forkIndices[height - numShared];
 }
 
-BlockIndex* Chain::GetTip()
+const BlockIndex* Chain::GetTip() const
 {
-	return m_indices[m_height];
+	return GetByHeight(m_height);
 }
 
-bool Chain::AddBlock(BlockIndex* pBlockIndex)
+bool Chain::AddBlock(const BlockIndex& blockIndex)
 {
-	if (pBlockIndex->GetHeight() == (m_height + 1) && pBlockIndex->GetPrevious() == GetTip())
+	if (blockIndex.GetHeight() != (m_height + 1))
+	{
+		return false;
+	}
+
+	if (!m_forkIndices.empty() || !m_arena.Share(m_chainType, blockIndex))
 	{
-		pBlockIndex->AddChainType(m_chainType);
-		m_indices.push_back(pBlockIndex);
-		m_height++;
-		return true;
+		m_forkIndices.push_back(blockIndex);
 	}
 
-	return false;
+	m_height++;
+	Rejoin();
+
+	return true;
 }
 
 bool Chain::Rewind(const uint64_t lastHeight)
@@ -44,20 +56,29 @@ bool Chain::Rewind(const uint64_t lastHeight)
 
 	if (m_height > lastHeight)
 	{
-		for (uint64_t i = lastHeight + 1; i <= m_height; i++)
+		const uint64_t numShared = m_arena.GetNumShared(m_chainType);
+		if (lastHeight < numShared)
 		{
-			BlockIndex* pBlockIndex = m_indices[i];
-			pBlockIndex->RemoveChainType(m_chainType);
-			if (pBlockIndex->IsSafeToDelete())
-			{
-				// TODO: Return hashes of all deleted indices, so they can be removed from the database?
-				delete pBlockIndex;
-			}
+			m_forkIndices.clear();
+			m_arena.Unshare(m_chainType, lastHeight + 1);
+		}
+		else
+		{
+			m_forkIndices.erase(m_forkIndices.begin() + (lastHeight + 1 - numShared), m_forkIndices.end());
 		}
 
-		m_indices.erase(m_indices.begin() + lastHeight + 1, m_indices.end());
 		m_height = lastHeight;
+		m_firstDirtyHeight = std::min(m_firstDirtyHeight, lastHeight + 1);
 	}
 
 	return true;
+}
+
+// Moves the side-table back into the arena, once the other chains have moved onto this fork (or off of the heights it uses).
+void Chain::Rejoin()
+{
+	while (!m_forkIndices.empty() && m_arena.Share(m_chainType, m_forkIndices.front()))
+	{
+		m_forkIndices.pop_front();
+	}
 }
\ No newline at end of file
@@ -1,21 +1,46 @@
 #pragma once
 
 #include "BlockIndex.h"
+#include "BlockIndexArena.h"
 
+#include <Core/ChainType.h>
+#include <deque>
+
+//
+// A chain of block indices by height. The heights it has in common with the other chains are read from the shared BlockIndexArena,
+// and only the blocks of a fork are kept in a (usually empty) side-table.
+// The pointers returned stay valid until this chain is next modified.
+//
 class Chain
 {
 public:
-	Chain(const EChainType chainType, BlockIndex* pGenesisBlock);
+	Chain(const EChainType chainType, BlockIndexArena& arena);
 
-	BlockIndex* GetByHeight(const uint64_t height);
-	BlockIndex* GetTip();
+	const BlockIndex* GetByHeight(const uint64_t height) const;
+	const BlockIndex* GetTip() const;
 	inline EChainType GetType() const { return m_chainType; }
 
-	bool AddBlock(BlockIndex* pBlockIndex);
+	//
+	// Adds the index at the next height. The caller must make sure the block builds on the tip.
+	//
+	bool AddBlock(const BlockIndex& blockIndex);
 	bool Rewind(const uint64_t lastHeight);
 
+	//
+	// The lowest height whose hash has changed since the last MarkFlushed().
+	// Persisted hashes below this height are still valid, so only the tail from this height on needs to be written.
+	//
+	inline uint64_t GetFirstDirtyHeight() const { return m_firstDirtyHeight; }
+	inline void MarkFlushed() { m_firstDirtyHeight = m_height + 1; }
+
 private:
+	void Rejoin();
+
 	const EChainType m_chainType;
-	std::vector<BlockIndex*> m_indices;
-	size_t m_height;
+	BlockIndexArena& m_arena;
+
+	// The indices above the heights shared with the arena, while this chain is on a fork.
+	std::deque<BlockIndex> m_forkIndices;
+	uint64_t m_height;
+	uint64_t m_firstDirtyHeight;
 };
\ No newline at end of file
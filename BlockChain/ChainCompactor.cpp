@@ -0,0 +1,105 @@
+#include "ChainCompactor.h"
+#include "ChainState.h"
+#include "TxHashSetArchiver.h"
+
+#include <Consensus/BlockTime.h>
+#include <Infrastructure/ThreadManager.h>
+#include <Infrastructure/Logger.h>
+#include <TxHashSet.h>
+
+// Compact once per day's worth of blocks.
+static const uint64_t COMPACTION_INTERVAL = Consensus::DAY_HEIGHT;
+
+ChainCompactor::ChainCompactor(ChainState& chainState, TxHashSetArchiver& archiver)
+	: m_chainState(chainState), m_archiver(archiver), m_lastCompactionHeight(0), m_lastArchiveHeight(0)
+{
+
+}
+
+void ChainCompactor::Start()
+{
+	m_terminate = false;
+
+	if (m_compactThread.joinable())
+	{
+		m_compactThread.join();
+	}
+
+	m_compactThread = std::thread(Thread_Compact, std::ref(*this));
+}
+
+void ChainCompactor::Stop()
+{
+	m_terminate = true;
+
+	if (m_compactThread.joinable())
+	{
+		m_compactThread.join();
+	}
+}
+
+void ChainCompactor::Thread_Compact(ChainCompactor& compactor)
+{
+	ThreadManagerAPI::SetCurrentThreadName("COMPACT_THREAD");
+
+	LoggerAPI::LogInfo("ChainCompactor::Thread_Compact() - BEGIN");
+
+	while (!compactor.m_terminate)
+	{
+		const uint64_t height = compactor.m_chainState.GetHeight(EChainType::CONFIRMED);
+		const uint64_t archiveHeight = TxHashSetArchiver::GetArchiveHeight(height);
+		if (archiveHeight > compactor.m_lastArchiveHeight)
+		{
+			// Built before compacting, since compaction would remove outputs spent after the previous archive height.
+			compactor.m_archiver.Build(archiveHeight);
+			compactor.m_lastArchiveHeight = archiveHeight;
+		}
+
+		if (archiveHeight > 0 && height >= compactor.m_lastCompactionHeight + COMPACTION_INTERVAL)
+		{
+			// Nothing spent after the archive height is removed, so the archive can always be rebuilt.
+			compactor.Compact(archiveHeight);
+
+			// Failed compactions are retried at the next interval, rather than immediately.
+			compactor.m_lastCompactionHeight = height;
+		}
+
+		std::this_thread::sleep_for(std::chrono::seconds(5));
+	}
+
+	LoggerAPI::LogInfo("ChainCompactor::Thread_Compact() - END");
+}
+
+bool ChainCompactor::Compact(const uint64_t horizonHeight)
+{
+	std::shared_ptr<ITxHashSetCompaction> pCompaction = nullptr;
+	{
+		LockedChainState lockedState = m_chainState.GetLocked();
+		ITxHashSet* pTxHashSet = lockedState.GetTxHashSet();
+		if (pTxHashSet == nullptr)
+		{
+			return false;
+		}
+
+		pCompaction = pTxHashSet->PrepareCompaction(horizonHeight);
+		if (pCompaction == nullptr)
+		{
+			return false;
+		}
+	}
+
+	LoggerAPI::LogInfo("ChainCompactor::Compact - Rewriting TxHashSet files.");
+	pCompaction->Run();
+
+	// Always finished, even if Run failed, so the TxHashSet knows the compaction is no longer pending.
+	LockedChainState lockedState = m_chainState.GetLocked();
+	ITxHashSet* pTxHashSet = lockedState.GetTxHashSet();
+	if (pTxHashSet == nullptr || !pTxHashSet->FinishCompaction(*pCompaction))
+	{
+		LoggerAPI::LogWarning("ChainCompactor::Compact - Compaction failed.");
+		return false;
+	}
+
+	LoggerAPI::LogInfo("ChainCompactor::Compact - Compaction complete.");
+	return true;
+}
\ No newline at end of file
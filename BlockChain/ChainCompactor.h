@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <stdint.h>
+
+// Forward Declarations
+class ChainState;
+class TxHashSetArchiver;
+
+//
+// Background job that periodically removes spent outputs and rangeproofs beyond the horizon from the TxHashSet's files,
+// so disk usage tracks the UTXO set rather than the full history.
+// The chain lock is only held to prepare the compaction and to swap the compacted files in, not while the files are rewritten.
+// The TxHashSet archive is built on the same thread, so the files are never compacted while they're being zipped.
+//
+class ChainCompactor
+{
+public:
+	ChainCompactor(ChainState& chainState, TxHashSetArchiver& archiver);
+
+	void Start();
+	void Stop();
+
+private:
+	static void Thread_Compact(ChainCompactor& compactor);
+	bool Compact(const uint64_t horizonHeight);
+
+	ChainState& m_chainState;
+	TxHashSetArchiver& m_archiver;
+	uint64_t m_lastCompactionHeight;
+	uint64_t m_lastArchiveHeight;
+
+	std::atomic<bool> m_terminate;
+	std::thread m_compactThread;
+};
\ No newline at end of file
@@ -5,7 +5,7 @@
 #include <TxHashSet.h>
 
 ChainState::ChainState(const Config& config, ChainStore& chainStore, BlockStore& blockStore, IHeaderMMR& headerMMR)
-	: m_config(config), m_chainStore(chainStore), m_blockStore(blockStore), m_headerMMR(headerMMR)
+	: m_config(config), m_chainStore(chainStore), m_blockStore(blockStore), m_orphanPool(config), m_syncDifficulty(blockStore), m_candidateDifficulty(blockStore), m_headerMMR(headerMMR)
 {
 
 }
@@ -39,43 +39,57 @@ void ChainState::Initialize(const BlockHeader& genesisHeader)
 		m_blockStore.LoadHeaders(hashesToLoad);
 	}
 
-	m_pTxHashSet = std::shared_ptr<ITxHashSet>(TxHashSetAPI::Open(m_config, m_blockStore.GetBlockDB()));
+	m_chainTips.Publish(m_chainStore, m_blockStore);
+
+	m_pTxHashSet = std::shared_ptr<ITxHashSet>(TxHashSetAPI::Open(m_config));
+
+	// Lost or corrupted hash files are regenerated from the data files, rather than requiring a full resync.
+	const BlockIndex* pConfirmedTip = m_chainStore.GetConfirmedChain().GetTip();
+	if (m_pTxHashSet != nullptr && pConfirmedTip->GetHeight() > 0)
+	{
+		std::shared_ptr<const BlockHeader> pConfirmedHeader = m_blockStore.GetBlockHeaderByHash(pConfirmedTip->GetHash());
+		if (pConfirmedHeader != nullptr)
+		{
+			m_pTxHashSet->RebuildHashFiles(*pConfirmedHeader);
+		}
+	}
 }
 
-uint64_t ChainState::GetHeight(const EChainType chainType)
+std::shared_ptr<const ChainTip> ChainState::GetTip(const EChainType chainType) const
 {
-	std::shared_lock<std::shared_mutex> readLock(m_headersMutex);
+	return m_chainTips.GetTip(chainType);
+}
 
-	std::unique_ptr<BlockHeader> pHead = GetHead_Locked(chainType);
-	if (pHead != nullptr)
+uint64_t ChainState::GetHeight(const EChainType chainType) const
+{
+	std::shared_ptr<const ChainTip> pTip = m_chainTips.GetTip(chainType);
+	if (pTip != nullptr)
 	{
-		return pHead->GetHeight();
+		return pTip->GetHeight();
 	}
 
 	return 0;
 }
 
-uint64_t ChainState::GetTotalDifficulty(const EChainType chainType)
+uint64_t ChainState::GetTotalDifficulty(const EChainType chainType) const
 {
-	std::shared_lock<std::shared_mutex> readLock(m_headersMutex);
-
-	std::unique_ptr<BlockHeader> pHead = GetHead_Locked(chainType);
-	if (pHead != nullptr)
+	std::shared_ptr<const ChainTip> pTip = m_chainTips.GetTip(chainType);
+	if (pTip != nullptr)
 	{
-		return pHead->GetProofOfWork().GetTotalDifficulty();
+		return pTip->GetTotalDifficulty();
 	}
 
 	return 0;
 }
 
-std::unique_ptr<BlockHeader> ChainState::GetBlockHeaderByHash(const Hash& hash)
+std::shared_ptr<const BlockHeader> ChainState::GetBlockHeaderByHash(const Hash& hash)
 {
 	std::shared_lock<std::shared_mutex> readLock(m_headersMutex);
 
 	return m_blockStore.GetBlockHeaderByHash(hash);
 }
 
-std::unique_ptr<BlockHeader> ChainState::GetBlockHeaderByHeight(const uint64_t height, const EChainType chainType)
+std::shared_ptr<const BlockHeader> ChainState::GetBlockHeaderByHeight(const uint64_t height, const EChainType chainType)
 {
 	std::shared_lock<std::shared_mutex> readLock(m_headersMutex);
 
@@ -86,38 +100,31 @@ std::unique_ptr<BlockHeader> ChainState::GetBlockHeaderByHeight(const uint64_t h
 		return m_blockStore.GetBlockHeaderByHash(pBlockIndex->GetHash());
 	}
 
-	return std::unique_ptr<BlockHeader>(nullptr);
+	return std::shared_ptr<const BlockHeader>(nullptr);
 }
 
-std::unique_ptr<BlockHeader> ChainState::GetHead_Locked(const EChainType chainType)
+void ChainState::BlockValidated(const Hash& blockDataHash)
 {
-	const Hash& headHash = GetHeadHash_Locked(chainType);
-
-	return m_blockStore.GetBlockHeaderByHash(headHash);
-}
+	std::lock_guard<std::mutex> lockGuard(m_validatedBlocksMutex);
 
-const Hash& ChainState::GetHeadHash_Locked(const EChainType chainType)
-{
-	return m_chainStore.GetChain(chainType).GetTip()->GetHash();
+	m_validatedBlocks.insert(blockDataHash);
 }
 
-void ChainState::BlockValidated(const Hash& hash)
+bool ChainState::HasBlockBeenValidated(const Hash& blockDataHash) const
 {
-	std::shared_lock<std::shared_mutex> readLock(m_headersMutex);
+	std::lock_guard<std::mutex> lockGuard(m_validatedBlocksMutex);
 
-	m_validatedBlocks.insert(hash);
+	return m_validatedBlocks.find(blockDataHash) != m_validatedBlocks.cend();
 }
 
-bool ChainState::HasBlockBeenValidated(const Hash& hash) const
+bool ChainState::HasOrphan(const Hash& hash) const
 {
-	std::shared_lock<std::shared_mutex> readLock(m_headersMutex);
-
-	return m_validatedBlocks.find(hash) != m_validatedBlocks.cend();
+	return m_orphanPool.IsOrphan(hash);
 }
 
 LockedChainState ChainState::GetLocked()
 {
-	return LockedChainState(m_headersMutex, m_chainStore, m_blockStore, m_headerMMR, m_orphanPool, m_pTxHashSet);
+	return LockedChainState(m_headersMutex, m_chainTips, m_chainStore, m_blockStore, m_headerMMR, m_orphanPool, m_syncDifficulty, m_candidateDifficulty, m_pTxHashSet);
 }
 
 void ChainState::FlushAll()
@@ -1,16 +1,19 @@
 #pragma once
 
 #include "Chain.h"
+#include "ChainTip.h"
 #include "ChainStore.h"
 #include "BlockStore.h"
 #include "LockedChainState.h"
 #include "OrphanPool.h"
+#include "DifficultyWindow.h"
 
 #include <Core/BlockHeader.h>
 #include <Core/ChainType.h>
 #include <HeaderMMR.h>
 #include <Hash.h>
 #include <shared_mutex>
+#include <mutex>
 #include <map>
 #include <set>
 #include <atomic>
@@ -27,31 +30,45 @@ public:
 
 	void Initialize(const BlockHeader& genesisHeader);
 
-	uint64_t GetHeight(const EChainType chainType);
-	uint64_t GetTotalDifficulty(const EChainType chainType);
+	//
+	// These never lock the chain state. They read the latest published tip of the chain (see ChainTips).
+	//
+	std::shared_ptr<const ChainTip> GetTip(const EChainType chainType) const;
+	uint64_t GetHeight(const EChainType chainType) const;
+	uint64_t GetTotalDifficulty(const EChainType chainType) const;
 
-	std::unique_ptr<BlockHeader> GetBlockHeaderByHash(const Hash& hash);
-	std::unique_ptr<BlockHeader> GetBlockHeaderByHeight(const uint64_t height, const EChainType chainType);
+	std::shared_ptr<const BlockHeader> GetBlockHeaderByHash(const Hash& hash);
+	std::shared_ptr<const BlockHeader> GetBlockHeaderByHeight(const uint64_t height, const EChainType chainType);
 
-	void BlockValidated(const Hash& hash);
-	bool HasBlockBeenValidated(const Hash& hash) const;
+	//
+	// Tracks blocks that passed the checks that don't depend on the TxHashSet (see BlockValidator).
+	// Blocks are identified by the hash of the whole serialized block, since the header hash doesn't commit to the body.
+	// These use their own lock, so they can be called with or without the chain state lock held.
+	//
+	void BlockValidated(const Hash& blockDataHash);
+	bool HasBlockBeenValidated(const Hash& blockDataHash) const;
+
+	//
+	// Doesn't lock the chain state. The orphan pool has its own lock.
+	//
+	bool HasOrphan(const Hash& hash) const;
 
 	LockedChainState GetLocked();
 	void FlushAll();
 
 private:
-	std::unique_ptr<BlockHeader> GetHead_Locked(const EChainType chainType);
-	const Hash& GetHeadHash_Locked(const EChainType chainType);
-
 	mutable std::shared_mutex m_headersMutex;
+	ChainTips m_chainTips;
 
 	const Config& m_config;
 	ChainStore& m_chainStore;
 	BlockStore& m_blockStore;
 	OrphanPool m_orphanPool;
+	DifficultyWindow m_syncDifficulty;
+	DifficultyWindow m_candidateDifficulty;
 	IHeaderMMR& m_headerMMR;
 	std::shared_ptr<ITxHashSet> m_pTxHashSet;
 
-	// TODO: Figure out best approach to storing orphans. Probably could just store them by hash, and iterate over them daily (weekly?) and get rid of anything beyond horizon.
+	mutable std::mutex m_validatedBlocksMutex;
 	std::set<Hash> m_validatedBlocks;
 };
\ No newline at end of file
@@ -1,15 +1,17 @@
 #include "ChainStore.h"
 
-#include <filesystem>
-#include <FileUtil.h>
 #include <vector>
-#include <map>
+#include <algorithm>
 
-ChainStore::ChainStore(const Config& config, BlockIndex* pGenesisIndex)
+ChainStore::ChainStore(const Config& config, const BlockIndex& genesisIndex)
 	: m_config(config),
-	m_confirmedChain(EChainType::CONFIRMED, pGenesisIndex),
-	m_candidateChain(EChainType::CANDIDATE, pGenesisIndex),
-	m_syncChain(EChainType::SYNC, pGenesisIndex),
+	m_arena(genesisIndex),
+	m_confirmedChain(EChainType::CONFIRMED, m_arena),
+	m_candidateChain(EChainType::CANDIDATE, m_arena),
+	m_syncChain(EChainType::SYNC, m_arena),
+	m_confirmedFile(config.GetChainDirectory() + "confirmed.chain"),
+	m_candidateFile(config.GetChainDirectory() + "candidate.chain"),
+	m_syncFile(config.GetChainDirectory() + "sync.chain"),
 	m_loaded(false)
 {
 
@@ -24,69 +26,75 @@ bool ChainStore::Load()
 
 	m_loaded = true;
 
-	const std::string dbPath = m_config.GetChainDirectory();
-
 	// TODO: Use Common Chain (pre-horizon?)
 
 	bool success = true;
-	if (!ReadChain(m_syncChain, dbPath + "sync.chain"))
+	if (!ReadChain(m_syncChain, m_syncFile))
 	{
 		success = false;
 	}
 
-	if (!ReadChain(m_candidateChain, dbPath + "candidate.chain"))
+	if (!ReadChain(m_candidateChain, m_candidateFile))
 	{
 		success = false;
 	}
 
-	if (!ReadChain(m_confirmedChain, dbPath + "confirmed.chain"))
+	if (!ReadChain(m_confirmedChain, m_confirmedFile))
 	{
 		success = false;
 	}
 
-	return false;
+	return success;
 }
 
-bool ChainStore::ReadChain(Chain& chain, const std::string& path)
+bool ChainStore::ReadChain(Chain& chain, File& file)
 {
-	std::vector<unsigned char> data;
-	if (FileUtil::ReadFile(path, data)) // TODO: Buffered read
+	if (!file.Load())
+	{
+		return false;
+	}
+
+	// Hashes are read straight from the mapped file, one at a time.
+	const uint64_t numHashes = file.GetSize() / 32;
+
+	for (uint64_t height = 1; height < numHashes; height++) // Start at 1 to ignore genesis hash
 	{
-		BlockIndex* pPrevious = chain.GetByHeight(0);
-		uint64_t height = 1; // Start at 1 to ignore genesis hash
-		while (height * 32 < data.size())
+		std::vector<unsigned char> hashBytes;
+		if (!file.Read(height * 32, 32, hashBytes))
 		{
-			const Hash hash = Hash(&data[height * 32]);
-			BlockIndex* pIndex = GetOrCreateIndex(hash, height, pPrevious);
-			chain.AddBlock(pIndex);
+			return false;
+		}
 
-			pPrevious = pIndex;
-			++height;
+		// Chains are read in the order they're normally ahead of each other, so each height is only stored once, by the first chain.
+		if (!chain.AddBlock(BlockIndex(Hash(std::move(hashBytes)), height)))
+		{
+			// Anything from here on gets truncated by the next flush.
+			return false;
 		}
+	}
 
-		return true;
+	if (numHashes > 0)
+	{
+		chain.MarkFlushed();
 	}
 
-	return false;
+	return true;
 }
 
 bool ChainStore::Flush()
 {
-	// Open file for writing
-	const std::string path = m_config.GetChainDirectory();
-
 	bool success = true;
-	if (!WriteChain(m_syncChain, path + "sync.chain"))
+	if (!WriteChain(m_syncChain, m_syncFile))
 	{
 		success = false;
 	}
 
-	if (!WriteChain(m_candidateChain, path + "candidate.chain"))
+	if (!WriteChain(m_candidateChain, m_candidateFile))
 	{
 		success = false;
 	}
 
-	if (!WriteChain(m_confirmedChain, path + "confirmed.chain"))
+	if (!WriteChain(m_confirmedChain, m_confirmedFile))
 	{
 		success = false;
 	}
@@ -94,73 +102,62 @@ bool ChainStore::Flush()
 	return success;
 }
 
-bool ChainStore::WriteChain(Chain& chain, const std::string& path)
+bool ChainStore::WriteChain(Chain& chain, File& file)
 {
-	std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::ate);
-	if (!file.is_open())
+	// Hashes below the first dirty height are already in the file. Anything after them belongs to rewound blocks.
+	const uint64_t firstHeight = std::min(chain.GetFirstDirtyHeight(), file.GetSize() / 32);
+	if (!file.Rewind(firstHeight * 32))
 	{
 		return false;
 	}
 
-	bool success = false;
-
-	// For each block, write hash to file
 	const uint64_t height = chain.GetTip()->GetHeight();
-	for (uint64_t i = 0; i <= height; i++)
+	if (firstHeight <= height)
 	{
-		BlockIndex* pIndex = chain.GetByHeight(i);
-		if (pIndex == nullptr)
+		std::vector<unsigned char> hashBytes;
+		hashBytes.reserve((height - firstHeight + 1) * 32);
+
+		for (uint64_t i = firstHeight; i <= height; i++)
 		{
-			break;
+			const Hash hash = chain.GetByHeight(i)->GetHash();
+			hashBytes.insert(hashBytes.end(), hash.GetData().cbegin(), hash.GetData().cend());
 		}
 
-		file.write((const char*)&pIndex->GetHash().GetData()[0], 32); // TODO: Use a buffered write.
+		file.Append(hashBytes);
 	}
 
-	// Close file
-	file.close();
-	return success;
-}
-
-BlockIndex* ChainStore::GetOrCreateIndex(const Hash& hash, const uint64_t height, BlockIndex* pPreviousIndex)
-{
-	BlockIndex* pSyncIndex = m_syncChain.GetByHeight(height);
-	if (pSyncIndex != nullptr && pSyncIndex->GetHash() == hash)
-	{
-		return pSyncIndex;
-	}
-
-	BlockIndex* pCandidateIndex = m_candidateChain.GetByHeight(height);
-	if (pCandidateIndex != nullptr && pCandidateIndex->GetHash() == hash)
+	if (!file.Flush())
 	{
-		return pCandidateIndex;
-	}
-
-	BlockIndex* pConfirmedIndex = m_confirmedChain.GetByHeight(height);
-	if (pConfirmedIndex != nullptr && pConfirmedIndex->GetHash() == hash)
-	{
-		return pConfirmedIndex;
+		return false;
 	}
 
-	return new BlockIndex(hash, height, pPreviousIndex);
+	chain.MarkFlushed();
+	return true;
 }
 
-BlockIndex* ChainStore::FindCommonIndex(const EChainType chainType1, const EChainType chainType2)
+const BlockIndex* ChainStore::FindCommonIndex(const EChainType chainType1, const EChainType chainType2)
 {
 	Chain& chain1 = GetChain(chainType1);
 	Chain& chain2 = GetChain(chainType2);
 
-	uint64_t height = std::min(chain1.GetTip()->GetHeight(), chain2.GetTip()->GetHeight());
-	BlockIndex* pChain1Index = chain1.GetByHeight(height);
-	BlockIndex* pChain2Index = chain2.GetByHeight(height);
-
-	while (pChain1Index->GetHash() != pChain2Index->GetHash())
+	// Both chains share the arena up to the shorter of their shared heights, so only their side-tables need to be searched.
+	// Chains that agree on a height agree on every height below it, so the last common height can be found by binary search.
+	uint64_t lowHeight = std::min(m_arena.GetNumShared(chainType1), m_arena.GetNumShared(chainType2)) - 1;
+	uint64_t highHeight = std::min(chain1.GetTip()->GetHeight(), chain2.GetTip()->GetHeight());
+	while (lowHeight < highHeight)
 	{
-		pChain1Index = pChain1Index->GetPrevious();
-		pChain2Index = pChain2Index->GetPrevious();
+		const uint64_t height = lowHeight + ((highHeight - lowHeight + 1) / 2);
+		if (*chain1.GetByHeight(height) == *chain2.GetByHeight(height))
+		{
+			lowHeight = height;
+		}
+		else
+		{
+			highHeight = height - 1;
+		}
 	}
 
-	return pChain1Index;
+	return chain1.GetByHeight(lowHeight);
 }
 
 Chain& ChainStore::GetChain(const EChainType chainType)
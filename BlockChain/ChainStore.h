@@ -3,31 +3,40 @@
 #include "Chain.h"
 
 #include <Config/Config.h>
+#include <Core/File.h>
 
+//
+// Each chain is persisted as an append-only file of 32-byte hashes, indexed by height.
+// Files are memory-mapped, and a flush only truncates to the first changed height and appends the new tail.
+//
 // TODO: Move to Database
 class ChainStore
 {
 public:
-	ChainStore(const Config& config, BlockIndex* pGenesisIndex);
+	ChainStore(const Config& config, const BlockIndex& genesisIndex);
 	bool Load();
 	bool Flush();
 
 	Chain& GetChain(const EChainType chainType);
-	BlockIndex* GetOrCreateIndex(const Hash& hash, const uint64_t height, BlockIndex* pPreviousIndex);
-	BlockIndex* FindCommonIndex(const EChainType chainType1, const EChainType chainType2);
+	const BlockIndex* FindCommonIndex(const EChainType chainType1, const EChainType chainType2);
 
 	inline Chain& GetConfirmedChain() { return m_confirmedChain; }
 	inline Chain& GetCandidateChain() { return m_candidateChain; }
 	inline Chain& GetSyncChain() { return m_syncChain; }
 
 private:
-	bool ReadChain(Chain& chain, const std::string& path);
-	bool WriteChain(Chain& chain, const std::string& path);
+	bool ReadChain(Chain& chain, File& file);
+	bool WriteChain(Chain& chain, File& file);
 
 	bool m_loaded;
+	BlockIndexArena m_arena;
 	Chain m_confirmedChain;
 	Chain m_candidateChain;
 	Chain m_syncChain;
 
+	File m_confirmedFile;
+	File m_candidateFile;
+	File m_syncFile;
+
 	const Config& m_config;
 };
\ No newline at end of file
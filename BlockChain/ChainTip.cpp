@@ -0,0 +1,43 @@
+#include "ChainTip.h"
+
+#include <Infrastructure/Logger.h>
+#include <atomic>
+
+std::shared_ptr<const ChainTip> ChainTips::GetTip(const EChainType chainType) const
+{
+	return std::atomic_load(&m_tips[(size_t)chainType]);
+}
+
+void ChainTips::Publish(ChainStore& chainStore, BlockStore& blockStore)
+{
+	for (const EChainType chainType : { EChainType::SYNC, EChainType::CANDIDATE, EChainType::CONFIRMED })
+	{
+		const BlockIndex* pTipIndex = chainStore.GetChain(chainType).GetTip();
+
+		const std::shared_ptr<const ChainTip> pCurrentTip = GetTip(chainType);
+		if (pCurrentTip != nullptr && pCurrentTip->GetHash() == pTipIndex->GetHash())
+		{
+			continue;
+		}
+
+		std::shared_ptr<const ChainTip> pNewTip = nullptr;
+		std::shared_ptr<const BlockHeader> pHeader = blockStore.GetBlockHeaderByHash(pTipIndex->GetHash());
+		if (pHeader != nullptr)
+		{
+			pNewTip = std::make_shared<const ChainTip>(
+				pHeader->GetHash(),
+				pHeader->GetHeight(),
+				pHeader->GetProofOfWork().GetTotalDifficulty(),
+				pHeader->GetOutputMMRSize(),
+				pHeader->GetKernelMMRSize()
+			);
+		}
+		else
+		{
+			LoggerAPI::LogWarning("ChainTips::Publish - Header not found for tip at height " + std::to_string(pTipIndex->GetHeight()));
+			pNewTip = std::make_shared<const ChainTip>(pTipIndex->GetHash(), pTipIndex->GetHeight(), 0, 0, 0);
+		}
+
+		std::atomic_store(&m_tips[(size_t)chainType], pNewTip);
+	}
+}
\ No newline at end of file
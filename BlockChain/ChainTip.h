@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ChainStore.h"
+#include "BlockStore.h"
+
+#include <Core/ChainType.h>
+#include <Hash.h>
+#include <stdint.h>
+#include <memory>
+#include <array>
+
+//
+// An immutable summary of the tip of a chain.
+//
+class ChainTip
+{
+public:
+	ChainTip(const Hash& hash, const uint64_t height, const uint64_t totalDifficulty, const uint64_t outputMMRSize, const uint64_t kernelMMRSize)
+		: m_hash(hash), m_height(height), m_totalDifficulty(totalDifficulty), m_outputMMRSize(outputMMRSize), m_kernelMMRSize(kernelMMRSize)
+	{
+
+	}
+
+	inline const Hash& GetHash() const { return m_hash; }
+	inline uint64_t GetHeight() const { return m_height; }
+	inline uint64_t GetTotalDifficulty() const { return m_totalDifficulty; }
+	inline uint64_t GetOutputMMRSize() const { return m_outputMMRSize; }
+	inline uint64_t GetKernelMMRSize() const { return m_kernelMMRSize; }
+
+private:
+	const Hash m_hash;
+	const uint64_t m_height;
+	const uint64_t m_totalDifficulty;
+	const uint64_t m_outputMMRSize;
+	const uint64_t m_kernelMMRSize;
+};
+
+//
+// The latest ChainTip of each chain type.
+// Tips are published with an atomic shared_ptr store, so readers never take the chain state lock,
+// and a tip they loaded stays valid for as long as they hold on to it.
+//
+class ChainTips
+{
+public:
+	//
+	// Returns nullptr until the first tips are published.
+	//
+	std::shared_ptr<const ChainTip> GetTip(const EChainType chainType) const;
+
+	//
+	// Publishes a new tip for each chain whose tip changed since the last call.
+	// Called when the chain state is initialized, and whenever its write lock is released (see LockedChainState),
+	// so a tip is never newer than the chain state a reader could lock afterwards.
+	// WARNING: Caller must hold the chain state write lock.
+	//
+	void Publish(ChainStore& chainStore, BlockStore& blockStore);
+
+private:
+	// Indexed by EChainType.
+	std::array<std::shared_ptr<const ChainTip>, 3> m_tips;
+};
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "DifficultyWindow.h"
+#include "BlockStore.h"
+
+#include <Consensus/BlockDifficulty.h>
+#include <Consensus/BlockTime.h>
+#include <Infrastructure/Logger.h>
+#include <HexUtil.h>
+#include <algorithm>
+
+DifficultyWindow::DifficultyWindow(BlockStore& blockStore)
+	: m_blockStore(blockStore), m_entries(CAPACITY), m_tipHeight(0), m_size(0)
+{
+
+}
+
+bool DifficultyWindow::CalculateNext(const BlockHeader& previousHeader, uint64_t& difficultyOut, uint32_t& secondaryScalingOut)
+{
+	if (!MoveTo(previousHeader))
+	{
+		return false;
+	}
+
+	const Entry& tip = GetEntry(m_tipHeight);
+
+	uint64_t timestampDelta = 0;
+	uint64_t difficultySum = 0;
+	uint64_t scalingSum = 0;
+	uint64_t numSecondary = 0;
+
+	uint64_t firstHeight = 0;
+	if (m_tipHeight >= Consensus::DIFFICULTY_ADJUST_WINDOW)
+	{
+		// The first entry only bounds the time span.
+		const Entry& first = GetEntry(m_tipHeight - Consensus::DIFFICULTY_ADJUST_WINDOW);
+		timestampDelta = tip.m_timestamp - first.m_timestamp;
+		difficultySum = tip.m_totalDifficulty - first.m_totalDifficulty;
+		firstHeight = m_tipHeight - Consensus::DIFFICULTY_ADJUST_WINDOW + 1;
+	}
+	else
+	{
+		// Just after launch, the window is padded with simulated pre-genesis headers, perfectly timed at the tip's difficulty.
+		// As above, the first (simulated) entry only bounds the time span.
+		const uint64_t numSimulated = Consensus::DIFFICULTY_ADJUST_WINDOW - m_tipHeight;
+		const uint64_t lastTimestampDelta = m_tipHeight > 0 ? (tip.m_timestamp - GetEntry(m_tipHeight - 1).m_timestamp) : Consensus::BLOCK_TIME_SEC;
+		const uint64_t simulatedTime = numSimulated * lastTimestampDelta;
+		const uint64_t genesisTimestamp = GetEntry(0).m_timestamp;
+		const uint64_t firstTimestamp = genesisTimestamp > simulatedTime ? (genesisTimestamp - simulatedTime) : 0;
+
+		timestampDelta = tip.m_timestamp - firstTimestamp;
+		difficultySum = tip.m_totalDifficulty + ((numSimulated - 1) * tip.m_difficulty);
+		scalingSum = (numSimulated - 1) * Consensus::INITIAL_GRAPH_WEIGHT;
+		numSecondary = numSimulated - 1;
+	}
+
+	for (uint64_t height = firstHeight; height <= m_tipHeight; height++)
+	{
+		const Entry& entry = GetEntry(height);
+		scalingSum += entry.m_secondaryScaling;
+		numSecondary += entry.m_secondary ? 1 : 0;
+	}
+
+	difficultyOut = Consensus::CalculateNextDifficulty(timestampDelta, difficultySum);
+	secondaryScalingOut = Consensus::CalculateSecondaryScaling(m_tipHeight + 1, scalingSum, numSecondary);
+	return true;
+}
+
+bool DifficultyWindow::CalculateMedianTimestamp(const BlockHeader& header, uint64_t& medianTimestampOut)
+{
+	if (!MoveTo(header))
+	{
+		return false;
+	}
+
+	// The window always holds at least MEDIAN_TIME_WINDOW entries, or every entry since genesis.
+	const uint64_t numTimestamps = std::min(m_tipHeight + 1, Consensus::MEDIAN_TIME_WINDOW);
+
+	std::vector<uint64_t> timestamps;
+	timestamps.reserve(numTimestamps);
+	for (uint64_t height = m_tipHeight + 1 - numTimestamps; height <= m_tipHeight; height++)
+	{
+		timestamps.push_back(GetEntry(height).m_timestamp);
+	}
+
+	std::sort(timestamps.begin(), timestamps.end());
+	medianTimestampOut = timestamps[timestamps.size() / 2];
+	return true;
+}
+
+// Moves the tip of the window to the header, sliding forward by one or rewinding when possible.
+bool DifficultyWindow::MoveTo(const BlockHeader& header)
+{
+	const uint64_t height = header.GetHeight();
+	if (Contains(height) && GetEntry(height).m_hash == header.GetHash())
+	{
+		m_size -= (m_tipHeight - height);
+		m_tipHeight = height;
+	}
+	else if (height > 0 && Contains(height - 1) && GetEntry(height - 1).m_hash == header.GetPreviousBlockHash())
+	{
+		m_size -= (m_tipHeight - (height - 1));
+		m_tipHeight = height - 1;
+		Push(header, GetEntry(height - 1).m_totalDifficulty);
+	}
+	else
+	{
+		return Reload(header);
+	}
+
+	// Rewinding may leave too few entries behind the new tip.
+	return IsComplete() || Reload(header);
+}
+
+// Reloads the window from the BlockStore, ending at the header.
+bool DifficultyWindow::Reload(const BlockHeader& header)
+{
+	LoggerAPI::LogDebug("DifficultyWindow::Reload - Loading difficulty window for header " + header.FormatHash());
+
+	m_size = 0;
+
+	// The difficulty of each entry depends on the header before it, so one extra header is loaded, unless the window reaches genesis.
+	const bool reachesGenesis = header.GetHeight() <= Consensus::DIFFICULTY_ADJUST_WINDOW;
+	const uint64_t numAncestors = reachesGenesis ? header.GetHeight() : (Consensus::DIFFICULTY_ADJUST_WINDOW + 1);
+
+	std::vector<std::shared_ptr<const BlockHeader>> ancestors;
+	ancestors.reserve(numAncestors);
+
+	Hash previousHash = header.GetPreviousBlockHash();
+	for (uint64_t i = 0; i < numAncestors; i++)
+	{
+		std::shared_ptr<const BlockHeader> pAncestor = m_blockStore.GetBlockHeaderByHash(previousHash);
+		if (pAncestor == nullptr)
+		{
+			LoggerAPI::LogWarning("DifficultyWindow::Reload - Failed to load header " + HexUtil::ConvertHash(previousHash));
+			return false;
+		}
+
+		previousHash = pAncestor->GetPreviousBlockHash();
+		ancestors.emplace_back(std::move(pAncestor));
+	}
+
+	uint64_t previousTotalDifficulty = 0;
+	auto iter = ancestors.crbegin();
+	if (!reachesGenesis)
+	{
+		previousTotalDifficulty = (*iter)->GetProofOfWork().GetTotalDifficulty();
+		iter++;
+	}
+
+	for (; iter != ancestors.crend(); iter++)
+	{
+		Push(**iter, previousTotalDifficulty);
+		previousTotalDifficulty = (*iter)->GetProofOfWork().GetTotalDifficulty();
+	}
+
+	Push(header, previousTotalDifficulty);
+	return true;
+}
+
+void DifficultyWindow::Push(const BlockHeader& header, const uint64_t previousTotalDifficulty)
+{
+	const ProofOfWork& proofOfWork = header.GetProofOfWork();
+
+	m_tipHeight = header.GetHeight();
+	if (m_size < CAPACITY)
+	{
+		m_size++;
+	}
+
+	Entry& entry = m_entries[m_tipHeight % CAPACITY];
+	entry.m_hash = header.GetHash();
+	entry.m_timestamp = (uint64_t)header.GetTimestamp();
+	entry.m_totalDifficulty = proofOfWork.GetTotalDifficulty();
+	entry.m_difficulty = proofOfWork.GetTotalDifficulty() - previousTotalDifficulty;
+	entry.m_secondaryScaling = proofOfWork.GetScalingDifficulty();
+	entry.m_secondary = proofOfWork.GetEdgeBits() == Consensus::SECOND_POW_EDGE_BITS;
+}
+
+bool DifficultyWindow::Contains(const uint64_t height) const
+{
+	return m_size > 0 && height <= m_tipHeight && (m_tipHeight - height) < m_size;
+}
+
+// The window needs DIFFICULTY_ADJUST_WINDOW + 1 entries, or every entry since genesis.
+bool DifficultyWindow::IsComplete() const
+{
+	return m_size > std::min(m_tipHeight, Consensus::DIFFICULTY_ADJUST_WINDOW);
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Core/BlockHeader.h>
+#include <Hash.h>
+#include <stdint.h>
+#include <vector>
+
+// Forward Declarations
+class BlockStore;
+
+//
+// A ring buffer of the timestamp, difficulty and secondary scaling of the last headers along one chain,
+// which the next difficulty and secondary scaling (and the median timestamp) are calculated from.
+//
+// The window slides by one header each time it's asked about the header after its tip, and rewinds by just moving its tip back
+// when asked about a header it already holds, so only the first request or a deep fork loads headers from the BlockStore.
+// Entries are identified by hash, so headers that fail validation or get rolled back never leave the window inconsistent.
+//
+class DifficultyWindow
+{
+public:
+	DifficultyWindow(BlockStore& blockStore);
+
+	//
+	// Calculates the difficulty and secondary scaling the header following the previous header must have.
+	// Returns false if the headers needed couldn't be loaded.
+	//
+	bool CalculateNext(const BlockHeader& previousHeader, uint64_t& difficultyOut, uint32_t& secondaryScalingOut);
+
+	//
+	// Calculates the median timestamp of the last MEDIAN_TIME_WINDOW headers, up to and including the given header.
+	// Returns false if the headers needed couldn't be loaded.
+	//
+	bool CalculateMedianTimestamp(const BlockHeader& header, uint64_t& medianTimestampOut);
+
+private:
+	struct Entry
+	{
+		Hash m_hash;
+		uint64_t m_timestamp;
+		uint64_t m_totalDifficulty;
+		uint64_t m_difficulty;
+		uint32_t m_secondaryScaling;
+		bool m_secondary;
+	};
+
+	bool MoveTo(const BlockHeader& header);
+	bool Reload(const BlockHeader& header);
+	void Push(const BlockHeader& header, const uint64_t previousTotalDifficulty);
+
+	bool Contains(const uint64_t height) const;
+	bool IsComplete() const;
+	inline const Entry& GetEntry(const uint64_t height) const { return m_entries[height % CAPACITY]; }
+
+	// Larger than the DIFFICULTY_ADJUST_WINDOW + 1 entries needed, so forks up to the difference deep are rewound without reloading.
+	static const uint64_t CAPACITY = 128;
+
+	BlockStore& m_blockStore;
+	std::vector<Entry> m_entries;
+	uint64_t m_tipHeight;
+	uint64_t m_size;
+};
\ No newline at end of file
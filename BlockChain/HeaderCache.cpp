@@ -0,0 +1,70 @@
+#include "HeaderCache.h"
+
+#include <algorithm>
+
+HeaderCache::HeaderCache(const uint64_t maxBytes)
+	: m_capacityPerShard(std::max(maxBytes / (ENTRY_BYTES * NUM_SHARDS), (uint64_t)1)), m_hits(0), m_misses(0)
+{
+
+}
+
+std::shared_ptr<const BlockHeader> HeaderCache::Get(const Hash& hash)
+{
+	Shard& shard = GetShard(hash);
+	std::lock_guard<std::mutex> lockGuard(shard.m_mutex);
+
+	auto iter = shard.m_indexByHash.find(hash);
+	if (iter == shard.m_indexByHash.cend())
+	{
+		m_misses++;
+		return nullptr;
+	}
+
+	m_hits++;
+
+	Entry& entry = shard.m_entries[iter->second];
+	entry.m_referenced = true;
+	return entry.m_pHeader;
+}
+
+void HeaderCache::Put(const std::shared_ptr<const BlockHeader>& pHeader)
+{
+	const Hash& hash = pHeader->GetHash();
+
+	Shard& shard = GetShard(hash);
+	std::lock_guard<std::mutex> lockGuard(shard.m_mutex);
+
+	auto iter = shard.m_indexByHash.find(hash);
+	if (iter != shard.m_indexByHash.cend())
+	{
+		shard.m_entries[iter->second].m_referenced = true;
+		return;
+	}
+
+	if (shard.m_entries.size() < m_capacityPerShard)
+	{
+		shard.m_indexByHash[hash] = shard.m_entries.size();
+		shard.m_entries.emplace_back(Entry{ pHeader, false });
+		return;
+	}
+
+	// Sweep past recently used entries, giving each a second chance, until one that wasn't used since the last sweep is found.
+	while (shard.m_entries[shard.m_hand].m_referenced)
+	{
+		shard.m_entries[shard.m_hand].m_referenced = false;
+		shard.m_hand = (shard.m_hand + 1) % shard.m_entries.size();
+	}
+
+	Entry& victim = shard.m_entries[shard.m_hand];
+	shard.m_indexByHash.erase(victim.m_pHeader->GetHash());
+	shard.m_indexByHash[hash] = shard.m_hand;
+	victim = Entry{ pHeader, false };
+
+	shard.m_hand = (shard.m_hand + 1) % shard.m_entries.size();
+}
+
+HeaderCache::Shard& HeaderCache::GetShard(const Hash& hash)
+{
+	// Block hashes are uniformly distributed, so any byte will do.
+	return m_shards[hash[0] % NUM_SHARDS];
+}
\ No newline at end of file
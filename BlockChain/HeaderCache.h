@@ -0,0 +1,65 @@
+#pragma once
+
+#include <Core/BlockHeader.h>
+#include <Hash.h>
+#include <stdint.h>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <array>
+#include <vector>
+#include <map>
+
+//
+// A size-bounded cache of block headers, used for headers that are no longer kept in memory by the BlockStore.
+// Entries are split into shards by hash, each with its own lock, so concurrent readers rarely contend.
+// Each shard evicts using CLOCK (second chance), which only has to mark an entry on a hit, rather than reorder a list.
+//
+class HeaderCache
+{
+public:
+	HeaderCache(const uint64_t maxBytes);
+
+	//
+	// Returns nullptr if the header isn't cached.
+	//
+	std::shared_ptr<const BlockHeader> Get(const Hash& hash);
+
+	//
+	// Caches the header, evicting another from its shard if the shard is full.
+	//
+	void Put(const std::shared_ptr<const BlockHeader>& pHeader);
+
+	inline uint64_t GetCapacity() const { return m_capacityPerShard * NUM_SHARDS; }
+	inline uint64_t GetHits() const { return m_hits.load(); }
+	inline uint64_t GetMisses() const { return m_misses.load(); }
+
+	// Approximate memory used by each entry: the header, its heap-allocated hashes (plus the key), its 42 proof nonces,
+	// and the allocation overhead of the shared_ptr and the index node.
+	static const uint64_t ENTRY_BYTES = sizeof(BlockHeader) + (8 * 32) + (42 * sizeof(uint64_t)) + 256;
+
+private:
+	static const size_t NUM_SHARDS = 16;
+
+	struct Entry
+	{
+		std::shared_ptr<const BlockHeader> m_pHeader;
+		bool m_referenced;
+	};
+
+	struct Shard
+	{
+		std::mutex m_mutex;
+		std::vector<Entry> m_entries;
+		std::map<Hash, size_t> m_indexByHash;
+		size_t m_hand{ 0 };
+	};
+
+	Shard& GetShard(const Hash& hash);
+
+	const uint64_t m_capacityPerShard;
+	std::array<Shard, NUM_SHARDS> m_shards;
+
+	std::atomic<uint64_t> m_hits;
+	std::atomic<uint64_t> m_misses;
+};
\ No newline at end of file
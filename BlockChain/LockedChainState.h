@@ -3,6 +3,8 @@
 #include "BlockStore.h"
 #include "ChainStore.h"
 #include "OrphanPool.h"
+#include "DifficultyWindow.h"
+#include "ChainTip.h"
 
 #include <HeaderMMR.h>
 #include <Core/BlockHeader.h>
@@ -15,13 +17,16 @@
 class LockedChainState
 {
 public:
-	LockedChainState(std::shared_mutex& mutex, ChainStore& chainStore, BlockStore& blockStore, IHeaderMMR& headerMMR, OrphanPool& orphanPool, std::shared_ptr<ITxHashSet>& pTxHashSet)
+	LockedChainState(std::shared_mutex& mutex, ChainTips& chainTips, ChainStore& chainStore, BlockStore& blockStore, IHeaderMMR& headerMMR, OrphanPool& orphanPool, DifficultyWindow& syncDifficulty, DifficultyWindow& candidateDifficulty, std::shared_ptr<ITxHashSet>& pTxHashSet)
 		: m_pReferences(new int(1)), 
 		m_mutex(mutex), 
+		m_chainTips(chainTips), 
 		m_chainStore(chainStore), 
 		m_blockStore(blockStore), 
 		m_headerMMR(headerMMR), 
 		m_orphanPool(orphanPool), 
+		m_syncDifficulty(syncDifficulty), 
+		m_candidateDifficulty(candidateDifficulty), 
 		m_pTxHashSet(pTxHashSet)
 	{
 		m_mutex.lock();
@@ -32,6 +37,8 @@ public:
 	{
 		if (--(*m_pReferences) == 0)
 		{
+			// Publish any new tips before unlocking, so lock-free readers see them as soon as the chain state can be read.
+			m_chainTips.Publish(m_chainStore, m_blockStore);
 			m_mutex.unlock();
 			LoggerAPI::LogInfo("LockedChainState - Mutex Unlocked.");
 			delete m_pReferences;
@@ -41,26 +48,36 @@ public:
 	LockedChainState(const LockedChainState& other)
 		: m_pReferences(other.m_pReferences),
 		m_mutex(other.m_mutex),
+		m_chainTips(other.m_chainTips),
 		m_chainStore(other.m_chainStore),
 		m_blockStore(other.m_blockStore),
 		m_headerMMR(other.m_headerMMR),
 		m_orphanPool(other.m_orphanPool),
+		m_syncDifficulty(other.m_syncDifficulty),
+		m_candidateDifficulty(other.m_candidateDifficulty),
 		m_pTxHashSet(other.m_pTxHashSet)
 	{
 		++(*m_pReferences);
 	}
 	LockedChainState& operator=(const LockedChainState&) = delete;
 
+	//
+	// Takes ownership of the given TxHashSet (which may be null), and deletes the current one.
+	// The current TxHashSet must never be deleted any other way, since ChainState owns it.
+	//
 	inline void UpdateTxHashSet(ITxHashSet* pTxHashSet) { m_pTxHashSet.reset(pTxHashSet); }
 	inline ITxHashSet* GetTxHashSet() { return m_pTxHashSet.get(); }
 
 	int* m_pReferences;
 	std::shared_mutex& m_mutex;
+	ChainTips& m_chainTips;
 	ChainStore& m_chainStore;
 	BlockStore& m_blockStore;
 	IHeaderMMR& m_headerMMR;
 	OrphanPool& m_orphanPool;
+	DifficultyWindow& m_syncDifficulty;
+	DifficultyWindow& m_candidateDifficulty;
 	
 private:
-	std::shared_ptr<ITxHashSet> m_pTxHashSet;
+	std::shared_ptr<ITxHashSet>& m_pTxHashSet;
 };
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "OrphanPool.h"
+
+#include <Infrastructure/Logger.h>
+#include <StringUtil.h>
+#include <HexUtil.h>
+#include <iterator>
+
+OrphanPool::OrphanPool(const Config& config)
+	: m_maxBytes((uint64_t)config.GetChainConfig().GetOrphanPoolMB() * 1024 * 1024), m_bytes(0)
+{
+
+}
+
+bool OrphanPool::IsOrphan(const Hash& hash) const
+{
+	std::lock_guard<std::mutex> lockGuard(m_mutex);
+
+	return m_orphansByHash.find(hash) != m_orphansByHash.cend();
+}
+
+bool OrphanPool::AddOrphan(const FullBlock& block)
+{
+	std::lock_guard<std::mutex> lockGuard(m_mutex);
+
+	const Hash& hash = block.GetHash();
+	if (m_orphansByHash.find(hash) != m_orphansByHash.cend())
+	{
+		return false;
+	}
+
+	const uint64_t bytes = EstimateBytes(block);
+	if (bytes > m_maxBytes)
+	{
+		return false;
+	}
+
+	// Make room by evicting the oldest orphans.
+	while (m_bytes + bytes > m_maxBytes)
+	{
+		LoggerAPI::LogDebug("OrphanPool::AddOrphan - Pool full. Evicting orphan " + HexUtil::ConvertHash(m_hashesByAge.front()));
+		Remove(m_orphansByHash.find(m_hashesByAge.front()));
+	}
+
+	m_hashesByAge.push_back(hash);
+
+	Orphan orphan;
+	orphan.m_pBlock = std::make_shared<const FullBlock>(block);
+	orphan.m_bytes = bytes;
+	orphan.m_received = std::chrono::system_clock::now();
+	orphan.m_ageIter = std::prev(m_hashesByAge.end());
+
+	m_orphansByHash.emplace(hash, std::move(orphan));
+	m_hashesByPrevious.emplace(block.GetBlockHeader().GetPreviousBlockHash(), hash);
+	m_bytes += bytes;
+
+	return true;
+}
+
+void OrphanPool::RemoveOrphan(const Hash& hash)
+{
+	std::lock_guard<std::mutex> lockGuard(m_mutex);
+
+	auto iter = m_orphansByHash.find(hash);
+	if (iter != m_orphansByHash.end())
+	{
+		Remove(iter);
+	}
+}
+
+std::vector<std::shared_ptr<const FullBlock>> OrphanPool::TakeChildren(const Hash& previousHash)
+{
+	std::lock_guard<std::mutex> lockGuard(m_mutex);
+
+	std::vector<Hash> childHashes;
+	auto range = m_hashesByPrevious.equal_range(previousHash);
+	for (auto iter = range.first; iter != range.second; iter++)
+	{
+		childHashes.push_back(iter->second);
+	}
+
+	std::vector<std::shared_ptr<const FullBlock>> children;
+	for (const Hash& childHash : childHashes)
+	{
+		auto orphanIter = m_orphansByHash.find(childHash);
+		children.push_back(orphanIter->second.m_pBlock);
+		Remove(orphanIter);
+	}
+
+	return children;
+}
+
+void OrphanPool::Prune(const uint64_t confirmedHeight)
+{
+	std::lock_guard<std::mutex> lockGuard(m_mutex);
+
+	const size_t numOrphans = m_orphansByHash.size();
+	const auto expiry = std::chrono::system_clock::now() - std::chrono::seconds((int64_t)MAX_AGE_SECONDS);
+
+	auto iter = m_orphansByHash.begin();
+	while (iter != m_orphansByHash.end())
+	{
+		const Orphan& orphan = iter->second;
+		if (orphan.m_pBlock->GetBlockHeader().GetHeight() <= confirmedHeight || orphan.m_received < expiry)
+		{
+			Remove(iter++);
+		}
+		else
+		{
+			iter++;
+		}
+	}
+
+	if (m_orphansByHash.size() != numOrphans)
+	{
+		LoggerAPI::LogDebug(StringUtil::Format("OrphanPool::Prune - Pruned %llu orphans. %llu remaining.", (uint64_t)(numOrphans - m_orphansByHash.size()), (uint64_t)m_orphansByHash.size()));
+	}
+}
+
+// Caller must hold the lock.
+void OrphanPool::Remove(std::map<Hash, Orphan>::iterator iter)
+{
+	const Hash& previousHash = iter->second.m_pBlock->GetBlockHeader().GetPreviousBlockHash();
+	auto range = m_hashesByPrevious.equal_range(previousHash);
+	for (auto previousIter = range.first; previousIter != range.second; previousIter++)
+	{
+		if (previousIter->second == iter->first)
+		{
+			m_hashesByPrevious.erase(previousIter);
+			break;
+		}
+	}
+
+	m_hashesByAge.erase(iter->second.m_ageIter);
+	m_bytes -= iter->second.m_bytes;
+	m_orphansByHash.erase(iter);
+}
+
+// Approximate memory used by the block: each element, plus the rangeproofs, which are allocated separately.
+uint64_t OrphanPool::EstimateBytes(const FullBlock& block)
+{
+	const TransactionBody& body = block.GetTransactionBody();
+
+	uint64_t bytes = sizeof(FullBlock) + (42 * sizeof(uint64_t));
+	bytes += body.GetInputs().size() * sizeof(TransactionInput);
+	bytes += body.GetKernels().size() * sizeof(TransactionKernel);
+	for (const TransactionOutput& output : body.GetOutputs())
+	{
+		bytes += sizeof(TransactionOutput) + output.GetRangeProof().GetProofBytes().size();
+	}
+
+	return bytes;
+}
\ No newline at end of file
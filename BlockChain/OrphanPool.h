@@ -1,17 +1,74 @@
 #pragma once
 
 #include <Hash.h>
-#include <Core/BlockHeader.h>
+#include <Core/FullBlock.h>
+#include <Config/Config.h>
 
 #include <map>
+#include <list>
+#include <vector>
+#include <memory>
 #include <mutex>
+#include <chrono>
 
+//
+// Full blocks that can't be applied yet, because their parent hasn't been confirmed (eg. blocks received out of order during sync).
+// Orphans are indexed by hash, and by previous block hash, so the children of a block can be processed as soon as it's confirmed.
+//
+// The pool is bounded by the configured memory budget, evicting the oldest orphans first.
+// Orphans also expire once they're older than MAX_AGE_SECONDS, or no longer above the confirmed height.
+//
+// Safe to call concurrently. The pool has its own lock, so IsOrphan can be called without holding the chain state lock.
+//
 class OrphanPool
 {
 public:
-	bool IsOrphan(const Hash& hash) const { return m_orphanHeaders.count(hash) > 0; }
-	void AddOrphan(const BlockHeader& header) { m_orphanHeaders[header.GetHash()] = new BlockHeader(header); }
+	OrphanPool(const Config& config);
+
+	bool IsOrphan(const Hash& hash) const;
+
+	//
+	// Returns false if the block is already an orphan, or is too large for the pool.
+	//
+	bool AddOrphan(const FullBlock& block);
+
+	//
+	// Removes the orphan with the given hash, if there is one.
+	//
+	void RemoveOrphan(const Hash& hash);
+
+	//
+	// Removes and returns the orphans whose previous block is the given block.
+	//
+	std::vector<std::shared_ptr<const FullBlock>> TakeChildren(const Hash& previousHash);
+
+	//
+	// Removes orphans at or below the confirmed height, and any older than MAX_AGE_SECONDS.
+	//
+	void Prune(const uint64_t confirmedHeight);
+
+	// Orphans are kept long enough for a slow peer to deliver the missing parent during sync.
+	static const int64_t MAX_AGE_SECONDS = 600;
 
 private:
-	std::map<Hash, BlockHeader*> m_orphanHeaders;
+	struct Orphan
+	{
+		std::shared_ptr<const FullBlock> m_pBlock;
+		uint64_t m_bytes;
+		std::chrono::system_clock::time_point m_received;
+		std::list<Hash>::iterator m_ageIter;
+	};
+
+	void Remove(std::map<Hash, Orphan>::iterator iter);
+	static uint64_t EstimateBytes(const FullBlock& block);
+
+	mutable std::mutex m_mutex;
+	const uint64_t m_maxBytes;
+	uint64_t m_bytes;
+
+	std::map<Hash, Orphan> m_orphansByHash;
+	std::multimap<Hash, Hash> m_hashesByPrevious;
+
+	// Oldest first.
+	std::list<Hash> m_hashesByAge;
 };
\ No newline at end of file
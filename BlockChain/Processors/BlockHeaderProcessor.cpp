@@ -5,6 +5,8 @@
 #include <HeaderMMR.h>
 #include <HexUtil.h>
 #include <StringUtil.h>
+#include <async++.h>
+#include <atomic>
 
 BlockHeaderProcessor::BlockHeaderProcessor(ChainState& chainState)
 	: m_chainState(chainState)
@@ -20,7 +22,7 @@ EBlockChainStatus BlockHeaderProcessor::ProcessSingleHeader(const BlockHeader& h
 	Chain& candidateChain = lockedState.m_chainStore.GetCandidateChain();
 
 	// Check if header already processed
-	BlockIndex* pCandidateIndex = candidateChain.GetByHeight(header.GetHeight());
+	const BlockIndex* pCandidateIndex = candidateChain.GetByHeight(header.GetHeight());
 	if (pCandidateIndex != nullptr && pCandidateIndex->GetHash() == header.GetHash())
 	{
 		LoggerAPI::LogInfo(StringUtil::Format("BlockHeaderProcessor::ProcessSingleHeader - Header %s already processed.", header.FormatHash().c_str()));
@@ -28,7 +30,7 @@ EBlockChainStatus BlockHeaderProcessor::ProcessSingleHeader(const BlockHeader& h
 	}
 
 	// If this is not the next header needed, process as an orphan.
-	BlockIndex* pLastIndex = candidateChain.GetTip();
+	const BlockIndex* pLastIndex = candidateChain.GetTip();
 	if (pLastIndex->GetHash() != header.GetPreviousBlockHash())
 	{
 		LoggerAPI::LogInfo(StringUtil::Format("BlockHeaderProcessor::ProcessSingleHeader - Processing header %s as an orphan.", header.FormatHash().c_str()));
@@ -39,8 +41,8 @@ EBlockChainStatus BlockHeaderProcessor::ProcessSingleHeader(const BlockHeader& h
 	LoggerAPI::LogDebug("BlockHeaderProcessor::ProcessSingleHeader - Processing next candidate header " + header.FormatHash());
 
 	// Validate the header.
-	std::unique_ptr<BlockHeader> pPreviousHeaderPtr = lockedState.m_blockStore.GetBlockHeaderByHash(pLastIndex->GetHash());
-	if (!BlockHeaderValidator(lockedState.m_headerMMR).IsValidHeader(header, *pPreviousHeaderPtr))
+	std::shared_ptr<const BlockHeader> pPreviousHeaderPtr = lockedState.m_blockStore.GetBlockHeaderByHash(pLastIndex->GetHash());
+	if (!BlockHeaderValidator(lockedState.m_headerMMR, lockedState.m_candidateDifficulty).IsValidHeader(header, *pPreviousHeaderPtr))
 	{
 		LoggerAPI::LogDebug("BlockHeaderProcessor::ProcessSingleHeader - Header failed to validate.");
 		return EBlockChainStatus::INVALID;
@@ -50,9 +52,15 @@ EBlockChainStatus BlockHeaderProcessor::ProcessSingleHeader(const BlockHeader& h
 	lockedState.m_headerMMR.AddHeader(header);
 	lockedState.m_headerMMR.Commit();
 
-	BlockIndex* pBlockIndex = lockedState.m_chainStore.GetOrCreateIndex(header.GetHash(), header.GetHeight(), pLastIndex);
-	lockedState.m_chainStore.GetSyncChain().AddBlock(pBlockIndex);
-	candidateChain.AddBlock(pBlockIndex);
+	// The sync chain is only extended if it's on the same fork as the candidate chain.
+	const BlockIndex blockIndex(header.GetHash(), header.GetHeight());
+	Chain& syncChain = lockedState.m_chainStore.GetSyncChain();
+	if (syncChain.GetTip()->GetHash() == header.GetPreviousBlockHash())
+	{
+		syncChain.AddBlock(blockIndex);
+	}
+
+	candidateChain.AddBlock(blockIndex);
 
 	LoggerAPI::LogInfo("BlockHeaderProcessor::ProcessSingleHeader - Successfully validated " + header.FormatHash());
 
@@ -73,6 +81,23 @@ EBlockChainStatus BlockHeaderProcessor::ProcessSyncHeaders(const std::vector<Blo
 		return EBlockChainStatus::INVALID;
 	}
 
+	// Everything that doesn't depend on the chain state is validated for the whole batch first, in parallel, without holding the lock.
+	std::atomic_bool statelessValid(true);
+	async::parallel_for(async::irange((size_t)0, headers.size()), [&headers, &statelessValid](const size_t i)
+	{
+		if (!BlockHeaderValidator::IsStatelessValid(headers[i]))
+		{
+			statelessValid = false;
+		}
+	});
+
+	if (!statelessValid)
+	{
+		LoggerAPI::LogError("BlockHeaderProcessor::ProcessSyncHeaders - Batch contains an invalid header.");
+		return EBlockChainStatus::INVALID;
+	}
+
+	// The remaining checks are sequential, and done in chunks so the lock is released between them.
 	const size_t size = headers.size();
 	size_t index = 0;
 
@@ -113,7 +138,7 @@ EBlockChainStatus BlockHeaderProcessor::ProcessChunkedSyncHeaders(const std::vec
 	for (size_t i = 0; i < headers.size(); i++)
 	{
 		const BlockHeader& header = headers[i];
-		BlockIndex* pSyncHeader = syncChain.GetByHeight(header.GetHeight());
+		const BlockIndex* pSyncHeader = syncChain.GetByHeight(header.GetHeight());
 		if (pSyncHeader == nullptr || header.GetHash() != pSyncHeader->GetHash())
 		{
 			newHeaders.push_back(header);
@@ -127,7 +152,7 @@ EBlockChainStatus BlockHeaderProcessor::ProcessChunkedSyncHeaders(const std::vec
 	}
 
 	// Check if previous header exists and matches previous.
-	BlockIndex* pPrevIndex = syncChain.GetByHeight(newHeaders.front().GetHeight() - 1);
+	const BlockIndex* pPrevIndex = syncChain.GetByHeight(newHeaders.front().GetHeight() - 1);
 	if (pPrevIndex == nullptr || pPrevIndex->GetHash() != newHeaders.front().GetPreviousBlockHash())
 	{
 		LoggerAPI::LogInfo("BlockHeaderProcessor::ProcessChunkedSyncHeaders - Previous header doesn't match. Still syncing?");
@@ -140,12 +165,12 @@ EBlockChainStatus BlockHeaderProcessor::ProcessChunkedSyncHeaders(const std::vec
 	// TODO: If previous sync header != previous candidate header, we'll have to rewind further and apply sync headers.
 	headerMMR.Rewind(newHeaders.front().GetHeight());
 
-	// Validate the headers.
-	std::unique_ptr<BlockHeader> pPreviousHeaderPtr = lockedState.m_blockStore.GetBlockHeaderByHash(pPrevIndex->GetHash());
+	// Validate the headers against the chain. Stateless validation was already done by ProcessSyncHeaders.
+	std::shared_ptr<const BlockHeader> pPreviousHeaderPtr = lockedState.m_blockStore.GetBlockHeaderByHash(pPrevIndex->GetHash());
 	const BlockHeader* pPreviousHeader = pPreviousHeaderPtr.get();
 	for (auto& header : newHeaders)
 	{
-		if (!BlockHeaderValidator(headerMMR).IsValidHeader(header, *pPreviousHeader))
+		if (!BlockHeaderValidator(headerMMR, lockedState.m_syncDifficulty).IsValidNextHeader(header, *pPreviousHeader))
 		{
 			headerMMR.Rollback();
 			return EBlockChainStatus::INVALID;
@@ -184,7 +209,7 @@ EBlockChainStatus BlockHeaderProcessor::AddSyncHeaders(LockedChainState& lockedS
 	const uint64_t firstHeaderHeight = headers.begin()->GetHeight();
 
 	// Ensure chain is on correct fork.
-	BlockIndex* pPrevious = syncChain.GetByHeight(firstHeaderHeight - 1);
+	const BlockIndex* pPrevious = syncChain.GetByHeight(firstHeaderHeight - 1);
 	if (pPrevious == nullptr || pPrevious->GetHash() != headers.begin()->GetPreviousBlockHash())
 	{
 		return EBlockChainStatus::UNKNOWN_ERROR;
@@ -199,13 +224,10 @@ EBlockChainStatus BlockHeaderProcessor::AddSyncHeaders(LockedChainState& lockedS
 		}
 	}
 
-	std::vector<BlockHeader*> blockHeadersToAdd;
 	for (auto& header : headers)
 	{
 		// Add to chain
-		BlockIndex* pBlockIndex = lockedState.m_chainStore.GetOrCreateIndex(header.GetHash(), header.GetHeight(), pPrevious);
-		syncChain.AddBlock(pBlockIndex);
-		pPrevious = pBlockIndex;
+		syncChain.AddBlock(BlockIndex(header.GetHash(), header.GetHeight()));
 	}
 
 	lockedState.m_blockStore.AddHeaders(headers);
@@ -219,10 +241,10 @@ bool BlockHeaderProcessor::CheckAndAcceptSyncChain(LockedChainState& lockedState
 	Chain& candidateChain = lockedState.m_chainStore.GetCandidateChain();
 
 	const Hash syncHeadHash = syncChain.GetTip()->GetHash();
-	std::unique_ptr<BlockHeader> pSyncHead = lockedState.m_blockStore.GetBlockHeaderByHash(syncHeadHash);
+	std::shared_ptr<const BlockHeader> pSyncHead = lockedState.m_blockStore.GetBlockHeaderByHash(syncHeadHash);
 
 	const Hash candidateHeadHash = candidateChain.GetTip()->GetHash();
-	std::unique_ptr<BlockHeader> pCandidateHead = lockedState.m_blockStore.GetBlockHeaderByHash(candidateHeadHash);
+	std::shared_ptr<const BlockHeader> pCandidateHead = lockedState.m_blockStore.GetBlockHeaderByHash(candidateHeadHash);
 
 	if (pSyncHead == nullptr || pCandidateHead == nullptr)
 	{
@@ -231,13 +253,13 @@ bool BlockHeaderProcessor::CheckAndAcceptSyncChain(LockedChainState& lockedState
 
 	if (pSyncHead->GetProofOfWork().GetTotalDifficulty() > pCandidateHead->GetProofOfWork().GetTotalDifficulty())
 	{
-		BlockIndex* pCommonIndex = lockedState.m_chainStore.FindCommonIndex(EChainType::SYNC, EChainType::CANDIDATE);
+		const BlockIndex* pCommonIndex = lockedState.m_chainStore.FindCommonIndex(EChainType::SYNC, EChainType::CANDIDATE);
 		if (candidateChain.Rewind(pCommonIndex->GetHeight()))
 		{
 			uint64_t height = pCommonIndex->GetHeight() + 1;
 			while (height <= pSyncHead->GetHeight())
 			{
-				candidateChain.AddBlock(syncChain.GetByHeight(height));
+				candidateChain.AddBlock(*syncChain.GetByHeight(height));
 				height++;
 			}
 
@@ -3,11 +3,14 @@
 #include "../Validators/BlockValidator.h"
 
 #include <Consensus/BlockTime.h>
+#include <Serialization/Serializer.h>
+#include <Crypto.h>
 #include <Infrastructure/Logger.h>
 #include <HeaderMMR.h>
 #include <HexUtil.h>
 #include <StringUtil.h>
 #include <algorithm>
+#include <deque>
 
 BlockProcessor::BlockProcessor(ChainState& chainState)
 	: m_chainState(chainState)
@@ -34,6 +37,31 @@ EBlockChainStatus BlockProcessor::ProcessBlock(const FullBlock& block)
 		|| headerStatus == EBlockChainStatus::ALREADY_EXISTS
 		|| headerStatus == EBlockChainStatus::ORPHANED)
 	{
+		// Blocks that were already processed are skipped before validating them. This only reads the published confirmed tip,
+		// and the confirmed headers (with a shared lock) when the tip alone can't tell. ProcessBlockInternal checks again under the lock.
+		std::shared_ptr<const ChainTip> pConfirmedTip = m_chainState.GetTip(EChainType::CONFIRMED);
+		if (IsConfirmed(pConfirmedTip, height, header.GetHash()))
+		{
+			LoggerAPI::LogInfo(StringUtil::Format("BlockProcessor::ProcessBlock - Block %s already part of confirmed chain.", header.FormatHash().c_str()));
+			return EBlockChainStatus::ALREADY_EXISTS;
+		}
+
+		// An orphan still has to be orphaned (see ShouldOrphan) until its previous block is confirmed.
+		if (m_chainState.HasOrphan(header.GetHash()) && !IsConfirmed(pConfirmedTip, height - 1, header.GetPreviousBlockHash()))
+		{
+			LoggerAPI::LogInfo(StringUtil::Format("BlockProcessor::ProcessBlock - Block %s already processed as an orphan.", header.FormatHash().c_str()));
+			return EBlockChainStatus::ALREADY_EXISTS;
+		}
+
+		// Everything that doesn't depend on the TxHashSet is validated before taking the lock, so readers aren't blocked while proofs and signatures are verified,
+		// and blocks received from different peers are validated in parallel.
+		// If the previous header isn't known yet, the block can't be applied anyway, and it's validated once it can be.
+		std::shared_ptr<const BlockHeader> pPreviousHeader = m_chainState.GetBlockHeaderByHash(header.GetPreviousBlockHash());
+		if (pPreviousHeader != nullptr && !ValidateBlock(block, *pPreviousHeader))
+		{
+			return EBlockChainStatus::INVALID;
+		}
+
 		return ProcessBlockInternal(block);
 	}
 
@@ -47,47 +75,68 @@ EBlockChainStatus BlockProcessor::ProcessBlockInternal(const FullBlock& block)
 	const BlockHeader& header = block.GetBlockHeader();
 
 	// 1. Check if already part of confirmed chain
-	BlockIndex* pConfirmedIndex = confirmedChain.GetByHeight(header.GetHeight());
+	const BlockIndex* pConfirmedIndex = confirmedChain.GetByHeight(header.GetHeight());
 	if (pConfirmedIndex != nullptr && pConfirmedIndex->GetHash() == header.GetHash())
 	{
 		LoggerAPI::LogInfo(StringUtil::Format("BlockProcessor::ProcessBlock - Block %s already part of confirmed chain.", header.FormatHash().c_str()));
 		return EBlockChainStatus::ALREADY_EXISTS;
 	}
 
-	// 2. Check if already processed as an orphan
-	if (lockedState.m_orphanPool.IsOrphan(header.GetHash()))
+	// 2. Orphan if block should be processed as an orphan
+	if (ShouldOrphan(block, lockedState))
 	{
-		LoggerAPI::LogInfo(StringUtil::Format("BlockProcessor::ProcessBlock - Block %s already processed as an orphan.", header.FormatHash().c_str()));
-		return EBlockChainStatus::ALREADY_EXISTS;
+		if (lockedState.m_orphanPool.IsOrphan(header.GetHash()))
+		{
+			LoggerAPI::LogInfo(StringUtil::Format("BlockProcessor::ProcessBlock - Block %s already processed as an orphan.", header.FormatHash().c_str()));
+			return EBlockChainStatus::ALREADY_EXISTS;
+		}
+
+		return ProcessOrphanBlock(block, lockedState);
 	}
 
-	// 3. Orphan if block should be processed as an orphan
-	if (ShouldOrphan(block, lockedState))
+	// 3. An orphan that can now be applied is taken out of the pool. This happens when its parent was confirmed while it wasn't on the candidate chain.
+	lockedState.m_orphanPool.RemoveOrphan(header.GetHash());
+
+	const EBlockChainStatus status = ProcessNextBlock(block, lockedState);
+
+	// 4. Process any orphans that were waiting for this block
+	if (status == EBlockChainStatus::SUCCESS)
 	{
-		return ProcessOrphanBlock(block, lockedState);
+		ProcessOrphans(header.GetHash(), lockedState);
 	}
 
-	return ProcessNextBlock(block, lockedState);
+	return status;
 }
 
 EBlockChainStatus BlockProcessor::ProcessNextBlock(const FullBlock& block, LockedChainState& lockedState)
 {
-	// TODO: Remove from orphanPool (if there) and check for orphans to process
-
-	Chain& confirmedChain = lockedState.m_chainStore.GetConfirmedChain();
-	confirmedChain.Rewind(block.GetBlockHeader().GetHeight() - 1);
-
-	std::unique_ptr<BlockHeader> pPreviousHeader = lockedState.m_blockStore.GetBlockHeaderByHash(block.GetBlockHeader().GetPreviousBlockHash());
+	std::shared_ptr<const BlockHeader> pPreviousHeader = lockedState.m_blockStore.GetBlockHeaderByHash(block.GetBlockHeader().GetPreviousBlockHash());
 	if (pPreviousHeader == nullptr)
 	{
 		return EBlockChainStatus::STORE_ERROR;
 	}
 
+	// Normally already done by ProcessBlock, unless the previous header arrived after it checked.
+	if (!ValidateBlock(block, *pPreviousHeader))
+	{
+		return EBlockChainStatus::INVALID;
+	}
+
+	// Only applying the block to the TxHashSet needs the lock.
 	ITxHashSet* pTxHashSet = lockedState.GetTxHashSet();
-	pTxHashSet->Rewind(*pPreviousHeader);
+	if (pTxHashSet == nullptr)
+	{
+		LoggerAPI::LogError("BlockProcessor::ProcessNextBlock - TxHashSet not open.");
+		return EBlockChainStatus::STORE_ERROR;
+	}
+
+	if (!pTxHashSet->Rewind(*pPreviousHeader))
+	{
+		pTxHashSet->Discard();
+		return EBlockChainStatus::STORE_ERROR;
+	}
 
-	pTxHashSet->ApplyBlock(block);
-	if (!BlockValidator(lockedState.GetTxHashSet()).IsBlockValid(block, pPreviousHeader->GetTotalKernelOffset()))
+	if (!pTxHashSet->ApplyBlock(block))
 	{
 		pTxHashSet->Discard();
 		return EBlockChainStatus::INVALID;
@@ -95,25 +144,65 @@ EBlockChainStatus BlockProcessor::ProcessNextBlock(const FullBlock& block, Locke
 
 	pTxHashSet->Commit();
 
+	Chain& confirmedChain = lockedState.m_chainStore.GetConfirmedChain();
+	confirmedChain.Rewind(block.GetBlockHeader().GetHeight() - 1);
+
 	Chain& candidateChain = lockedState.m_chainStore.GetCandidateChain();
-	confirmedChain.AddBlock(candidateChain.GetByHeight(block.GetBlockHeader().GetHeight()));
+	confirmedChain.AddBlock(*candidateChain.GetByHeight(block.GetBlockHeader().GetHeight()));
 
 	return EBlockChainStatus::SUCCESS;
 }
 
+// Keeps the block until its parent is confirmed, so it doesn't have to be downloaded again. See ProcessOrphans.
 EBlockChainStatus BlockProcessor::ProcessOrphanBlock(const FullBlock& block, LockedChainState& lockedState)
 {
-	// TODO: Implement
+	OrphanPool& orphanPool = lockedState.m_orphanPool;
+	orphanPool.Prune(lockedState.m_chainStore.GetConfirmedChain().GetTip()->GetHeight());
+
+	if (orphanPool.AddOrphan(block))
+	{
+		LoggerAPI::LogDebug(StringUtil::Format("BlockProcessor::ProcessOrphanBlock - Block %s added to orphan pool.", block.GetBlockHeader().FormatHash().c_str()));
+	}
+
 	return EBlockChainStatus::ORPHANED;
 }
 
+// Processes the orphans that were waiting for the confirmed block, then any that were waiting for those, and so on.
+void BlockProcessor::ProcessOrphans(const Hash& confirmedHash, LockedChainState& lockedState)
+{
+	OrphanPool& orphanPool = lockedState.m_orphanPool;
+
+	std::deque<Hash> confirmedHashes({ confirmedHash });
+	while (!confirmedHashes.empty())
+	{
+		const std::vector<std::shared_ptr<const FullBlock>> children = orphanPool.TakeChildren(confirmedHashes.front());
+		confirmedHashes.pop_front();
+
+		for (const std::shared_ptr<const FullBlock>& pChild : children)
+		{
+			// Only a child on the candidate chain can be applied. Others stay orphans, and invalid ones are dropped.
+			if (ShouldOrphan(*pChild, lockedState))
+			{
+				orphanPool.AddOrphan(*pChild);
+			}
+			else if (ProcessNextBlock(*pChild, lockedState) == EBlockChainStatus::SUCCESS)
+			{
+				LoggerAPI::LogInfo(StringUtil::Format("BlockProcessor::ProcessOrphans - Orphan %s confirmed.", pChild->GetBlockHeader().FormatHash().c_str()));
+				confirmedHashes.push_back(pChild->GetHash());
+			}
+		}
+	}
+
+	orphanPool.Prune(lockedState.m_chainStore.GetConfirmedChain().GetTip()->GetHeight());
+}
+
 bool BlockProcessor::ShouldOrphan(const FullBlock& block, LockedChainState& lockedState)
 {
 	Chain& candidateChain = lockedState.m_chainStore.GetCandidateChain();
 
 	// Orphan if previous block not a part of candidate chain.
 	const BlockHeader& header = block.GetBlockHeader();
-	BlockIndex* pPreviousCandidateIndex = candidateChain.GetByHeight(header.GetHeight() - 1);
+	const BlockIndex* pPreviousCandidateIndex = candidateChain.GetByHeight(header.GetHeight() - 1);
 	if (pPreviousCandidateIndex == nullptr || pPreviousCandidateIndex->GetHash() != header.GetPreviousBlockHash())
 	{
 		LoggerAPI::LogInfo(StringUtil::Format("BlockProcessor::ProcessBlock - Previous block header missing. Treating %s as orphan.", header.FormatHash().c_str()));
@@ -122,7 +211,7 @@ bool BlockProcessor::ShouldOrphan(const FullBlock& block, LockedChainState& lock
 	}
 
 	// Orphan if block not a part of candidate chain.
-	BlockIndex* pCandidateIndex = candidateChain.GetByHeight(header.GetHeight());
+	const BlockIndex* pCandidateIndex = candidateChain.GetByHeight(header.GetHeight());
 	if (nullptr == pCandidateIndex || pCandidateIndex->GetHash() != header.GetHash())
 	{
 		LoggerAPI::LogInfo(StringUtil::Format("BlockProcessor::ProcessBlock - Candidate block mismatch. Treating %s as orphan.", header.FormatHash().c_str()));
@@ -133,7 +222,7 @@ bool BlockProcessor::ShouldOrphan(const FullBlock& block, LockedChainState& lock
 	Chain& confirmedChain = lockedState.m_chainStore.GetConfirmedChain();
 
 	// Orphan if previous block not a part of confirmed chain.
-	BlockIndex* pPreviousConfirmedIndex = confirmedChain.GetByHeight(header.GetHeight() - 1);
+	const BlockIndex* pPreviousConfirmedIndex = confirmedChain.GetByHeight(header.GetHeight() - 1);
 	if (pPreviousConfirmedIndex == nullptr || pPreviousConfirmedIndex->GetHash() != header.GetPreviousBlockHash())
 	{
 		LoggerAPI::LogInfo(StringUtil::Format("BlockProcessor::ProcessBlock - Previous confirmed block missing. Treating %s as orphan.", header.FormatHash().c_str()));
@@ -142,7 +231,7 @@ bool BlockProcessor::ShouldOrphan(const FullBlock& block, LockedChainState& lock
 	}
 
 	// Orphan if different block a part of confirmed chain.
-	BlockIndex* pConfirmedIndex = confirmedChain.GetByHeight(header.GetHeight());
+	const BlockIndex* pConfirmedIndex = confirmedChain.GetByHeight(header.GetHeight());
 	if (nullptr != pConfirmedIndex && pConfirmedIndex->GetHash() != header.GetHash())
 	{
 		LoggerAPI::LogInfo(StringUtil::Format("BlockProcessor::ProcessBlock - Confirmed block mismatch. Treating %s as orphan.", header.FormatHash().c_str()));
@@ -151,4 +240,43 @@ bool BlockProcessor::ShouldOrphan(const FullBlock& block, LockedChainState& lock
 	}
 
 	return false;
+}
+
+// Returns true if the block with the given hash is at the given height of the confirmed chain, whose tip was loaded by the caller.
+bool BlockProcessor::IsConfirmed(const std::shared_ptr<const ChainTip>& pConfirmedTip, const uint64_t height, const Hash& hash) const
+{
+	if (pConfirmedTip == nullptr || pConfirmedTip->GetHeight() < height)
+	{
+		return false;
+	}
+
+	if (pConfirmedTip->GetHeight() == height)
+	{
+		return pConfirmedTip->GetHash() == hash;
+	}
+
+	std::shared_ptr<const BlockHeader> pConfirmedHeader = m_chainState.GetBlockHeaderByHeight(height, EChainType::CONFIRMED);
+	return pConfirmedHeader != nullptr && pConfirmedHeader->GetHash() == hash;
+}
+
+// Validates the block with BlockValidator, unless it already passed. Doesn't need the chain state lock.
+// A peer can pair a valid header with any body, so a block only counts as validated if its header and body both match.
+bool BlockProcessor::ValidateBlock(const FullBlock& block, const BlockHeader& previousHeader) const
+{
+	Serializer serializer;
+	block.Serialize(serializer);
+	const Hash blockDataHash = Crypto::Blake2b(serializer.GetBytes());
+	if (m_chainState.HasBlockBeenValidated(blockDataHash))
+	{
+		return true;
+	}
+
+	if (!BlockValidator().IsBlockValid(block, previousHeader.GetTotalKernelOffset()))
+	{
+		LoggerAPI::LogWarning("BlockProcessor::ValidateBlock - Block " + block.GetBlockHeader().FormatHash() + " failed to validate.");
+		return false;
+	}
+
+	m_chainState.BlockValidated(blockDataHash);
+	return true;
 }
\ No newline at end of file
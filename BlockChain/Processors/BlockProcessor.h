@@ -16,8 +16,11 @@ private:
 	EBlockChainStatus ProcessBlockInternal(const FullBlock& block);
 	EBlockChainStatus ProcessNextBlock(const FullBlock& block, LockedChainState& lockedState);
 	EBlockChainStatus ProcessOrphanBlock(const FullBlock& block, LockedChainState& lockedState);
+	void ProcessOrphans(const Hash& confirmedHash, LockedChainState& lockedState);
 
 	bool ShouldOrphan(const FullBlock& block, LockedChainState& lockedState);
+	bool IsConfirmed(const std::shared_ptr<const ChainTip>& pConfirmedTip, const uint64_t height, const Hash& hash) const;
+	bool ValidateBlock(const FullBlock& block, const BlockHeader& previousHeader) const;
 
 	ChainState& m_chainState;
 };
\ No newline at end of file
@@ -6,6 +6,11 @@
 #include <BlockChainServer.h>
 #include <StringUtil.h>
 #include <HexUtil.h>
+#include <FileUtil.h>
+#include <fstream>
+
+// Zip files are read in chunks of 1MB.
+static const size_t ZIP_READ_BUFFER_SIZE = 1024 * 1024;
 
 TxHashSetProcessor::TxHashSetProcessor(const Config& config, IBlockChainServer& blockChainServer, ChainState& chainState, IBlockDB& blockDB)
 	: m_config(config), m_blockChainServer(blockChainServer), m_chainState(chainState), m_blockDB(blockDB)
@@ -13,72 +18,126 @@ TxHashSetProcessor::TxHashSetProcessor(const Config& config, IBlockChainServer&
 
 }
 
-ITxHashSet* TxHashSetProcessor::ProcessTxHashSet(const Hash& blockHash, const std::string& path)
+std::unique_ptr<ITxHashSetDownload> TxHashSetProcessor::StartDownload(const Hash& blockHash)
 {
-	std::unique_ptr<BlockHeader> pHeader = m_chainState.GetBlockHeaderByHash(blockHash);
+	std::shared_ptr<const BlockHeader> pHeader = m_chainState.GetBlockHeaderByHash(blockHash);
 	if (pHeader == nullptr)
 	{
-		LoggerAPI::LogError(StringUtil::Format("TxHashSetProcessor::ProcessTxHashSet - Header not found for hash %s.", HexUtil::ConvertHash(blockHash)));
-		return nullptr;
+		LoggerAPI::LogError(StringUtil::Format("TxHashSetProcessor::StartDownload - Header not found for hash %s.", HexUtil::ConvertHash(blockHash).c_str()));
+		return std::unique_ptr<ITxHashSetDownload>(nullptr);
 	}
 
-	// 1. Load and Extract TxHashSet Zip
-	ITxHashSet* pTxHashSet = TxHashSetAPI::LoadFromZip(m_config, m_blockDB, path, *pHeader);
-	if (pTxHashSet == nullptr)
+	// Only the TxHashSet of a candidate block ahead of the confirmed chain is of any use.
+	std::shared_ptr<const BlockHeader> pCandidateHeader = m_chainState.GetBlockHeaderByHeight(pHeader->GetHeight(), EChainType::CANDIDATE);
+	if (pCandidateHeader == nullptr || pCandidateHeader->GetHash() != blockHash || pHeader->GetHeight() <= m_chainState.GetHeight(EChainType::CONFIRMED))
+	{
+		LoggerAPI::LogError(StringUtil::Format("TxHashSetProcessor::StartDownload - TxHashSet for %s not needed.", HexUtil::ConvertHash(blockHash).c_str()));
+		return std::unique_ptr<ITxHashSetDownload>(nullptr);
+	}
+
+	return TxHashSetAPI::StartDownload(m_config, *pHeader, m_blockChainServer);
+}
+
+bool TxHashSetProcessor::FinishDownload(const Hash& blockHash, ITxHashSetDownload& download)
+{
+	std::shared_ptr<const BlockHeader> pHeader = m_chainState.GetBlockHeaderByHash(blockHash);
+	if (pHeader == nullptr)
 	{
-		LoggerAPI::LogError("TxHashSetProcessor::ProcessTxHashSet - Failed to load " + path);
-		return nullptr;
+		LoggerAPI::LogError(StringUtil::Format("TxHashSetProcessor::FinishDownload - Header not found for hash %s.", HexUtil::ConvertHash(blockHash).c_str()));
+		return false;
 	}
 
-	// 2. Validate entire TxHashSet
+	// 1. Wait for the MMRs to be validated, and validate the kernel sums
 	Commitment outputSum(CBigInteger<33>::ValueOf(0));
 	Commitment kernelSum(CBigInteger<33>::ValueOf(0));
-	if (!pTxHashSet->Validate(*pHeader, m_blockChainServer, outputSum, kernelSum))
+	if (!download.Finish(outputSum, kernelSum))
 	{
-		LoggerAPI::LogError(StringUtil::Format("TxHashSetProcessor::ProcessTxHashSet - Validation of %s failed.", path.c_str()));
-		TxHashSetAPI::Close(pTxHashSet);
-		return nullptr;
+		LoggerAPI::LogError(StringUtil::Format("TxHashSetProcessor::FinishDownload - Validation of TxHashSet for %s failed.", HexUtil::ConvertHash(blockHash).c_str()));
+		return false;
 	}
 
-	// 3. Add BlockSums to DB
+	LockedChainState lockedState = m_chainState.GetLocked();
+
+	// 2. Make sure the block is still on the candidate chain, since it may have been reorged away during the download.
+	const BlockIndex* pBlockIndex = lockedState.m_chainStore.GetCandidateChain().GetByHeight(pHeader->GetHeight());
+	if (pBlockIndex == nullptr || pBlockIndex->GetHash() != blockHash)
+	{
+		LoggerAPI::LogError(StringUtil::Format("TxHashSetProcessor::FinishDownload - Block %s no longer on candidate chain.", HexUtil::ConvertHash(blockHash).c_str()));
+		return false;
+	}
+
+	// 3. Replace the existing TxHashSet, which must be closed first so its files can be moved
+	lockedState.UpdateTxHashSet(nullptr);
+	ITxHashSet* pTxHashSet = download.Install();
+	if (pTxHashSet == nullptr)
+	{
+		LoggerAPI::LogError(StringUtil::Format("TxHashSetProcessor::FinishDownload - Failed to install TxHashSet for %s.", HexUtil::ConvertHash(blockHash).c_str()));
+		lockedState.UpdateTxHashSet(TxHashSetAPI::Open(m_config));
+		return false;
+	}
+
+	lockedState.UpdateTxHashSet(pTxHashSet);
+
+	// 4. Add BlockSums to DB
 	const BlockSums blockSums(std::move(outputSum), std::move(kernelSum));
 	m_blockDB.AddBlockSums(pHeader->GetHash(), blockSums);
 
-	// 4. Add Output positions to DB
-	pTxHashSet->SaveOutputPositions();
-
 	// 5. Update confirmed chain
-	if (!UpdateConfirmedChain(*pHeader))
+	if (!UpdateConfirmedChain(lockedState, *pBlockIndex))
 	{
-		LoggerAPI::LogError(StringUtil::Format("TxHashSetProcessor::ProcessTxHashSet - Failed to update confirmed chain for %s.", path.c_str()));
-		TxHashSetAPI::Close(pTxHashSet);
-		return nullptr;
+		LoggerAPI::LogError(StringUtil::Format("TxHashSetProcessor::FinishDownload - Failed to update confirmed chain for %s.", HexUtil::ConvertHash(blockHash).c_str()));
+		return false;
 	}
 
-	// TODO: 6. Check for orphans
-
-	return pTxHashSet;
+	return true;
 }
 
-bool TxHashSetProcessor::UpdateConfirmedChain(const BlockHeader& blockHeader)
+// Feeds the zip file through the same pipeline as a download, so each MMR is validated as soon as it's extracted.
+bool TxHashSetProcessor::ProcessTxHashSet(const Hash& blockHash, const std::string& path)
 {
-	LockedChainState lockedState = m_chainState.GetLocked();
-	Chain& candidateChain = lockedState.m_chainStore.GetCandidateChain();
-	Chain& confirmedChain = lockedState.m_chainStore.GetConfirmedChain();
-	
-	BlockIndex* pBlockIndex = candidateChain.GetByHeight(blockHeader.GetHeight());
-	if (pBlockIndex->GetHash() != blockHeader.GetHash())
+	std::ifstream zipFile(path, std::ios::in | std::ios::binary);
+	if (!zipFile.is_open())
 	{
+		LoggerAPI::LogError("TxHashSetProcessor::ProcessTxHashSet - Failed to open " + path);
 		return false;
 	}
 
-	BlockIndex* pCommonIndex = lockedState.m_chainStore.FindCommonIndex(EChainType::CANDIDATE, EChainType::CONFIRMED);
+	std::unique_ptr<ITxHashSetDownload> pDownload = StartDownload(blockHash);
+	if (pDownload == nullptr)
+	{
+		return false;
+	}
+
+	std::vector<unsigned char> buffer(ZIP_READ_BUFFER_SIZE);
+	while (zipFile)
+	{
+		zipFile.read((char*)buffer.data(), buffer.size());
+		if (!pDownload->Write(buffer.data(), (size_t)zipFile.gcount()))
+		{
+			LoggerAPI::LogError("TxHashSetProcessor::ProcessTxHashSet - Failed to extract " + path);
+			return false;
+		}
+	}
+
+	zipFile.close();
+	FileUtil::RemoveFile(path);
+
+	return FinishDownload(blockHash, *pDownload);
+}
+
+// Moves the confirmed chain to the given candidate block, whose TxHashSet was just installed.
+bool TxHashSetProcessor::UpdateConfirmedChain(LockedChainState& lockedState, const BlockIndex& blockIndex)
+{
+	Chain& candidateChain = lockedState.m_chainStore.GetCandidateChain();
+	Chain& confirmedChain = lockedState.m_chainStore.GetConfirmedChain();
+
+	const BlockIndex* pCommonIndex = lockedState.m_chainStore.FindCommonIndex(EChainType::CANDIDATE, EChainType::CONFIRMED);
 	if (confirmedChain.Rewind(pCommonIndex->GetHeight()))
 	{
 		uint64_t height = pCommonIndex->GetHeight() + 1;
-		while (height <= pBlockIndex->GetHeight())
+		while (height <= blockIndex.GetHeight())
 		{
-			confirmedChain.AddBlock(candidateChain.GetByHeight(height));
+			confirmedChain.AddBlock(*candidateChain.GetByHeight(height));
 			height++;
 		}
 
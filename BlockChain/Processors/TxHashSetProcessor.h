@@ -6,6 +6,7 @@
 #include <Config/Config.h>
 #include <Hash.h>
 #include <string>
+#include <memory>
 
 // Forward Declarations
 class IBlockChainServer;
@@ -17,10 +18,26 @@ class TxHashSetProcessor
 public:
 	TxHashSetProcessor(const Config& config, IBlockChainServer& blockChainServer, ChainState& chainState, IBlockDB& blockDB);
 
-	ITxHashSet* ProcessTxHashSet(const Hash& blockHash, const std::string& path);
+	//
+	// Starts extracting the TxHashSet of the given block as it's downloaded. See ITxHashSetDownload.
+	// Returns nullptr if the block is not on the candidate chain, or is not ahead of the confirmed chain.
+	// The existing TxHashSet stays open until the download is finished.
+	//
+	std::unique_ptr<ITxHashSetDownload> StartDownload(const Hash& blockHash);
+
+	//
+	// Finishes validating the downloaded TxHashSet, replaces the existing TxHashSet with it, saves its block sums, and updates the confirmed chain to its block.
+	// Returns false (leaving the existing TxHashSet in place) if the TxHashSet is invalid, or its block is no longer on the candidate chain.
+	//
+	bool FinishDownload(const Hash& blockHash, ITxHashSetDownload& download);
+
+	//
+	// Extracts and validates an already downloaded TxHashSet zip file, which is deleted once extracted.
+	//
+	bool ProcessTxHashSet(const Hash& blockHash, const std::string& path);
 
 private:
-	bool UpdateConfirmedChain(const BlockHeader& blockHeader);
+	bool UpdateConfirmedChain(LockedChainState& lockedState, const BlockIndex& blockIndex);
 
 	const Config& m_config;
 	IBlockChainServer& m_blockChainServer;
@@ -0,0 +1,115 @@
+#include "TxHashSetArchiver.h"
+#include "ChainState.h"
+
+#include <Consensus/BlockTime.h>
+#include <Infrastructure/Logger.h>
+#include <HexUtil.h>
+#include <FileUtil.h>
+#include <StringUtil.h>
+#include <TxHashSet.h>
+#include <filesystem>
+
+// Twice a day, so a syncing node never has to download more than half a day's worth of blocks on top of the archive.
+static const uint64_t ARCHIVE_INTERVAL = 12 * Consensus::HOUR_HEIGHT;
+static const std::string ARCHIVE_PREFIX = "txhashset_archive_";
+
+TxHashSetArchiver::TxHashSetArchiver(const Config& config, ChainState& chainState)
+	: m_config(config), m_chainState(chainState)
+{
+
+}
+
+uint64_t TxHashSetArchiver::GetArchiveHeight(const uint64_t height)
+{
+	if (height <= Consensus::CUT_THROUGH_HORIZON)
+	{
+		return 0;
+	}
+
+	const uint64_t horizonHeight = height - Consensus::CUT_THROUGH_HORIZON;
+	return horizonHeight - (horizonHeight % ARCHIVE_INTERVAL);
+}
+
+bool TxHashSetArchiver::Build(const uint64_t archiveHeight)
+{
+	std::shared_ptr<const BlockHeader> pHeader = m_chainState.GetBlockHeaderByHeight(archiveHeight, EChainType::CONFIRMED);
+	if (pHeader == nullptr)
+	{
+		LoggerAPI::LogWarning("TxHashSetArchiver::Build - No confirmed block at height " + std::to_string(archiveHeight));
+		return false;
+	}
+
+	// Zips are only ever renamed into place once complete, so an existing zip (ie. from before a restart) can be reused.
+	const std::string zipPath = GetZipPath(pHeader->GetHash());
+	if (!std::filesystem::exists(zipPath))
+	{
+		std::unique_ptr<ITxHashSetArchive> pArchive = nullptr;
+		{
+			LockedChainState lockedState = m_chainState.GetLocked();
+			ITxHashSet* pTxHashSet = lockedState.GetTxHashSet();
+			if (pTxHashSet == nullptr)
+			{
+				return false;
+			}
+
+			pArchive = pTxHashSet->PrepareArchive(*pHeader);
+			if (pArchive == nullptr)
+			{
+				return false;
+			}
+		}
+
+		LoggerAPI::LogInfo("TxHashSetArchiver::Build - Writing archive for block " + pHeader->FormatHash());
+		if (!pArchive->Write(zipPath))
+		{
+			LoggerAPI::LogWarning("TxHashSetArchiver::Build - Failed to write archive for block " + pHeader->FormatHash());
+			return false;
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lockGuard(m_mutex);
+		m_pHeader = std::move(pHeader);
+		m_zipPath = zipPath;
+	}
+
+	RemoveOldArchives();
+
+	LoggerAPI::LogInfo("TxHashSetArchiver::Build - Archive ready at " + zipPath);
+	return true;
+}
+
+std::unique_ptr<BlockHeader> TxHashSetArchiver::GetArchive(std::string& zipPathOut) const
+{
+	std::lock_guard<std::mutex> lockGuard(m_mutex);
+	if (m_pHeader == nullptr)
+	{
+		return std::unique_ptr<BlockHeader>(nullptr);
+	}
+
+	zipPathOut = m_zipPath;
+	return std::make_unique<BlockHeader>(*m_pHeader);
+}
+
+std::string TxHashSetArchiver::GetZipPath(const Hash& blockHash) const
+{
+	return m_config.GetTxHashSetDirectory() + ARCHIVE_PREFIX + HexUtil::ConvertHash(blockHash) + ".zip";
+}
+
+// Old archives may still be being sent to peers. That's safe, since they're sent from a handle opened before they were announced (see FileToSend),
+// so the peer still gets the whole file. Any that can't be removed yet are removed by a later build.
+void TxHashSetArchiver::RemoveOldArchives() const
+{
+	std::string currentZipPath;
+	GetArchive(currentZipPath);
+
+	std::error_code errorCode;
+	for (const auto& entry : std::filesystem::directory_iterator(m_config.GetTxHashSetDirectory(), errorCode))
+	{
+		const std::string fileName = entry.path().filename().string();
+		if (fileName.compare(0, ARCHIVE_PREFIX.size(), ARCHIVE_PREFIX) == 0 && entry.path() != std::filesystem::path(currentZipPath))
+		{
+			FileUtil::RemoveFile(entry.path().string());
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <Core/BlockHeader.h>
+#include <Config/Config.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <stdint.h>
+
+// Forward Declarations
+class ChainState;
+
+//
+// Builds the TxHashSet zip that's sent to syncing peers, and caches it on disk.
+// The archive is only rebuilt when the archive height moves (every ARCHIVE_INTERVAL blocks), and every peer is sent the same file,
+// so serving any number of peers costs a single build.
+//
+class TxHashSetArchiver
+{
+public:
+	TxHashSetArchiver(const Config& config, ChainState& chainState);
+
+	//
+	// Returns the height of the block that should be archived when the confirmed chain is at the given height.
+	// This is the horizon, rounded down to the archive interval. Compaction must never go beyond it, since the archive needs
+	// the outputs spent after it.
+	//
+	static uint64_t GetArchiveHeight(const uint64_t height);
+
+	//
+	// Replaces the archive with one for the confirmed block at the given height.
+	// The chain lock is only held to prepare the archive, not while the zip is written.
+	//
+	bool Build(const uint64_t archiveHeight);
+
+	//
+	// Returns the header of the archived block, and the path of its zip, or nullptr if there's no archive yet.
+	//
+	std::unique_ptr<BlockHeader> GetArchive(std::string& zipPathOut) const;
+
+private:
+	std::string GetZipPath(const Hash& blockHash) const;
+	void RemoveOldArchives() const;
+
+	const Config& m_config;
+	ChainState& m_chainState;
+
+	mutable std::mutex m_mutex;
+	std::shared_ptr<const BlockHeader> m_pHeader;
+	std::string m_zipPath;
+};
\ No newline at end of file
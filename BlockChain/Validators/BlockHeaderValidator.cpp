@@ -10,8 +10,8 @@
 #include <HeaderMMR.h>
 #include <chrono>
 
-BlockHeaderValidator::BlockHeaderValidator(const IHeaderMMR& headerMMR)
-	: m_headerMMR(headerMMR)
+BlockHeaderValidator::BlockHeaderValidator(const IHeaderMMR& headerMMR, DifficultyWindow& difficultyWindow)
+	: m_headerMMR(headerMMR), m_difficultyWindow(difficultyWindow)
 {
 
 }
@@ -20,18 +20,16 @@ BlockHeaderValidator::BlockHeaderValidator(const IHeaderMMR& headerMMR)
 // TODO: Look up previous header instead of taking it in
 bool BlockHeaderValidator::IsValidHeader(const BlockHeader& header, const BlockHeader& previousHeader) const
 {
-	// Validate Height
-	if (header.GetHeight() != (previousHeader.GetHeight() + 1))
-	{
-		LoggerAPI::LogWarning("BlockHeaderValidator::IsValidHeader - Invalid height for header " + HexUtil::ConvertHash(header.GetHash()));
-		return false;
-	}
+	return IsStatelessValid(header) && IsValidNextHeader(header, previousHeader);
+}
 
+bool BlockHeaderValidator::IsStatelessValid(const BlockHeader& header)
+{
 	// Validate Timestamp (Refuse blocks more than 12 block intervals in the future.)
 	const auto maxBlockTime = std::chrono::system_clock::now() + std::chrono::seconds(12 * Consensus::BLOCK_TIME_SEC);
 	if (header.GetTimestamp() > maxBlockTime.time_since_epoch().count())
 	{
-		LoggerAPI::LogWarning("BlockHeaderValidator::IsValidHeader - Timestamp beyond maxBlockTime for header " + HexUtil::ConvertHash(header.GetHash()));
+		LoggerAPI::LogWarning("BlockHeaderValidator::IsStatelessValid - Timestamp beyond maxBlockTime for header " + HexUtil::ConvertHash(header.GetHash()));
 		return false;
 	}
 
@@ -39,32 +37,51 @@ bool BlockHeaderValidator::IsValidHeader(const BlockHeader& header, const BlockH
 	const uint16_t validHeaderVersion = Consensus::GetValidHeaderVersion(header.GetHeight());
 	if (header.GetVersion() != validHeaderVersion)
 	{
-		LoggerAPI::LogWarning("BlockHeaderValidator::IsValidHeader - Invalid version for header " + HexUtil::ConvertHash(header.GetHash()));
+		LoggerAPI::LogWarning("BlockHeaderValidator::IsStatelessValid - Invalid version for header " + HexUtil::ConvertHash(header.GetHash()));
+		return false;
+	}
+
+	// Validate Cuckoo Cycle
+	if (!PoWValidator().IsCuckooValid(header))
+	{
+		LoggerAPI::LogWarning("BlockHeaderValidator::IsStatelessValid - Invalid cuckoo cycle for header " + HexUtil::ConvertHash(header.GetHash()));
+		return false;
+	}
+
+	return true;
+}
+
+bool BlockHeaderValidator::IsValidNextHeader(const BlockHeader& header, const BlockHeader& previousHeader) const
+{
+	// Validate Height
+	if (header.GetHeight() != (previousHeader.GetHeight() + 1))
+	{
+		LoggerAPI::LogWarning("BlockHeaderValidator::IsValidNextHeader - Invalid height for header " + HexUtil::ConvertHash(header.GetHash()));
 		return false;
 	}
 
 	// Validate Timestamp
 	if (header.GetTimestamp() <= previousHeader.GetTimestamp())
 	{
-		LoggerAPI::LogWarning("BlockHeaderValidator::IsValidHeader - Timestamp not after previous for header " + HexUtil::ConvertHash(header.GetHash()));
+		LoggerAPI::LogWarning("BlockHeaderValidator::IsValidNextHeader - Timestamp not after previous for header " + HexUtil::ConvertHash(header.GetHash()));
 		return false;
 	}
 
 	// Validate Proof Of Work
-	const bool validPoW = PoWValidator().IsPoWValid(header, previousHeader);
+	const bool validPoW = PoWValidator().IsPoWValid(header, previousHeader, m_difficultyWindow);
 	if (!validPoW)
 	{
-		LoggerAPI::LogWarning("BlockHeaderValidator::IsValidHeader - Invalid Proof of Work for header " + HexUtil::ConvertHash(header.GetHash()));
+		LoggerAPI::LogWarning("BlockHeaderValidator::IsValidNextHeader - Invalid Proof of Work for header " + HexUtil::ConvertHash(header.GetHash()));
 		return false;
 	}
 
 	// Validate the previous header MMR root is correct against the local MMR.
 	if (m_headerMMR.Root(header.GetHeight() - 1) != header.GetPreviousRoot())
 	{
-		LoggerAPI::LogWarning("BlockHeaderValidator::IsValidHeader - Invalid Header MMR Root for header " + HexUtil::ConvertHash(header.GetHash()));
+		LoggerAPI::LogWarning("BlockHeaderValidator::IsValidNextHeader - Invalid Header MMR Root for header " + HexUtil::ConvertHash(header.GetHash()));
 		return false;
 	}
 
-	LoggerAPI::LogTrace("BlockHeaderValidator::IsValidHeader - Header valid " + HexUtil::ConvertHash(header.GetHash()));
+	LoggerAPI::LogTrace("BlockHeaderValidator::IsValidNextHeader - Header valid " + HexUtil::ConvertHash(header.GetHash()));
 	return true;
 }
\ No newline at end of file
@@ -4,13 +4,28 @@
 
 // Forward Declarations
 class IHeaderMMR;
+class DifficultyWindow;
 
 class BlockHeaderValidator
 {
 public:
-	BlockHeaderValidator(const IHeaderMMR& headerMMR);
+	BlockHeaderValidator(const IHeaderMMR& headerMMR, DifficultyWindow& difficultyWindow);
 
 	bool IsValidHeader(const BlockHeader& header, const BlockHeader& previousHeader) const;
 
+	//
+	// Validates everything that doesn't depend on the chain: the timestamp isn't too far in the future, the version, and the cuckoo cycle.
+	// Safe to call concurrently, and without holding the chain state lock.
+	//
+	static bool IsStatelessValid(const BlockHeader& header);
+
+	//
+	// Validates the header extends the previous header (height, timestamp and difficulty), and commits to the local header MMR.
+	// Slides the difficulty window to the previous header, so it should be the window of the chain being extended.
+	// Assumes IsStatelessValid already passed.
+	//
+	bool IsValidNextHeader(const BlockHeader& header, const BlockHeader& previousHeader) const;
+
 	const IHeaderMMR& m_headerMMR;
+	DifficultyWindow& m_difficultyWindow;
 };
\ No newline at end of file
@@ -5,13 +5,6 @@
 
 #include <Crypto.h>
 #include <Consensus/Common.h>
-#include <TxHashSet.h>
-
-BlockValidator::BlockValidator(ITxHashSet* pTxHashSet)
-	: m_pTxHashSet(pTxHashSet)
-{
-
-}
 
 // Validates all the elements in a block that can be checked without additional data. 
 // Includes commitment sums and kernels, Merkle trees, reward, etc.
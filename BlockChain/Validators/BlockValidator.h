@@ -4,18 +4,17 @@
 
 // Forward Declarations
 class BlindingFactor;
-class ITxHashSet;
 
 class BlockValidator
 {
 public:
-	BlockValidator(ITxHashSet* pTxHashSet);
-
+	//
+	// Validates everything that doesn't depend on the TxHashSet: the transaction body, proofs and signatures, lock heights, coinbase and kernel sums.
+	// Safe to call concurrently, and without holding the chain state lock.
+	//
 	bool IsBlockValid(const FullBlock& block, const BlindingFactor& previousKernelOffset) const;
 
 private:
 	bool VerifyKernelLockHeights(const FullBlock& block) const;
 	bool VerifyCoinbase(const FullBlock& block) const;
-
-	ITxHashSet* m_pTxHashSet;
 };
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stdint.h>
+#include <cstddef>
+#include <array>
+
+//
+// SipHash-2-4 as used by cuckoo cycle: the 4 keys are the initial state, and each nonce is hashed as a single 8-byte block, without a length block.
+//
+// LANES independent hashes are computed side by side, one state word per array, so every step is the same operation across all lanes.
+// Compilers vectorize these loops (4 lanes of 64 bits fill an AVX2 register), without needing any intrinsics.
+//
+template<size_t LANES>
+class CuckooSipHash
+{
+public:
+	CuckooSipHash(const std::array<uint64_t, 4>& keys)
+	{
+		m_v0.fill(keys[0]);
+		m_v1.fill(keys[1]);
+		m_v2.fill(keys[2]);
+		m_v3.fill(keys[3]);
+	}
+
+	//
+	// Hashes the next nonce of each lane. The state carries over from the previous call, which cuckaroo relies on to hash blocks of nonces.
+	//
+	inline void Hash24(const std::array<uint64_t, LANES>& nonces)
+	{
+		for (size_t i = 0; i < LANES; i++)
+		{
+			m_v3[i] ^= nonces[i];
+		}
+
+		Round();
+		Round();
+
+		for (size_t i = 0; i < LANES; i++)
+		{
+			m_v0[i] ^= nonces[i];
+			m_v2[i] ^= 0xff;
+		}
+
+		Round();
+		Round();
+		Round();
+		Round();
+	}
+
+	inline std::array<uint64_t, LANES> Digest() const
+	{
+		std::array<uint64_t, LANES> digests;
+		for (size_t i = 0; i < LANES; i++)
+		{
+			digests[i] = (m_v0[i] ^ m_v1[i]) ^ (m_v2[i] ^ m_v3[i]);
+		}
+
+		return digests;
+	}
+
+private:
+	static inline uint64_t RotateLeft(const uint64_t value, const int bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	inline void Round()
+	{
+		for (size_t i = 0; i < LANES; i++)
+		{
+			m_v0[i] += m_v1[i];
+			m_v2[i] += m_v3[i];
+			m_v1[i] = RotateLeft(m_v1[i], 13);
+			m_v3[i] = RotateLeft(m_v3[i], 16);
+			m_v1[i] ^= m_v0[i];
+			m_v3[i] ^= m_v2[i];
+			m_v0[i] = RotateLeft(m_v0[i], 32);
+			m_v2[i] += m_v1[i];
+			m_v0[i] += m_v3[i];
+			m_v1[i] = RotateLeft(m_v1[i], 17);
+			m_v3[i] = RotateLeft(m_v3[i], 21);
+			m_v1[i] ^= m_v2[i];
+			m_v3[i] ^= m_v0[i];
+			m_v2[i] = RotateLeft(m_v2[i], 32);
+		}
+	}
+
+	std::array<uint64_t, LANES> m_v0;
+	std::array<uint64_t, LANES> m_v1;
+	std::array<uint64_t, LANES> m_v2;
+	std::array<uint64_t, LANES> m_v3;
+};
\ No newline at end of file
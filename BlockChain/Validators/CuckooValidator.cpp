@@ -0,0 +1,189 @@
+#include "CuckooValidator.h"
+#include "CuckooSipHash.h"
+
+#include <Consensus/BlockDifficulty.h>
+#include <Crypto.h>
+#include <algorithm>
+
+// Number of hashes computed side by side.
+static const size_t LANES = 4;
+
+// Cuckaroo generates edges in blocks of 64 siphashes.
+static const uint64_t EDGE_BLOCK_SIZE = 64;
+static const uint64_t EDGE_BLOCK_MASK = EDGE_BLOCK_SIZE - 1;
+
+CuckooValidator::CuckooValidator(const std::vector<unsigned char>& prePoW, const uint8_t edgeBits)
+	: m_edgeMask(((uint64_t)1 << edgeBits) - 1)
+{
+	const Hash hash = Crypto::Blake2b(prePoW);
+	for (size_t i = 0; i < m_keys.size(); i++)
+	{
+		// Little-endian
+		uint64_t key = 0;
+		for (size_t j = 0; j < 8; j++)
+		{
+			key |= (uint64_t)hash[(int)((i * 8) + j)] << (j * 8);
+		}
+
+		m_keys[i] = key;
+	}
+}
+
+bool CuckooValidator::IsCuckatooValid(const std::vector<uint64_t>& edges) const
+{
+	if (!AreEdgesValid(edges))
+	{
+		return false;
+	}
+
+	// The endpoints of edge n are siphash(2n) and siphash(2n + 1). PROOFSIZE is even, so they split evenly into lanes.
+	std::vector<uint64_t> endpoints(2 * edges.size());
+	for (size_t first = 0; first < endpoints.size(); first += LANES)
+	{
+		std::array<uint64_t, LANES> nonces;
+		for (size_t i = 0; i < LANES; i++)
+		{
+			const size_t endpoint = (std::min)(first + i, endpoints.size() - 1);
+			nonces[i] = (2 * edges[endpoint / 2]) + (endpoint % 2);
+		}
+
+		CuckooSipHash<LANES> sipHash(m_keys);
+		sipHash.Hash24(nonces);
+		const std::array<uint64_t, LANES> digests = sipHash.Digest();
+
+		for (size_t i = 0; i < LANES && (first + i) < endpoints.size(); i++)
+		{
+			endpoints[first + i] = digests[i] & m_edgeMask;
+		}
+	}
+
+	// In cuckatoo, nodes u and u^1 are joined, so endpoints are matched on all but their lowest bit.
+	return IsCycle(endpoints, 1);
+}
+
+bool CuckooValidator::IsCuckarooValid(const std::vector<uint64_t>& edges) const
+{
+	if (!AreEdgesValid(edges))
+	{
+		return false;
+	}
+
+	// Each edge is the xor of its siphash with the last siphash of its block (forcing the whole block to be hashed).
+	// The hashes of a block depend on each other, so blocks are spread across the lanes instead.
+	std::vector<uint64_t> endpoints(2 * edges.size());
+	for (size_t first = 0; first < edges.size(); first += LANES)
+	{
+		std::array<uint64_t, LANES> blockStarts;
+		for (size_t i = 0; i < LANES; i++)
+		{
+			blockStarts[i] = edges[(std::min)(first + i, edges.size() - 1)] & ~EDGE_BLOCK_MASK;
+		}
+
+		CuckooSipHash<LANES> sipHash(m_keys);
+		std::array<std::array<uint64_t, LANES>, EDGE_BLOCK_SIZE> blockHashes;
+		for (uint64_t n = 0; n < EDGE_BLOCK_SIZE; n++)
+		{
+			std::array<uint64_t, LANES> nonces;
+			for (size_t i = 0; i < LANES; i++)
+			{
+				nonces[i] = blockStarts[i] + n;
+			}
+
+			sipHash.Hash24(nonces);
+			blockHashes[n] = sipHash.Digest();
+		}
+
+		for (size_t i = 0; i < LANES && (first + i) < edges.size(); i++)
+		{
+			const uint64_t position = edges[first + i] & EDGE_BLOCK_MASK;
+			uint64_t edge = blockHashes[position][i];
+			if (position != EDGE_BLOCK_MASK)
+			{
+				edge ^= blockHashes[EDGE_BLOCK_MASK][i];
+			}
+
+			endpoints[2 * (first + i)] = edge & m_edgeMask;
+			endpoints[(2 * (first + i)) + 1] = (edge >> 32) & m_edgeMask;
+		}
+	}
+
+	return IsCycle(endpoints, 0);
+}
+
+// Edges must be in range, and sorted with no duplicates.
+bool CuckooValidator::AreEdgesValid(const std::vector<uint64_t>& edges) const
+{
+	if (edges.size() != Consensus::PROOFSIZE)
+	{
+		return false;
+	}
+
+	for (size_t n = 0; n < edges.size(); n++)
+	{
+		if (edges[n] > m_edgeMask)
+		{
+			return false;
+		}
+
+		if (n > 0 && edges[n] <= edges[n - 1])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// The endpoints of edge n are at 2n (u) and 2n + 1 (v).
+// Checks that every node in the proof is shared by exactly 2 edges, and that following them visits every edge in a single cycle.
+bool CuckooValidator::IsCycle(const std::vector<uint64_t>& endpoints, const int nodeShift)
+{
+	const size_t numEndpoints = endpoints.size();
+
+	// Each side of the graph must have every node an even number of times.
+	uint64_t xor0 = (nodeShift == 0) ? 0 : ((numEndpoints / 4) & 1);
+	uint64_t xor1 = xor0;
+	for (size_t n = 0; n < numEndpoints; n += 2)
+	{
+		xor0 ^= endpoints[n];
+		xor1 ^= endpoints[n + 1];
+	}
+
+	if ((xor0 | xor1) != 0)
+	{
+		return false;
+	}
+
+	size_t cycleLength = 0;
+	size_t i = 0;
+	do
+	{
+		// Find the one other edge with an endpoint matching the one at i.
+		size_t j = i;
+		for (size_t k = (i + 2) % numEndpoints; k != i; k = (k + 2) % numEndpoints)
+		{
+			if ((endpoints[k] >> nodeShift) == (endpoints[i] >> nodeShift))
+			{
+				// Branch in cycle
+				if (j != i)
+				{
+					return false;
+				}
+
+				j = k;
+			}
+		}
+
+		// Dead end
+		if (j == i || (nodeShift != 0 && endpoints[j] == endpoints[i]))
+		{
+			return false;
+		}
+
+		// Continue from the other endpoint of that edge.
+		i = j ^ 1;
+		cycleLength++;
+	} while (i != 0);
+
+	return cycleLength == (numEndpoints / 2);
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <array>
+
+//
+// Verifies cuckoo cycle proofs: Cuckatoo for the primary proof of work, and Cuckaroo for the secondary proof of work.
+// The siphash keys of the graph are taken from the blake2b hash of the header's pre-PoW bytes.
+// See: https://github.com/tromp/cuckoo
+//
+class CuckooValidator
+{
+public:
+	CuckooValidator(const std::vector<unsigned char>& prePoW, const uint8_t edgeBits);
+
+	bool IsCuckatooValid(const std::vector<uint64_t>& edges) const;
+	bool IsCuckarooValid(const std::vector<uint64_t>& edges) const;
+
+private:
+	bool AreEdgesValid(const std::vector<uint64_t>& edges) const;
+	static bool IsCycle(const std::vector<uint64_t>& endpoints, const int nodeShift);
+
+	std::array<uint64_t, 4> m_keys;
+	uint64_t m_edgeMask;
+};
\ No newline at end of file
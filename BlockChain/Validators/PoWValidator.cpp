@@ -1,10 +1,14 @@
 #include "PoWValidator.h"
+#include "CuckooValidator.h"
 #include "../uint128/uint128_t.h"
+#include "../DifficultyWindow.h"
 
 #include <Consensus/BlockTime.h>
 #include <Consensus/BlockDifficulty.h>
+#include <Infrastructure/Logger.h>
+#include <StringUtil.h>
 
-bool PoWValidator::IsPoWValid(const BlockHeader& header, const BlockHeader& previousHeader) const
+bool PoWValidator::IsPoWValid(const BlockHeader& header, const BlockHeader& previousHeader, DifficultyWindow& difficultyWindow) const
 {
 	const ProofOfWork& proofOfWork = header.GetProofOfWork();
 	const ProofOfWork& previousProofOfWork = previousHeader.GetProofOfWork();
@@ -21,27 +25,47 @@ bool PoWValidator::IsPoWValid(const BlockHeader& header, const BlockHeader& prev
 		return false;
 	}
 
-	// TODO: Implement
-	//let child_batch = ctx.batch.child() ? ;
-	//let diff_iter = store::DifficultyIter::from_batch(header.previous, child_batch);
-	//let next_header_info = Consensus::next_difficulty(header.GetHeight(), diff_iter);
-	//if (targetDifficulty != next_header_info.difficulty
-	//{
-	//	return Err(ErrorKind::WrongTotalDifficulty.into());
-	//}
+	// Validate the difficulty and secondary scaling against the ones calculated from the previous headers.
+	uint64_t nextDifficulty = 0;
+	uint32_t nextSecondaryScaling = 0;
+	if (!difficultyWindow.CalculateNext(previousHeader, nextDifficulty, nextSecondaryScaling))
+	{
+		return false;
+	}
 
-	// TODO: Implement
-	// check the secondary PoW scaling factor if applicable
-	//if (proofOfWork.GetScalingDifficulty() != next_header_info.secondary_scaling)
-	//{
-	//	return Err(ErrorKind::InvalidScaling.into());
-	//}
+	if (targetDifficulty != nextDifficulty)
+	{
+		LoggerAPI::LogWarning(StringUtil::Format("PoWValidator::IsPoWValid - Expected difficulty %llu, but was %llu.", nextDifficulty, targetDifficulty));
+		return false;
+	}
 
-	// TODO: Implement Siphash verification
+	if (proofOfWork.GetScalingDifficulty() != nextSecondaryScaling)
+	{
+		LoggerAPI::LogWarning(StringUtil::Format("PoWValidator::IsPoWValid - Expected secondary scaling %u, but was %u.", nextSecondaryScaling, proofOfWork.GetScalingDifficulty()));
+		return false;
+	}
 
 	return true;
 }
 
+bool PoWValidator::IsCuckooValid(const BlockHeader& header) const
+{
+	const ProofOfWork& proofOfWork = header.GetProofOfWork();
+	const uint8_t edgeBits = proofOfWork.GetEdgeBits();
+
+	// Secondary PoW uses cuckaroo. Primary PoW uses cuckatoo, with at least the minimum edge bits.
+	if (edgeBits == Consensus::SECOND_POW_EDGE_BITS)
+	{
+		return CuckooValidator(header.GetPreProofOfWork(), edgeBits).IsCuckarooValid(proofOfWork.GetProofNonces());
+	}
+	else if (edgeBits >= Consensus::DEFAULT_MIN_EDGE_BITS && edgeBits < 64)
+	{
+		return CuckooValidator(header.GetPreProofOfWork(), edgeBits).IsCuckatooValid(proofOfWork.GetProofNonces());
+	}
+
+	return false;
+}
+
 // Maximum difficulty this proof of work can achieve
 uint64_t PoWValidator::GetMaximumDifficulty(const ProofOfWork& proofOfWork) const
 {
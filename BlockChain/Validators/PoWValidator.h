@@ -2,10 +2,21 @@
 
 #include <Core/BlockHeader.h>
 
+// Forward Declarations
+class DifficultyWindow;
+
 class PoWValidator
 {
 public:
-	bool IsPoWValid(const BlockHeader& header, const BlockHeader& previousHeader) const;
+	//
+	// Validates the difficulty and secondary scaling of the header against the previous headers, read from the difficulty window.
+	//
+	bool IsPoWValid(const BlockHeader& header, const BlockHeader& previousHeader, DifficultyWindow& difficultyWindow) const;
+
+	//
+	// Validates the cuckoo cycle of the header. Only depends on the header itself.
+	//
+	bool IsCuckooValid(const BlockHeader& header) const;
 
 private:
 	uint64_t GetMaximumDifficulty(const ProofOfWork& proofOfWork) const;
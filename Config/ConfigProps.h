@@ -25,4 +25,12 @@ namespace ConfigProps
 		static const std::string PATIENCE_SECS = "PATIENCE_SECS";
 		static const std::string STEM_PROBABILITY = "STEM_PROBABILITY";
 	}
+
+	namespace Chain
+	{
+		static const std::string CHAIN = "CHAIN";
+
+		static const std::string HEADER_CACHE_MB = "HEADER_CACHE_MB";
+		static const std::string ORPHAN_POOL_MB = "ORPHAN_POOL_MB";
+	}
 }
\ No newline at end of file
@@ -22,9 +22,12 @@ Config ConfigReader::ReadConfig(const Json::Value& root) const
 	// Read Dandelion Config
 	const DandelionConfig dandelionConfig = ReadDandelion(root);
 
+	// Read Chain Config
+	const ChainConfig chainConfig = ReadChain(root);
+
 	// TODO: Mempool, mining, wallet, and logger settings
 
-	return Config(clientMode, environment, dataPath, dandelionConfig, p2pConfig);
+	return Config(clientMode, environment, dataPath, dandelionConfig, p2pConfig, chainConfig);
 }
 
 EClientMode ConfigReader::ReadClientMode(const Json::Value& root) const
@@ -139,4 +142,27 @@ DandelionConfig ConfigReader::ReadDandelion(const Json::Value& root) const
 	}
 
 	return DandelionConfig(relaySeconds, embargoSeconds, patienceSeconds, stemProbability);
+}
+
+ChainConfig ConfigReader::ReadChain(const Json::Value& root) const
+{
+	uint32_t headerCacheMB = 64;
+	uint32_t orphanPoolMB = 32;
+
+	if (root.isMember(ConfigProps::Chain::CHAIN))
+	{
+		const Json::Value& chainRoot = root[ConfigProps::Chain::CHAIN];
+
+		if (chainRoot.isMember(ConfigProps::Chain::HEADER_CACHE_MB))
+		{
+			headerCacheMB = chainRoot.get(ConfigProps::Chain::HEADER_CACHE_MB, 64).asUInt();
+		}
+
+		if (chainRoot.isMember(ConfigProps::Chain::ORPHAN_POOL_MB))
+		{
+			orphanPoolMB = chainRoot.get(ConfigProps::Chain::ORPHAN_POOL_MB, 32).asUInt();
+		}
+	}
+
+	return ChainConfig(headerCacheMB, orphanPoolMB);
 }
\ No newline at end of file
@@ -14,4 +14,5 @@ private:
 	std::string ReadDataPath(const Json::Value& root) const;
 	P2PConfig ReadP2P(const Json::Value& root) const;
 	DandelionConfig ReadDandelion(const Json::Value& root) const;
+	ChainConfig ReadChain(const Json::Value& root) const;
 };
\ No newline at end of file
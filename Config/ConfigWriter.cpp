@@ -13,6 +13,7 @@ bool ConfigWriter::SaveConfig(const Config& config, const std::string& configPat
 	WriteDataPath(root, config.GetDataDirectory());
 	WriteP2P(root, config.GetP2PConfig());
 	WriteDandelion(root, config.GetDandelionConfig());
+	WriteChain(root, config.GetChainConfig());
 
 	std::ofstream file(configPath, std::ios::out | std::ios::binary | std::ios::ate);
 	if (!file.is_open())
@@ -119,4 +120,21 @@ void ConfigWriter::WriteDandelion(Json::Value& root, const DandelionConfig& dand
 	dandelionJSON[ConfigProps::Dandelion::STEM_PROBABILITY] = stemProbabilityValue;
 
 	root[ConfigProps::Dandelion::DANDELION] = dandelionJSON;
+}
+
+void ConfigWriter::WriteChain(Json::Value& root, const ChainConfig& chainConfig) const
+{
+	Json::Value chainJSON;
+
+	Json::Value headerCacheValue = Json::Value(chainConfig.GetHeaderCacheMB());
+	const std::string headerCacheComment = "/* The memory (in MB) used to cache block headers older than the cut-through horizon. Recent headers are always kept in memory. */";
+	headerCacheValue.setComment(headerCacheComment, Json::commentBefore);
+	chainJSON[ConfigProps::Chain::HEADER_CACHE_MB] = headerCacheValue;
+
+	Json::Value orphanPoolValue = Json::Value(chainConfig.GetOrphanPoolMB());
+	const std::string orphanPoolComment = "/* The memory (in MB) used to hold blocks that arrive before their parent is confirmed. */";
+	orphanPoolValue.setComment(orphanPoolComment, Json::commentBefore);
+	chainJSON[ConfigProps::Chain::ORPHAN_POOL_MB] = orphanPoolValue;
+
+	root[ConfigProps::Chain::CHAIN] = chainJSON;
 }
\ No newline at end of file
@@ -15,4 +15,5 @@ private:
 	void WriteDataPath(Json::Value& root, const std::string& dataPath) const;
 	void WriteP2P(Json::Value& root, const P2PConfig& p2pConfig) const;
 	void WriteDandelion(Json::Value& root, const DandelionConfig& dandelionConfig) const;
+	void WriteChain(Json::Value& root, const ChainConfig& chainConfig) const;
 };
\ No newline at end of file
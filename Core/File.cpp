@@ -2,6 +2,7 @@
 
 #include <FileUtil.h>
 #include <fstream>
+#include <algorithm>
 #include <Windows.h>
 
 static bool TruncateFile(const std::string& filePath, const uint64_t size)
@@ -26,7 +27,24 @@ File::File(const std::string& path)
 
 }
 
+File::File(File&& other) noexcept
+	: m_path(other.m_path),
+	m_bufferIndex(other.m_bufferIndex),
+	m_fileSize(other.m_fileSize),
+	m_buffer(std::move(other.m_buffer)),
+	m_mmap(std::move(other.m_mmap))
+{
+
+}
+
 bool File::Load()
+{
+	std::unique_lock<std::shared_mutex> writeLock(m_mutex);
+
+	return LoadInternal();
+}
+
+bool File::LoadInternal()
 {
 	std::ifstream file(m_path, std::ios::in | std::ifstream::ate | std::ifstream::binary);
 	if (!file.is_open())
@@ -38,6 +56,7 @@ bool File::Load()
 	m_bufferIndex = m_fileSize;
 	file.close();
 
+	m_mmap.unmap();
 	if (m_fileSize > 0)
 	{
 		std::error_code error;
@@ -49,15 +68,29 @@ bool File::Load()
 
 bool File::Flush()
 {
-	if (m_fileSize == m_bufferIndex && m_buffer.empty())
+	std::unique_lock<std::shared_mutex> writeLock(m_mutex);
+	if (!IsDirty())
 	{
 		return true;
 	}
 
-	std::ofstream file(m_path, std::ios::out | std::ios::binary | std::ios::app);
+	// Windows can't truncate a mapped file, so the mapping is only released up front when the file shrinks.
+	// Otherwise, it stays in place until the new mapping replaces it.
+	const bool shrinking = (m_bufferIndex + m_buffer.size()) < m_fileSize;
+	if (shrinking)
+	{
+		m_mmap.unmap();
+	}
+
+	// Open without std::ios::app, since appends must start at m_bufferIndex, which may be before the end of the file after a rewind.
+	std::fstream file(m_path, std::ios::in | std::ios::out | std::ios::binary);
 	if (!file.is_open())
 	{
-		return false;
+		file.open(m_path, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			return false;
+		}
 	}
 
 	file.seekp(m_bufferIndex, std::ios::beg);
@@ -74,84 +107,107 @@ bool File::Flush()
 	m_bufferIndex = m_fileSize;
 	m_buffer.clear();
 
-	TruncateFile(m_path, m_fileSize);
+	if (shrinking)
+	{
+		TruncateFile(m_path, m_fileSize);
+	}
 
+	mio::mmap_source mmap;
 	if (m_fileSize > 0)
 	{
 		std::error_code error;
-		m_mmap = mio::make_mmap_source(m_path, error);
+		mmap = mio::make_mmap_source(m_path, error);
 	}
 
+	m_mmap = std::move(mmap);
+
 	return true;
 }
 
 void File::Append(const std::vector<unsigned char>& data)
 {
+	std::unique_lock<std::shared_mutex> writeLock(m_mutex);
 	m_buffer.insert(m_buffer.end(), data.cbegin(), data.cend());
 }
 
+// Rewinds in memory only. Truncation of the file on disk is deferred until the next Flush, so a rewind can still be discarded.
 bool File::Rewind(const uint64_t nextPosition)
 {
-	if (!Flush())
+	std::unique_lock<std::shared_mutex> writeLock(m_mutex);
+	if (nextPosition > m_bufferIndex + m_buffer.size())
 	{
 		return false;
 	}
 
-	if (nextPosition > m_fileSize)
+	if (nextPosition >= m_bufferIndex)
 	{
-		return false;
+		m_buffer.erase(m_buffer.begin() + (nextPosition - m_bufferIndex), m_buffer.end());
 	}
-
-	m_bufferIndex = nextPosition;
-	if (nextPosition <= m_bufferIndex)
+	else
 	{
 		m_buffer.clear();
 		m_bufferIndex = nextPosition;
 	}
-	else
-	{
-		m_buffer.erase(m_buffer.begin() + nextPosition - m_bufferIndex, m_buffer.end());
-	}
 
 	return true;
 }
 
 bool File::Discard()
 {
+	std::unique_lock<std::shared_mutex> writeLock(m_mutex);
 	m_bufferIndex = m_fileSize;
 	m_buffer.clear();
 
 	return true;
 }
 
+bool File::ReplaceWith(const std::string& path)
+{
+	std::unique_lock<std::shared_mutex> writeLock(m_mutex);
+
+	// The mapping must be released before the file can be replaced.
+	m_mmap.unmap();
+	m_buffer.clear();
+
+	if (!FileUtil::RenameFile(path, m_path))
+	{
+		LoadInternal();
+		return false;
+	}
+
+	return LoadInternal();
+}
+
 uint64_t File::GetSize() const
 {
+	std::shared_lock<std::shared_mutex> readLock(m_mutex);
+
 	return m_bufferIndex + m_buffer.size();
 }
 
 bool File::Read(const uint64_t position, const uint64_t numBytes, std::vector<unsigned char>& data) const
 {
-	if (position < m_bufferIndex)
+	std::shared_lock<std::shared_mutex> readLock(m_mutex);
+	if (position + numBytes > m_bufferIndex + m_buffer.size())
 	{
-		data = std::vector<unsigned char>(m_mmap.cbegin() + position, m_mmap.cbegin() + position + numBytes);
-
-		//std::ifstream file(m_path, std::ios::in | std::ios::binary | std::ios::ate);
-		//if (!file.is_open())
-		//{
-		//	return false;
-		//}
+		return false;
+	}
 
-		//data.resize((size_t)numBytes);
+	data.reserve(data.size() + numBytes);
 
-		//file.seekg(position, std::ios::beg);
-		//file.read((char*)&data[0], numBytes);
-		//file.close();
+	// Committed bytes are read from the memory-mapped file, and the remainder from the uncommitted buffer.
+	const uint64_t numMappedBytes = (position < m_bufferIndex) ? (std::min)(numBytes, m_bufferIndex - position) : 0;
+	if (numMappedBytes > 0)
+	{
+		data.insert(data.end(), m_mmap.cbegin() + position, m_mmap.cbegin() + position + numMappedBytes);
 	}
-	else
+
+	if (numMappedBytes < numBytes)
 	{
-		const uint64_t firstBufferIndex = position - m_bufferIndex;
+		const uint64_t firstBufferIndex = position + numMappedBytes - m_bufferIndex;
+		const uint64_t numBufferBytes = numBytes - numMappedBytes;
 
-		data.insert(data.end(), m_buffer.cbegin() + firstBufferIndex, m_buffer.cbegin() + firstBufferIndex + numBytes);
+		data.insert(data.end(), m_buffer.cbegin() + firstBufferIndex, m_buffer.cbegin() + firstBufferIndex + numBufferBytes);
 	}
 
 	return true;
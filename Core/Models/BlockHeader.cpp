@@ -33,6 +33,20 @@ BlockHeader::BlockHeader
 }
 
 void BlockHeader::Serialize(Serializer& serializer) const
+{
+	SerializePreProofOfWork(serializer);
+	serializer.Append<uint8_t>(m_proofOfWork.GetEdgeBits());
+	m_proofOfWork.SerializeProofNonces(serializer);
+}
+
+std::vector<unsigned char> BlockHeader::GetPreProofOfWork() const
+{
+	Serializer serializer;
+	SerializePreProofOfWork(serializer);
+	return serializer.GetBytes();
+}
+
+void BlockHeader::SerializePreProofOfWork(Serializer& serializer) const
 {
 	serializer.Append<uint16_t>(m_version);
 	serializer.Append<uint64_t>(m_height);
@@ -45,7 +59,9 @@ void BlockHeader::Serialize(Serializer& serializer) const
 	m_totalKernelOffset.Serialize(serializer);
 	serializer.Append<uint64_t>(m_outputMMRSize);
 	serializer.Append<uint64_t>(m_kernelMMRSize);
-	m_proofOfWork.Serialize(serializer);
+	serializer.Append<uint64_t>(m_proofOfWork.GetTotalDifficulty());
+	serializer.Append<uint32_t>(m_proofOfWork.GetScalingDifficulty());
+	serializer.Append<uint64_t>(m_proofOfWork.GetNonce());
 }
 
 BlockHeader BlockHeader::Deserialize(ByteBuffer& byteBuffer)
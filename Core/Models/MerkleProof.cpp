@@ -0,0 +1,32 @@
+#include <Core/MerkleProof.h>
+
+MerkleProof::MerkleProof(const uint64_t mmrSize, std::vector<Hash>&& path)
+	: m_mmrSize(mmrSize), m_path(std::move(path))
+{
+
+}
+
+void MerkleProof::Serialize(Serializer& serializer) const
+{
+	serializer.Append<uint64_t>(m_mmrSize);
+
+	serializer.Append<uint64_t>(m_path.size());
+	for (const Hash& hash : m_path)
+	{
+		serializer.AppendBigInteger<32>(hash);
+	}
+}
+
+MerkleProof MerkleProof::Deserialize(ByteBuffer& byteBuffer)
+{
+	const uint64_t mmrSize = byteBuffer.ReadU64();
+
+	const uint64_t pathLength = byteBuffer.ReadU64();
+	std::vector<Hash> path;
+	for (uint64_t i = 0; i < pathLength; i++)
+	{
+		path.emplace_back(byteBuffer.ReadBigInteger<32>());
+	}
+
+	return MerkleProof(mmrSize, std::move(path));
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include <Catch2/catch.hpp>
+
+#include <Consensus/BlockDifficulty.h>
+
+// Expected values are from grin's core/tests/consensus.rs, or worked out from grin's consensus.rs where noted.
+
+using namespace Consensus;
+
+// A full window of blocks, each with the given difficulty, found the given number of seconds apart.
+static uint64_t NextDifficulty(const uint64_t blockTime, const uint64_t difficulty)
+{
+	return CalculateNextDifficulty(blockTime * DIFFICULTY_ADJUST_WINDOW, difficulty * DIFFICULTY_ADJUST_WINDOW);
+}
+
+TEST_CASE("Consensus::Damp and Consensus::Clamp")
+{
+	REQUIRE(Damp(BLOCK_TIME_WINDOW, BLOCK_TIME_WINDOW, DIFFICULTY_DAMP_FACTOR) == BLOCK_TIME_WINDOW);
+	REQUIRE(Damp(5400, 3600, 3) == 4200);
+	REQUIRE(Damp(0, 3600, 3) == 2400);
+
+	REQUIRE(Clamp(4200, 3600, 2) == 4200);
+	REQUIRE(Clamp(8400, 3600, 2) == 7200);
+	REQUIRE(Clamp(0, 3600, 2) == 1800);
+}
+
+TEST_CASE("Consensus::CalculateNextDifficulty")
+{
+	// Right block time, difficulty stays constant
+	REQUIRE(NextDifficulty(BLOCK_TIME_SEC, 1000) == 1000);
+
+	// Averages the window: half at 500, half at 1500
+	REQUIRE(CalculateNextDifficulty(BLOCK_TIME_WINDOW, (DIFFICULTY_ADJUST_WINDOW / 2) * (500 + 1500)) == 1000);
+
+	// Too slow, difficulty goes down (damped)
+	REQUIRE(NextDifficulty(90, 1000) == 857);
+	REQUIRE(NextDifficulty(120, 1000) == 750);
+
+	// Too fast, difficulty goes up (damped)
+	REQUIRE(NextDifficulty(55, 1000) == 1028);
+	REQUIRE(NextDifficulty(45, 1000) == 1090);
+	REQUIRE(NextDifficulty(30, 1000) == 1200);
+
+	// Clamped at the lower time bound
+	REQUIRE(NextDifficulty(0, 1000) == 1500);
+
+	// Clamped at the upper time bound
+	REQUIRE(NextDifficulty(300, 1000) == 500);
+	REQUIRE(NextDifficulty(400, 1000) == 500);
+
+	// Never drops below the minimum, and doesn't get stuck on it when blocks are fast.
+	REQUIRE(NextDifficulty(90, 0) == MIN_DIFFICULTY);
+	REQUIRE(NextDifficulty(BLOCK_TIME_SEC / 4, MIN_DIFFICULTY) > MIN_DIFFICULTY);
+}
+
+TEST_CASE("Consensus::GetSecondaryPoWRatio")
+{
+	REQUIRE(GetSecondaryPoWRatio(1) == 90);
+	REQUIRE(GetSecondaryPoWRatio(181) == 90);
+
+	REQUIRE(GetSecondaryPoWRatio(WEEK_HEIGHT - 1) == 90);
+	REQUIRE(GetSecondaryPoWRatio(WEEK_HEIGHT) == 90);
+	REQUIRE(GetSecondaryPoWRatio(WEEK_HEIGHT + 1) == 90);
+
+	REQUIRE(GetSecondaryPoWRatio((2 * WEEK_HEIGHT) - 1) == 89);
+	REQUIRE(GetSecondaryPoWRatio(2 * WEEK_HEIGHT) == 89);
+	REQUIRE(GetSecondaryPoWRatio((2 * WEEK_HEIGHT) + 1) == 89);
+
+	REQUIRE(GetSecondaryPoWRatio(64000 - 1) == 85);
+	REQUIRE(GetSecondaryPoWRatio(64000) == 85);
+
+	REQUIRE(GetSecondaryPoWRatio(YEAR_HEIGHT) == 45);
+
+	REQUIRE(GetSecondaryPoWRatio((91 * WEEK_HEIGHT) - 1) == 12);
+	REQUIRE(GetSecondaryPoWRatio(91 * WEEK_HEIGHT) == 12);
+	REQUIRE(GetSecondaryPoWRatio((91 * WEEK_HEIGHT) + 1) == 12);
+
+	REQUIRE(GetSecondaryPoWRatio((2 * YEAR_HEIGHT) - 1) == 1);
+	REQUIRE(GetSecondaryPoWRatio(2 * YEAR_HEIGHT) == 0);
+	REQUIRE(GetSecondaryPoWRatio(3 * YEAR_HEIGHT) == 0);
+}
+
+// Worked out from grin's secondary_pow_scaling, for a full window of blocks with a scaling of 50.
+TEST_CASE("Consensus::CalculateSecondaryScaling")
+{
+	const uint64_t scalingSum = 50 * DIFFICULTY_ADJUST_WINDOW;
+
+	// All primary, scaling goes up (damped), so secondary blocks get easier to find.
+	REQUIRE(CalculateSecondaryScaling(1, scalingSum, 0) == 54);
+
+	// All secondary, when 90% are wanted, scaling goes down (damped).
+	REQUIRE(CalculateSecondaryScaling(1, scalingSum, DIFFICULTY_ADJUST_WINDOW) == 49);
+
+	// Just the right ratio, scaling stays constant.
+	REQUIRE(CalculateSecondaryScaling(1, scalingSum, DIFFICULTY_ADJUST_WINDOW * 9 / 10) == 50);
+
+	// 40% secondary, when 90% are wanted.
+	REQUIRE(CalculateSecondaryScaling(1, scalingSum, DIFFICULTY_ADJUST_WINDOW * 4 / 10) == 52);
+
+	// All secondary, when only 14% are wanted, scaling goes down, but is clamped.
+	REQUIRE(CalculateSecondaryScaling(890000, scalingSum, DIFFICULTY_ADJUST_WINDOW) == 33);
+
+	// Never drops below the minimum.
+	REQUIRE(CalculateSecondaryScaling(890000, MIN_AR_SCALE * DIFFICULTY_ADJUST_WINDOW, DIFFICULTY_ADJUST_WINDOW) == MIN_AR_SCALE);
+	REQUIRE(CalculateSecondaryScaling(2 * YEAR_HEIGHT, scalingSum, 0) == MIN_AR_SCALE);
+}
+
+TEST_CASE("Consensus::INITIAL_GRAPH_WEIGHT")
+{
+	// graph_weight(0, SECOND_POW_EDGE_BITS) = (2 << (29 - 24)) * 29
+	REQUIRE(INITIAL_GRAPH_WEIGHT == 1856);
+
+	// A window padded entirely with simulated pre-genesis blocks, which are secondary, with the initial graph weight.
+	REQUIRE(CalculateSecondaryScaling(1, INITIAL_GRAPH_WEIGHT * DIFFICULTY_ADJUST_WINDOW, DIFFICULTY_ADJUST_WINDOW) == 1840);
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include <Catch2/catch.hpp>
+
+#include "../../BlockChain/Validators/CuckooSipHash.h"
+#include "../../BlockChain/Validators/CuckooValidator.h"
+
+// Test vectors are from grin's core/src/pow/siphash.rs, cuckatoo.rs and cuckaroo.rs.
+
+static uint64_t SipHash24(const std::array<uint64_t, 4>& keys, const uint64_t nonce)
+{
+	CuckooSipHash<1> sipHash(keys);
+	sipHash.Hash24({ nonce });
+	return sipHash.Digest()[0];
+}
+
+// The hash of the nonce, xor'd with the last hash of its block of 64, like cuckaroo edges.
+static uint64_t SipHashBlock(const std::array<uint64_t, 4>& keys, const uint64_t nonce)
+{
+	CuckooSipHash<1> sipHash(keys);
+	std::vector<uint64_t> blockHashes;
+	for (uint64_t n = (nonce & ~63); n < (nonce & ~63) + 64; n++)
+	{
+		sipHash.Hash24({ n });
+		blockHashes.push_back(sipHash.Digest()[0]);
+	}
+
+	return ((nonce & 63) == 63) ? blockHashes[63] : (blockHashes[nonce & 63] ^ blockHashes[63]);
+}
+
+// An empty 80 byte header, with the given nonce in its last 4 bytes (little-endian).
+static std::vector<unsigned char> CreatePrePoW(const uint32_t nonce)
+{
+	std::vector<unsigned char> prePoW(80, 0);
+	for (size_t i = 0; i < 4; i++)
+	{
+		prePoW[76 + i] = (unsigned char)(nonce >> (8 * i));
+	}
+
+	return prePoW;
+}
+
+static const std::vector<uint64_t> CUCKATOO_29_SOLUTION = {
+	0x48a9e2, 0x9cf043, 0x155ca30, 0x18f4783, 0x248f86c, 0x2629a64, 0x5bad752, 0x72e3569,
+	0x93db760, 0x97d3b37, 0x9e05670, 0xa315d5a, 0xa3571a1, 0xa48db46, 0xa7796b6, 0xac43611,
+	0xb64912f, 0xbb6c71e, 0xbcc8be1, 0xc38a43a, 0xd4faa99, 0xe018a66, 0xe37e49c, 0xfa975fa,
+	0x11786035, 0x1243b60a, 0x12892da0, 0x141b5453, 0x1483c3a0, 0x1505525e, 0x1607352c,
+	0x16181fe3, 0x17e3a1da, 0x180b651e, 0x1899d678, 0x1931b0bb, 0x19606448, 0x1b041655,
+	0x1b2c20ad, 0x1bd7a83c, 0x1c05d5b0, 0x1c0b9caa
+};
+
+static const std::vector<uint64_t> CUCKAROO_19_SOLUTION = {
+	0x45e9, 0x6a59, 0xf1ad, 0x10ef7, 0x129e8, 0x13e58, 0x17936, 0x19f7f, 0x208df, 0x23704,
+	0x24564, 0x27e64, 0x2b828, 0x2bb41, 0x2ffc0, 0x304c5, 0x31f2a, 0x347de, 0x39686, 0x3ab6c,
+	0x429ad, 0x45254, 0x49200, 0x4f8f8, 0x5697f, 0x57ad1, 0x5dd47, 0x607f8, 0x66199, 0x686c7,
+	0x6d5f3, 0x6da7a, 0x6dbdf, 0x6f6bf, 0x6ffbb, 0x7580e, 0x78594, 0x785ac, 0x78b1d, 0x7b80d,
+	0x7c11c, 0x7da35
+};
+
+TEST_CASE("CuckooSipHash::Hash24")
+{
+	REQUIRE(SipHash24({ 1, 2, 3, 4 }, 10) == 928382149599306901ULL);
+	REQUIRE(SipHash24({ 1, 2, 3, 4 }, 111) == 10524991083049122233ULL);
+	REQUIRE(SipHash24({ 9, 7, 6, 7 }, 12) == 1305683875471634734ULL);
+	REQUIRE(SipHash24({ 9, 7, 6, 7 }, 10) == 11589833042187638814ULL);
+
+	// Each lane is hashed independently.
+	CuckooSipHash<4> sipHash({ 1, 2, 3, 4 });
+	sipHash.Hash24({ 10, 111, 10, 111 });
+	const std::array<uint64_t, 4> digests = sipHash.Digest();
+	REQUIRE(digests[0] == 928382149599306901ULL);
+	REQUIRE(digests[1] == 10524991083049122233ULL);
+	REQUIRE(digests[2] == 928382149599306901ULL);
+	REQUIRE(digests[3] == 10524991083049122233ULL);
+}
+
+TEST_CASE("CuckooSipHash - Block")
+{
+	REQUIRE(SipHashBlock({ 1, 2, 3, 4 }, 10) == 1182162244994096396ULL);
+	REQUIRE(SipHashBlock({ 1, 2, 3, 4 }, 123) == 11303676240481718781ULL);
+	REQUIRE(SipHashBlock({ 9, 7, 6, 7 }, 12) == 4886136884237259030ULL);
+}
+
+TEST_CASE("CuckooValidator::IsCuckatooValid")
+{
+	const CuckooValidator validator(CreatePrePoW(20), 29);
+	REQUIRE(validator.IsCuckatooValid(CUCKATOO_29_SOLUTION));
+
+	// Not a cuckaroo cycle, or a cycle for any other header.
+	REQUIRE(!validator.IsCuckarooValid(CUCKATOO_29_SOLUTION));
+	REQUIRE(!CuckooValidator(CreatePrePoW(21), 29).IsCuckatooValid(CUCKATOO_29_SOLUTION));
+
+	// Mutated edge
+	std::vector<uint64_t> mutated = CUCKATOO_29_SOLUTION;
+	mutated[5]++;
+	REQUIRE(!validator.IsCuckatooValid(mutated));
+
+	// Short cycle
+	const std::vector<uint64_t> shortCycle(CUCKATOO_29_SOLUTION.cbegin(), CUCKATOO_29_SOLUTION.cend() - 1);
+	REQUIRE(!validator.IsCuckatooValid(shortCycle));
+
+	// Unsorted
+	std::vector<uint64_t> unsorted = CUCKATOO_29_SOLUTION;
+	std::swap(unsorted[0], unsorted[1]);
+	REQUIRE(!validator.IsCuckatooValid(unsorted));
+
+	// Duplicate edge
+	std::vector<uint64_t> duplicate = CUCKATOO_29_SOLUTION;
+	duplicate[1] = duplicate[0];
+	REQUIRE(!validator.IsCuckatooValid(duplicate));
+
+	// Edges out of range
+	REQUIRE(!CuckooValidator(CreatePrePoW(20), 28).IsCuckatooValid(CUCKATOO_29_SOLUTION));
+}
+
+TEST_CASE("CuckooValidator::IsCuckarooValid")
+{
+	const CuckooValidator validator(CreatePrePoW(71), 19);
+	REQUIRE(validator.IsCuckarooValid(CUCKAROO_19_SOLUTION));
+
+	// Not a cuckatoo cycle, or a cycle for any other header.
+	REQUIRE(!validator.IsCuckatooValid(CUCKAROO_19_SOLUTION));
+	REQUIRE(!CuckooValidator(CreatePrePoW(72), 19).IsCuckarooValid(CUCKAROO_19_SOLUTION));
+
+	// Mutated edge
+	std::vector<uint64_t> mutated = CUCKAROO_19_SOLUTION;
+	mutated[41]++;
+	REQUIRE(!validator.IsCuckarooValid(mutated));
+
+	// Short cycle
+	const std::vector<uint64_t> shortCycle(CUCKAROO_19_SOLUTION.cbegin() + 1, CUCKAROO_19_SOLUTION.cend());
+	REQUIRE(!validator.IsCuckarooValid(shortCycle));
+
+	// Unsorted
+	std::vector<uint64_t> unsorted = CUCKAROO_19_SOLUTION;
+	std::swap(unsorted[40], unsorted[41]);
+	REQUIRE(!validator.IsCuckarooValid(unsorted));
+
+	// Edges out of range
+	REQUIRE(!CuckooValidator(CreatePrePoW(71), 18).IsCuckarooValid(CUCKAROO_19_SOLUTION));
+}
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include <Catch2/catch.hpp>
+
+#include "../../BlockChain/BlockStore.h"
+#include "../../BlockChain/DifficultyWindow.h"
+
+#include <Config/Genesis.h>
+#include <Consensus/BlockDifficulty.h>
+#include <filesystem>
+#include <random>
+
+// Headers the BlockStore doesn't pin are looked up here.
+class TestBlockDB : public IBlockDB
+{
+public:
+	virtual std::vector<BlockHeader*> LoadBlockHeaders(const std::vector<Hash>& hashes) override final
+	{
+		std::vector<BlockHeader*> blockHeaders;
+		for (const Hash& hash : hashes)
+		{
+			auto iter = m_blockHeaders.find(hash);
+			if (iter != m_blockHeaders.cend())
+			{
+				blockHeaders.push_back(new BlockHeader(iter->second));
+			}
+		}
+
+		return blockHeaders;
+	}
+
+	virtual std::unique_ptr<BlockHeader> GetBlockHeader(const Hash& hash) override final
+	{
+		auto iter = m_blockHeaders.find(hash);
+		return iter == m_blockHeaders.cend() ? std::unique_ptr<BlockHeader>(nullptr) : std::make_unique<BlockHeader>(iter->second);
+	}
+
+	virtual void AddBlockHeader(const BlockHeader& blockHeader) override final
+	{
+		m_blockHeaders.emplace(blockHeader.GetHash(), blockHeader);
+	}
+
+	virtual void AddBlockHeaders(const std::vector<const BlockHeader*>& blockHeaders) override final
+	{
+		for (const BlockHeader* pBlockHeader : blockHeaders)
+		{
+			AddBlockHeader(*pBlockHeader);
+		}
+	}
+
+	virtual void AddBlockSums(const Hash& blockHash, const BlockSums& blockSums) override final { }
+	virtual std::unique_ptr<BlockSums> GetBlockSums(const Hash& blockHash) override final { return std::unique_ptr<BlockSums>(nullptr); }
+
+private:
+	std::map<Hash, BlockHeader> m_blockHeaders;
+};
+
+// Builds chains of headers with random timestamps, difficulties and secondary scaling.
+class TestChainBuilder
+{
+public:
+	TestChainBuilder(BlockStore& blockStore) : m_blockStore(blockStore), m_random(1), m_nextId(1) { }
+
+	//
+	// Adds numHeaders headers on top of the given chain (or starts a new one), and returns the extended chain.
+	//
+	std::vector<BlockHeader> Extend(const std::vector<BlockHeader>& chain, const uint64_t numHeaders)
+	{
+		std::vector<BlockHeader> extended = chain;
+		for (uint64_t i = 0; i < numHeaders; i++)
+		{
+			const BlockHeader* pPrevious = extended.empty() ? nullptr : &extended.back();
+			const uint64_t height = pPrevious == nullptr ? 0 : (pPrevious->GetHeight() + 1);
+			const int64_t timestamp = pPrevious == nullptr ? 1550000000 : (pPrevious->GetTimestamp() + 1 + (int64_t)(m_random() % 180));
+			const uint64_t previousTotalDifficulty = pPrevious == nullptr ? 0 : pPrevious->GetProofOfWork().GetTotalDifficulty();
+			const bool secondary = (m_random() % 10) != 0;
+
+			// Every header gets a unique proof, since the header hash is the hash of the proof.
+			std::vector<uint64_t> proofNonces(Consensus::PROOFSIZE, 0);
+			proofNonces[0] = m_nextId++;
+
+			ProofOfWork proofOfWork(
+				previousTotalDifficulty + 1000 + (m_random() % 1000),
+				(uint32_t)(Consensus::MIN_AR_SCALE + (m_random() % 2000)),
+				0,
+				secondary ? Consensus::SECOND_POW_EDGE_BITS : Consensus::DEFAULT_MIN_EDGE_BITS,
+				std::move(proofNonces)
+			);
+
+			Hash previousHash = pPrevious == nullptr ? Hash() : pPrevious->GetHash();
+			BlockHeader header(1, height, timestamp, std::move(previousHash), Hash(), Hash(), Hash(), Hash(), BlindingFactor(Hash()), 0, 0, std::move(proofOfWork));
+			m_blockStore.AddHeader(header);
+			extended.emplace_back(std::move(header));
+		}
+
+		return extended;
+	}
+
+private:
+	BlockStore& m_blockStore;
+	std::mt19937_64 m_random;
+	uint64_t m_nextId;
+};
+
+struct HeaderInfo
+{
+	uint64_t m_timestamp;
+	uint64_t m_difficulty;
+	uint64_t m_secondaryScaling;
+	bool m_secondary;
+};
+
+// Calculates the next difficulty and secondary scaling the way grin's next_difficulty does: from the last DIFFICULTY_ADJUST_WINDOW + 1 headers,
+// padded with simulated pre-genesis headers (perfectly timed, at the tip's difficulty, secondary, with the initial graph weight) when the chain is shorter.
+static void CalculateExpected(const std::vector<BlockHeader>& chain, const uint64_t tipHeight, uint64_t& difficultyOut, uint32_t& secondaryScalingOut)
+{
+	// Newest first
+	std::vector<HeaderInfo> headerInfos;
+	for (uint64_t height = tipHeight + 1; height > 0 && headerInfos.size() <= Consensus::DIFFICULTY_ADJUST_WINDOW; height--)
+	{
+		const ProofOfWork& proofOfWork = chain[height - 1].GetProofOfWork();
+		const uint64_t previousTotalDifficulty = height > 1 ? chain[height - 2].GetProofOfWork().GetTotalDifficulty() : 0;
+		headerInfos.push_back({ (uint64_t)chain[height - 1].GetTimestamp(), proofOfWork.GetTotalDifficulty() - previousTotalDifficulty, proofOfWork.GetScalingDifficulty(), proofOfWork.GetEdgeBits() == Consensus::SECOND_POW_EDGE_BITS });
+	}
+
+	const uint64_t lastTimestampDelta = headerInfos.size() > 1 ? (headerInfos[0].m_timestamp - headerInfos[1].m_timestamp) : Consensus::BLOCK_TIME_SEC;
+	uint64_t lastTimestamp = headerInfos.back().m_timestamp;
+	while (headerInfos.size() <= Consensus::DIFFICULTY_ADJUST_WINDOW)
+	{
+		lastTimestamp = lastTimestamp > lastTimestampDelta ? (lastTimestamp - lastTimestampDelta) : 0;
+		headerInfos.push_back({ lastTimestamp, headerInfos[0].m_difficulty, Consensus::INITIAL_GRAPH_WEIGHT, true });
+	}
+
+	// The oldest header only bounds the time span.
+	uint64_t difficultySum = 0;
+	uint64_t scalingSum = 0;
+	uint64_t numSecondary = 0;
+	for (size_t i = 0; i < Consensus::DIFFICULTY_ADJUST_WINDOW; i++)
+	{
+		difficultySum += headerInfos[i].m_difficulty;
+		scalingSum += headerInfos[i].m_secondaryScaling;
+		numSecondary += headerInfos[i].m_secondary ? 1 : 0;
+	}
+
+	const uint64_t timestampDelta = headerInfos[0].m_timestamp - headerInfos[Consensus::DIFFICULTY_ADJUST_WINDOW].m_timestamp;
+	difficultyOut = Consensus::CalculateNextDifficulty(timestampDelta, difficultySum);
+	secondaryScalingOut = Consensus::CalculateSecondaryScaling(tipHeight + 1, scalingSum, numSecondary);
+}
+
+static void RequireNextMatches(DifficultyWindow& difficultyWindow, const std::vector<BlockHeader>& chain, const uint64_t tipHeight)
+{
+	uint64_t expectedDifficulty = 0;
+	uint32_t expectedScaling = 0;
+	CalculateExpected(chain, tipHeight, expectedDifficulty, expectedScaling);
+
+	uint64_t difficulty = 0;
+	uint32_t scaling = 0;
+	REQUIRE(difficultyWindow.CalculateNext(chain[tipHeight], difficulty, scaling));
+	REQUIRE(difficulty == expectedDifficulty);
+	REQUIRE(scaling == expectedScaling);
+}
+
+TEST_CASE("DifficultyWindow::CalculateNext")
+{
+	const std::string dataDirectory = (std::filesystem::temp_directory_path() / "GrinPlusPlus_DifficultyWindow").string() + "/";
+	const Config config(EClientMode::FAST_SYNC, Environment(Genesis::FLOONET_GENESIS), dataDirectory, DandelionConfig(10, 30, 10, 90), P2PConfig(), ChainConfig());
+
+	TestBlockDB blockDB;
+	BlockStore blockStore(config, blockDB);
+	TestChainBuilder builder(blockStore);
+
+	const std::vector<BlockHeader> chain = builder.Extend(std::vector<BlockHeader>(), 300);
+
+	// Slides one header at a time, from the padded windows just after genesis, and around the ring (of 128 entries) twice.
+	DifficultyWindow difficultyWindow(blockStore);
+	for (uint64_t height = 0; height < chain.size(); height++)
+	{
+		RequireNextMatches(difficultyWindow, chain, height);
+	}
+
+	// Rewinds to a fork within the ring, and follows it.
+	const std::vector<BlockHeader> fork = builder.Extend(std::vector<BlockHeader>(chain.cbegin(), chain.cbegin() + 251), 30);
+	for (uint64_t height = 250; height < fork.size(); height++)
+	{
+		RequireNextMatches(difficultyWindow, fork, height);
+	}
+
+	// The fork overwrote entries of the original chain, which must be reloaded.
+	RequireNextMatches(difficultyWindow, chain, 299);
+
+	// Rewinds deeper than the ring holds.
+	RequireNextMatches(difficultyWindow, chain, 100);
+
+	// Reloads a padded window.
+	RequireNextMatches(difficultyWindow, chain, 10);
+
+	// Every header's window loaded from scratch.
+	for (uint64_t height = 0; height < chain.size(); height += 37)
+	{
+		DifficultyWindow freshWindow(blockStore);
+		RequireNextMatches(freshWindow, chain, height);
+	}
+}
\ No newline at end of file
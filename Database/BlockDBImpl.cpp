@@ -8,7 +8,6 @@
 #include <filesystem>
 
 const std::string BLOCK_SUMS_KEY = "SUMS_";
-const std::string OUTPUT_POS_KEY = "OUT_";
 
 std::string kDBPath = "/tmp/rocksdb_simple_example";
 
@@ -104,7 +103,7 @@ void BlockDB::AddBlockHeader(const BlockHeader& blockHeader)
 	m_pDatabase->Put(WriteOptions(), Slice(key), value);
 }
 
-void BlockDB::AddBlockHeaders(const std::vector<BlockHeader*>& blockHeaders)
+void BlockDB::AddBlockHeaders(const std::vector<const BlockHeader*>& blockHeaders)
 {
 	LoggerAPI::LogInfo("BlockDB::AddBlockHeaders - Adding headers - " + std::to_string(blockHeaders.size()));
 	std::lock_guard<std::mutex> lockGuard(m_mutex);
@@ -163,48 +162,4 @@ std::unique_ptr<BlockSums> BlockDB::GetBlockSums(const Hash& blockHash)
 	}
 
 	return pBlockSums;
-}
-
-
-void BlockDB::AddOutputPosition(const Commitment& outputCommitment, const uint64_t mmrIndex)
-{
-	const std::string outputHex = HexUtil::ConvertToHex(outputCommitment.GetCommitmentBytes().GetData(), false, false);
-	LoggerAPI::LogInfo(StringUtil::Format("BlockDB::AddOutputPosition - Adding position (%lld) for output (%s).", mmrIndex, outputHex.c_str()));
-
-	std::lock_guard<std::mutex> lockGuard(m_mutex);
-
-	// Calculate Key Value ("OUT_POS_" + <Commitment_In_Hex_>)
-	const std::string key = OUTPUT_POS_KEY + outputHex;
-	const Slice keyValue(&key[0], key.size());
-
-	// Serializes the output position
-	Serializer serializer;
-	serializer.Append<uint64_t>(mmrIndex);
-	Slice value((const char*)&serializer.GetBytes()[0], serializer.GetBytes().size());
-
-	// Insert the output position
-	m_pDatabase->Put(WriteOptions(), keyValue, value);
-}
-
-std::optional<uint64_t> BlockDB::GetOutputPosition(const Commitment& outputCommitment)
-{
-	std::lock_guard<std::mutex> lockGuard(m_mutex);
-	std::optional<uint64_t> outputPosition = std::nullopt;
-
-	// Calculate Key Value ("OUT_POS_" + <Commitment_In_Hex_>)
-	const std::string key = OUTPUT_POS_KEY + HexUtil::ConvertToHex(outputCommitment.GetCommitmentBytes().GetData(), false, false);
-	Slice keyValue((const char*)&key[0], key.size());
-
-	// Read from DB
-	std::string value;
-	const Status s = m_pDatabase->Get(ReadOptions(), keyValue, &value);
-	if (s.ok())
-	{
-		// Deserialize result
-		std::vector<unsigned char> data(value.data(), value.data() + value.size());
-		ByteBuffer byteBuffer(data);
-		outputPosition = std::make_optional<uint64_t>(byteBuffer.ReadU64());
-	}
-
-	return outputPosition;
 }
\ No newline at end of file
@@ -25,14 +25,11 @@ public:
 	virtual std::unique_ptr<BlockHeader> GetBlockHeader(const Hash& hash) override final;
 
 	virtual void AddBlockHeader(const BlockHeader& blockHeader) override final;
-	virtual void AddBlockHeaders(const std::vector<BlockHeader*>& blockHeaders) override final;
+	virtual void AddBlockHeaders(const std::vector<const BlockHeader*>& blockHeaders) override final;
 
 	virtual void AddBlockSums(const Hash& blockHash, const BlockSums& blockSums) override final;
 	virtual std::unique_ptr<BlockSums> GetBlockSums(const Hash& blockHash) override final;
 
-	virtual void AddOutputPosition(const Commitment& outputCommitment, const uint64_t mmrIndex) override final;
-	virtual std::optional<uint64_t> GetOutputPosition(const Commitment& outputCommitment) override final;
-
 private:
 	std::string GetHeadKey(const EChainType chainType) const;
 
@@ -19,7 +19,7 @@ std::vector<CBigInteger<32>> BlockLocator::GetLocators() const
 	locators.reserve(locatorHeights.size());
 	for (const uint64_t locatorHeight : locatorHeights)
 	{
-		std::unique_ptr<BlockHeader> pHeader = m_blockChainServer.GetBlockHeaderByHeight(locatorHeight, EChainType::SYNC);
+		std::shared_ptr<const BlockHeader> pHeader = m_blockChainServer.GetSharedBlockHeaderByHeight(locatorHeight, EChainType::SYNC);
 		if (pHeader != nullptr)
 		{
 			locators.push_back(pHeader->GetHash());
@@ -59,11 +59,11 @@ std::vector<uint64_t> BlockLocator::GetLocatorHeights() const
 	return heights;
 }
 
-std::vector<BlockHeader> BlockLocator::LocateHeaders(const std::vector<CBigInteger<32>>& locatorHashes) const
+std::vector<std::shared_ptr<const BlockHeader>> BlockLocator::LocateHeaders(const std::vector<CBigInteger<32>>& locatorHashes) const
 {
-	std::vector<BlockHeader> blockHeaders;
+	std::vector<std::shared_ptr<const BlockHeader>> blockHeaders;
 
-	std::unique_ptr<BlockHeader> pCommonHeader = FindCommonHeader(locatorHashes);
+	std::shared_ptr<const BlockHeader> pCommonHeader = FindCommonHeader(locatorHashes);
 	if (pCommonHeader != nullptr)
 	{
 		const uint64_t totalHeight = m_blockChainServer.GetHeight(EChainType::SYNC);
@@ -72,29 +72,29 @@ std::vector<BlockHeader> BlockLocator::LocateHeaders(const std::vector<CBigInteg
 
 		for (int i = 1; i <= numHeadersToSend; i++)
 		{
-			std::unique_ptr<BlockHeader> pHeader = m_blockChainServer.GetBlockHeaderByHeight(headerHeight + i, EChainType::SYNC);
+			std::shared_ptr<const BlockHeader> pHeader = m_blockChainServer.GetSharedBlockHeaderByHeight(headerHeight + i, EChainType::SYNC);
 			if (pHeader == nullptr)
 			{
 				break;
 			}
 
-			blockHeaders.push_back(*pHeader);
+			blockHeaders.emplace_back(std::move(pHeader));
 		}
 	}
 	
 	return blockHeaders;
 }
 
-std::unique_ptr<BlockHeader> BlockLocator::FindCommonHeader(const std::vector<CBigInteger<32>>& locatorHashes) const
+std::shared_ptr<const BlockHeader> BlockLocator::FindCommonHeader(const std::vector<CBigInteger<32>>& locatorHashes) const
 {
 	for (CBigInteger<32> locatorHash : locatorHashes)
 	{
-		std::unique_ptr<BlockHeader> pHeader = m_blockChainServer.GetBlockHeaderByHash(locatorHash);
+		std::shared_ptr<const BlockHeader> pHeader = m_blockChainServer.GetSharedBlockHeaderByHash(locatorHash);
 		if (pHeader != nullptr)
 		{
 			return pHeader;
 		}
 	}
 
-	return std::unique_ptr<BlockHeader>(nullptr);
+	return std::shared_ptr<const BlockHeader>(nullptr);
 }
\ No newline at end of file
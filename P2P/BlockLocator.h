@@ -9,11 +9,14 @@ public:
 	BlockLocator(IBlockChainServer& blockChainServer);
 
 	std::vector<CBigInteger<32>> GetLocators() const;
-	std::vector<BlockHeader> LocateHeaders(const std::vector<CBigInteger<32>>& locatorHashes) const;
+	//
+	// Returns shared handles to the headers following the first locator found in the sync chain, without copying them.
+	//
+	std::vector<std::shared_ptr<const BlockHeader>> LocateHeaders(const std::vector<CBigInteger<32>>& locatorHashes) const;
 
 private:
 	std::vector<uint64_t> GetLocatorHeights() const;
-	std::unique_ptr<BlockHeader> FindCommonHeader(const std::vector<CBigInteger<32>>& locatorHashes) const;
+	std::shared_ptr<const BlockHeader> FindCommonHeader(const std::vector<CBigInteger<32>>& locatorHashes) const;
 
 	IBlockChainServer& m_blockChainServer;
 };
\ No newline at end of file
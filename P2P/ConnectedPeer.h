@@ -9,12 +9,12 @@ class ConnectedPeer
 {
 public:
 	ConnectedPeer(const SOCKET connection, const Peer& peer)
-		: m_connection(connection), m_peer(peer)
+		: m_connection(connection), m_peer(peer), m_txHashSetRequested(false)
 	{
 
 	}
 	ConnectedPeer(const ConnectedPeer& peer)
-		: m_connection(peer.m_connection), m_peer(peer.m_peer), m_totalDifficulty(peer.m_totalDifficulty.load())
+		: m_connection(peer.m_connection), m_peer(peer.m_peer), m_totalDifficulty(peer.m_totalDifficulty.load()), m_txHashSetRequested(peer.m_txHashSetRequested.load())
 	{
 
 	}
@@ -25,6 +25,12 @@ public:
 		m_height = height;
 	}
 
+	//
+	// A TxHashSet archive is only accepted from a peer it was requested from, and only once per request.
+	//
+	inline void OnTxHashSetRequested() { m_txHashSetRequested = true; }
+	inline bool TakeTxHashSetRequest() { return m_txHashSetRequested.exchange(false); }
+
 	inline const SOCKET GetConnection() const { return m_connection; }
 	inline const Peer& GetPeer() const { return m_peer; }
 	inline const uint64_t GetTotalDifficulty() const { return m_totalDifficulty; }
@@ -35,5 +41,6 @@ private:
 	const Peer m_peer;
 	std::atomic<uint64_t> m_totalDifficulty;
 	std::atomic<uint64_t> m_height;
+	std::atomic<bool> m_txHashSetRequested;
 	// TODO: Add Connection Stats
 };
\ No newline at end of file
@@ -63,6 +63,11 @@ void Connection::Disconnect()
 
 void Connection::Send(const IMessage& message)
 {
+	if (message.GetMessageType() == MessageTypes::TxHashSetRequest)
+	{
+		m_connectedPeer.OnTxHashSetRequested();
+	}
+
 	std::lock_guard<std::mutex> lockGuard(m_sendMutex);
 	m_sendQueue.emplace(message.Clone());
 }
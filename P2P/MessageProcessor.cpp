@@ -27,10 +27,9 @@
 
 #include <HexUtil.h>
 #include <StringUtil.h>
-#include <FileUtil.h>
 #include <BlockChainServer.h>
+#include <TxHashSet.h>
 #include <Infrastructure/Logger.h>
-#include <fstream>
 #include <filesystem>
 
 static const int BUFFER_SIZE = 64 * 1024;
@@ -136,10 +135,10 @@ MessageProcessor::EStatus MessageProcessor::ProcessMessageInternal(const uint64_
 				const GetHeadersMessage getHeadersMessage = GetHeadersMessage::Deserialize(byteBuffer);
 				const std::vector<CBigInteger<32>>& hashes = getHeadersMessage.GetHashes();
 
-				std::vector<BlockHeader> blockHeaders = BlockLocator(m_blockChainServer).LocateHeaders(hashes);
+				std::vector<std::shared_ptr<const BlockHeader>> blockHeaders = BlockLocator(m_blockChainServer).LocateHeaders(hashes);
 				const HeadersMessage headersMessage(std::move(blockHeaders));
 
-				LoggerAPI::LogDebug(StringUtil::Format("MessageProcessor::ProcessMessageInternal - Sending %lld headers to %s.", blockHeaders.size(), formattedIPAddress.c_str()));
+				LoggerAPI::LogDebug(StringUtil::Format("MessageProcessor::ProcessMessageInternal - Sending %lld headers to %s.", headersMessage.GetNumHeaders(), formattedIPAddress.c_str()));
 				return MessageSender().Send(connectedPeer, headersMessage) ? EStatus::SUCCESS : EStatus::SOCKET_FAILURE;
 			}
 			case Header:
@@ -257,22 +256,52 @@ MessageProcessor::EStatus MessageProcessor::SendTxHashSet(const uint64_t connect
 {
 	LoggerAPI::LogInfo(StringUtil::Format("MessageProcessor::SendTxHashSet - Sending TxHashSet snapshot to %s.", connectedPeer.GetPeer().GetIPAddress().Format().c_str()));
 
-	// TODO: Implmement
+	// Archives are only built in the background, so the current archive is always sent, along with its own block's hash and height, whichever block was requested.
+	std::string zipPath;
+	std::unique_ptr<BlockHeader> pHeader = m_blockChainServer.GetTxHashSetArchive(zipPath);
+	if (pHeader == nullptr)
+	{
+		LoggerAPI::LogInfo("MessageProcessor::SendTxHashSet - No archive available yet.");
+		return EStatus::SUCCESS;
+	}
+
+	// Opened before announcing the archive, so its size can't change, or the archive be removed by a newer build, before it's sent.
+	std::unique_ptr<FileToSend> pZipFile = FileToSend::Open(zipPath);
+	if (pZipFile == nullptr)
+	{
+		return EStatus::SUCCESS;
+	}
+
+	const TxHashSetArchiveMessage archiveMessage(Hash(pHeader->GetHash()), pHeader->GetHeight(), pZipFile->GetSize());
+	if (!MessageSender().Send(connectedPeer, archiveMessage) || !MessageSender().SendFile(connectedPeer, *pZipFile))
+	{
+		return EStatus::SOCKET_FAILURE;
+	}
+
 	return EStatus::SUCCESS;
 }
 
+// The zip is extracted and validated as it arrives, rather than being written to disk first. See ITxHashSetDownload.
 MessageProcessor::EStatus MessageProcessor::ReceiveTxHashSet(const uint64_t connectionId, ConnectedPeer& connectedPeer, const TxHashSetArchiveMessage& txHashSetArchiveMessage)
 {
+	if (!connectedPeer.TakeTxHashSetRequest())
+	{
+		LoggerAPI::LogError(StringUtil::Format("MessageProcessor::ReceiveTxHashSet - Unrequested TxHashSet received from %s.", connectedPeer.GetPeer().GetIPAddress().Format().c_str()));
+		return EStatus::BAN_PEER;
+	}
+
 	LoggerAPI::LogInfo(StringUtil::Format("MessageProcessor::ReceiveTxHashSet - Downloading TxHashSet from %s.", connectedPeer.GetPeer().GetIPAddress().Format().c_str()));
 
+	std::unique_ptr<ITxHashSetDownload> pDownload = m_blockChainServer.StartTxHashSetDownload(txHashSetArchiveMessage.GetBlockHash());
+	if (pDownload == nullptr)
+	{
+		LoggerAPI::LogError("MessageProcessor::ReceiveTxHashSet - Failed to start download.");
+		return EStatus::UNKNOWN_ERROR;
+	}
+
 	const DWORD timeout = 25 * 1000;
 	setsockopt(connectedPeer.GetConnection(), SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout, sizeof(timeout));
 
-	const std::string hashStr = HexUtil::ConvertHash(txHashSetArchiveMessage.GetBlockHash());
-	const std::string txHashSetPath = m_config.GetTxHashSetDirectory() + StringUtil::Format("txhashset_%s.zip", hashStr.c_str());
-	std::ofstream fout;
-	fout.open(txHashSetPath, std::ios::binary | std::ios::out | std::ios::trunc);
-
 	size_t bytesReceived = 0;
 	std::vector<unsigned char> buffer(BUFFER_SIZE, 0);
 	while (bytesReceived < txHashSetArchiveMessage.GetZippedSize())
@@ -283,20 +312,24 @@ MessageProcessor::EStatus MessageProcessor::ReceiveTxHashSet(const uint64_t conn
 		{
 			// Ban peer?
 			LoggerAPI::LogError("MessageProcessor::ReceiveTxHashSet - Transmission ended abruptly.");
-			fout.close();
-			FileUtil::RemoveFile(txHashSetPath);
+			return EStatus::BAN_PEER;
+		}
 
+		if (!pDownload->Write(&buffer[0], newBytesReceived))
+		{
+			LoggerAPI::LogError("MessageProcessor::ReceiveTxHashSet - Received invalid TxHashSet zip.");
 			return EStatus::BAN_PEER;
 		}
 
-		fout.write((char*)&buffer[0], newBytesReceived);
 		bytesReceived += newBytesReceived;
 	}
 
-	fout.close();
-
 	LoggerAPI::LogInfo("MessageProcessor::ReceiveTxHashSet - Downloading successful.");
-	m_blockChainServer.ProcessTransactionHashSet(txHashSetArchiveMessage.GetBlockHash(), txHashSetPath);
+	if (m_blockChainServer.FinishTxHashSetDownload(txHashSetArchiveMessage.GetBlockHash(), std::move(pDownload)) == EBlockChainStatus::INVALID)
+	{
+		LoggerAPI::LogError("MessageProcessor::ReceiveTxHashSet - Received invalid TxHashSet.");
+		return EStatus::BAN_PEER;
+	}
 
 	return EStatus::SUCCESS;
 }
\ No newline at end of file
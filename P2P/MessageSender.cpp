@@ -2,6 +2,17 @@
 
 #include <Infrastructure/Logger.h>
 #include <HexUtil.h>
+#include <algorithm>
+
+#ifdef _WIN32
+	#include <MSWSock.h>
+	#pragma comment(lib, "Mswsock.lib")
+#else
+	#include <sys/sendfile.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
 
 bool MessageSender::Send(ConnectedPeer& connectedPeer, const IMessage& message)
 {
@@ -17,4 +28,106 @@ bool MessageSender::Send(ConnectedPeer& connectedPeer, const IMessage& message)
 	// TODO: Update stats.
 
 	return nSendBytes != SOCKET_ERROR;
+}
+
+#ifdef _WIN32
+FileToSend::FileToSend(const std::string& path, HANDLE hFile, const uint64_t size)
+	: m_path(path), m_hFile(hFile), m_size(size)
+{
+
+}
+
+std::unique_ptr<FileToSend> FileToSend::Open(const std::string& path)
+{
+	// FILE_SHARE_DELETE, so a newer archive can replace this one while it's being sent.
+	HANDLE hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		LoggerAPI::LogWarning("FileToSend::Open - Failed to open " + path);
+		return std::unique_ptr<FileToSend>(nullptr);
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(hFile, &size))
+	{
+		LoggerAPI::LogWarning("FileToSend::Open - Failed to read size of " + path);
+		CloseHandle(hFile);
+		return std::unique_ptr<FileToSend>(nullptr);
+	}
+
+	return std::unique_ptr<FileToSend>(new FileToSend(path, hFile, (uint64_t)size.QuadPart));
+}
+
+FileToSend::~FileToSend()
+{
+	CloseHandle(m_hFile);
+}
+#else
+FileToSend::FileToSend(const std::string& path, const int fileDescriptor, const uint64_t size)
+	: m_path(path), m_fileDescriptor(fileDescriptor), m_size(size)
+{
+
+}
+
+std::unique_ptr<FileToSend> FileToSend::Open(const std::string& path)
+{
+	const int fileDescriptor = open(path.c_str(), O_RDONLY);
+	if (fileDescriptor < 0)
+	{
+		LoggerAPI::LogWarning("FileToSend::Open - Failed to open " + path);
+		return std::unique_ptr<FileToSend>(nullptr);
+	}
+
+	struct stat fileStat;
+	if (fstat(fileDescriptor, &fileStat) != 0)
+	{
+		LoggerAPI::LogWarning("FileToSend::Open - Failed to read size of " + path);
+		close(fileDescriptor);
+		return std::unique_ptr<FileToSend>(nullptr);
+	}
+
+	return std::unique_ptr<FileToSend>(new FileToSend(path, fileDescriptor, (uint64_t)fileStat.st_size));
+}
+
+FileToSend::~FileToSend()
+{
+	close(m_fileDescriptor);
+}
+#endif
+
+bool MessageSender::SendFile(ConnectedPeer& connectedPeer, const FileToSend& file)
+{
+	const uint64_t numBytes = file.GetSize();
+
+#ifdef _WIN32
+	// TransmitFile sends at most 2^31 - 2 bytes per call, starting from the current file pointer.
+	const uint64_t MAX_TRANSMIT_BYTES = 0x7FFFFFFE;
+
+	bool success = true;
+	uint64_t bytesSent = 0;
+	while (success && bytesSent < numBytes)
+	{
+		const DWORD bytesToSend = (DWORD)std::min<uint64_t>(numBytes - bytesSent, MAX_TRANSMIT_BYTES);
+
+		LARGE_INTEGER offset;
+		offset.QuadPart = bytesSent;
+		success = SetFilePointerEx(file.m_hFile, offset, NULL, FILE_BEGIN) && TransmitFile(connectedPeer.GetConnection(), file.m_hFile, bytesToSend, 0, NULL, NULL, 0);
+		bytesSent += bytesToSend;
+	}
+#else
+	// sendfile reads from the given offset, rather than the file's own position.
+	bool success = true;
+	off_t offset = 0;
+	while (success && (uint64_t)offset < numBytes)
+	{
+		success = sendfile(connectedPeer.GetConnection(), file.m_fileDescriptor, &offset, (size_t)(numBytes - offset)) > 0;
+	}
+#endif
+
+	if (!success)
+	{
+		LoggerAPI::LogWarning("MessageSender::SendFile - Failed to send " + file.GetPath() + " to " + connectedPeer.GetPeer().GetIPAddress().Format());
+	}
+
+	return success;
 }
\ No newline at end of file
@@ -3,8 +3,49 @@
 #include "ConnectedPeer.h"
 #include "Messages/Message.h"
 
+#include <string>
+#include <memory>
+
+//
+// A file opened to be sent with MessageSender::SendFile.
+// Its size is read from the open handle, so it always matches the bytes that will be sent, even if the file at the path is replaced or removed afterwards.
+//
+class FileToSend
+{
+public:
+	static std::unique_ptr<FileToSend> Open(const std::string& path);
+	~FileToSend();
+
+	inline const std::string& GetPath() const { return m_path; }
+	inline uint64_t GetSize() const { return m_size; }
+
+private:
+#ifdef _WIN32
+	FileToSend(const std::string& path, HANDLE hFile, const uint64_t size);
+#else
+	FileToSend(const std::string& path, const int fileDescriptor, const uint64_t size);
+#endif
+	FileToSend(const FileToSend&) = delete;
+	FileToSend& operator=(const FileToSend&) = delete;
+
+	friend class MessageSender;
+
+	const std::string m_path;
+#ifdef _WIN32
+	HANDLE m_hFile;
+#else
+	int m_fileDescriptor;
+#endif
+	const uint64_t m_size;
+};
+
 class MessageSender
 {
 public:
 	static bool Send(ConnectedPeer& connectedPeer, const IMessage& message);
+
+	//
+	// Sends the whole file straight from the OS's file cache to the socket, without copying it through user space.
+	//
+	static bool SendFile(ConnectedPeer& connectedPeer, const FileToSend& file);
 };
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Message.h"
 
 #include <Core/BlockHeader.h>
+#include <memory>
 
 class HeadersMessage : public IMessage
 {
@@ -14,6 +15,15 @@ public:
 		: m_headers(std::move(headers))
 	{
 
+	}
+
+	//
+	// Messages being sent can be built from shared handles to the stored headers, so serving headers never copies them.
+	//
+	HeadersMessage(std::vector<std::shared_ptr<const BlockHeader>>&& sharedHeaders)
+		: m_sharedHeaders(std::move(sharedHeaders))
+	{
+
 	}
 	HeadersMessage(const HeadersMessage& other) = default;
 	HeadersMessage(HeadersMessage&& other) noexcept = default;
@@ -38,6 +48,9 @@ public:
 	// Getters
 	//
 	virtual MessageTypes::EMessageType GetMessageType() const override final { return MessageTypes::Headers; }
+	inline size_t GetNumHeaders() const { return m_headers.size() + m_sharedHeaders.size(); }
+
+	// Only includes headers that were deserialized, not the shared handles.
 	inline const std::vector<BlockHeader>& GetHeaders() const { return m_headers; }
 
 	//
@@ -59,13 +72,19 @@ public:
 protected:
 	virtual void SerializeBody(Serializer& serializer) const override final
 	{
-		serializer.Append<uint16_t>((uint16_t)m_headers.size());
+		serializer.Append<uint16_t>((uint16_t)GetNumHeaders());
 		for (auto iter = m_headers.cbegin(); iter != m_headers.cend(); iter++)
 		{
 			iter->Serialize(serializer);
 		}
+
+		for (auto iter = m_sharedHeaders.cbegin(); iter != m_sharedHeaders.cend(); iter++)
+		{
+			(*iter)->Serialize(serializer);
+		}
 	}
 
 private:
 	std::vector<BlockHeader> m_headers;
+	std::vector<std::shared_ptr<const BlockHeader>> m_sharedHeaders;
 };
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include <BlockChainServer.h>
 #include <Infrastructure/Logger.h>
+#include <algorithm>
 
 BlockSyncer::BlockSyncer(ConnectionManager& connectionManager, IBlockChainServer& blockChainServer)
 	: m_connectionManager(connectionManager), m_blockChainServer(blockChainServer)
@@ -48,7 +49,7 @@ bool BlockSyncer::IsBlockSyncDue() const
 		}
 
 		// Check if blocks were received, and we're ready to request next batch.
-		if (height >= (m_lastHeight + 1))
+		if (height >= m_lastHeight)
 		{
 			LoggerAPI::LogWarning("BlockSyncer::IsBlockSyncDue() - Blocks received. Requesting next batch.");
 			return true;
@@ -63,21 +64,40 @@ bool BlockSyncer::RequestBlocks()
 	LoggerAPI::LogWarning("BlockSyncer: Requesting blocks.");
 
 	const uint64_t chainHeight = m_blockChainServer.GetHeight(EChainType::CONFIRMED);
-	std::unique_ptr<BlockHeader> pNextHeader = m_blockChainServer.GetBlockHeaderByHeight(chainHeight + 1, EChainType::CANDIDATE);
-	if (pNextHeader != nullptr)
+	const uint64_t lastHeight = std::min(chainHeight + BLOCKS_PER_REQUEST, m_connectionManager.GetHighestHeight());
+
+	uint64_t numRequested = 0;
+	for (uint64_t height = chainHeight + 1; height <= lastHeight; height++)
 	{
-		const GetBlockMessage getBlockMessage(pNextHeader->GetHash());
-		m_connectionId = m_connectionManager.SendMessageToMostWorkPeer(getBlockMessage);
+		std::shared_ptr<const BlockHeader> pHeader = m_blockChainServer.GetSharedBlockHeaderByHeight(height, EChainType::CANDIDATE);
+		if (pHeader == nullptr)
+		{
+			break;
+		}
+
+		// Blocks that arrived out of order wait in the orphan pool until their parent is confirmed, so they're not requested again.
+		// The next block's parent is already confirmed though, so if it's still an orphan it was stranded (eg. by a reorg), and is requested so it gets processed.
+		if (height > chainHeight + 1 && m_blockChainServer.HasOrphan(pHeader->GetHash()))
+		{
+			continue;
+		}
 
-		if (m_connectionId != 0)
+		const GetBlockMessage getBlockMessage(pHeader->GetHash());
+		m_connectionId = m_connectionManager.SendMessageToMostWorkPeer(getBlockMessage);
+		if (m_connectionId == 0)
 		{
-			LoggerAPI::LogWarning("BlockSyncer: Blocks requested.");
-			m_timeout = std::chrono::system_clock::now() + std::chrono::seconds(5);
-			m_lastHeight = chainHeight;
+			break;
 		}
 
-		return m_connectionId != 0;
+		numRequested++;
+		m_lastHeight = height;
 	}
 
-	return false;
+	if (numRequested > 0)
+	{
+		LoggerAPI::LogWarning("BlockSyncer: " + std::to_string(numRequested) + " blocks requested.");
+		m_timeout = std::chrono::system_clock::now() + std::chrono::seconds(5 + numRequested);
+	}
+
+	return numRequested > 0;
 }
\ No newline at end of file
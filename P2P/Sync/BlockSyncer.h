@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <stdint.h>
 
 // Forward Declarations
 class ConnectionManager;
@@ -17,6 +18,9 @@ private:
 	bool IsBlockSyncDue() const;
 	bool RequestBlocks();
 
+	// Blocks are requested in batches, and any that arrive out of order are kept as orphans until their parent is confirmed.
+	static const uint64_t BLOCKS_PER_REQUEST = 16;
+
 	ConnectionManager & m_connectionManager;
 	IBlockChainServer& m_blockChainServer;
 
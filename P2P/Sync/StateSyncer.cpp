@@ -10,7 +10,8 @@ StateSyncer::StateSyncer(ConnectionManager& connectionManager, IBlockChainServer
 	: m_connectionManager(connectionManager), m_blockChainServer(blockChainServer)
 {
 	m_timeout = std::chrono::system_clock::now();
-	m_requestedHeight = 0;
+	m_requested = false;
+	m_confirmedHeight = 0;
 }
 
 bool StateSyncer::SyncState()
@@ -23,7 +24,7 @@ bool StateSyncer::SyncState()
 	}
 
 	// If state sync is still in progress, return true to delay block sync.
-	if (m_blockChainServer.GetHeight(EChainType::CONFIRMED) < m_requestedHeight)
+	if (m_requested && m_blockChainServer.GetHeight(EChainType::CONFIRMED) <= m_confirmedHeight && m_timeout > std::chrono::system_clock::now())
 	{
 		return true;
 	}
@@ -49,10 +50,10 @@ bool StateSyncer::IsStateSyncDue() const
 		return false;
 	}
 
-	if (m_requestedHeight > 0)
+	if (m_requested)
 	{
 		// If state sync has already occurred, just rely on block sync.
-		if (blockHeight >= m_requestedHeight)
+		if (blockHeight > m_confirmedHeight)
 		{
 			return false;
 		}
@@ -71,7 +72,7 @@ bool StateSyncer::RequestState()
 {
 	const uint64_t headerHeight = m_blockChainServer.GetHeight(EChainType::CANDIDATE);
 	const uint64_t requestedHeight = headerHeight - Consensus::STATE_SYNC_THRESHOLD;
-	Hash hash = m_blockChainServer.GetBlockHeaderByHeight(requestedHeight, EChainType::CANDIDATE)->GetHash();
+	Hash hash = m_blockChainServer.GetSharedBlockHeaderByHeight(requestedHeight, EChainType::CANDIDATE)->GetHash();
 
 	const TxHashSetRequestMessage txHashSetRequestMessage(std::move(hash), requestedHeight);
 	const bool requested = m_connectionManager.SendMessageToMostWorkPeer(txHashSetRequestMessage);
@@ -79,7 +80,8 @@ bool StateSyncer::RequestState()
 	if (requested)
 	{
 		m_timeout = std::chrono::system_clock::now() + std::chrono::minutes(10);
-		m_requestedHeight = requestedHeight;
+		m_requested = true;
+		m_confirmedHeight = m_blockChainServer.GetHeight(EChainType::CONFIRMED);
 	}
 
 	return requested;
@@ -18,7 +18,10 @@ private:
 	bool RequestState();
 
 	std::chrono::time_point<std::chrono::system_clock> m_timeout;
-	uint64_t m_requestedHeight;
+	bool m_requested;
+
+	// Peers send their latest archive rather than the requested block's, so state sync is done once the confirmed chain moves past this.
+	uint64_t m_confirmedHeight;
 
 	ConnectionManager & m_connectionManager;
 	IBlockChainServer& m_blockChainServer;
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Serialization/ByteBuffer.h>
+#include <Serialization/Serializer.h>
+#include <stdint.h>
+#include <vector>
+
+//
+// The information needed to undo a block that was applied to the TxHashSet.
+// Hashes and data are rewound by truncating to the output MMR size from before the block,
+// so only the leaf positions that the block spent need to be recorded.
+//
+class BlockUndo
+{
+public:
+	BlockUndo(const uint64_t height, const uint64_t outputMMRSize, std::vector<uint64_t>&& spentPositions)
+		: m_height(height), m_outputMMRSize(outputMMRSize), m_spentPositions(std::move(spentPositions))
+	{
+
+	}
+
+	inline uint64_t GetHeight() const { return m_height; }
+	inline uint64_t GetOutputMMRSize() const { return m_outputMMRSize; }
+	inline const std::vector<uint64_t>& GetSpentPositions() const { return m_spentPositions; }
+
+	void Serialize(Serializer& serializer) const
+	{
+		serializer.Append<uint64_t>(m_height);
+		serializer.Append<uint64_t>(m_outputMMRSize);
+		serializer.Append<uint64_t>(m_spentPositions.size());
+		for (const uint64_t position : m_spentPositions)
+		{
+			serializer.Append<uint64_t>(position);
+		}
+	}
+
+	static BlockUndo Deserialize(ByteBuffer& byteBuffer)
+	{
+		const uint64_t height = byteBuffer.ReadU64();
+		const uint64_t outputMMRSize = byteBuffer.ReadU64();
+
+		const uint64_t numSpent = byteBuffer.ReadU64();
+		std::vector<uint64_t> spentPositions;
+		spentPositions.reserve(numSpent);
+		for (uint64_t i = 0; i < numSpent; i++)
+		{
+			spentPositions.push_back(byteBuffer.ReadU64());
+		}
+
+		return BlockUndo(height, outputMMRSize, std::move(spentPositions));
+	}
+
+private:
+	// Height of the block that was applied.
+	uint64_t m_height;
+
+	// Size of the output MMR before the block was applied.
+	uint64_t m_outputMMRSize;
+
+	// Output (and rangeproof) leaf positions spent by the block.
+	std::vector<uint64_t> m_spentPositions;
+};
\ No newline at end of file
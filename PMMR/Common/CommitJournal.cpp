@@ -0,0 +1,133 @@
+#include "CommitJournal.h"
+
+#include <Serialization/Serializer.h>
+#include <Serialization/ByteBuffer.h>
+#include <Infrastructure/Logger.h>
+#include <FileUtil.h>
+
+CommitJournal::CommitJournal(const std::string& path)
+	: m_path(path)
+{
+
+}
+
+void CommitJournal::AddFile(const File& file)
+{
+	if (file.IsDirty())
+	{
+		m_entries.emplace_back(Entry({ EEntryType::APPEND, file.GetPath(), file.GetFlushPosition(), file.GetPendingData(), "" }));
+	}
+}
+
+void CommitJournal::AddReplacement(const std::string& path, const std::vector<unsigned char>& contents)
+{
+	m_entries.emplace_back(Entry({ EEntryType::REPLACE, path, 0, contents, "" }));
+}
+
+void CommitJournal::AddRename(const std::string& sourcePath, const std::string& path)
+{
+	m_entries.emplace_back(Entry({ EEntryType::RENAME, path, 0, std::vector<unsigned char>(), sourcePath }));
+}
+
+bool CommitJournal::Write() const
+{
+	Serializer serializer;
+	serializer.Append<uint64_t>(m_entries.size());
+	for (const Entry& entry : m_entries)
+	{
+		serializer.Append<uint8_t>((uint8_t)entry.type);
+		serializer.AppendVarStr(entry.path);
+		serializer.Append<uint64_t>(entry.position);
+		serializer.Append<uint64_t>(entry.data.size());
+		serializer.AppendByteVector(entry.data);
+
+		if (entry.type == EEntryType::RENAME)
+		{
+			serializer.AppendVarStr(entry.sourcePath);
+		}
+	}
+
+	return FileUtil::SafeWriteToFile(m_path, serializer.GetBytes());
+}
+
+bool CommitJournal::Remove() const
+{
+	FileUtil::RemoveFile(m_path);
+	return true;
+}
+
+bool CommitJournal::Recover(const std::string& path)
+{
+	std::vector<unsigned char> data;
+	if (!FileUtil::ReadFile(path, data))
+	{
+		return true;
+	}
+
+	LoggerAPI::LogWarning("CommitJournal::Recover - Incomplete commit found. Replaying " + path);
+
+	std::vector<Entry> entries;
+	try
+	{
+		ByteBuffer byteBuffer(data);
+		const uint64_t numEntries = byteBuffer.ReadU64();
+		for (uint64_t i = 0; i < numEntries; i++)
+		{
+			const EEntryType type = (EEntryType)byteBuffer.ReadU8();
+			std::string entryPath = byteBuffer.ReadVarStr();
+			const uint64_t position = byteBuffer.ReadU64();
+			const uint64_t numBytes = byteBuffer.ReadU64();
+			std::vector<unsigned char> entryData = byteBuffer.ReadVector(numBytes);
+			std::string sourcePath = (type == EEntryType::RENAME) ? byteBuffer.ReadVarStr() : "";
+			entries.emplace_back(Entry({ type, std::move(entryPath), position, std::move(entryData), std::move(sourcePath) }));
+		}
+	}
+	catch (DeserializationException&)
+	{
+		LoggerAPI::LogError("CommitJournal::Recover - Failed to deserialize " + path);
+		return false;
+	}
+
+	for (const Entry& entry : entries)
+	{
+		if (!Replay(entry))
+		{
+			LoggerAPI::LogError("CommitJournal::Recover - Failed to replay changes to " + entry.path);
+			return false;
+		}
+	}
+
+	FileUtil::RemoveFile(path);
+	return true;
+}
+
+bool CommitJournal::Replay(const Entry& entry)
+{
+	if (entry.type == EEntryType::REPLACE)
+	{
+		return FileUtil::SafeWriteToFile(entry.path, entry.data);
+	}
+
+	if (entry.type == EEntryType::RENAME)
+	{
+		// If the source no longer exists, the rename already happened.
+		if (std::filesystem::exists(entry.sourcePath))
+		{
+			return FileUtil::RenameFile(entry.sourcePath, entry.path);
+		}
+
+		return true;
+	}
+
+	File file(entry.path);
+	file.Load();
+
+	// The file on disk may already contain some or all of the appended data, so rewind to the journaled position first.
+	if (!file.Rewind(entry.position))
+	{
+		return false;
+	}
+
+	file.Append(entry.data);
+	return file.Flush();
+}
\ No newline at end of file
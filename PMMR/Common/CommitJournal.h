@@ -0,0 +1,67 @@
+#pragma once
+
+#include <Core/File.h>
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+//
+// A small write-ahead journal used to commit changes to several files as a single atomic unit.
+// Every pending change is written to the journal (atomically, via rename) before any of the files are touched.
+// If the node dies mid-commit, Recover() replays the journal the next time the files are opened.
+// Replaying is idempotent, so a crash during recovery is also safe.
+//
+class CommitJournal
+{
+public:
+	CommitJournal(const std::string& path);
+
+	//
+	// Records the uncommitted truncation and appends of the given file.
+	//
+	void AddFile(const File& file);
+
+	//
+	// Records the complete new contents of a small file (ie. a LeafSet or PruneList bitmap).
+	//
+	void AddReplacement(const std::string& path, const std::vector<unsigned char>& contents);
+
+	//
+	// Records that the file at sourcePath (ie. a compacted hash or data file) replaces the file at path.
+	//
+	void AddRename(const std::string& sourcePath, const std::string& path);
+
+	bool Write() const;
+	bool Remove() const;
+
+	//
+	// Replays and then removes the journal at the given path, if one exists.
+	// Returns false only when a journal exists but could not be replayed.
+	//
+	static bool Recover(const std::string& path);
+
+private:
+	enum class EEntryType : uint8_t
+	{
+		APPEND = 0,
+		REPLACE = 1,
+		RENAME = 2
+	};
+
+	struct Entry
+	{
+		EEntryType type;
+		std::string path;
+		uint64_t position;
+		std::vector<unsigned char> data;
+
+		// Only used by RENAME entries.
+		std::string sourcePath;
+	};
+
+	static bool Replay(const Entry& entry);
+
+	const std::string m_path;
+	std::vector<Entry> m_entries;
+};
\ No newline at end of file
@@ -32,6 +32,11 @@ public:
 		return m_file.Discard();
 	}
 
+	inline bool ReplaceWith(const std::string& path)
+	{
+		return m_file.ReplaceWith(path);
+	}
+
 	inline uint64_t GetSize() const
 	{
 		return m_file.GetSize() / NUM_BYTES;
@@ -47,6 +52,11 @@ public:
 		m_file.Append(data);
 	}
 
+	inline const File& GetFile() const
+	{
+		return m_file;
+	}
+
 private:
 	File m_file;
 };
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include "FileCompactor.h"
+
+#include <Infrastructure/Logger.h>
+#include <fstream>
+#include <algorithm>
+
+// Number of records read from the original file at a time.
+static const uint64_t RECORDS_PER_CHUNK = 4096;
+
+FileCompactor::FileCompactor(const std::string& path, const uint64_t recordSize, const uint64_t numRecords, std::vector<uint64_t>&& recordsToRemove)
+	: m_path(path), m_recordSize(recordSize), m_numRecords(numRecords), m_recordsToRemove(std::move(recordsToRemove))
+{
+
+}
+
+bool FileCompactor::Rewrite() const
+{
+	// The original is read with a plain stream rather than mapped, so the live File can still be flushed (and truncated) meanwhile.
+	std::ifstream inFile(m_path, std::ios::in | std::ios::binary);
+	std::ofstream outFile(GetCompactedPath(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!inFile.is_open() || !outFile.is_open())
+	{
+		LoggerAPI::LogError("FileCompactor::Rewrite - Failed to open " + m_path);
+		return false;
+	}
+
+	std::vector<unsigned char> chunk(RECORDS_PER_CHUNK * m_recordSize);
+	auto nextRemoved = m_recordsToRemove.cbegin();
+	for (uint64_t firstRecord = 0; firstRecord < m_numRecords; firstRecord += RECORDS_PER_CHUNK)
+	{
+		const uint64_t numRecords = (std::min)(RECORDS_PER_CHUNK, m_numRecords - firstRecord);
+		if (!inFile.read((char*)chunk.data(), numRecords * m_recordSize))
+		{
+			LoggerAPI::LogError("FileCompactor::Rewrite - Failed to read " + m_path);
+			return false;
+		}
+
+		// Write each run of kept records with a single call.
+		uint64_t runStart = 0;
+		for (uint64_t i = 0; i < numRecords; i++)
+		{
+			if (nextRemoved != m_recordsToRemove.cend() && *nextRemoved == firstRecord + i)
+			{
+				outFile.write((const char*)chunk.data() + (runStart * m_recordSize), (i - runStart) * m_recordSize);
+				runStart = i + 1;
+				++nextRemoved;
+			}
+		}
+
+		outFile.write((const char*)chunk.data() + (runStart * m_recordSize), (numRecords - runStart) * m_recordSize);
+	}
+
+	outFile.close();
+	return !outFile.fail();
+}
+
+bool FileCompactor::AppendRemaining(const File& file) const
+{
+	const uint64_t firstByte = m_numRecords * m_recordSize;
+	if (file.GetSize() < firstByte)
+	{
+		LoggerAPI::LogError("FileCompactor::AppendRemaining - " + m_path + " was rewound past the compacted records.");
+		return false;
+	}
+
+	std::vector<unsigned char> remaining;
+	if (!file.Read(firstByte, file.GetSize() - firstByte, remaining))
+	{
+		return false;
+	}
+
+	std::ofstream outFile(GetCompactedPath(), std::ios::out | std::ios::binary | std::ios::app);
+	if (!outFile.is_open())
+	{
+		return false;
+	}
+
+	if (!remaining.empty())
+	{
+		outFile.write((const char*)remaining.data(), remaining.size());
+	}
+
+	outFile.close();
+	return !outFile.fail();
+}
\ No newline at end of file
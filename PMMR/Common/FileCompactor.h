@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Core/File.h>
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+//
+// Rewrites a file of fixed-size records (ie. a hash or data file) without the given records.
+// The compacted copy is written next to the original, which is never modified, so readers and writers of the original are unaffected.
+// Only the first numRecords records are rewritten. Anything after them is copied from the live file by AppendRemaining.
+//
+class FileCompactor
+{
+public:
+	FileCompactor(const std::string& path, const uint64_t recordSize, const uint64_t numRecords, std::vector<uint64_t>&& recordsToRemove);
+
+	//
+	// Writes the first numRecords records, minus the removed ones, to GetCompactedPath().
+	// This does all of the heavy I/O, so it should never be called while holding the chain lock.
+	//
+	bool Rewrite() const;
+
+	//
+	// Appends every record after the first numRecords from the given (flushed) file to the compacted file.
+	//
+	bool AppendRemaining(const File& file) const;
+
+	inline const std::string& GetPath() const { return m_path; }
+	inline std::string GetCompactedPath() const { return m_path + ".compact"; }
+	inline uint64_t GetNumRecords() const { return m_numRecords; }
+
+private:
+	const std::string m_path;
+	const uint64_t m_recordSize;
+	const uint64_t m_numRecords;
+
+	// Sorted indices of the records to skip.
+	const std::vector<uint64_t> m_recordsToRemove;
+};
\ No newline at end of file
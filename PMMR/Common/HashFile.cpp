@@ -24,6 +24,11 @@ bool HashFile::Discard()
 	return m_file.Discard();
 }
 
+bool HashFile::ReplaceWith(const std::string& path)
+{
+	return m_file.ReplaceWith(path);
+}
+
 bool HashFile::Flush()
 {
 	return m_file.Flush();
@@ -45,6 +50,24 @@ Hash HashFile::GetHashAt(const uint64_t mmrIndex) const
 	return ZERO_HASH;
 }
 
+// Reads the hashes with a single sequential read of the file.
+std::vector<Hash> HashFile::GetHashes(const uint64_t firstIndex, const uint64_t numHashes) const
+{
+	std::vector<Hash> hashes;
+
+	std::vector<unsigned char> data;
+	if (m_file.Read(firstIndex * HASH_SIZE, numHashes * HASH_SIZE, data))
+	{
+		hashes.reserve(numHashes);
+		for (uint64_t i = 0; i < numHashes; i++)
+		{
+			hashes.emplace_back(Hash(&data[i * HASH_SIZE]));
+		}
+	}
+
+	return hashes;
+}
+
 void HashFile::AddHash(const Hash& hash)
 {
 	m_file.Append(hash.GetData());
@@ -72,7 +95,7 @@ Hash HashFile::Root(const uint64_t size) const
 	}
 
 	Hash hash = ZERO_HASH;
-	const std::vector<uint64_t> peakIndices = MMRUtil::GetPeakIndices(size);
+	const MMRPeaks peakIndices = MMRUtil::GetPeaks(size);
 	for (auto iter = peakIndices.crbegin(); iter != peakIndices.crend(); iter++)
 	{
 		if (hash == ZERO_HASH)
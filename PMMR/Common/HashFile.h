@@ -13,15 +13,19 @@ public:
 	bool Flush();
 	bool Rewind(const uint64_t size);
 	bool Discard();
+	bool ReplaceWith(const std::string& path);
 
 	uint64_t GetSize() const;
 	Hash GetHashAt(const uint64_t mmrIndex) const;
+	std::vector<Hash> GetHashes(const uint64_t firstIndex, const uint64_t numHashes) const;
 	
 	void AddHash(const Hash& hash);
 	void AddHashes(const std::vector<Hash>& hashes);
 
 	Hash Root(const uint64_t size) const;
 
+	inline const File& GetFile() const { return m_file; }
+
 private:
 	// TODO: Store peaks in memory
 	File m_file;
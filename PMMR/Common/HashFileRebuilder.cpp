@@ -0,0 +1,281 @@
+#include "HashFileRebuilder.h"
+#include "MMRUtil.h"
+
+#include <Serialization/DeserializationException.h>
+#include <Infrastructure/Logger.h>
+#include <async++.h>
+#include <algorithm>
+#include <fstream>
+#include <thread>
+
+// Subtrees of this height (4096 leaves) are hashed as independent tasks.
+static const uint64_t SUBTREE_HEIGHT = 12;
+
+HashFileRebuilder::HashFileRebuilder(const File& dataFile, const uint64_t recordSize, const PruneList* pPruneList, const HashFile& existingHashFile, const LeafHasher& leafHasher)
+	: m_dataFile(dataFile), m_recordSize(recordSize), m_pPruneList(pPruneList), m_existingHashFile(existingHashFile), m_leafHasher(leafHasher)
+{
+
+}
+
+std::unique_ptr<Hash> HashFileRebuilder::Rebuild(const uint64_t mmrSize, const std::string& outputPath) const
+{
+	const MMRPeaks peakIndices = MMRUtil::GetPeaks(mmrSize);
+	if (peakIndices.empty())
+	{
+		LoggerAPI::LogError("HashFileRebuilder::Rebuild - Invalid MMR size " + std::to_string(mmrSize));
+		return std::unique_ptr<Hash>(nullptr);
+	}
+
+	// Walk down from each peak until reaching subtrees small enough to be hashed as one task.
+	std::vector<Subtree> subtrees;
+	std::vector<Subtree> upperNodes;
+
+	std::vector<Subtree> nodesToSplit;
+	for (const uint64_t peakIndex : peakIndices)
+	{
+		nodesToSplit.emplace_back(Subtree({ peakIndex, MMRUtil::GetHeight(peakIndex) }));
+	}
+
+	while (!nodesToSplit.empty())
+	{
+		const Subtree node = nodesToSplit.back();
+		nodesToSplit.pop_back();
+
+		if (node.height <= SUBTREE_HEIGHT)
+		{
+			subtrees.push_back(node);
+		}
+		else
+		{
+			upperNodes.push_back(node);
+			nodesToSplit.emplace_back(Subtree({ MMRUtil::GetLeftChildIndex(node.rootIndex, node.height), node.height - 1 }));
+			nodesToSplit.emplace_back(Subtree({ MMRUtil::GetRightChildIndex(node.rootIndex), node.height - 1 }));
+		}
+	}
+
+	// Every node of a subtree comes before its root, so ordering by root index puts the subtrees and upper nodes in postorder.
+	auto compareRoots = [](const Subtree& a, const Subtree& b) { return a.rootIndex < b.rootIndex; };
+	std::sort(subtrees.begin(), subtrees.end(), compareRoots);
+	std::sort(upperNodes.begin(), upperNodes.end(), compareRoots);
+
+	std::ofstream outputFile(outputPath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!outputFile.is_open())
+	{
+		LoggerAPI::LogError("HashFileRebuilder::Rebuild - Failed to open " + outputPath);
+		return std::unique_ptr<Hash>(nullptr);
+	}
+
+	auto writeHashes = [&outputFile](const std::vector<Hash>& hashes)
+	{
+		for (const Hash& hash : hashes)
+		{
+			outputFile.write((const char*)&hash.GetData()[0], HASH_SIZE);
+		}
+	};
+
+	// Subtrees are hashed in batches, so only a batch of hashes is held in memory before being written.
+	const size_t batchSize = 4 * (std::max)(std::thread::hardware_concurrency(), 1u);
+
+	std::vector<std::optional<Hash>> stack;
+	size_t nextUpperNode = 0;
+	for (size_t batchStart = 0; batchStart < subtrees.size(); batchStart += batchSize)
+	{
+		const size_t batchEnd = (std::min)(batchStart + batchSize, subtrees.size());
+
+		std::vector<SubtreeHashes> results(batchEnd - batchStart);
+		async::parallel_for(async::irange(batchStart, batchEnd), [this, &subtrees, &results, batchStart](const size_t i)
+		{
+			results[i - batchStart] = this->HashSubtree(subtrees[i]);
+		});
+
+		for (size_t i = batchStart; i < batchEnd; i++)
+		{
+			// Upper nodes that come before this subtree have all of their children on the stack.
+			while (nextUpperNode < upperNodes.size() && upperNodes[nextUpperNode].rootIndex < subtrees[i].rootIndex)
+			{
+				std::vector<Hash> storedHashes;
+				if (!HashParent(upperNodes[nextUpperNode++].rootIndex, stack, storedHashes))
+				{
+					return std::unique_ptr<Hash>(nullptr);
+				}
+
+				writeHashes(storedHashes);
+			}
+
+			SubtreeHashes& result = results[i - batchStart];
+			if (!result.success)
+			{
+				return std::unique_ptr<Hash>(nullptr);
+			}
+
+			writeHashes(result.storedHashes);
+			stack.push_back(result.rootHash);
+		}
+	}
+
+	while (nextUpperNode < upperNodes.size())
+	{
+		std::vector<Hash> storedHashes;
+		if (!HashParent(upperNodes[nextUpperNode++].rootIndex, stack, storedHashes))
+		{
+			return std::unique_ptr<Hash>(nullptr);
+		}
+
+		writeHashes(storedHashes);
+	}
+
+	outputFile.close();
+	if (outputFile.fail())
+	{
+		LoggerAPI::LogError("HashFileRebuilder::Rebuild - Failed to write " + outputPath);
+		return std::unique_ptr<Hash>(nullptr);
+	}
+
+	// The stack now holds the peaks, from left to right. Bag them just like MMR::Root.
+	Hash root = ZERO_HASH;
+	for (auto iter = stack.crbegin(); iter != stack.crend(); iter++)
+	{
+		if (!iter->has_value())
+		{
+			return std::unique_ptr<Hash>(nullptr);
+		}
+
+		root = (iter == stack.crbegin()) ? iter->value() : MMRUtil::HashParentWithIndex(iter->value(), root, mmrSize);
+	}
+
+	return std::make_unique<Hash>(std::move(root));
+}
+
+HashFileRebuilder::SubtreeHashes HashFileRebuilder::HashSubtree(const Subtree& subtree) const
+{
+	SubtreeHashes result({ false, std::nullopt, std::vector<Hash>() });
+
+	const uint64_t numNodes = ((uint64_t)2 << subtree.height) - 1;
+	const uint64_t firstIndex = subtree.rootIndex + 1 - numNodes;
+
+	// The leaves that still have data are contiguous in the data file, so they're all read at once.
+	const uint64_t firstLeafIndex = MMRUtil::GetNumLeaves(firstIndex) - 1;
+	const uint64_t numLeaves = (uint64_t)1 << subtree.height;
+	uint64_t firstDataPosition = 0;
+	uint64_t numRecords = 0;
+	for (uint64_t leafIndex = firstLeafIndex; leafIndex < firstLeafIndex + numLeaves; leafIndex++)
+	{
+		const uint64_t mmrIndex = MMRUtil::GetPMMRIndex(leafIndex);
+		if (!IsPruned(mmrIndex) || IsPrunedRoot(mmrIndex))
+		{
+			firstDataPosition = (numRecords == 0) ? (leafIndex - GetLeafShift(mmrIndex)) : firstDataPosition;
+			numRecords++;
+		}
+	}
+
+	std::vector<unsigned char> data;
+	if (numRecords > 0 && !m_dataFile.Read(firstDataPosition * m_recordSize, numRecords * m_recordSize, data))
+	{
+		LoggerAPI::LogError("HashFileRebuilder::HashSubtree - Failed to read leaf data for subtree at index " + std::to_string(subtree.rootIndex));
+		return result;
+	}
+
+	std::vector<std::optional<Hash>> stack;
+	stack.reserve(subtree.height + 2);
+	result.storedHashes.reserve(numNodes);
+
+	uint64_t recordIndex = 0;
+	for (uint64_t mmrIndex = firstIndex; mmrIndex <= subtree.rootIndex; mmrIndex++)
+	{
+		if (!MMRUtil::IsLeaf(mmrIndex))
+		{
+			if (!HashParent(mmrIndex, stack, result.storedHashes))
+			{
+				return result;
+			}
+		}
+		else if (IsPruned(mmrIndex) && !IsPrunedRoot(mmrIndex))
+		{
+			stack.push_back(std::nullopt);
+		}
+		else
+		{
+			const auto recordStart = data.cbegin() + (recordIndex++ * m_recordSize);
+			const std::vector<unsigned char> record(recordStart, recordStart + m_recordSize);
+
+			try
+			{
+				stack.push_back(std::make_optional(m_leafHasher(mmrIndex, record)));
+				result.storedHashes.push_back(stack.back().value());
+			}
+			catch (DeserializationException&)
+			{
+				LoggerAPI::LogError("HashFileRebuilder::HashSubtree - Failed to deserialize leaf at index " + std::to_string(mmrIndex));
+				return result;
+			}
+		}
+	}
+
+	result.success = true;
+	result.rootHash = stack.back();
+	return result;
+}
+
+bool HashFileRebuilder::HashParent(const uint64_t mmrIndex, std::vector<std::optional<Hash>>& stack, std::vector<Hash>& storedHashes) const
+{
+	if (stack.size() < 2)
+	{
+		return false;
+	}
+
+	const std::optional<Hash> rightHash = std::move(stack.back());
+	stack.pop_back();
+	const std::optional<Hash> leftHash = std::move(stack.back());
+	stack.pop_back();
+
+	if (IsPrunedRoot(mmrIndex))
+	{
+		// The leaves under a pruned root are gone, so its hash can only come from the existing file.
+		const uint64_t shiftedIndex = mmrIndex - GetShift(mmrIndex);
+		if (shiftedIndex >= m_existingHashFile.GetSize())
+		{
+			LoggerAPI::LogError("HashFileRebuilder::HashParent - Hash of pruned root " + std::to_string(mmrIndex) + " is not available.");
+			return false;
+		}
+
+		stack.push_back(std::make_optional(m_existingHashFile.GetHashAt(shiftedIndex)));
+		storedHashes.push_back(stack.back().value());
+	}
+	else if (IsPruned(mmrIndex))
+	{
+		stack.push_back(std::nullopt);
+	}
+	else
+	{
+		if (!leftHash.has_value() || !rightHash.has_value())
+		{
+			LoggerAPI::LogError("HashFileRebuilder::HashParent - Missing child hash for node " + std::to_string(mmrIndex));
+			return false;
+		}
+
+		stack.push_back(std::make_optional(MMRUtil::HashParentWithIndex(leftHash.value(), rightHash.value(), mmrIndex)));
+		storedHashes.push_back(stack.back().value());
+	}
+
+	return true;
+}
+
+bool HashFileRebuilder::IsPruned(const uint64_t mmrIndex) const
+{
+	return m_pPruneList != nullptr && m_pPruneList->IsPruned(mmrIndex);
+}
+
+bool HashFileRebuilder::IsPrunedRoot(const uint64_t mmrIndex) const
+{
+	return m_pPruneList != nullptr && m_pPruneList->IsPrunedRoot(mmrIndex);
+}
+
+uint64_t HashFileRebuilder::GetShift(const uint64_t mmrIndex) const
+{
+	return (m_pPruneList == nullptr) ? 0 : m_pPruneList->GetShift(mmrIndex);
+}
+
+uint64_t HashFileRebuilder::GetLeafShift(const uint64_t mmrIndex) const
+{
+	return (m_pPruneList == nullptr) ? 0 : m_pPruneList->GetLeafShift(mmrIndex);
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "HashFile.h"
+#include "PruneList.h"
+
+#include <Core/File.h>
+#include <Hash.h>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+//
+// Regenerates an MMR's hash file from its data file, for when the hash file is lost or corrupted.
+// The MMR is split into perfect subtrees, which are hashed in parallel, each with a single sequential read of the data file.
+// Pruned nodes are skipped, so the new file has the same layout as the original. Since the leaves under a pruned root
+// are no longer in the data file, the hashes of pruned roots (other than leaves) are copied from the existing hash file.
+//
+class HashFileRebuilder
+{
+public:
+	// Calculates the hash of the leaf at the given mmr index from its record in the data file.
+	typedef std::function<Hash(const uint64_t mmrIndex, const std::vector<unsigned char>& record)> LeafHasher;
+
+	//
+	// pPruneList may be null for MMRs that are never pruned (ie. the kernel MMR).
+	//
+	HashFileRebuilder(const File& dataFile, const uint64_t recordSize, const PruneList* pPruneList, const HashFile& existingHashFile, const LeafHasher& leafHasher);
+
+	//
+	// Writes the hashes of an MMR with the given size to outputPath.
+	// Returns the root, so it can be checked before replacing the existing hash file, or nullptr if the hashes could not be calculated.
+	//
+	std::unique_ptr<Hash> Rebuild(const uint64_t mmrSize, const std::string& outputPath) const;
+
+private:
+	struct Subtree
+	{
+		uint64_t rootIndex;
+		uint64_t height;
+	};
+
+	struct SubtreeHashes
+	{
+		bool success;
+		std::optional<Hash> rootHash;
+
+		// The hashes that are stored in the hash file, in order.
+		std::vector<Hash> storedHashes;
+	};
+
+	SubtreeHashes HashSubtree(const Subtree& subtree) const;
+
+	//
+	// Pops the children of the parent from the stack, and pushes the parent's hash, or nullopt if it's not stored.
+	// Returns false if a hash that's needed is missing.
+	//
+	bool HashParent(const uint64_t mmrIndex, std::vector<std::optional<Hash>>& stack, std::vector<Hash>& storedHashes) const;
+
+	bool IsPruned(const uint64_t mmrIndex) const;
+	bool IsPrunedRoot(const uint64_t mmrIndex) const;
+	uint64_t GetShift(const uint64_t mmrIndex) const;
+	uint64_t GetLeafShift(const uint64_t mmrIndex) const;
+
+	const File& m_dataFile;
+	const uint64_t m_recordSize;
+	const PruneList* m_pPruneList;
+	const HashFile& m_existingHashFile;
+	const LeafHasher m_leafHasher;
+};
\ No newline at end of file
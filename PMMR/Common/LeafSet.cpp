@@ -3,7 +3,6 @@
 
 #include <fstream>
 #include <FileUtil.h>
-#include <HexUtil.h>
 
 LeafSet::LeafSet(const std::string& path)
 	: m_path(path)
@@ -11,28 +10,77 @@ LeafSet::LeafSet(const std::string& path)
 
 }
 
-void LeafSet::Add(const uint32_t position)
+void LeafSet::Add(const uint64_t position)
 {
-	m_bitmap.add(position + 1);
+	m_leafPositions.add(position + 1);
+
+	if (m_bitmap.addChecked(position + 1))
+	{
+		if (!m_removed.removeChecked(position + 1))
+		{
+			m_added.add(position + 1);
+		}
+	}
 }
 
-void LeafSet::Remove(const uint32_t position)
+void LeafSet::Remove(const uint64_t position)
 {
-	m_bitmap.remove(position + 1);
+	if (m_bitmap.removeChecked(position + 1))
+	{
+		if (!m_added.removeChecked(position + 1))
+		{
+			m_removed.add(position + 1);
+		}
+	}
 }
 
-bool LeafSet::Contains(const uint32_t position) const
+bool LeafSet::Contains(const uint64_t position) const
 {
 	return m_bitmap.contains(position + 1);
 }
 
-bool LeafSet::Load()
+void LeafSet::Rewind(const uint64_t size, const std::vector<uint64_t>& leavesToAdd)
+{
+	for (const uint64_t position : leavesToAdd)
+	{
+		Add(position);
+	}
+
+	// Positions are stored as (mmrIndex + 1), so remove everything from (size + 1) up.
+	if (!m_bitmap.isEmpty() && m_bitmap.maximum() > size)
+	{
+		Roaring64Map positionsToRemove;
+		RoaringUtil::AddRange(positionsToRemove, size + 1, m_bitmap.maximum() + 1);
+		positionsToRemove &= m_bitmap;
+
+		for (auto iter = positionsToRemove.begin(); iter != positionsToRemove.end(); ++iter)
+		{
+			Remove(*iter - 1);
+		}
+	}
+}
+
+bool LeafSet::Load(const uint64_t size)
 {
+	// Generated directly from the leaf indices, rather than checking the height of every node.
+	const uint64_t numLeaves = (size == 0) ? 0 : MMRUtil::GetNumLeaves(size - 1);
+
+	std::vector<uint64_t> leafPositions;
+	leafPositions.reserve(numLeaves);
+	for (uint64_t leafIndex = 0; leafIndex < numLeaves; leafIndex++)
+	{
+		leafPositions.push_back(MMRUtil::GetPMMRIndex(leafIndex) + 1);
+	}
+
+	m_leafPositions = Roaring64Map();
+	m_leafPositions.addMany(leafPositions.size(), leafPositions.data());
+
 	std::vector<unsigned char> data;
 	if (FileUtil::ReadFile(m_path, data))
 	{
-		m_bitmap = Roaring::readSafe((const char*)&data[0], data.size());
-		m_bitmapBackup = m_bitmap;
+		m_bitmap = RoaringUtil::Deserialize(data);
+		m_added = Roaring64Map();
+		m_removed = Roaring64Map();
 
 		return true;
 	}
@@ -42,80 +90,72 @@ bool LeafSet::Load()
 
 bool LeafSet::Flush()
 {
-	if (Flush(m_path, m_bitmap))
+	if (FileUtil::SafeWriteToFile(m_path, Serialize()))
 	{
-		m_bitmapBackup = m_bitmap;
+		m_added = Roaring64Map();
+		m_removed = Roaring64Map();
 		return true;
 	}
 
 	return false;
 }
 
-bool LeafSet::Flush(const std::string& path, Roaring& bitmap) const
+void LeafSet::DiscardChanges()
 {
-	bitmap.runOptimize();
+	m_bitmap -= m_added;
+	m_bitmap |= m_removed;
 
-	const size_t size = bitmap.getSizeInBytes();
-	if (size > 0)
-	{
-		std::vector<unsigned char> buffer(size);
-		if (size == bitmap.write((char*)&buffer[0]))
-		{
-			if (FileUtil::SafeWriteToFile(path, buffer))
-			{
-				return true;
-			}
-		}
-	}
-
-	return false;
+	m_added = Roaring64Map();
+	m_removed = Roaring64Map();
 }
 
-bool LeafSet::Snapshot(const Hash& blockHash)
+std::vector<unsigned char> LeafSet::Serialize()
 {
-	std::string path = m_path + "." + HexUtil::ConvertHash(blockHash);
-	Roaring snapshotBitmap = m_bitmap;
-
-	return Flush(path, snapshotBitmap);
+	return RoaringUtil::Serialize(m_bitmap);
 }
 
-void LeafSet::DiscardChanges()
+std::vector<unsigned char> LeafSet::Snapshot(const uint64_t size, const std::vector<uint64_t>& leavesToAdd) const
 {
-	m_bitmap = m_bitmapBackup;
+	Roaring64Map bitmap = m_bitmap;
+	for (const uint64_t position : leavesToAdd)
+	{
+		bitmap.add(position + 1);
+	}
+
+	if (!bitmap.isEmpty() && bitmap.maximum() > size)
+	{
+		Roaring64Map positionsToRemove;
+		RoaringUtil::AddRange(positionsToRemove, size + 1, bitmap.maximum() + 1);
+		bitmap -= positionsToRemove;
+	}
+
+	return RoaringUtil::Serialize(bitmap);
 }
 
 // Calculate the set of pruned positions up to the cutoff size.
 // Uses both the LeafSet and the PruneList to determine prunedness.
-Roaring LeafSet::CalculatePrunedPositions(const uint64_t cutoffSize, const Roaring& rewindRmPos, const PruneList& pruneList) const
+// This is the unpruned leaves that were not in the LeafSet as of the cutoff, computed entirely with bitmap operations.
+Roaring64Map LeafSet::CalculatePrunedPositions(const uint64_t cutoffSize, const Roaring64Map& rewindRmPos, const PruneList& pruneList) const
 {
-	Roaring bitmap = m_bitmap;
+	Roaring64Map prunedPositions = CalculateUnprunedPositions(cutoffSize, pruneList);
 
-	// First remove positions from LeafSet that were added after the point we are rewinding to.
-	Roaring rewindAddedPositions;
-	rewindAddedPositions.addRange(cutoffSize, m_bitmap.maximum());
-	bitmap -= rewindAddedPositions;
+	// Positions added after the cutoff are already excluded, since the unpruned positions stop at the cutoff.
+	prunedPositions -= m_bitmap;
 
-	// Then add back output positions to the LeafSet that were removed.
-	bitmap |= rewindRmPos;
+	// Positions removed after the cutoff were still in the LeafSet as of the cutoff.
+	prunedPositions -= rewindRmPos;
 
-	// Invert bitmap for the leaf pos and return the resulting bitmap.
-	const Roaring unpruned = CalculateUnprunedPositions(cutoffSize, pruneList);
-	bitmap.flip(0, cutoffSize);
-	
-	return bitmap & unpruned;
+	return prunedPositions;
 }
 
 // Calculate the set of unpruned leaves up to the cutoff size.
-Roaring LeafSet::CalculateUnprunedPositions(const uint64_t cutoffSize, const PruneList& pruneList) const
+Roaring64Map LeafSet::CalculateUnprunedPositions(const uint64_t cutoffSize, const PruneList& pruneList) const
 {
-	std::vector<uint32_t> unprunedPositions; // TODO: Reserve size for performance hint?
-	for (uint64_t i = 0; i < cutoffSize; i++)
-	{
-		if (MMRUtil::IsLeaf(i) && !pruneList.IsPruned(i))
-		{
-			unprunedPositions.push_back((uint32_t)i + 1);
-		}
-	}
+	// Positions are stored as (mmrIndex + 1), so the positions before the cutoff are [1, cutoffSize].
+	Roaring64Map unprunedPositions;
+	RoaringUtil::AddRange(unprunedPositions, 1, cutoffSize + 1);
+	unprunedPositions &= m_leafPositions;
+	unprunedPositions -= pruneList.GetPrunedCache();
 
-	return Roaring(unprunedPositions.size(), &unprunedPositions[0]);
+	return unprunedPositions;
 }
\ No newline at end of file
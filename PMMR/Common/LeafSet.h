@@ -1,6 +1,6 @@
 #pragma once
 
-#include "CRoaring/roaring.hh"
+#include "RoaringUtil.h"
 #include "PruneList.h"
 
 #include <string>
@@ -11,23 +11,44 @@ class LeafSet
 public:
 	LeafSet(const std::string& path);
 
-	void Add(const uint32_t position);
-	void Remove(const uint32_t position);
-	bool Contains(const uint32_t position) const;
+	void Add(const uint64_t position);
+	void Remove(const uint64_t position);
+	bool Contains(const uint64_t position) const;
 
-	bool Load();
+	//
+	// Removes all leaves at or beyond the given MMR size, and restores the given (previously spent) leaves.
+	//
+	void Rewind(const uint64_t size, const std::vector<uint64_t>& leavesToAdd);
+
+	//
+	// Loads the unspent leaves of an MMR with the given size.
+	//
+	bool Load(const uint64_t size);
 	bool Flush();
-	bool Snapshot(const Hash& blockHash);
 	void DiscardChanges();
 
-	Roaring CalculatePrunedPositions(const uint64_t cutoffSize, const Roaring& rewindRmPos, const PruneList& pruneList) const;
+	inline const std::string& GetPath() const { return m_path; }
+	inline bool IsDirty() const { return !m_added.isEmpty() || !m_removed.isEmpty(); }
+	std::vector<unsigned char> Serialize();
 
-private:
-	Roaring CalculateUnprunedPositions(const uint64_t cutoffSize, const PruneList& pruneList) const;
+	//
+	// Serializes the leaf set as it was at the given MMR size, given the leaves spent since then, without modifying it.
+	//
+	std::vector<unsigned char> Snapshot(const uint64_t size, const std::vector<uint64_t>& leavesToAdd) const;
+
+	Roaring64Map CalculatePrunedPositions(const uint64_t cutoffSize, const Roaring64Map& rewindRmPos, const PruneList& pruneList) const;
 
-	bool Flush(const std::string& path, Roaring& bitmap) const;
+private:
+	Roaring64Map CalculateUnprunedPositions(const uint64_t cutoffSize, const PruneList& pruneList) const;
 
 	const std::string m_path;
-	Roaring m_bitmap;
-	Roaring m_bitmapBackup; // TODO: Use a batch/transaction object with a commit(), instead
+	Roaring64Map m_bitmap;
+
+	// Uncommitted changes, tracked so they can be discarded without copying the entire bitmap.
+	Roaring64Map m_added;
+	Roaring64Map m_removed;
+
+	// (mmrIndex + 1) of every leaf ever added. Built once when loaded, then kept up to date by Add, so const methods never modify it.
+	// Leaf positions never change, so this is never shrunk, even when rewinding.
+	Roaring64Map m_leafPositions;
 };
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <Hash.h>
 #include <stdint.h>
 #include <memory>
+#include <optional>
+#include <vector>
 
 class MMR
 {
@@ -23,6 +25,13 @@ public:
 	//
 	virtual std::unique_ptr<Hash> GetHashAt(const uint64_t mmrIndex) const = 0;
 
+	//
+	// Gets the Hashes of the numNodes nodes starting at firstMMRIndex, reading the hash file sequentially.
+	// Pruned nodes are returned as std::nullopt.
+	// Returns an empty vector if the hashes could not be read.
+	//
+	virtual std::vector<std::optional<Hash>> GetHashes(const uint64_t firstMMRIndex, const uint64_t numNodes) const = 0;
+
 	//
 	// Rewinds the MMR to the given size, ie. the index of the last node in the MMR.
 	//
@@ -36,5 +45,5 @@ public:
 	//
 	// Discards all working changes since the last flush to disk.
 	//
-	// TODO: virtual bool Discard() = 0;
+	virtual bool Discard() = 0;
 };
\ No newline at end of file
@@ -1,25 +1,215 @@
 #pragma once
 
 #include <Hash.h>
+#include <BitUtil.h>
 #include <stdint.h>
 #include <vector>
+#include <array>
+#include <iterator>
 
+//
+// The peak indices of an MMR, ordered from left to right.
+// An MMR can never have more than 64 peaks, so this has a fixed capacity and never allocates.
+//
+class MMRPeaks
+{
+public:
+	constexpr MMRPeaks() : m_indices(), m_numPeaks(0) { }
+
+	constexpr void Add(const uint64_t peakIndex) { m_indices[m_numPeaks++] = peakIndex; }
+	constexpr void Clear() { m_numPeaks = 0; }
+
+	constexpr size_t size() const { return m_numPeaks; }
+	constexpr bool empty() const { return m_numPeaks == 0; }
+	constexpr uint64_t operator[](const size_t index) const { return m_indices[index]; }
+
+	constexpr const uint64_t* begin() const { return m_indices.data(); }
+	constexpr const uint64_t* end() const { return m_indices.data() + m_numPeaks; }
+	std::reverse_iterator<const uint64_t*> crbegin() const { return std::reverse_iterator<const uint64_t*>(end()); }
+	std::reverse_iterator<const uint64_t*> crend() const { return std::reverse_iterator<const uint64_t*>(begin()); }
+
+	std::vector<uint64_t> ToVector() const { return std::vector<uint64_t>(begin(), end()); }
+
+private:
+	std::array<uint64_t, 64> m_indices;
+	size_t m_numPeaks;
+};
+
+//
+// Iterates over the mmr indices of all nodes at a given height, from left to right.
+// A height of 0 iterates over the leaves.
+//
+class MMRLevelIterator
+{
+public:
+	constexpr MMRLevelIterator(const uint64_t height, const uint64_t position) : m_height(height), m_position(position) { }
+
+	// The k-th node at height h is the parent of leaves [k * 2^h, (k + 1) * 2^h), so it's added right after leaf ((k + 1) * 2^h) - 1.
+	constexpr uint64_t operator*() const
+	{
+		const uint64_t lastLeafIndex = ((m_position + 1) << m_height) - 1;
+		return (2 * lastLeafIndex) - BitUtil::CountBitsSet(lastLeafIndex) + m_height;
+	}
+
+	constexpr MMRLevelIterator& operator++() { ++m_position; return *this; }
+	constexpr bool operator==(const MMRLevelIterator& other) const { return m_position == other.m_position && m_height == other.m_height; }
+	constexpr bool operator!=(const MMRLevelIterator& other) const { return !(*this == other); }
+
+private:
+	uint64_t m_height;
+	uint64_t m_position;
+};
+
+class MMRLevel
+{
+public:
+	constexpr MMRLevel(const uint64_t height, const uint64_t numNodes) : m_height(height), m_numNodes(numNodes) { }
+
+	constexpr MMRLevelIterator begin() const { return MMRLevelIterator(m_height, 0); }
+	constexpr MMRLevelIterator end() const { return MMRLevelIterator(m_height, m_numNodes); }
+	constexpr uint64_t size() const { return m_numNodes; }
+
+private:
+	uint64_t m_height;
+	uint64_t m_numNodes;
+};
+
+//
+// Position arithmetic for MMRs.
+// mmrIndex is the zero-based postorder traversal index of a node in the MMR.
+//
+// Height 2:            6
+// Height 1:      2           5
+// Height 0:   0     1     3     4     7
+//
+// Each parent is added right after its right child, so 2 is the parent of 0 and 1, 5 of 3 and 4, and 6 of 2 and 5.
+//
+// The position arithmetic is constexpr, allocation-free, and built on popcount, so the cost doesn't grow with the size of the MMR.
+// Only GetPeakIndices (which copies the peaks into a vector) and HashParentWithIndex aren't.
+//
 class MMRUtil
 {
 public:
-	static uint64_t GetHeight(const uint64_t mmrIndex);
-	static uint64_t GetParentIndex(const uint64_t mmrIndex);
-	static uint64_t GetSiblingIndex(const uint64_t mmrIndex);
-	static uint64_t GetLeftChildIndex(const uint64_t mmrIndex, const uint64_t height);
-	static uint64_t GetRightChildIndex(const uint64_t mmrIndex);
-	static std::vector<uint64_t> GetPeakIndices(const uint64_t size);
-	static uint64_t GetNumNodes(const uint64_t mmrIndex);
-	static uint64_t GetNumLeaves(const uint64_t lastMMRIndex);
-	static bool IsLeaf(const uint64_t mmrIndex);
-	static uint64_t GetPMMRIndex(const uint64_t leafIndex);
+	static constexpr uint64_t GetHeight(const uint64_t mmrIndex) { return Locate(mmrIndex).height; }
+
+	static constexpr uint64_t GetParentIndex(const uint64_t mmrIndex)
+	{
+		const NodeInfo node = Locate(mmrIndex);
+
+		// The parent of a right sibling is the next node. For a left sibling, it's after the entire right subtree.
+		return node.isRightSibling ? (mmrIndex + 1) : (mmrIndex + ((uint64_t)1 << (node.height + 1)));
+	}
+
+	static constexpr uint64_t GetSiblingIndex(const uint64_t mmrIndex)
+	{
+		const NodeInfo node = Locate(mmrIndex);
+		const uint64_t subtreeSize = ((uint64_t)1 << (node.height + 1)) - 1;
+
+		return node.isRightSibling ? (mmrIndex - subtreeSize) : (mmrIndex + subtreeSize);
+	}
+
+	// WARNING: Assumes mmrIndex is a parent.
+	static constexpr uint64_t GetLeftChildIndex(const uint64_t mmrIndex, const uint64_t height) { return mmrIndex - ((uint64_t)1 << height); }
+
+	// WARNING: Assumes mmrIndex is a parent.
+	static constexpr uint64_t GetRightChildIndex(const uint64_t mmrIndex) { return mmrIndex - 1; }
+
+	//
+	// Calculates the postorder traversal index of all peaks in an MMR with the given size (# of nodes).
+	// Returns empty when the size does not represent a complete MMR (ie. siblings exist, but no parent).
+	//
+	static constexpr MMRPeaks GetPeaks(const uint64_t size)
+	{
+		MMRPeaks peaks;
+
+		uint64_t numLeft = size;
+		uint64_t sumPrevPeaks = 0;
+		uint64_t prevPeakSize = UINT64_MAX;
+		while (numLeft > 0)
+		{
+			// Largest perfect tree (2^n - 1 nodes) that fits in the remaining nodes.
+			const uint64_t peakSize = BitUtil::FillOnesToRight(numLeft + 1) >> 1;
+
+			// Peaks must be strictly decreasing in size, otherwise 2 siblings are missing their parent.
+			if (peakSize >= prevPeakSize)
+			{
+				peaks.Clear();
+				return peaks;
+			}
+
+			peaks.Add(sumPrevPeaks + peakSize - 1);
+			sumPrevPeaks += peakSize;
+			numLeft -= peakSize;
+			prevPeakSize = peakSize;
+		}
+
+		return peaks;
+	}
+
+	// Allocates. Prefer GetPeaks.
+	static std::vector<uint64_t> GetPeakIndices(const uint64_t size) { return GetPeaks(size).ToVector(); }
+
+	//
+	// Returns the size of the smallest complete MMR containing mmrIndex.
+	//
+	static constexpr uint64_t GetNumNodes(const uint64_t mmrIndex) { return GetSizeFromLeaves(Locate(mmrIndex).lastLeafIndex + 1); }
+
+	//
+	// Returns the number of leaves in the smallest complete MMR containing lastMMRIndex.
+	//
+	static constexpr uint64_t GetNumLeaves(const uint64_t lastMMRIndex) { return Locate(lastMMRIndex).lastLeafIndex + 1; }
+
+	static constexpr bool IsLeaf(const uint64_t mmrIndex) { return GetHeight(mmrIndex) == 0; }
+
+	//
+	// Returns the mmr index of the leaf with the given (zero-based) leaf index.
+	//
+	static constexpr uint64_t GetPMMRIndex(const uint64_t leafIndex) { return 2 * leafIndex - BitUtil::CountBitsSet(leafIndex); }
+
+	//
+	// Returns the number of nodes in an MMR with the given number of leaves.
+	//
+	static constexpr uint64_t GetSizeFromLeaves(const uint64_t numLeaves) { return 2 * numLeaves - BitUtil::CountBitsSet(numLeaves); }
+
+	//
+	// Iterates over the nodes at the given height in an MMR of the given (complete) size.
+	//
+	static constexpr MMRLevel GetLevel(const uint64_t height, const uint64_t size)
+	{
+		return MMRLevel(height, (size == 0) ? 0 : (GetNumLeaves(size - 1) >> height));
+	}
+
+	static constexpr MMRLevel GetLeaves(const uint64_t size) { return GetLevel(0, size); }
 
 	static Hash HashParentWithIndex(const Hash& leftChild, const Hash& rightChild, const uint64_t parentIndex);
 
 private:
-	static std::vector<uint64_t> GetPeakSizes(const uint64_t size);
+	struct NodeInfo
+	{
+		uint64_t height;
+		uint64_t lastLeafIndex;
+		bool isRightSibling;
+	};
+
+	//
+	// Every node is added right after a leaf: leaf L is stored at index GetSizeFromLeaves(L) = 2L - popcount(L),
+	// and is followed by one parent for each trailing 1 bit of L.
+	// So the node at mmrIndex was added by the largest L with GetSizeFromLeaves(L) <= mmrIndex, and its height is the difference.
+	// Since 0 <= 2L - mmrIndex <= popcount(L) <= 64, L is found with a fixed 6-step binary search.
+	//
+	static constexpr NodeInfo Locate(const uint64_t mmrIndex)
+	{
+		uint64_t leafIndex = (mmrIndex + 1) >> 1;
+		for (uint64_t step = 32; step > 0; step >>= 1)
+		{
+			leafIndex += (GetSizeFromLeaves(leafIndex + step) <= mmrIndex) ? step : 0;
+		}
+
+		const uint64_t height = mmrIndex - GetSizeFromLeaves(leafIndex);
+
+		// The node is the k-th node at its height, where k = ((L + 1) >> height) - 1. Odd nodes are right siblings.
+		const bool isRightSibling = ((((leafIndex + 1) >> height) - 1) & 1) == 1;
+
+		return NodeInfo{ height, leafIndex, isRightSibling };
+	}
 };
\ No newline at end of file
@@ -0,0 +1,206 @@
+#include "MerkleProofBuilder.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+// Hashes this close together are read with a single sequential read, rather than separately.
+static const uint64_t MAX_READ_GAP = 16;
+
+std::unique_ptr<MerkleProof> MerkleProofBuilder::Build(const MMR& mmr, const uint64_t mmrSize, const uint64_t mmrIndex)
+{
+	std::vector<std::unique_ptr<MerkleProof>> proofs = BuildBatch(mmr, mmrSize, std::vector<uint64_t>({ mmrIndex }));
+
+	return std::move(proofs.front());
+}
+
+std::vector<std::unique_ptr<MerkleProof>> MerkleProofBuilder::BuildBatch(const MMR& mmr, const uint64_t mmrSize, const std::vector<uint64_t>& mmrIndices)
+{
+	std::vector<std::unique_ptr<MerkleProof>> proofs(mmrIndices.size());
+
+	const MMRPeaks peaks = MMRUtil::GetPeaks(mmrSize);
+	if (peaks.empty())
+	{
+		return proofs;
+	}
+
+	// Determine every hash needed by any of the proofs. Nearby leaves share most of their upper siblings.
+	std::vector<std::vector<uint64_t>> siblings(mmrIndices.size());
+	std::vector<size_t> leafPeaks(mmrIndices.size());
+	std::vector<uint64_t> indicesToRead(peaks.begin(), peaks.end());
+	size_t firstPeak = peaks.size();
+	for (size_t i = 0; i < mmrIndices.size(); i++)
+	{
+		if (mmrIndices[i] < mmrSize && MMRUtil::IsLeaf(mmrIndices[i]))
+		{
+			leafPeaks[i] = FindPeak(peaks, mmrIndices[i]);
+			siblings[i] = GetSiblings(mmrIndices[i], peaks[leafPeaks[i]]);
+			indicesToRead.insert(indicesToRead.end(), siblings[i].cbegin(), siblings[i].cend());
+			firstPeak = (std::min)(firstPeak, leafPeaks[i]);
+		}
+	}
+
+	std::sort(indicesToRead.begin(), indicesToRead.end());
+	indicesToRead.erase(std::unique(indicesToRead.begin(), indicesToRead.end()), indicesToRead.end());
+
+	// Read the hashes in runs, so each part of the hash file is only read once.
+	std::unordered_map<uint64_t, Hash> hashes;
+	size_t runStart = 0;
+	while (runStart < indicesToRead.size())
+	{
+		size_t runEnd = runStart + 1;
+		while (runEnd < indicesToRead.size() && indicesToRead[runEnd] - indicesToRead[runEnd - 1] <= MAX_READ_GAP)
+		{
+			runEnd++;
+		}
+
+		const uint64_t firstIndex = indicesToRead[runStart];
+		const std::vector<std::optional<Hash>> run = mmr.GetHashes(firstIndex, indicesToRead[runEnd - 1] - firstIndex + 1);
+		if (!run.empty())
+		{
+			for (size_t j = runStart; j < runEnd; j++)
+			{
+				const std::optional<Hash>& hash = run[indicesToRead[j] - firstIndex];
+				if (hash.has_value())
+				{
+					hashes.emplace(indicesToRead[j], hash.value());
+				}
+			}
+		}
+
+		runStart = runEnd;
+	}
+
+	for (const uint64_t peakIndex : peaks)
+	{
+		if (hashes.find(peakIndex) == hashes.cend())
+		{
+			return proofs;
+		}
+	}
+
+	// rightPeaks[k] is the bagged hash of every peak to the right of peak k.
+	std::vector<Hash> rightPeaks(peaks.size());
+	for (size_t k = peaks.size() - 1; k > firstPeak; k--)
+	{
+		const Hash& peakHash = hashes[peaks[k]];
+		rightPeaks[k - 1] = (k == peaks.size() - 1) ? peakHash : MMRUtil::HashParentWithIndex(peakHash, rightPeaks[k], mmrSize);
+	}
+
+	for (size_t i = 0; i < mmrIndices.size(); i++)
+	{
+		if (mmrIndices[i] >= mmrSize || !MMRUtil::IsLeaf(mmrIndices[i]))
+		{
+			continue;
+		}
+
+		const size_t peak = leafPeaks[i];
+
+		std::vector<Hash> path;
+		path.reserve(siblings[i].size() + peak + 1);
+
+		bool complete = true;
+		for (const uint64_t siblingIndex : siblings[i])
+		{
+			auto iter = hashes.find(siblingIndex);
+			if (iter == hashes.cend())
+			{
+				complete = false;
+				break;
+			}
+
+			path.push_back(iter->second);
+		}
+
+		if (!complete)
+		{
+			continue;
+		}
+
+		if (peak < peaks.size() - 1)
+		{
+			path.push_back(rightPeaks[peak]);
+		}
+
+		for (size_t k = peak; k > 0; k--)
+		{
+			path.push_back(hashes[peaks[k - 1]]);
+		}
+
+		proofs[i] = std::make_unique<MerkleProof>(MerkleProof(mmrSize, std::move(path)));
+	}
+
+	return proofs;
+}
+
+bool MerkleProofBuilder::Verify(const MerkleProof& proof, const Hash& root, const Hash& leafHash, const uint64_t mmrIndex)
+{
+	const uint64_t mmrSize = proof.GetMMRSize();
+	if (mmrIndex >= mmrSize || !MMRUtil::IsLeaf(mmrIndex))
+	{
+		return false;
+	}
+
+	const MMRPeaks peaks = MMRUtil::GetPeaks(mmrSize);
+	if (peaks.empty())
+	{
+		return false;
+	}
+
+	const size_t peak = FindPeak(peaks, mmrIndex);
+	const std::vector<uint64_t> siblings = GetSiblings(mmrIndex, peaks[peak]);
+	const std::vector<Hash>& path = proof.GetPath();
+	const size_t numRightPeaks = (peak < peaks.size() - 1) ? 1 : 0;
+	if (path.size() != siblings.size() + numRightPeaks + peak)
+	{
+		return false;
+	}
+
+	Hash hash = leafHash;
+	uint64_t currentIndex = mmrIndex;
+	auto iter = path.cbegin();
+	for (const uint64_t siblingIndex : siblings)
+	{
+		const uint64_t parentIndex = MMRUtil::GetParentIndex(currentIndex);
+		if (siblingIndex > currentIndex)
+		{
+			hash = MMRUtil::HashParentWithIndex(hash, *iter++, parentIndex);
+		}
+		else
+		{
+			hash = MMRUtil::HashParentWithIndex(*iter++, hash, parentIndex);
+		}
+
+		currentIndex = parentIndex;
+	}
+
+	if (numRightPeaks > 0)
+	{
+		hash = MMRUtil::HashParentWithIndex(hash, *iter++, mmrSize);
+	}
+
+	while (iter != path.cend())
+	{
+		hash = MMRUtil::HashParentWithIndex(*iter++, hash, mmrSize);
+	}
+
+	return hash == root;
+}
+
+size_t MerkleProofBuilder::FindPeak(const MMRPeaks& peaks, const uint64_t mmrIndex)
+{
+	return std::lower_bound(peaks.begin(), peaks.end(), mmrIndex) - peaks.begin();
+}
+
+std::vector<uint64_t> MerkleProofBuilder::GetSiblings(const uint64_t mmrIndex, const uint64_t peakIndex)
+{
+	std::vector<uint64_t> siblings;
+
+	uint64_t currentIndex = mmrIndex;
+	while (currentIndex < peakIndex)
+	{
+		siblings.push_back(MMRUtil::GetSiblingIndex(currentIndex));
+		currentIndex = MMRUtil::GetParentIndex(currentIndex);
+	}
+
+	return siblings;
+}
\ No newline at end of file
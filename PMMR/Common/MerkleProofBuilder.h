@@ -0,0 +1,43 @@
+#pragma once
+
+#include "MMR.h"
+#include "MMRUtil.h"
+
+#include <Core/MerkleProof.h>
+#include <Hash.h>
+#include <memory>
+#include <vector>
+#include <stdint.h>
+
+//
+// Generates and verifies MerkleProofs for the leaves of an MMR.
+// The root is bagged like MMR::Root: starting from the rightmost peak, each peak to the left is hashed with the running hash,
+// using the MMR size as the index.
+//
+class MerkleProofBuilder
+{
+public:
+	//
+	// Returns nullptr if mmrIndex is not a leaf of an MMR of the given size, or a hash needed by the proof has been pruned.
+	//
+	static std::unique_ptr<MerkleProof> Build(const MMR& mmr, const uint64_t mmrSize, const uint64_t mmrIndex);
+
+	//
+	// Builds proofs for many leaves at once. Each hash needed by any of the proofs is read only once, in sorted order,
+	// and the bagged peaks are calculated once for the whole batch.
+	// The result is parallel to mmrIndices. Leaves that can't be proven get a nullptr.
+	//
+	static std::vector<std::unique_ptr<MerkleProof>> BuildBatch(const MMR& mmr, const uint64_t mmrSize, const std::vector<uint64_t>& mmrIndices);
+
+	//
+	// Recalculates the root from the leaf's hash and the proof, and compares it to the expected root.
+	//
+	static bool Verify(const MerkleProof& proof, const Hash& root, const Hash& leafHash, const uint64_t mmrIndex);
+
+private:
+	// Returns the position (from left to right) of the peak that mmrIndex is under.
+	static size_t FindPeak(const MMRPeaks& peaks, const uint64_t mmrIndex);
+
+	// Returns the mmr indices of the siblings from mmrIndex up to (but not including) its peak.
+	static std::vector<uint64_t> GetSiblings(const uint64_t mmrIndex, const uint64_t peakIndex);
+};
\ No newline at end of file
@@ -0,0 +1,265 @@
+#include "OutputPositionIndex.h"
+
+#include <FileUtil.h>
+#include <StringUtil.h>
+#include <Infrastructure/Logger.h>
+#include <Serialization/Serializer.h>
+#include <random>
+
+static const uint64_t EMPTY_SLOT = UINT64_MAX;
+static const uint64_t MIN_SLOTS = 1024;
+
+// Key (33 bytes) + features (1 byte) + mmr index (8 bytes)
+static const size_t SNAPSHOT_ENTRY_SIZE = 42;
+static const size_t SNAPSHOT_HEADER_SIZE = 16;
+
+OutputPositionIndex::OutputPositionIndex()
+	: m_slots(MIN_SLOTS, Slot{ Key(), 0, EMPTY_SLOT }), m_size(0)
+{
+	// Commitments are chosen by whoever creates the output, so the hash is seeded to stop them from being ground into long probe chains.
+	std::random_device randomDevice;
+	m_seed = ((uint64_t)randomDevice() << 32) | randomDevice();
+}
+
+std::optional<OutputPositionIndex::Entry> OutputPositionIndex::Find(const Commitment& commitment) const
+{
+	const Slot& slot = m_slots[FindSlot(GetKey(commitment))];
+	if (slot.mmrIndex == EMPTY_SLOT)
+	{
+		return std::nullopt;
+	}
+
+	return std::make_optional<Entry>(Entry{ (EOutputFeatures)slot.features, slot.mmrIndex });
+}
+
+void OutputPositionIndex::Insert(const Commitment& commitment, const EOutputFeatures features, const uint64_t mmrIndex)
+{
+	const Key key = GetKey(commitment);
+	m_changes.emplace_back(Change{ key, Put(key, features, mmrIndex) });
+}
+
+bool OutputPositionIndex::Erase(const Commitment& commitment)
+{
+	const Key key = GetKey(commitment);
+	std::optional<Entry> previous = Remove(key);
+	if (!previous.has_value())
+	{
+		return false;
+	}
+
+	m_changes.emplace_back(Change{ key, previous });
+	return true;
+}
+
+void OutputPositionIndex::Reserve(const uint64_t numEntries)
+{
+	uint64_t numSlots = m_slots.size();
+	while ((numEntries * 4) >= (numSlots * 3))
+	{
+		numSlots *= 2;
+	}
+
+	if (numSlots != m_slots.size())
+	{
+		Resize(numSlots);
+	}
+}
+
+void OutputPositionIndex::Clear()
+{
+	m_slots.assign(MIN_SLOTS, Slot{ Key(), 0, EMPTY_SLOT });
+	m_size = 0;
+	m_changes.clear();
+}
+
+void OutputPositionIndex::Commit()
+{
+	m_changes.clear();
+}
+
+void OutputPositionIndex::Discard()
+{
+	for (auto iter = m_changes.crbegin(); iter != m_changes.crend(); iter++)
+	{
+		if (iter->previous.has_value())
+		{
+			Put(iter->key, iter->previous.value().features, iter->previous.value().mmrIndex);
+		}
+		else
+		{
+			Remove(iter->key);
+		}
+	}
+
+	m_changes.clear();
+}
+
+bool OutputPositionIndex::Save(const std::string& path, const uint64_t outputMMRSize) const
+{
+	Serializer serializer;
+	serializer.Append<uint64_t>(outputMMRSize);
+	serializer.Append<uint64_t>(m_size);
+
+	for (const Slot& slot : m_slots)
+	{
+		if (slot.mmrIndex != EMPTY_SLOT)
+		{
+			serializer.AppendByteVector(std::vector<unsigned char>(slot.key.cbegin(), slot.key.cend()));
+			serializer.Append<uint8_t>(slot.features);
+			serializer.Append<uint64_t>(slot.mmrIndex);
+		}
+	}
+
+	return FileUtil::SafeWriteToFile(path, serializer.GetBytes());
+}
+
+bool OutputPositionIndex::Load(const std::string& path, const uint64_t outputMMRSize)
+{
+	std::vector<unsigned char> data;
+	if (!FileUtil::ReadFile(path, data))
+	{
+		return false;
+	}
+
+	FileUtil::RemoveFile(path);
+
+	const auto readU64 = [&data](const size_t offset)
+	{
+		uint64_t value = 0;
+		for (size_t i = 0; i < 8; i++)
+		{
+			value = (value << 8) | data[offset + i];
+		}
+
+		return value;
+	};
+
+	if (data.size() < SNAPSHOT_HEADER_SIZE || readU64(0) != outputMMRSize)
+	{
+		LoggerAPI::LogWarning("OutputPositionIndex::Load - Snapshot does not match output MMR size " + std::to_string(outputMMRSize));
+		return false;
+	}
+
+	const uint64_t numEntries = readU64(8);
+	if ((data.size() - SNAPSHOT_HEADER_SIZE) / SNAPSHOT_ENTRY_SIZE != numEntries || (data.size() - SNAPSHOT_HEADER_SIZE) % SNAPSHOT_ENTRY_SIZE != 0)
+	{
+		LoggerAPI::LogWarning("OutputPositionIndex::Load - Snapshot is corrupt.");
+		return false;
+	}
+
+	Clear();
+	Reserve(numEntries);
+
+	for (size_t offset = SNAPSHOT_HEADER_SIZE; offset < data.size(); offset += SNAPSHOT_ENTRY_SIZE)
+	{
+		Key key;
+		std::copy(data.cbegin() + offset, data.cbegin() + offset + key.size(), key.begin());
+		Put(key, (EOutputFeatures)data[offset + key.size()], readU64(offset + key.size() + 1));
+	}
+
+	LoggerAPI::LogInfo(StringUtil::Format("OutputPositionIndex::Load - Loaded %llu output positions.", m_size));
+	return true;
+}
+
+OutputPositionIndex::Key OutputPositionIndex::GetKey(const Commitment& commitment)
+{
+	Key key;
+	const std::vector<unsigned char>& bytes = commitment.GetCommitmentBytes().GetData();
+	std::copy(bytes.cbegin(), bytes.cend(), key.begin());
+
+	return key;
+}
+
+// The first byte of a commitment is just the sign of the point, but the rest is uniformly distributed.
+uint64_t OutputPositionIndex::GetBucket(const Key& key) const
+{
+	uint64_t value = 0;
+	memcpy(&value, &key[1], sizeof(uint64_t));
+
+	return ((value ^ m_seed) * 0x9E3779B97F4A7C15ULL) & (m_slots.size() - 1);
+}
+
+uint64_t OutputPositionIndex::FindSlot(const Key& key) const
+{
+	const uint64_t mask = m_slots.size() - 1;
+
+	uint64_t slotIndex = GetBucket(key);
+	while (m_slots[slotIndex].mmrIndex != EMPTY_SLOT && m_slots[slotIndex].key != key)
+	{
+		slotIndex = (slotIndex + 1) & mask;
+	}
+
+	return slotIndex;
+}
+
+std::optional<OutputPositionIndex::Entry> OutputPositionIndex::Put(const Key& key, const EOutputFeatures features, const uint64_t mmrIndex)
+{
+	Slot& slot = m_slots[FindSlot(key)];
+	if (slot.mmrIndex != EMPTY_SLOT)
+	{
+		const Entry previous{ (EOutputFeatures)slot.features, slot.mmrIndex };
+		slot.features = (uint8_t)features;
+		slot.mmrIndex = mmrIndex;
+		return std::make_optional<Entry>(previous);
+	}
+
+	slot = Slot{ key, (uint8_t)features, mmrIndex };
+	m_size++;
+
+	// Keep the load factor below 3/4, so probe sequences stay short.
+	if ((m_size * 4) >= (m_slots.size() * 3))
+	{
+		Resize(m_slots.size() * 2);
+	}
+
+	return std::nullopt;
+}
+
+//
+// Removes the key using backward-shift deletion. Instead of leaving a tombstone, each following entry in the probe sequence
+// is moved back into the hole, unless the hole is before the bucket it hashes to.
+//
+std::optional<OutputPositionIndex::Entry> OutputPositionIndex::Remove(const Key& key)
+{
+	const uint64_t mask = m_slots.size() - 1;
+
+	uint64_t hole = FindSlot(key);
+	if (m_slots[hole].mmrIndex == EMPTY_SLOT)
+	{
+		return std::nullopt;
+	}
+
+	const Entry removed{ (EOutputFeatures)m_slots[hole].features, m_slots[hole].mmrIndex };
+
+	uint64_t next = (hole + 1) & mask;
+	while (m_slots[next].mmrIndex != EMPTY_SLOT)
+	{
+		const uint64_t bucket = GetBucket(m_slots[next].key);
+		if (((next - bucket) & mask) >= ((next - hole) & mask))
+		{
+			m_slots[hole] = m_slots[next];
+			hole = next;
+		}
+
+		next = (next + 1) & mask;
+	}
+
+	m_slots[hole].mmrIndex = EMPTY_SLOT;
+	m_size--;
+
+	return std::make_optional<Entry>(removed);
+}
+
+void OutputPositionIndex::Resize(const uint64_t numSlots)
+{
+	std::vector<Slot> slots(numSlots, Slot{ Key(), 0, EMPTY_SLOT });
+	m_slots.swap(slots);
+
+	for (const Slot& slot : slots)
+	{
+		if (slot.mmrIndex != EMPTY_SLOT)
+		{
+			m_slots[FindSlot(slot.key)] = slot;
+		}
+	}
+}
\ No newline at end of file
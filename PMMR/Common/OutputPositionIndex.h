@@ -0,0 +1,79 @@
+#pragma once
+
+#include <Crypto/Commitment.h>
+#include <Core/Features.h>
+#include <array>
+#include <optional>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+//
+// In-memory map from the commitment of every unspent output to its features and mmr index, so checking an input
+// never needs a database lookup or a read of the output PMMR.
+// Entries are stored in a single flat array using open addressing with linear probing, keyed by a seeded hash of the commitment.
+// Like the MMRs, changes are logged until Commit(), so they can be undone by Discard().
+//
+class OutputPositionIndex
+{
+public:
+	struct Entry
+	{
+		EOutputFeatures features;
+		uint64_t mmrIndex;
+	};
+
+	OutputPositionIndex();
+
+	std::optional<Entry> Find(const Commitment& commitment) const;
+	void Insert(const Commitment& commitment, const EOutputFeatures features, const uint64_t mmrIndex);
+	bool Erase(const Commitment& commitment);
+
+	void Reserve(const uint64_t numEntries);
+	void Clear();
+
+	void Commit();
+	void Discard();
+
+	inline uint64_t GetSize() const { return m_size; }
+
+	//
+	// The snapshot records the size of the output MMR it was taken at, and Load refuses a snapshot taken at any other size.
+	// Load also deletes the snapshot, so one left behind by a node that crashed after loading it can never be used.
+	//
+	bool Save(const std::string& path, const uint64_t outputMMRSize) const;
+	bool Load(const std::string& path, const uint64_t outputMMRSize);
+
+private:
+	typedef std::array<unsigned char, 33> Key;
+
+	struct Slot
+	{
+		Key key;
+		uint8_t features;
+		uint64_t mmrIndex;
+	};
+
+	struct Change
+	{
+		Key key;
+		std::optional<Entry> previous;
+	};
+
+	static Key GetKey(const Commitment& commitment);
+	uint64_t GetBucket(const Key& key) const;
+
+	// Returns the slot holding the key, or the empty slot where it would be inserted.
+	uint64_t FindSlot(const Key& key) const;
+
+	std::optional<Entry> Put(const Key& key, const EOutputFeatures features, const uint64_t mmrIndex);
+	std::optional<Entry> Remove(const Key& key);
+	void Resize(const uint64_t numSlots);
+
+	std::vector<Slot> m_slots;
+	uint64_t m_size;
+	uint64_t m_seed;
+
+	// Changes since the last commit, oldest first.
+	std::vector<Change> m_changes;
+};
\ No newline at end of file
@@ -0,0 +1,556 @@
+#pragma once
+
+#include "MMR.h"
+#include "MMRUtil.h"
+#include "HashFile.h"
+#include "DataFile.h"
+#include "LeafSet.h"
+#include "PruneList.h"
+#include "CommitJournal.h"
+#include "PMMRCompaction.h"
+#include "HashFileRebuilder.h"
+#include "MerkleProofBuilder.h"
+#include "../Zip/TxHashSetArchive.h"
+
+#include <Serialization/Serializer.h>
+#include <Serialization/ByteBuffer.h>
+#include <Infrastructure/Logger.h>
+#include <StringUtil.h>
+#include <FileUtil.h>
+#include <HexUtil.h>
+#include <Crypto.h>
+#include <Hash.h>
+#include <optional>
+#include <memory>
+#include <string>
+#include <vector>
+
+//
+// An MMR of fixed-size elements, stored as a hash file and a data file in the folder of the given name.
+// ELEMENT must have Serialize(Serializer&) and static Deserialize(ByteBuffer&), and serialize to at most ELEMENT_SIZE bytes.
+// Shorter elements (ie. rangeproofs) are zero-padded in the data file.
+//
+// When PRUNABLE, a LeafSet tracks which leaves are unspent, and a PruneList tracks the subtrees removed from the files by compaction.
+// Otherwise (ie. kernels) every node is kept, and neither exists.
+//
+// GetHash and GetAt are not virtual, so the hot paths (including Root and Append) never go through the MMR interface.
+//
+template<class ELEMENT, size_t ELEMENT_SIZE, bool PRUNABLE>
+class PMMR : public MMR
+{
+public:
+	//
+	// Returns the unpruned size of the MMR.
+	//
+	virtual uint64_t GetSize() const override final
+	{
+		if constexpr (PRUNABLE)
+		{
+			return m_pruneList->GetTotalShift() + m_hashFile.GetSize();
+		}
+		else
+		{
+			return m_hashFile.GetSize();
+		}
+	}
+
+	//
+	// Returns the hash at the given mmr index, or std::nullopt if it has been pruned.
+	//
+	std::optional<Hash> GetHash(const uint64_t mmrIndex) const
+	{
+		if constexpr (PRUNABLE)
+		{
+			if (m_pruneList->IsPruned(mmrIndex) && !m_pruneList->IsPrunedRoot(mmrIndex))
+			{
+				return std::nullopt;
+			}
+
+			return std::make_optional(m_hashFile.GetHashAt(mmrIndex - m_pruneList->GetShift(mmrIndex)));
+		}
+		else
+		{
+			return std::make_optional(m_hashFile.GetHashAt(mmrIndex));
+		}
+	}
+
+	virtual std::unique_ptr<Hash> GetHashAt(const uint64_t mmrIndex) const override final
+	{
+		std::optional<Hash> hash = GetHash(mmrIndex);
+
+		return hash.has_value() ? std::make_unique<Hash>(std::move(hash.value())) : std::unique_ptr<Hash>(nullptr);
+	}
+
+	virtual std::vector<std::optional<Hash>> GetHashes(const uint64_t firstMMRIndex, const uint64_t numNodes) const override final
+	{
+		if constexpr (!PRUNABLE)
+		{
+			std::vector<Hash> hashes = m_hashFile.GetHashes(firstMMRIndex, numNodes);
+
+			return std::vector<std::optional<Hash>>(std::make_move_iterator(hashes.begin()), std::make_move_iterator(hashes.end()));
+		}
+
+		// Pruned nodes (other than pruned roots) are not stored in the hash file, so the remaining hashes are contiguous.
+		std::vector<bool> stored(numNodes);
+		uint64_t numStored = 0;
+		uint64_t firstStoredIndex = 0;
+		for (uint64_t i = 0; i < numNodes; i++)
+		{
+			const uint64_t mmrIndex = firstMMRIndex + i;
+			stored[i] = !m_pruneList->IsPruned(mmrIndex) || m_pruneList->IsPrunedRoot(mmrIndex);
+			if (stored[i])
+			{
+				firstStoredIndex = (numStored == 0) ? mmrIndex : firstStoredIndex;
+				numStored++;
+			}
+		}
+
+		if (numStored == 0)
+		{
+			return std::vector<std::optional<Hash>>(numNodes, std::nullopt);
+		}
+
+		const uint64_t firstShiftedIndex = firstStoredIndex - m_pruneList->GetShift(firstStoredIndex);
+		std::vector<Hash> storedHashes = m_hashFile.GetHashes(firstShiftedIndex, numStored);
+		if (storedHashes.size() != numStored)
+		{
+			return std::vector<std::optional<Hash>>();
+		}
+
+		std::vector<std::optional<Hash>> hashes;
+		hashes.reserve(numNodes);
+		auto iter = storedHashes.begin();
+		for (uint64_t i = 0; i < numNodes; i++)
+		{
+			if (stored[i])
+			{
+				hashes.emplace_back(std::move(*iter++));
+			}
+			else
+			{
+				hashes.emplace_back(std::nullopt);
+			}
+		}
+
+		return hashes;
+	}
+
+	//
+	// Bags the peaks of an MMR of the given size, from right to left.
+	//
+	virtual Hash Root(const uint64_t size) const override final
+	{
+		LoggerAPI::LogTrace("PMMR::Root - Calculating root of " + m_name + " MMR with size " + std::to_string(size));
+
+		std::optional<Hash> root = std::nullopt;
+		const MMRPeaks peakIndices = MMRUtil::GetPeaks(size);
+		for (auto iter = peakIndices.crbegin(); iter != peakIndices.crend(); iter++)
+		{
+			const std::optional<Hash> peakHash = GetHash(*iter);
+			if (peakHash.has_value())
+			{
+				root = root.has_value() ? MMRUtil::HashParentWithIndex(peakHash.value(), root.value(), size) : peakHash.value();
+			}
+		}
+
+		return root.value_or(ZERO_HASH);
+	}
+
+	//
+	// Returns the element of the leaf at the given mmr index.
+	// Returns nullptr if the index is not a leaf, or (when PRUNABLE) the leaf is spent or pruned.
+	//
+	std::unique_ptr<ELEMENT> GetAt(const uint64_t mmrIndex) const
+	{
+		if (!MMRUtil::IsLeaf(mmrIndex))
+		{
+			return std::unique_ptr<ELEMENT>(nullptr);
+		}
+
+		uint64_t dataIndex = MMRUtil::GetNumLeaves(mmrIndex) - 1;
+		if constexpr (PRUNABLE)
+		{
+			if (!m_leafSet->Contains(mmrIndex) || (m_pruneList->IsPruned(mmrIndex) && !m_pruneList->IsPrunedRoot(mmrIndex)))
+			{
+				return std::unique_ptr<ELEMENT>(nullptr);
+			}
+
+			dataIndex -= m_pruneList->GetLeafShift(mmrIndex);
+		}
+
+		std::vector<unsigned char> data;
+		if (!m_dataFile.GetDataAt(dataIndex, data) || data.size() != ELEMENT_SIZE)
+		{
+			return std::unique_ptr<ELEMENT>(nullptr);
+		}
+
+		ByteBuffer byteBuffer(data);
+		return std::make_unique<ELEMENT>(ELEMENT::Deserialize(byteBuffer));
+	}
+
+	//
+	// Appends the element to the MMR, and returns its mmr index.
+	//
+	uint64_t Append(const ELEMENT& element)
+	{
+		return Append(&element, 1).front();
+	}
+
+	//
+	// Appends the elements to the MMR, and returns their mmr indices, in the same order.
+	// The peaks are read once, and kept in memory while hashing, so parents never read their children back from the hash file,
+	// and the new hashes and data are each appended to their files with a single write.
+	//
+	std::vector<uint64_t> Append(const std::vector<ELEMENT>& elements)
+	{
+		return elements.empty() ? std::vector<uint64_t>() : Append(elements.data(), elements.size());
+	}
+
+	//
+	// Rewinds the MMR to the given size. When PRUNABLE, the given leaves (spent by the blocks being rewound) are marked as unspent again.
+	//
+	virtual bool Rewind(const uint64_t size) override final
+	{
+		return Rewind(size, std::vector<uint64_t>());
+	}
+
+	bool Rewind(const uint64_t size, const std::vector<uint64_t>& leavesToAdd)
+	{
+		const bool hashRewind = m_hashFile.Rewind(GetNumStoredHashes(size));
+		const bool dataRewind = m_dataFile.Rewind(GetNumStoredLeaves(size));
+		if constexpr (PRUNABLE)
+		{
+			m_leafSet->Rewind(size, leavesToAdd);
+		}
+
+		return hashRewind && dataRewind;
+	}
+
+	virtual bool Flush() override final
+	{
+		LoggerAPI::LogInfo(StringUtil::Format("PMMR::Flush - Flushing %s MMR with size (%llu)", m_name.c_str(), GetSize()));
+		const bool hashFlush = m_hashFile.Flush();
+		const bool dataFlush = m_dataFile.Flush();
+		if constexpr (PRUNABLE)
+		{
+			const bool leafSetFlush = m_leafSet->Flush();
+			const bool pruneFlush = m_pruneList->Flush();
+
+			return hashFlush && dataFlush && leafSetFlush && pruneFlush;
+		}
+
+		return hashFlush && dataFlush;
+	}
+
+	virtual bool Discard() override final
+	{
+		LoggerAPI::LogDebug("PMMR::Discard - Discarding changes to " + m_name + " MMR since last flush.");
+		const bool hashDiscard = m_hashFile.Discard();
+		const bool dataDiscard = m_dataFile.Discard();
+		if constexpr (PRUNABLE)
+		{
+			m_leafSet->DiscardChanges();
+			m_pruneList->Discard();
+		}
+
+		return hashDiscard && dataDiscard;
+	}
+
+	void AddToJournal(CommitJournal& journal)
+	{
+		journal.AddFile(m_hashFile.GetFile());
+		journal.AddFile(m_dataFile.GetFile());
+
+		if constexpr (PRUNABLE)
+		{
+			if (m_leafSet->IsDirty())
+			{
+				journal.AddReplacement(m_leafSet->GetPath(), m_leafSet->Serialize());
+			}
+
+			if (m_pruneList->IsDirty())
+			{
+				journal.AddReplacement(m_pruneList->GetPath(), m_pruneList->Serialize());
+			}
+		}
+	}
+
+	//
+	// Adds the files to the archive as of the given MMR size. See TxHashSet::PrepareArchive.
+	// When PRUNABLE, the leaf set is restored with the given leaves (spent since then), and named after the block, as expected by TxHashSetDownload.
+	//
+	void AddToArchive(TxHashSetArchive& archive, const uint64_t size, const std::vector<uint64_t>& leavesToAdd, const Hash& blockHash) const
+	{
+		archive.AddFile(m_name + "/pmmr_hash.bin", m_hashFile.GetFile().GetPath(), GetNumStoredHashes(size) * HASH_SIZE);
+		archive.AddFile(m_name + "/pmmr_data.bin", m_dataFile.GetFile().GetPath(), GetNumStoredLeaves(size) * ELEMENT_SIZE);
+
+		if constexpr (PRUNABLE)
+		{
+			archive.AddData(m_name + "/pmmr_prun.bin", m_pruneList->Snapshot());
+			archive.AddData(m_name + "/pmmr_leaf.bin." + HexUtil::ConvertHash(blockHash), m_leafSet->Snapshot(size, leavesToAdd));
+		}
+	}
+
+	//
+	// Generates proofs that the leaves at the given mmr indices are included in the current MMR. See MerkleProofBuilder.
+	//
+	std::unique_ptr<MerkleProof> GetMerkleProof(const uint64_t mmrIndex) const
+	{
+		return MerkleProofBuilder::Build(*this, GetSize(), mmrIndex);
+	}
+
+	std::vector<std::unique_ptr<MerkleProof>> GetMerkleProofs(const std::vector<uint64_t>& mmrIndices) const
+	{
+		return MerkleProofBuilder::BuildBatch(*this, GetSize(), mmrIndices);
+	}
+
+	//
+	// Regenerates the hash file from the data file (see HashFileRebuilder), for an MMR of the given size.
+	// The existing hash file is only replaced if the new root matches the expected root.
+	//
+	bool RebuildHashFile(const uint64_t size, const Hash& expectedRoot)
+	{
+		if (IsDirty())
+		{
+			LoggerAPI::LogWarning("PMMR::RebuildHashFile - Uncommitted changes exist in " + m_name + " MMR.");
+			return false;
+		}
+
+		LoggerAPI::LogInfo("PMMR::RebuildHashFile - Rebuilding " + m_name + " hash file with size " + std::to_string(size));
+
+		const PruneList* pPruneList = nullptr;
+		if constexpr (PRUNABLE)
+		{
+			pPruneList = &m_pruneList.value();
+		}
+
+		const HashFileRebuilder rebuilder(m_dataFile.GetFile(), ELEMENT_SIZE, pPruneList, m_hashFile, [](const uint64_t mmrIndex, const std::vector<unsigned char>& record)
+		{
+			ByteBuffer byteBuffer(record);
+			return HashWithIndex(ELEMENT::Deserialize(byteBuffer), mmrIndex);
+		});
+
+		const std::string rebuildPath = m_hashFile.GetFile().GetPath() + ".rebuild";
+		std::unique_ptr<Hash> pRoot = rebuilder.Rebuild(size, rebuildPath);
+		if (pRoot == nullptr || *pRoot != expectedRoot)
+		{
+			LoggerAPI::LogError("PMMR::RebuildHashFile - Failed to rebuild a " + m_name + " hash file matching the expected root.");
+			FileUtil::RemoveFile(rebuildPath);
+			return false;
+		}
+
+		return m_hashFile.ReplaceWith(rebuildPath);
+	}
+
+	//
+	// Marks the leaf at the given mmr index as spent.
+	// Returns false if the leaf is not currently unspent.
+	//
+	bool Remove(const uint64_t mmrIndex)
+	{
+		static_assert(PRUNABLE, "Only prunable MMRs can remove leaves");
+
+		if (!m_leafSet->Contains(mmrIndex))
+		{
+			return false;
+		}
+
+		m_leafSet->Remove(mmrIndex);
+		return true;
+	}
+
+	//
+	// Compaction physically removes spent leaves from disk. See TxHashSet::PrepareCompaction.
+	// ApplyCompaction (after the compacted files are rewritten) updates the PruneList in memory and journals the file swap,
+	// and CommitCompaction then swaps the compacted files in.
+	//
+	std::unique_ptr<PMMRCompaction> PrepareCompaction(const uint64_t cutoffSize, const Roaring64Map& leavesToRemove, const Roaring64Map& nodesToRemove) const
+	{
+		static_assert(PRUNABLE, "Only prunable MMRs can be compacted");
+
+		if (cutoffSize == 0 || IsDirty())
+		{
+			return std::unique_ptr<PMMRCompaction>(nullptr);
+		}
+
+		return PMMRCompaction::Create(m_hashFile, m_dataFile.GetFile(), ELEMENT_SIZE, m_pruneList.value(), cutoffSize, leavesToRemove, nodesToRemove);
+	}
+
+	bool ApplyCompaction(PMMRCompaction& compaction, CommitJournal& journal)
+	{
+		static_assert(PRUNABLE, "Only prunable MMRs can be compacted");
+
+		if (IsDirty())
+		{
+			LoggerAPI::LogWarning("PMMR::ApplyCompaction - Uncommitted changes exist in " + m_name + " MMR.");
+			return false;
+		}
+
+		// Records appended after the compaction was prepared are copied over as-is.
+		const FileCompactor& hashCompactor = compaction.GetHashCompactor();
+		const FileCompactor& dataCompactor = compaction.GetDataCompactor();
+		if (!hashCompactor.AppendRemaining(m_hashFile.GetFile()) || !dataCompactor.AppendRemaining(m_dataFile.GetFile()))
+		{
+			LoggerAPI::LogError("PMMR::ApplyCompaction - Failed to copy new records to the compacted " + m_name + " files.");
+			return false;
+		}
+
+		const Roaring64Map& leavesToRemove = compaction.GetLeavesToRemove();
+		for (auto iter = leavesToRemove.begin(); iter != leavesToRemove.end(); ++iter)
+		{
+			m_pruneList->Add(*iter - 1);
+		}
+
+		journal.AddRename(hashCompactor.GetCompactedPath(), hashCompactor.GetPath());
+		journal.AddRename(dataCompactor.GetCompactedPath(), dataCompactor.GetPath());
+		journal.AddReplacement(m_pruneList->GetPath(), m_pruneList->Serialize());
+
+		return true;
+	}
+
+	bool CommitCompaction(const PMMRCompaction& compaction)
+	{
+		static_assert(PRUNABLE, "Only prunable MMRs can be compacted");
+
+		const bool hashReplaced = m_hashFile.ReplaceWith(compaction.GetHashCompactor().GetCompactedPath());
+		const bool dataReplaced = m_dataFile.ReplaceWith(compaction.GetDataCompactor().GetCompactedPath());
+		const bool pruneFlush = m_pruneList->Flush();
+		LoggerAPI::LogInfo(StringUtil::Format("PMMR::CommitCompaction - Compacted %s MMR to %llu hashes and %llu leaves.", m_name.c_str(), m_hashFile.GetSize(), m_dataFile.GetSize()));
+
+		return hashReplaced && dataReplaced && pruneFlush;
+	}
+
+protected:
+	PMMR(const std::string& txHashSetDirectory, const std::string& name)
+		: m_name(name),
+		m_hashFile(txHashSetDirectory + name + "/pmmr_hash.bin"),
+		m_dataFile(txHashSetDirectory + name + "/pmmr_data.bin")
+	{
+		m_hashFile.Load();
+		m_dataFile.Load();
+
+		if constexpr (PRUNABLE)
+		{
+			m_pruneList.emplace(PruneList::Load(txHashSetDirectory + name + "/pmmr_prun.bin"));
+
+			// Needs the PruneList to determine the size.
+			m_leafSet.emplace(txHashSetDirectory + name + "/pmmr_leaf.bin");
+			m_leafSet->Load(GetSize());
+		}
+	}
+
+	static Hash HashWithIndex(const ELEMENT& element, const uint64_t index)
+	{
+		Serializer serializer;
+		serializer.Append<uint64_t>(index);
+		element.Serialize(serializer);
+		return Crypto::Blake2b(serializer.GetBytes());
+	}
+
+	bool IsDirty() const
+	{
+		const bool filesDirty = m_hashFile.GetFile().IsDirty() || m_dataFile.GetFile().IsDirty();
+		if constexpr (PRUNABLE)
+		{
+			return filesDirty || m_leafSet->IsDirty() || m_pruneList->IsDirty();
+		}
+
+		return filesDirty;
+	}
+
+	// The name of the MMR's folder, ie. "kernel", "output", or "rangeproof".
+	const std::string m_name;
+
+	HashFile m_hashFile;
+	DataFile<ELEMENT_SIZE> m_dataFile;
+
+	// Only when PRUNABLE.
+	std::optional<LeafSet> m_leafSet;
+	std::optional<PruneList> m_pruneList;
+
+private:
+	// The number of hashes stored in the hash file (ie. excluding pruned nodes) for an MMR of the given size.
+	uint64_t GetNumStoredHashes(const uint64_t size) const
+	{
+		if constexpr (PRUNABLE)
+		{
+			return (size == 0) ? 0 : (size - m_pruneList->GetShift(size - 1));
+		}
+
+		return size;
+	}
+
+	// The number of records stored in the data file (ie. excluding pruned leaves) for an MMR of the given size.
+	uint64_t GetNumStoredLeaves(const uint64_t size) const
+	{
+		const uint64_t numLeaves = (size == 0) ? 0 : MMRUtil::GetNumLeaves(size - 1);
+		if constexpr (PRUNABLE)
+		{
+			return (size == 0) ? 0 : (numLeaves - m_pruneList->GetLeafShift(size - 1));
+		}
+
+		return numLeaves;
+	}
+
+	std::vector<uint64_t> Append(const ELEMENT* pElements, const size_t numElements)
+	{
+		uint64_t size = GetSize();
+
+		// (height, hash) of each peak, from left to right.
+		std::vector<std::pair<uint64_t, Hash>> peaks;
+		for (const uint64_t peakIndex : MMRUtil::GetPeaks(size))
+		{
+			peaks.emplace_back(std::make_pair(MMRUtil::GetHeight(peakIndex), GetHash(peakIndex).value()));
+		}
+
+		std::vector<uint64_t> leafIndices;
+		leafIndices.reserve(numElements);
+		std::vector<Hash> hashes;
+		hashes.reserve(2 * numElements + 64);
+		std::vector<unsigned char> data;
+		data.reserve(numElements * ELEMENT_SIZE);
+
+		for (size_t i = 0; i < numElements; i++)
+		{
+			const uint64_t leafIndex = size;
+
+			// The leaf is hashed with its index, followed by the serialized element, so both come from the same serialization.
+			Serializer serializer(sizeof(uint64_t) + ELEMENT_SIZE);
+			serializer.Append<uint64_t>(leafIndex);
+			pElements[i].Serialize(serializer);
+			const std::vector<unsigned char>& bytes = serializer.GetBytes();
+
+			const size_t dataSize = data.size();
+			data.insert(data.end(), bytes.cbegin() + sizeof(uint64_t), bytes.cend());
+			data.resize(dataSize + ELEMENT_SIZE);
+
+			Hash hash = Crypto::Blake2b(bytes);
+			hashes.push_back(hash);
+			leafIndices.push_back(leafIndex);
+			size++;
+
+			if constexpr (PRUNABLE)
+			{
+				m_leafSet->Add(leafIndex);
+			}
+
+			// Add parents, while the new node completes a subtree with the last peak.
+			uint64_t height = 0;
+			while (!peaks.empty() && peaks.back().first == height)
+			{
+				hash = MMRUtil::HashParentWithIndex(peaks.back().second, hash, size);
+				peaks.pop_back();
+				hashes.push_back(hash);
+				size++;
+				height++;
+			}
+
+			peaks.emplace_back(std::make_pair(height, std::move(hash)));
+		}
+
+		m_dataFile.AddData(data);
+		m_hashFile.AddHashes(hashes);
+
+		return leafIndices;
+	}
+};
\ No newline at end of file
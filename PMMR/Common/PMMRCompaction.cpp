@@ -0,0 +1,75 @@
+#include "PMMRCompaction.h"
+#include "MMRUtil.h"
+
+#include <FileUtil.h>
+#include <algorithm>
+
+PMMRCompaction::PMMRCompaction(const Roaring64Map& leavesToRemove, const Roaring64Map& nodesToRemove, FileCompactor&& hashCompactor, FileCompactor&& dataCompactor)
+	: m_leavesToRemove(leavesToRemove),
+	m_nodesToRemove(nodesToRemove),
+	m_hashCompactor(std::move(hashCompactor)),
+	m_dataCompactor(std::move(dataCompactor)),
+	m_journaled(false)
+{
+
+}
+
+PMMRCompaction::~PMMRCompaction()
+{
+	if (!m_journaled)
+	{
+		FileUtil::RemoveFile(m_hashCompactor.GetCompactedPath());
+		FileUtil::RemoveFile(m_dataCompactor.GetCompactedPath());
+	}
+}
+
+std::unique_ptr<PMMRCompaction> PMMRCompaction::Create(
+	const HashFile& hashFile,
+	const File& dataFile,
+	const uint64_t dataRecordSize,
+	const PruneList& pruneList,
+	const uint64_t cutoffSize,
+	const Roaring64Map& leavesToRemove,
+	const Roaring64Map& nodesToRemove)
+{
+	std::vector<uint64_t> hashesToRemove;
+	std::vector<uint64_t> dataToRemove;
+	for (auto iter = nodesToRemove.begin(); iter != nodesToRemove.end(); ++iter)
+	{
+		const uint64_t mmrIndex = *iter - 1;
+
+		// The highest removed node of each subtree becomes a pruned root, so its hash (and data, for a leaf) is kept.
+		if (!nodesToRemove.contains(MMRUtil::GetParentIndex(mmrIndex) + 1))
+		{
+			continue;
+		}
+
+		hashesToRemove.push_back(mmrIndex - pruneList.GetShift(mmrIndex));
+
+		if (MMRUtil::IsLeaf(mmrIndex))
+		{
+			dataToRemove.push_back((MMRUtil::GetNumLeaves(mmrIndex) - 1) - pruneList.GetLeafShift(mmrIndex));
+		}
+	}
+
+	// Merging with a root pruned by an earlier compaction (with a later cutoff) can remove nodes past the cutoff.
+	// Those are beyond an earlier horizon too, so they're just as safe to rewrite in the background.
+	uint64_t numHashes = cutoffSize - pruneList.GetShift(cutoffSize - 1);
+	uint64_t numData = MMRUtil::GetNumLeaves(cutoffSize - 1) - pruneList.GetLeafShift(cutoffSize - 1);
+	if (!hashesToRemove.empty())
+	{
+		numHashes = (std::max)(numHashes, hashesToRemove.back() + 1);
+	}
+
+	if (!dataToRemove.empty())
+	{
+		numData = (std::max)(numData, dataToRemove.back() + 1);
+	}
+
+	return std::unique_ptr<PMMRCompaction>(new PMMRCompaction(
+		leavesToRemove,
+		nodesToRemove,
+		FileCompactor(hashFile.GetFile().GetPath(), HASH_SIZE, numHashes, std::move(hashesToRemove)),
+		FileCompactor(dataFile.GetPath(), dataRecordSize, numData, std::move(dataToRemove))
+	));
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CRoaring/roaring.hh"
+#include "FileCompactor.h"
+#include "PruneList.h"
+#include "HashFile.h"
+
+#include <memory>
+#include <string>
+#include <stdint.h>
+
+//
+// A compaction of a single prunable MMR (output or rangeproof), which removes the given leaves,
+// along with every node (and previously pruned root) that they complete a subtree with, from its hash and data files.
+// Leaves and nodes are stored as (mmrIndex + 1), like the LeafSet and PruneList.
+//
+class PMMRCompaction
+{
+public:
+	//
+	// Determines where the removed nodes are currently stored, using the (not yet updated) PruneList.
+	// Removed nodes are (almost always) before cutoffSize, so only the records before it need to be rewritten.
+	//
+	static std::unique_ptr<PMMRCompaction> Create(
+		const HashFile& hashFile,
+		const File& dataFile,
+		const uint64_t dataRecordSize,
+		const PruneList& pruneList,
+		const uint64_t cutoffSize,
+		const Roaring64Map& leavesToRemove,
+		const Roaring64Map& nodesToRemove
+	);
+
+	~PMMRCompaction();
+
+	bool Rewrite() const { return m_hashCompactor.Rewrite() && m_dataCompactor.Rewrite(); }
+
+	inline const Roaring64Map& GetLeavesToRemove() const { return m_leavesToRemove; }
+	inline const Roaring64Map& GetNodesToRemove() const { return m_nodesToRemove; }
+	inline const FileCompactor& GetHashCompactor() const { return m_hashCompactor; }
+	inline const FileCompactor& GetDataCompactor() const { return m_dataCompactor; }
+
+	//
+	// Once the compacted files are recorded in a journal, they belong to the journal and must not be cleaned up.
+	//
+	inline void MarkJournaled() { m_journaled = true; }
+
+private:
+	PMMRCompaction(const Roaring64Map& leavesToRemove, const Roaring64Map& nodesToRemove, FileCompactor&& hashCompactor, FileCompactor&& dataCompactor);
+
+	const Roaring64Map m_leavesToRemove;
+	const Roaring64Map m_nodesToRemove;
+	const FileCompactor m_hashCompactor;
+	const FileCompactor m_dataCompactor;
+	bool m_journaled;
+};
\ No newline at end of file
@@ -3,7 +3,7 @@
 
 #include <FileUtil.h>
 
-PruneList::PruneList(const std::string& filePath, Roaring&& prunedRoots)
+PruneList::PruneList(const std::string& filePath, Roaring64Map&& prunedRoots)
 	: m_filePath(filePath), m_prunedRoots(std::move(prunedRoots))
 {
 
@@ -14,7 +14,7 @@ PruneList PruneList::Load(const std::string& filePath)
 	std::vector<unsigned char> data;
 	if (FileUtil::ReadFile(filePath, data))
 	{
-		Roaring prunedRoots = Roaring::readSafe((const char*)&data[0], data.size());
+		Roaring64Map prunedRoots = RoaringUtil::Deserialize(data);
 		PruneList pruneList(filePath, std::move(prunedRoots));
 		pruneList.BuildPrunedCache();
 		pruneList.BuildShiftCaches();
@@ -23,57 +23,123 @@ PruneList PruneList::Load(const std::string& filePath)
 	}
 	else
 	{
-		return PruneList(filePath, std::move(Roaring()));
+		return PruneList(filePath, std::move(Roaring64Map()));
 	}
 }
 
 bool PruneList::Flush()
 {
-	// Run the optimization step on the bitmap.
-	m_prunedRoots.runOptimize();
-
 	// Write the updated bitmap file to disk.
-	const size_t size = m_prunedRoots.getSizeInBytes();
-	if (size > 0)
+	// The pruned and shift caches are updated as roots are added, so there's nothing to rebuild.
+	const std::vector<unsigned char> buffer = Serialize();
+	if (FileUtil::SafeWriteToFile(m_filePath, buffer))
 	{
-		std::vector<unsigned char> buffer(size);
-		m_prunedRoots.write((char*)&buffer[0]);
-
-		if (FileUtil::SafeWriteToFile(m_filePath, buffer))
-		{
-			// Rebuild our "shift caches" here as we are flushing changes to disk
-			// and the contents of our prune_list has likely changed.
-			BuildPrunedCache();
-			BuildShiftCaches();
+		m_rootsAdded = Roaring64Map();
+		m_rootsRemoved = Roaring64Map();
+		m_cacheAdded = Roaring64Map();
+		m_cacheChanges.clear();
 
-			return true;
-		}
+		return true;
 	}
 
 	return false;
 }
 
+void PruneList::Discard()
+{
+	for (auto iter = m_cacheChanges.crbegin(); iter != m_cacheChanges.crend(); iter++)
+	{
+		UndoShiftCaches(*iter);
+	}
+
+	m_prunedRoots -= m_rootsAdded;
+	m_prunedRoots |= m_rootsRemoved;
+	m_prunedCache -= m_cacheAdded;
+
+	m_rootsAdded = Roaring64Map();
+	m_rootsRemoved = Roaring64Map();
+	m_cacheAdded = Roaring64Map();
+	m_cacheChanges.clear();
+}
+
+std::vector<unsigned char> PruneList::Serialize()
+{
+	return RoaringUtil::Serialize(m_prunedRoots);
+}
+
+// Serializes a copy, since serializing optimizes the bitmap in place.
+std::vector<unsigned char> PruneList::Snapshot() const
+{
+	Roaring64Map prunedRoots = m_prunedRoots;
+	return RoaringUtil::Serialize(prunedRoots);
+}
+
 // Push the node at the provided position in the prune list.
 // Compacts the list if pruning the additional node means a parent can get pruned as well.
 void PruneList::Add(const uint64_t position)
 {
+	if (IsPruned(position))
+	{
+		return;
+	}
+
 	uint64_t currentIndex = position;
+	uint64_t numRootsRemoved = 0;
 	while (true)
 	{
 		const uint64_t siblingIndex = MMRUtil::GetSiblingIndex(currentIndex);
 		if (m_prunedRoots.contains(siblingIndex + 1) || m_prunedCache.contains(siblingIndex + 1))
 		{
-			m_prunedCache.add(currentIndex + 1);
-			m_prunedRoots.remove(siblingIndex + 1);
+			AddToCache(currentIndex);
+			if (RemoveRoot(siblingIndex))
+			{
+				numRootsRemoved++;
+			}
+
 			currentIndex = MMRUtil::GetParentIndex(currentIndex);
 		}
 		else
 		{
-			m_prunedCache.add(currentIndex + 1);
-			m_prunedRoots.add(currentIndex + 1);
+			AddToCache(currentIndex);
+			AddRoot(currentIndex);
 			break;
 		}
 	}
+
+	// The removed roots were all descendants of the new root, so they were the cache entries immediately before it.
+	const uint64_t cacheIndex = m_prunedRoots.rank(currentIndex + 1) - 1;
+	m_cacheChanges.emplace_back(UpdateShiftCaches(cacheIndex, numRootsRemoved, MMRUtil::GetHeight(currentIndex)));
+}
+
+void PruneList::AddRoot(const uint64_t position)
+{
+	if (m_prunedRoots.addChecked(position + 1) && !m_rootsRemoved.removeChecked(position + 1))
+	{
+		m_rootsAdded.add(position + 1);
+	}
+}
+
+bool PruneList::RemoveRoot(const uint64_t position)
+{
+	if (m_prunedRoots.removeChecked(position + 1))
+	{
+		if (!m_rootsAdded.removeChecked(position + 1))
+		{
+			m_rootsRemoved.add(position + 1);
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+void PruneList::AddToCache(const uint64_t position)
+{
+	if (m_prunedCache.addChecked(position + 1))
+	{
+		m_cacheAdded.add(position + 1);
+	}
 }
 
 bool PruneList::IsPruned(const uint64_t position) const
@@ -137,58 +203,115 @@ uint64_t PruneList::GetLeafShift(const uint64_t position) const
 	}
 }
 
+// A subtree occupies a contiguous range of postorder indices ending at its root,
+// so every pruned node is covered by one range per pruned root.
 void PruneList::BuildPrunedCache()
 {
-	if (m_prunedRoots.isEmpty())
+	m_prunedCache = Roaring64Map();
+
+	for (auto iter = m_prunedRoots.begin(); iter != m_prunedRoots.end(); ++iter)
 	{
-		return;
+		const uint64_t rootIndex = *iter - 1;
+		const uint64_t subtreeSize = ((uint64_t)2 << MMRUtil::GetHeight(rootIndex)) - 1;
+		RoaringUtil::AddRange(m_prunedCache, rootIndex + 2 - subtreeSize, rootIndex + 2);
 	}
 
-	m_prunedCache = Roaring(roaring_bitmap_create_with_capacity(m_prunedRoots.maximum()));
-	for (uint64_t position = 0; position < m_prunedRoots.maximum(); position++)
+	m_prunedCache.runOptimize();
+}
+
+void PruneList::BuildShiftCaches()
+{
+	m_shiftCache.clear();
+	m_leafShiftCache.clear();
+	m_shiftCache.reserve(m_prunedRoots.cardinality());
+	m_leafShiftCache.reserve(m_prunedRoots.cardinality());
+
+	uint64_t shift = 0;
+	uint64_t leafShift = 0;
+	for (auto iter = m_prunedRoots.begin(); iter != m_prunedRoots.end(); ++iter)
 	{
-		uint64_t parent = position;
-		while (parent < m_prunedRoots.maximum())
-		{
-			if (m_prunedRoots.contains(parent + 1))
-			{
-				m_prunedCache.add(position);
-				break;
-			}
+		const uint64_t height = MMRUtil::GetHeight(*iter - 1);
 
-			parent = MMRUtil::GetParentIndex(parent);
-		}
+		shift += CalculateShift(height);
+		m_shiftCache.push_back(shift);
+
+		leafShift += CalculateLeafShift(height);
+		m_leafShiftCache.push_back(leafShift);
 	}
+}
 
-	m_prunedCache.runOptimize();
+// The number of hashes removed from the hash file when a subtree of the given height is pruned (everything but the root).
+uint64_t PruneList::CalculateShift(const uint64_t height)
+{
+	return 2 * (((uint64_t)1 << height) - 1);
 }
 
-void PruneList::BuildShiftCaches()
+// The number of leaves removed from the data file when a subtree of the given height is pruned.
+// A pruned leaf (height 0) keeps its data, since it's still its own root.
+uint64_t PruneList::CalculateLeafShift(const uint64_t height)
 {
-	if (m_prunedRoots.isEmpty())
+	return (height == 0) ? 0 : ((uint64_t)1 << height);
+}
+
+PruneList::CacheChange PruneList::UpdateShiftCaches(const uint64_t cacheIndex, const uint64_t numRemoved, const uint64_t height)
+{
+	CacheChange change({ cacheIndex, std::vector<std::pair<uint64_t, uint64_t>>() });
+	change.removedShifts.reserve(numRemoved);
+	for (uint64_t i = cacheIndex; i < cacheIndex + numRemoved; i++)
 	{
-		return;
+		change.removedShifts.emplace_back(std::make_pair(m_shiftCache[i], m_leafShiftCache[i]));
 	}
 
-	m_shiftCache.clear();
-	m_leafShiftCache.clear();
+	const uint64_t previousShift = (cacheIndex == 0) ? 0 : m_shiftCache[cacheIndex - 1];
+	const uint64_t previousLeafShift = (cacheIndex == 0) ? 0 : m_leafShiftCache[cacheIndex - 1];
+	const uint64_t oldShift = (numRemoved == 0) ? previousShift : change.removedShifts.back().first;
+	const uint64_t oldLeafShift = (numRemoved == 0) ? previousLeafShift : change.removedShifts.back().second;
+	const uint64_t newShift = previousShift + CalculateShift(height);
+	const uint64_t newLeafShift = previousLeafShift + CalculateLeafShift(height);
+
+	m_shiftCache.erase(m_shiftCache.begin() + cacheIndex, m_shiftCache.begin() + cacheIndex + numRemoved);
+	m_shiftCache.insert(m_shiftCache.begin() + cacheIndex, newShift);
+	m_leafShiftCache.erase(m_leafShiftCache.begin() + cacheIndex, m_leafShiftCache.begin() + cacheIndex + numRemoved);
+	m_leafShiftCache.insert(m_leafShiftCache.begin() + cacheIndex, newLeafShift);
 
-	// TODO: Use m_prunedRoots.iterate instead of looping through all values and checking contains.
-	for (uint64_t position = 0; position < m_prunedRoots.maximum(); position++)
+	// A new root covers at least as much as the roots it replaced, so later entries only ever grow.
+	// When the new root is the last one, this is just an append.
+	for (size_t i = cacheIndex + 1; i < m_shiftCache.size(); i++)
 	{
-		if (m_prunedRoots.contains(position + 1))
-		{
-			const uint64_t height = MMRUtil::GetHeight(position);
+		m_shiftCache[i] += (newShift - oldShift);
+		m_leafShiftCache[i] += (newLeafShift - oldLeafShift);
+	}
 
-			// Add to shift cache
-			const uint64_t previousShift = GetShift(position - 1);
-			const uint64_t currentShift = 2 * ((1 << height) - 1);
-			m_shiftCache.push_back(previousShift + currentShift);
+	return change;
+}
 
-			// Add to leaf shift cache
-			const uint64_t previousLeafShift = GetLeafShift(position - 1);
-			const uint64_t currentLeafShift = (height == 0) ? 0 : 1 << height;
-			m_leafShiftCache.push_back(previousLeafShift + currentLeafShift);
-		}
+void PruneList::UndoShiftCaches(const CacheChange& change)
+{
+	const uint64_t cacheIndex = change.cacheIndex;
+	const uint64_t previousShift = (cacheIndex == 0) ? 0 : m_shiftCache[cacheIndex - 1];
+	const uint64_t previousLeafShift = (cacheIndex == 0) ? 0 : m_leafShiftCache[cacheIndex - 1];
+	const uint64_t oldShift = change.removedShifts.empty() ? previousShift : change.removedShifts.back().first;
+	const uint64_t oldLeafShift = change.removedShifts.empty() ? previousLeafShift : change.removedShifts.back().second;
+	const uint64_t shiftDelta = m_shiftCache[cacheIndex] - oldShift;
+	const uint64_t leafShiftDelta = m_leafShiftCache[cacheIndex] - oldLeafShift;
+
+	for (size_t i = cacheIndex + 1; i < m_shiftCache.size(); i++)
+	{
+		m_shiftCache[i] -= shiftDelta;
+		m_leafShiftCache[i] -= leafShiftDelta;
 	}
+
+	m_shiftCache.erase(m_shiftCache.begin() + cacheIndex);
+	m_leafShiftCache.erase(m_leafShiftCache.begin() + cacheIndex);
+
+	std::vector<uint64_t> removedShifts;
+	std::vector<uint64_t> removedLeafShifts;
+	for (const auto& removed : change.removedShifts)
+	{
+		removedShifts.push_back(removed.first);
+		removedLeafShifts.push_back(removed.second);
+	}
+
+	m_shiftCache.insert(m_shiftCache.begin() + cacheIndex, removedShifts.cbegin(), removedShifts.cend());
+	m_leafShiftCache.insert(m_leafShiftCache.begin() + cacheIndex, removedLeafShifts.cbegin(), removedLeafShifts.cend());
 }
\ No newline at end of file
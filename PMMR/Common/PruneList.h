@@ -1,37 +1,76 @@
 #pragma once
 
-#include "CRoaring/roaring.hh"
+#include "RoaringUtil.h"
 
 #include <string>
 #include <vector>
 #include <stdint.h>
 
-// TODO: Document this.
+//
+// Tracks the pruned subtrees of an MMR. Only the roots of pruned subtrees are persisted.
+// The shift caches hold the cumulative number of hashes (and leaves) removed from the files by the first N pruned roots,
+// and are kept up to date as roots are added, so flushing never has to rebuild them.
+//
 class PruneList
 {
 public:
 	static PruneList Load(const std::string& filePath);
 
 	bool Flush();
+	void Discard();
+
+	inline const std::string& GetPath() const { return m_filePath; }
+	inline bool IsDirty() const { return !m_rootsAdded.isEmpty() || !m_rootsRemoved.isEmpty(); }
+	std::vector<unsigned char> Serialize();
+	std::vector<unsigned char> Snapshot() const;
 
 	void Add(const uint64_t mmrIndex);
 	bool IsPruned(const uint64_t mmrIndex) const;
 	bool IsPrunedRoot(const uint64_t mmrIndex) const;
 
+	// Every pruned node (roots and their descendants), stored as (mmrIndex + 1).
+	inline const Roaring64Map& GetPrunedCache() const { return m_prunedCache; }
+
 	uint64_t GetTotalShift() const;
 	uint64_t GetShift(const uint64_t mmrIndex) const;
 	uint64_t GetLeafShift(const uint64_t mmrIndex) const;
 
 private:
-	PruneList(const std::string& filePath, Roaring&& prunedRoots);
+	PruneList(const std::string& filePath, Roaring64Map&& prunedRoots);
+
+	void AddRoot(const uint64_t mmrIndex);
+	bool RemoveRoot(const uint64_t mmrIndex);
+	void AddToCache(const uint64_t mmrIndex);
 
 	void BuildPrunedCache();
 	void BuildShiftCaches();
 
+	static uint64_t CalculateShift(const uint64_t height);
+	static uint64_t CalculateLeafShift(const uint64_t height);
+
+	//
+	// Replaces the shift cache entries of the numRemoved roots at cacheIndex with a single new root,
+	// then adjusts every later entry. Returns the change so it can be undone by Discard.
+	//
+	struct CacheChange
+	{
+		uint64_t cacheIndex;
+		std::vector<std::pair<uint64_t, uint64_t>> removedShifts;
+	};
+
+	CacheChange UpdateShiftCaches(const uint64_t cacheIndex, const uint64_t numRemoved, const uint64_t height);
+	void UndoShiftCaches(const CacheChange& change);
+
 	const std::string m_filePath;
 
-	Roaring m_prunedRoots;
-	Roaring m_prunedCache;
+	Roaring64Map m_prunedRoots;
+	Roaring64Map m_prunedCache;
 	std::vector<uint64_t> m_shiftCache;
 	std::vector<uint64_t> m_leafShiftCache;
+
+	// Uncommitted changes, tracked so they can be discarded without rebuilding the caches.
+	Roaring64Map m_rootsAdded;
+	Roaring64Map m_rootsRemoved;
+	Roaring64Map m_cacheAdded;
+	std::vector<CacheChange> m_cacheChanges;
 };
\ No newline at end of file
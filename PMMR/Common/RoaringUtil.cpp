@@ -0,0 +1,70 @@
+#include "RoaringUtil.h"
+
+#include <cstring>
+#include <algorithm>
+
+// Size of the 64-bit header (chunk count and key) that precedes the 32-bit bitmap of a single chunk.
+static const size_t CHUNK_HEADER_SIZE = sizeof(uint64_t) + sizeof(uint32_t);
+
+void RoaringUtil::AddRange(Roaring64Map& bitmap, const uint64_t rangeStart, const uint64_t rangeEnd)
+{
+	uint64_t start = rangeStart;
+	while (start < rangeEnd)
+	{
+		// Roaring64Map::flip misses the last value of a chunk when a range spans chunks,
+		// so each chunk is flipped separately, and the (exclusive) end value added explicitly.
+		const uint64_t nextChunk = ((start >> 32) + 1) << 32;
+		const uint64_t end = (nextChunk == 0) ? rangeEnd : (std::min)(rangeEnd, nextChunk);
+
+		Roaring64Map range;
+		range.flip(start, end - 1);
+		range.add(end - 1);
+		bitmap |= range;
+
+		start = end;
+	}
+}
+
+std::vector<unsigned char> RoaringUtil::Serialize(Roaring64Map& bitmap)
+{
+	bitmap.runOptimize();
+	bitmap.shrinkToFit();
+
+	if (bitmap.isEmpty())
+	{
+		const Roaring empty;
+		std::vector<unsigned char> buffer(empty.getSizeInBytes());
+		empty.write((char*)&buffer[0]);
+		return buffer;
+	}
+
+	std::vector<unsigned char> buffer(bitmap.getSizeInBytes());
+	bitmap.write((char*)&buffer[0]);
+
+	// With the empty chunks removed, a maximum below 2^32 means chunk 0 is the only one.
+	if (bitmap.maximum() <= UINT32_MAX)
+	{
+		buffer.erase(buffer.begin(), buffer.begin() + CHUNK_HEADER_SIZE);
+	}
+
+	return buffer;
+}
+
+Roaring64Map RoaringUtil::Deserialize(const std::vector<unsigned char>& data)
+{
+	if (data.size() < sizeof(uint64_t))
+	{
+		return Roaring64Map();
+	}
+
+	// The 32-bit portable format begins with one of CRoaring's serial cookies.
+	// The 64-bit format begins with a u64 count of 2^32 chunks, which can't match them for any realistic MMR.
+	uint32_t cookie = 0;
+	memcpy(&cookie, &data[0], sizeof(uint32_t));
+	if ((cookie & 0xFFFF) == SERIAL_COOKIE || cookie == SERIAL_COOKIE_NO_RUNCONTAINER)
+	{
+		return Roaring64Map(Roaring::readSafe((const char*)&data[0], data.size()));
+	}
+
+	return Roaring64Map::readSafe((const char*)&data[0], data.size());
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "CRoaring/roaring.hh"
+
+#include <vector>
+#include <stdint.h>
+
+//
+// Helpers for the 64-bit position bitmaps used by the LeafSet and PruneList.
+//
+class RoaringUtil
+{
+public:
+	//
+	// Adds every value in [rangeStart, rangeEnd), which may span several 2^32 chunks.
+	//
+	static void AddRange(Roaring64Map& bitmap, const uint64_t rangeStart, const uint64_t rangeEnd);
+
+	//
+	// Bitmaps whose values all fit in 32 bits are written in the standard 32-bit portable format, so existing files (and grin's) stay byte-for-byte compatible.
+	// Only bitmaps with larger values use the 64-bit format.
+	//
+	static std::vector<unsigned char> Serialize(Roaring64Map& bitmap);
+
+	//
+	// Reads either format. Throws std::runtime_error if the data is malformed.
+	//
+	static Roaring64Map Deserialize(const std::vector<unsigned char>& data);
+};
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include "UndoFile.h"
+
+#include <Infrastructure/Logger.h>
+#include <StringUtil.h>
+#include <fstream>
+
+UndoFile::UndoFile(const std::string& path)
+	: m_file(path)
+{
+
+}
+
+bool UndoFile::Load()
+{
+	return m_file.Load();
+}
+
+bool UndoFile::Flush()
+{
+	return m_file.Flush();
+}
+
+bool UndoFile::Discard()
+{
+	return m_file.Discard();
+}
+
+void UndoFile::AddBlockUndo(const BlockUndo& blockUndo)
+{
+	Serializer serializer;
+	blockUndo.Serialize(serializer);
+
+	const uint64_t recordSize = serializer.GetBytes().size();
+	serializer.Append<uint64_t>(recordSize);
+
+	m_file.Append(serializer.GetBytes());
+}
+
+std::unique_ptr<BlockUndo> UndoFile::PopBlockUndo()
+{
+	uint64_t recordPosition = 0;
+	std::unique_ptr<BlockUndo> pBlockUndo = ReadBlockUndo(m_file.GetSize(), recordPosition);
+	if (pBlockUndo != nullptr)
+	{
+		m_file.Rewind(recordPosition);
+	}
+
+	return pBlockUndo;
+}
+
+std::vector<BlockUndo> UndoFile::GetBlockUndosAfter(const uint64_t height) const
+{
+	std::vector<BlockUndo> blockUndos;
+
+	uint64_t endPosition = m_file.GetSize();
+	while (true)
+	{
+		std::unique_ptr<BlockUndo> pBlockUndo = ReadBlockUndo(endPosition, endPosition);
+		if (pBlockUndo == nullptr || pBlockUndo->GetHeight() <= height)
+		{
+			break;
+		}
+
+		blockUndos.emplace_back(std::move(*pBlockUndo));
+	}
+
+	return blockUndos;
+}
+
+bool UndoFile::PrepareTrim(const uint64_t height, CommitJournal& journal)
+{
+	if (m_file.IsDirty())
+	{
+		LoggerAPI::LogWarning("UndoFile::PrepareTrim - Uncommitted changes exist.");
+		return false;
+	}
+
+	// Find where the first record above the height starts.
+	uint64_t firstKeptPosition = m_file.GetSize();
+	while (true)
+	{
+		uint64_t recordPosition = 0;
+		std::unique_ptr<BlockUndo> pBlockUndo = ReadBlockUndo(firstKeptPosition, recordPosition);
+		if (pBlockUndo == nullptr)
+		{
+			// Every record is above the height.
+			return false;
+		}
+
+		if (pBlockUndo->GetHeight() <= height)
+		{
+			break;
+		}
+
+		firstKeptPosition = recordPosition;
+	}
+
+	std::vector<unsigned char> keptBytes;
+	if (!m_file.Read(firstKeptPosition, m_file.GetSize() - firstKeptPosition, keptBytes))
+	{
+		return false;
+	}
+
+	std::ofstream trimmedFile(GetTrimmedPath(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!trimmedFile.is_open())
+	{
+		LoggerAPI::LogError("UndoFile::PrepareTrim - Failed to open " + GetTrimmedPath());
+		return false;
+	}
+
+	if (!keptBytes.empty())
+	{
+		trimmedFile.write((const char*)keptBytes.data(), keptBytes.size());
+	}
+
+	trimmedFile.close();
+	if (trimmedFile.fail())
+	{
+		LoggerAPI::LogError("UndoFile::PrepareTrim - Failed to write " + GetTrimmedPath());
+		return false;
+	}
+
+	LoggerAPI::LogInfo(StringUtil::Format("UndoFile::PrepareTrim - Trimming %llu bytes of undo records at or below height %llu.", firstKeptPosition, height));
+	journal.AddRename(GetTrimmedPath(), m_file.GetPath());
+	return true;
+}
+
+bool UndoFile::CommitTrim()
+{
+	return m_file.ReplaceWith(GetTrimmedPath());
+}
+
+// Reads the record ending at endPosition, and returns the position it starts at.
+std::unique_ptr<BlockUndo> UndoFile::ReadBlockUndo(const uint64_t endPosition, uint64_t& recordPositionOut) const
+{
+	if (endPosition < 8)
+	{
+		return std::unique_ptr<BlockUndo>(nullptr);
+	}
+
+	std::vector<unsigned char> sizeBytes;
+	if (!m_file.Read(endPosition - 8, 8, sizeBytes))
+	{
+		LoggerAPI::LogError("UndoFile::ReadBlockUndo - Failed to read record size.");
+		return std::unique_ptr<BlockUndo>(nullptr);
+	}
+
+	const uint64_t recordSize = ByteBuffer(sizeBytes).ReadU64();
+	if (recordSize > (endPosition - 8))
+	{
+		LoggerAPI::LogError("UndoFile::ReadBlockUndo - Undo file is corrupt.");
+		return std::unique_ptr<BlockUndo>(nullptr);
+	}
+
+	recordPositionOut = endPosition - 8 - recordSize;
+
+	std::vector<unsigned char> recordBytes;
+	if (!m_file.Read(recordPositionOut, recordSize, recordBytes))
+	{
+		LoggerAPI::LogError("UndoFile::ReadBlockUndo - Failed to read record.");
+		return std::unique_ptr<BlockUndo>(nullptr);
+	}
+
+	try
+	{
+		ByteBuffer byteBuffer(recordBytes);
+		return std::make_unique<BlockUndo>(BlockUndo::Deserialize(byteBuffer));
+	}
+	catch (const DeserializationException&)
+	{
+		LoggerAPI::LogError("UndoFile::ReadBlockUndo - Undo file is corrupt.");
+		return std::unique_ptr<BlockUndo>(nullptr);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "BlockUndo.h"
+#include "CommitJournal.h"
+
+#include <Core/File.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+//
+// Append-only stack of BlockUndo records, one for each block applied to the TxHashSet.
+// Each record is followed by its length, so the latest record can be found and popped from the end of the file
+// without an index, and without reading any of the older records.
+// Records at or below the horizon are no longer needed, and are trimmed from the start of the file along with each compaction.
+//
+class UndoFile
+{
+public:
+	UndoFile(const std::string& path);
+
+	bool Load();
+	bool Flush();
+	bool Discard();
+
+	void AddBlockUndo(const BlockUndo& blockUndo);
+
+	//
+	// Removes and returns the most recent record, or nullptr if there are none.
+	//
+	std::unique_ptr<BlockUndo> PopBlockUndo();
+
+	//
+	// Returns the records of every block above the given height, most recent first, without removing them.
+	//
+	std::vector<BlockUndo> GetBlockUndosAfter(const uint64_t height) const;
+
+	//
+	// Writes a copy of the file without the records at or below the given height, and journals it replacing this file.
+	// CommitTrim then swaps the copy in. Returns false if there's nothing to trim, or the file has uncommitted changes.
+	//
+	bool PrepareTrim(const uint64_t height, CommitJournal& journal);
+	bool CommitTrim();
+
+	inline const File& GetFile() const { return m_file; }
+
+private:
+	inline std::string GetTrimmedPath() const { return m_file.GetPath() + ".trim"; }
+
+	std::unique_ptr<BlockUndo> ReadBlockUndo(const uint64_t endPosition, uint64_t& recordPositionOut) const;
+
+	File m_file;
+};
\ No newline at end of file
@@ -12,7 +12,7 @@ bool KernelSignatureValidator::ValidateKernelSignatures(const KernelMMR& kernelM
 	const uint64_t numKernels = MMRUtil::GetNumLeaves(mmrSize);
 	for (uint64_t i = 0; i < mmrSize; i++)
 	{
-		std::unique_ptr<TransactionKernel> pKernel = kernelMMR.GetKernelAt(i);
+		std::unique_ptr<TransactionKernel> pKernel = kernelMMR.GetAt(i);
 		if (pKernel != nullptr)
 		{
 			if (!ValidateKernelSignature(*pKernel))
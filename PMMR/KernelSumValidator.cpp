@@ -6,14 +6,14 @@
 #include <Consensus/Common.h>
 #include <Infrastructure/Logger.h>
 
-bool KernelSumValidator::ValidateKernelSums(TxHashSet& txHashSet, const BlockHeader& blockHeader, const bool genesisHasReward, Commitment& outputSumOut, Commitment& kernelSumOut) const
+bool KernelSumValidator::ValidateKernelSums(const KernelMMR& kernelMMR, const OutputPMMR& outputPMMR, const BlockHeader& blockHeader, const bool genesisHasReward, Commitment& outputSumOut, Commitment& kernelSumOut) const
 {
 	// Calculate overage
 	const int64_t genesisReward = genesisHasReward ? 1 : 0;
 	const uint64_t overage = (genesisReward + blockHeader.GetHeight()) * Consensus::REWARD;
 
 	// Sum all outputs & overage commitments.
-	std::unique_ptr<Commitment> pUtxoSum = AddCommitments(txHashSet, overage, blockHeader.GetOutputMMRSize());
+	std::unique_ptr<Commitment> pUtxoSum = AddCommitments(outputPMMR, overage, blockHeader.GetOutputMMRSize());
 	if (pUtxoSum == nullptr)
 	{
 		LoggerAPI::LogError("KernelSumValidator::ValidateKernelSums - Failed to add commitments for block " + HexUtil::ConvertHash(blockHeader.GetHash()));
@@ -21,7 +21,7 @@ bool KernelSumValidator::ValidateKernelSums(TxHashSet& txHashSet, const BlockHea
 	}
 
 	// Sum the kernel excesses
-	std::unique_ptr<Commitment> pKernelSum = AddKernelExcesses(txHashSet, blockHeader.GetKernelMMRSize());
+	std::unique_ptr<Commitment> pKernelSum = AddKernelExcesses(kernelMMR, blockHeader.GetKernelMMRSize());
 	if (pKernelSum == nullptr)
 	{
 		LoggerAPI::LogError("KernelSumValidator::ValidateKernelSums - Failed to add excess commitments.");
@@ -49,7 +49,7 @@ bool KernelSumValidator::ValidateKernelSums(TxHashSet& txHashSet, const BlockHea
 	return true;
 }
 
-std::unique_ptr<Commitment> KernelSumValidator::AddCommitments(TxHashSet& txHashSet, const uint64_t overage, const uint64_t outputMMRSize) const
+std::unique_ptr<Commitment> KernelSumValidator::AddCommitments(const OutputPMMR& outputPMMR, const uint64_t overage, const uint64_t outputMMRSize) const
 {
 	// Determine over-commitment
 	std::unique_ptr<Commitment> pOverageCommitment = Crypto::CommitTransparent(overage);
@@ -62,11 +62,10 @@ std::unique_ptr<Commitment> KernelSumValidator::AddCommitments(TxHashSet& txHash
 	const std::vector<Commitment> overCommitment({ *pOverageCommitment });
 
 	// Determine output commitments
-	OutputPMMR* pOutputPMMR = txHashSet.GetOutputPMMR();
 	std::vector<Commitment> outputCommitments; // TODO: Reserve size
 	for (uint64_t i = 0; i < outputMMRSize; i++)
 	{
-		std::unique_ptr<OutputIdentifier> pOutput = pOutputPMMR->GetOutputAt(i);
+		std::unique_ptr<OutputIdentifier> pOutput = outputPMMR.GetAt(i);
 		if (pOutput != nullptr)
 		{
 			outputCommitments.push_back(pOutput->GetCommitment());
@@ -76,14 +75,13 @@ std::unique_ptr<Commitment> KernelSumValidator::AddCommitments(TxHashSet& txHash
 	return Crypto::AddCommitments(outputCommitments, overCommitment);
 }
 
-std::unique_ptr<Commitment> KernelSumValidator::AddKernelExcesses(TxHashSet& txHashSet, const uint64_t kernelMMRSize) const
+std::unique_ptr<Commitment> KernelSumValidator::AddKernelExcesses(const KernelMMR& kernelMMR, const uint64_t kernelMMRSize) const
 {
 	// Determine kernel excess commitments
-	KernelMMR* pKernelMMR = txHashSet.GetKernelMMR();
 	std::vector<Commitment> excessCommitments; // TODO: Reserve size
 	for (uint64_t i = 0; i < kernelMMRSize; i++)
 	{
-		std::unique_ptr<TransactionKernel> pKernel = pKernelMMR->GetKernelAt(i);
+		std::unique_ptr<TransactionKernel> pKernel = kernelMMR.GetAt(i);
 		if (pKernel != nullptr)
 		{
 			excessCommitments.push_back(pKernel->GetExcessCommitment());
@@ -1,6 +1,7 @@
 #pragma once
 
-#include "TxHashSetImpl.h"
+#include "KernelMMR.h"
+#include "OutputPMMR.h"
 
 #include <Core/BlockHeader.h>
 #include <Crypto/Commitment.h>
@@ -11,10 +12,10 @@
 class KernelSumValidator
 {
 public:
-	bool ValidateKernelSums(TxHashSet& txHashSet, const BlockHeader& blockHeader, const bool genesisHasReward, Commitment& outputSumOut, Commitment& kernelSumOut) const;
+	bool ValidateKernelSums(const KernelMMR& kernelMMR, const OutputPMMR& outputPMMR, const BlockHeader& blockHeader, const bool genesisHasReward, Commitment& outputSumOut, Commitment& kernelSumOut) const;
 
 private:
-	std::unique_ptr<Commitment> AddCommitments(TxHashSet& txHashSet, const uint64_t overage, const uint64_t outputMMRSize) const;
-	std::unique_ptr<Commitment> AddKernelExcesses(TxHashSet& txHashSet, const uint64_t kernelMMRSize) const;
+	std::unique_ptr<Commitment> AddCommitments(const OutputPMMR& outputPMMR, const uint64_t overage, const uint64_t outputMMRSize) const;
+	std::unique_ptr<Commitment> AddKernelExcesses(const KernelMMR& kernelMMR, const uint64_t kernelMMRSize) const;
 	std::unique_ptr<Commitment> AddKernelOffset(const Commitment& kernelSum, const BlindingFactor& totalKernelOffset, const uint64_t kernelMMRSize) const;
 };
\ No newline at end of file
@@ -1,193 +1,87 @@
 #include "OutputPMMR.h"
 #include "Common/MMRUtil.h"
 
-#include <StringUtil.h>
-#include <Infrastructure/Logger.h>
-
-OutputPMMR::OutputPMMR(const Config& config, HashFile&& hashFile, LeafSet&& leafSet, PruneList&& pruneList, DataFile<OUTPUT_SIZE>&& dataFile)
-	: m_config(config),
-	m_hashFile(std::move(hashFile)),
-	m_leafSet(std::move(leafSet)),
-	m_pruneList(std::move(pruneList)),
-	m_dataFile(std::move(dataFile))
+OutputPMMR::OutputPMMR(const std::string& txHashSetDirectory)
+	: PMMR(txHashSetDirectory, "output")
 {
 
 }
 
-OutputPMMR* OutputPMMR::Load(const Config& config)
+OutputPMMR* OutputPMMR::Load(const std::string& txHashSetDirectory)
 {
-	HashFile hashFile(config.GetTxHashSetDirectory() + "output/pmmr_hash.bin");
-	hashFile.Load();
-
-	LeafSet leafSet(config.GetTxHashSetDirectory() + "output/pmmr_leaf.bin");
-	leafSet.Load();
-
-	PruneList pruneList(std::move(PruneList::Load(config.GetTxHashSetDirectory() + "output/pmmr_prun.bin")));
-
-	DataFile<OUTPUT_SIZE> dataFile(config.GetTxHashSetDirectory() + "output/pmmr_data.bin");
-	dataFile.Load();
-
-	return new OutputPMMR(config, std::move(hashFile), std::move(leafSet), std::move(pruneList), std::move(dataFile));
+	return new OutputPMMR(txHashSetDirectory);
 }
 
-Hash OutputPMMR::Root(const uint64_t size) const
+std::vector<std::pair<uint64_t, OutputIdentifier>> OutputPMMR::GetUnspentOutputs(const uint64_t firstMMRIndex) const
 {
-	LoggerAPI::LogTrace("OutputPMMR::Root - Calculating root of MMR with size " + std::to_string(size));
-
-	if (size == 0)
-	{
-		return ZERO_HASH;
-	}
+	std::vector<std::pair<uint64_t, OutputIdentifier>> unspentOutputs;
 
-	Hash hash = ZERO_HASH;
-	const std::vector<uint64_t> peakIndices = MMRUtil::GetPeakIndices(size);
-	for (auto iter = peakIndices.crbegin(); iter != peakIndices.crend(); iter++)
+	const uint64_t size = GetSize();
+	uint64_t leafIndex = (firstMMRIndex == 0) ? 0 : MMRUtil::GetNumLeaves(firstMMRIndex - 1);
+	for (uint64_t mmrIndex = MMRUtil::GetPMMRIndex(leafIndex); mmrIndex < size; mmrIndex = MMRUtil::GetPMMRIndex(++leafIndex))
 	{
-		std::unique_ptr<Hash> pHash = GetHashAt(*iter);
-		if (pHash != nullptr)
+		std::unique_ptr<OutputIdentifier> pOutput = GetAt(mmrIndex);
+		if (pOutput != nullptr)
 		{
-			if (hash == ZERO_HASH)
-			{
-				hash = *pHash;
-			}
-			else
-			{
-				hash = MMRUtil::HashParentWithIndex(*pHash, hash, size);
-			}
+			unspentOutputs.emplace_back(std::make_pair(mmrIndex, std::move(*pOutput)));
 		}
 	}
 
-	return hash;
+	return unspentOutputs;
 }
 
-std::unique_ptr<Hash> OutputPMMR::GetHashAt(const uint64_t mmrIndex) const
-{
-	if (m_pruneList.IsPruned(mmrIndex) && !m_pruneList.IsPrunedRoot(mmrIndex))
-	{
-		return std::unique_ptr<Hash>(nullptr);
-	}
-
-	const uint64_t shift = m_pruneList.GetShift(mmrIndex);
-	const uint64_t shiftedIndex = (mmrIndex - shift);
-
-	return std::make_unique<Hash>(m_hashFile.GetHashAt(shiftedIndex));
+Roaring64Map OutputPMMR::DetermineLeavesToRemove(const uint64_t cutoffSize, const Roaring64Map& rewindRmPos) const
+{	
+	return m_leafSet->CalculatePrunedPositions(cutoffSize, rewindRmPos, *m_pruneList);
 }
 
-std::unique_ptr<OutputIdentifier> OutputPMMR::GetOutputAt(const uint64_t mmrIndex) const
+// Expands the leaves to remove to every node they complete a subtree with, including previously pruned roots that get merged.
+Roaring64Map OutputPMMR::DetermineNodesToRemove(const Roaring64Map& leavesToRemove) const
 {
-	if (MMRUtil::IsLeaf(mmrIndex))
+	Roaring64Map nodesToRemove;
+	for (auto iter = leavesToRemove.begin(); iter != leavesToRemove.end(); ++iter)
 	{
-		if (m_leafSet.Contains(mmrIndex))
+		uint64_t current = *iter - 1;
+		nodesToRemove.add(current + 1);
+
+		while (true)
 		{
-			if (m_pruneList.IsPruned(mmrIndex) && !m_pruneList.IsPrunedRoot(mmrIndex))
+			const uint64_t siblingIndex = MMRUtil::GetSiblingIndex(current);
+
+			// If the sibling was previously pruned, it's removed too, so we can traverse up to the parent.
+			const bool siblingPruned = m_pruneList->IsPrunedRoot(siblingIndex);
+			if (siblingPruned)
 			{
-				return std::unique_ptr<OutputIdentifier>(nullptr);
+				nodesToRemove.add(siblingIndex + 1);
 			}
 
-			const uint64_t shift = m_pruneList.GetLeafShift(mmrIndex);
-			const uint64_t numLeaves = MMRUtil::GetNumLeaves(mmrIndex);
-			const uint64_t shiftedIndex = ((numLeaves - 1) - shift);
-
-			std::vector<unsigned char> data;
-			m_dataFile.GetDataAt(shiftedIndex, data);
-
-			if (data.size() == OUTPUT_SIZE)
+			if (siblingPruned || nodesToRemove.contains(siblingIndex + 1))
 			{
-				ByteBuffer byteBuffer(data);
-				return std::make_unique<OutputIdentifier>(OutputIdentifier::Deserialize(byteBuffer));
+				current = MMRUtil::GetParentIndex(current);
+				nodesToRemove.add(current + 1);
+			}
+			else
+			{
+				break;
 			}
 		}
 	}
 
-	return std::unique_ptr<OutputIdentifier>(nullptr);
-}
-
-uint64_t OutputPMMR::GetSize() const
-{
-	const uint64_t totalShift = m_pruneList.GetTotalShift();
-
-	return totalShift + m_hashFile.GetSize();
+	return nodesToRemove;
 }
 
-bool OutputPMMR::Rewind(const uint64_t lastMMRIndex)
+std::unique_ptr<PMMRCompaction> OutputPMMR::PrepareCompaction(const uint64_t cutoffSize, const Roaring64Map& rewindRmPos) const
 {
-	const bool hashRewind = m_hashFile.Rewind(lastMMRIndex - m_pruneList.GetShift(lastMMRIndex));
-	const bool dataRewind = m_dataFile.Rewind(MMRUtil::GetNumLeaves(lastMMRIndex) - m_pruneList.GetLeafShift(lastMMRIndex));
-	// TODO: Rewind leafset
-
-	return hashRewind && dataRewind;
-}
-
-bool OutputPMMR::Flush()
-{
-	LoggerAPI::LogInfo(StringUtil::Format("OutputPMMR::Flush - Flushing with size (%lld)", GetSize()));
-	const bool hashFlush = m_hashFile.Flush();
-	const bool dataFlush = m_dataFile.Flush();
-	const bool leafSetFlush = m_leafSet.Flush();
-	const bool pruneFlush = m_pruneList.Flush();
-
-	return hashFlush && dataFlush && leafSetFlush && pruneFlush;
-}
-
-Roaring OutputPMMR::DetermineLeavesToRemove(const uint64_t cutoffSize, const Roaring& rewindRmPos) const
-{	
-	return m_leafSet.CalculatePrunedPositions(cutoffSize, rewindRmPos, m_pruneList);
-}
-
-struct IteratorParam
-{
-	IteratorParam(Roaring& expanded, const PruneList& pruneList)
-		: expanded(expanded), pruneList(pruneList)
+	if (cutoffSize == 0 || IsDirty())
 	{
-
+		return std::unique_ptr<PMMRCompaction>(nullptr);
 	}
 
-	Roaring& expanded;
-	const PruneList& pruneList;
-};
-
-bool Iterator(const uint32_t value, void* param)
-{
-	IteratorParam* pIteratorParam = (IteratorParam*)param;
-	Roaring& expanded = pIteratorParam->expanded;
-	const PruneList& pruneList = pIteratorParam->pruneList;
-
-	expanded.add(value);
-	uint64_t current = value;
-
-	while (true)
+	const Roaring64Map leavesToRemove = DetermineLeavesToRemove(cutoffSize, rewindRmPos);
+	if (leavesToRemove.isEmpty())
 	{
-		const uint64_t siblingIndex = MMRUtil::GetSiblingIndex(current);
-
-		const bool siblingPruned = pruneList.IsPrunedRoot(siblingIndex);
-
-		// if sibling previously pruned, push it back onto list of pos to remove so we can remove it and traverse up to parent
-		if (siblingPruned)
-		{
-			expanded.add(siblingIndex);
-		}
-
-		if (siblingPruned || expanded.contains(siblingIndex))
-		{
-			const uint64_t parentIndex = MMRUtil::GetParentIndex(current);
-			expanded.add(parentIndex);
-			current = parentIndex;
-		}
-		else
-		{
-			break;
-		}
+		return std::unique_ptr<PMMRCompaction>(nullptr);
 	}
 
-	return true;
-}
-
-Roaring OutputPMMR::DetermineNodesToRemove(const Roaring& leavesToRemove) const
-{
-	Roaring expanded;
-
-	IteratorParam iteratorParam(expanded, m_pruneList);
-	leavesToRemove.iterate(Iterator, &iteratorParam);
-
-	return expanded;
+	return PrepareCompaction(cutoffSize, leavesToRemove, DetermineNodesToRemove(leavesToRemove));
 }
\ No newline at end of file
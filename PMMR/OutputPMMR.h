@@ -1,44 +1,33 @@
 #pragma once
 
-#include "Common/MMR.h"
+#include "Common/PMMR.h"
 #include "Common/CRoaring/roaring.hh"
-#include "Common/LeafSet.h"
-#include "Common/PruneList.h"
-#include "Common/HashFile.h"
-#include "Common/DataFile.h"
 
 #include <Core/OutputIdentifier.h>
-#include <Config/Config.h>
-#include <Hash.h>
+#include <string>
 
 #define OUTPUT_SIZE 34
 
-class OutputPMMR : public MMR
+class OutputPMMR : public PMMR<OutputIdentifier, OUTPUT_SIZE, true>
 {
 public:
-	static OutputPMMR* Load(const Config& config);
+	static OutputPMMR* Load(const std::string& txHashSetDirectory);
 
-	void Compact();
+	//
+	// Returns every unspent output at or after the given mmr index, along with its mmr index.
+	//
+	std::vector<std::pair<uint64_t, OutputIdentifier>> GetUnspentOutputs(const uint64_t firstMMRIndex) const;
 
-	virtual Hash Root(const uint64_t mmrIndex) const override final;
-	virtual std::unique_ptr<Hash> GetHashAt(const uint64_t mmrIndex) const override final;
-	virtual uint64_t GetSize() const override final;
-
-	virtual bool Rewind(const uint64_t lastMMRIndex) override final;
-	virtual bool Flush() override final;
-
-	std::unique_ptr<OutputIdentifier> GetOutputAt(const uint64_t mmrIndex) const;
+	//
+	// Determines the spent leaves (excluding those spent after the cutoff, and those the given rewind would restore) to compact,
+	// and every node they complete a subtree with. The same leaves and nodes are then removed from the RangeProofPMMR.
+	//
+	using PMMR::PrepareCompaction;
+	std::unique_ptr<PMMRCompaction> PrepareCompaction(const uint64_t cutoffSize, const Roaring64Map& rewindRmPos) const;
 
 private:
-	OutputPMMR(const Config& config, HashFile&& hashFile, LeafSet&& leafSet, PruneList&& pruneList, DataFile<OUTPUT_SIZE>&& dataFile);
-
-	Roaring DetermineLeavesToRemove(const uint64_t cutoffSize, const Roaring& rewindRmPos) const;
-	Roaring DetermineNodesToRemove(const Roaring& leavesToRemove) const;
-
-	const Config& m_config;
+	OutputPMMR(const std::string& txHashSetDirectory);
 
-	HashFile m_hashFile;
-	LeafSet m_leafSet;
-	PruneList m_pruneList;
-	DataFile<OUTPUT_SIZE> m_dataFile;
+	Roaring64Map DetermineLeavesToRemove(const uint64_t cutoffSize, const Roaring64Map& rewindRmPos) const;
+	Roaring64Map DetermineNodesToRemove(const Roaring64Map& leavesToRemove) const;
 };
\ No newline at end of file
@@ -1,34 +1,21 @@
 #pragma once
 
-#include "Common/MMR.h"
-#include "Common/CRoaring/roaring.hh"
-#include "Common/LeafSet.h"
-#include "Common/PruneList.h"
-#include "Common/HashFile.h"
-#include "Common/DataFile.h"
+#include "Common/PMMR.h"
 
-#include <Config/Config.h>
+#include <Crypto/RangeProof.h>
+#include <string>
 
 #define RANGE_PROOF_SIZE 683
 
-class RangeProofPMMR : public MMR
+//
+// Rangeproofs are spent and pruned along with their outputs,
+// so the leaves and nodes to remove during compaction are determined by the OutputPMMR.
+//
+class RangeProofPMMR : public PMMR<RangeProof, RANGE_PROOF_SIZE, true>
 {
 public:
-	static RangeProofPMMR* Load(const Config& config);
-
-	virtual Hash Root(const uint64_t mmrIndex) const override final;
-	virtual std::unique_ptr<Hash> GetHashAt(const uint64_t mmrIndex) const override final;
-	virtual uint64_t GetSize() const override final;
-
-	virtual bool Rewind(const uint64_t lastMMRIndex) override final;
-	virtual bool Flush() override final;
+	static RangeProofPMMR* Load(const std::string& txHashSetDirectory);
 
 private:
-	RangeProofPMMR(const Config& config, HashFile&& hashFile, LeafSet&& leafSet, PruneList&& pruneList, DataFile<RANGE_PROOF_SIZE>&& dataFile);
-
-	const Config& m_config;
-	HashFile m_hashFile;
-	LeafSet m_leafSet;
-	PruneList m_pruneList;
-	DataFile<RANGE_PROOF_SIZE> m_dataFile;
+	RangeProofPMMR(const std::string& txHashSetDirectory);
 };
\ No newline at end of file
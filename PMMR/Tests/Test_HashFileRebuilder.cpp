@@ -0,0 +1,139 @@
+#include <Catch2/catch.hpp>
+
+#include "../Common/HashFileRebuilder.h"
+#include "../Common/DataFile.h"
+#include "../Common/MMRUtil.h"
+
+#include <filesystem>
+#include <fstream>
+
+static const uint64_t RECORD_SIZE = 8;
+
+static std::vector<unsigned char> CreateRecord(const uint64_t leafIndex)
+{
+	std::vector<unsigned char> record(RECORD_SIZE);
+	for (size_t i = 0; i < RECORD_SIZE; i++)
+	{
+		record[i] = (unsigned char)((leafIndex >> (8 * i)) ^ (i * 31));
+	}
+
+	return record;
+}
+
+static Hash HashLeaf(const uint64_t mmrIndex, const std::vector<unsigned char>& record)
+{
+	std::vector<unsigned char> bytes(32);
+	std::copy(record.cbegin(), record.cend(), bytes.begin());
+	const Hash recordHash(std::move(bytes));
+
+	return MMRUtil::HashParentWithIndex(recordHash, recordHash, mmrIndex);
+}
+
+static std::vector<unsigned char> ReadFile(const std::string& path)
+{
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+	return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+//
+// Writes the hash and data files the way the PMMRs do, leaving out pruned nodes (other than pruned roots) and
+// the records of pruned leaves, then rebuilds the hash file and compares it to the original.
+//
+static void TestRebuild(const uint64_t numLeaves, const std::vector<uint64_t>& prunedLeaves, const bool usePruneList)
+{
+	const std::string directory = (std::filesystem::temp_directory_path() / "GrinPlusPlus_HashFileRebuilder").string() + "/";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+
+	PruneList pruneList = PruneList::Load(directory + "pmmr_prun.bin");
+	for (const uint64_t leafIndex : prunedLeaves)
+	{
+		pruneList.Add(MMRUtil::GetPMMRIndex(leafIndex));
+	}
+
+	std::vector<Hash> allHashes;
+	std::vector<Hash> storedHashes;
+	DataFile<RECORD_SIZE> dataFile(directory + "pmmr_data.bin");
+	for (uint64_t leafIndex = 0; leafIndex < numLeaves; leafIndex++)
+	{
+		const uint64_t mmrIndex = MMRUtil::GetPMMRIndex(leafIndex);
+		const std::vector<unsigned char> record = CreateRecord(leafIndex);
+		allHashes.push_back(HashLeaf(mmrIndex, record));
+		if (!pruneList.IsPruned(mmrIndex) || pruneList.IsPrunedRoot(mmrIndex))
+		{
+			dataFile.AddData(record);
+			storedHashes.push_back(allHashes.back());
+		}
+
+		const uint64_t newSize = MMRUtil::GetNumNodes(mmrIndex);
+		while (allHashes.size() < newSize)
+		{
+			const uint64_t parentIndex = allHashes.size();
+			const Hash& left = allHashes[MMRUtil::GetSiblingIndex(parentIndex - 1)];
+			allHashes.push_back(MMRUtil::HashParentWithIndex(left, allHashes.back(), parentIndex));
+			if (!pruneList.IsPruned(parentIndex) || pruneList.IsPrunedRoot(parentIndex))
+			{
+				storedHashes.push_back(allHashes.back());
+			}
+		}
+	}
+
+	REQUIRE(dataFile.Flush());
+
+	HashFile hashFile(directory + "pmmr_hash.bin");
+	hashFile.AddHashes(storedHashes);
+	REQUIRE(hashFile.Flush());
+
+	const uint64_t mmrSize = allHashes.size();
+	Hash expectedRoot = ZERO_HASH;
+	const MMRPeaks peakIndices = MMRUtil::GetPeaks(mmrSize);
+	for (auto iter = peakIndices.crbegin(); iter != peakIndices.crend(); iter++)
+	{
+		expectedRoot = (expectedRoot == ZERO_HASH) ? allHashes[*iter] : MMRUtil::HashParentWithIndex(allHashes[*iter], expectedRoot, mmrSize);
+	}
+
+	HashFileRebuilder rebuilder(dataFile.GetFile(), RECORD_SIZE, usePruneList ? &pruneList : nullptr, hashFile, HashLeaf);
+	std::unique_ptr<Hash> pRoot = rebuilder.Rebuild(mmrSize, directory + "pmmr_hash.bin.rebuild");
+	REQUIRE(pRoot != nullptr);
+	REQUIRE(*pRoot == expectedRoot);
+	REQUIRE(ReadFile(directory + "pmmr_hash.bin.rebuild") == ReadFile(directory + "pmmr_hash.bin"));
+
+	std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("HashFileRebuilder - Unpruned")
+{
+	for (const uint64_t numLeaves : { 1, 2, 3, 7, 100, 4096, 4097 })
+	{
+		TestRebuild(numLeaves, std::vector<uint64_t>(), false);
+	}
+}
+
+TEST_CASE("HashFileRebuilder - Multiple subtrees")
+{
+	// The first peak is taller than a subtree, so its upper nodes are hashed from the subtree roots.
+	TestRebuild(10000, std::vector<uint64_t>(), false);
+}
+
+TEST_CASE("HashFileRebuilder - Pruned")
+{
+	std::vector<uint64_t> prunedLeaves;
+	for (uint64_t leafIndex = 0; leafIndex < 10000; leafIndex += 3)
+	{
+		prunedLeaves.push_back(leafIndex);
+	}
+
+	// Prunes leaves 4, 5, 6 & 7, so their parents are pruned too.
+	for (const uint64_t leafIndex : { 4, 5, 7 })
+	{
+		prunedLeaves.push_back(leafIndex);
+	}
+
+	// Prunes an entire subtree.
+	for (uint64_t leafIndex = 4096; leafIndex < 8192; leafIndex++)
+	{
+		prunedLeaves.push_back(leafIndex);
+	}
+
+	TestRebuild(10000, prunedLeaves, true);
+}
\ No newline at end of file
@@ -2,6 +2,138 @@
 
 #include "../Common/MMRUtil.h"
 
+#include <chrono>
+#include <random>
+
+//
+// The original loop-based implementations, kept to verify the bit-arithmetic versions against.
+//
+namespace LegacyMMRUtil
+{
+	static uint64_t FillOnesToRight(const uint64_t input)
+	{
+		return BitUtil::FillOnesToRight(input);
+	}
+
+	static uint64_t GetHeight(const uint64_t mmrIndex)
+	{
+		uint64_t height = mmrIndex;
+		uint64_t peakSize = FillOnesToRight(mmrIndex + 1);
+		while (peakSize != 0)
+		{
+			if (height >= peakSize)
+			{
+				height -= peakSize;
+			}
+
+			peakSize >>= 1;
+		}
+
+		return height;
+	}
+
+	static uint64_t GetParentIndex(const uint64_t mmrIndex)
+	{
+		const uint64_t height = GetHeight(mmrIndex);
+		if (GetHeight(mmrIndex + 1) == (height + 1))
+		{
+			return mmrIndex + 1;
+		}
+		else
+		{
+			return mmrIndex + ((uint64_t)1 << (height + 1));
+		}
+	}
+
+	static uint64_t GetSiblingIndex(const uint64_t mmrIndex)
+	{
+		const uint64_t height = GetHeight(mmrIndex);
+		if (GetHeight(mmrIndex + 1) == (height + 1))
+		{
+			return mmrIndex + 1 - ((uint64_t)1 << (height + 1));
+		}
+		else
+		{
+			return mmrIndex + ((uint64_t)1 << (height + 1)) - 1;
+		}
+	}
+
+	static std::vector<uint64_t> GetPeakIndices(const uint64_t size)
+	{
+		std::vector<uint64_t> peakIndices;
+		if (size > 0)
+		{
+			uint64_t peakSize = FillOnesToRight(size);
+			uint64_t numLeft = size;
+			uint64_t sumPrevPeaks = 0;
+			while (peakSize != 0)
+			{
+				if (numLeft >= peakSize)
+				{
+					peakIndices.push_back(sumPrevPeaks + peakSize - 1);
+					sumPrevPeaks += peakSize;
+					numLeft -= peakSize;
+				}
+
+				peakSize >>= 1;
+			}
+
+			if (numLeft > 0)
+			{
+				return std::vector<uint64_t>();
+			}
+		}
+
+		return peakIndices;
+	}
+
+	static uint64_t GetNumNodes(const uint64_t mmrIndex)
+	{
+		uint64_t numNodes = mmrIndex;
+		uint64_t height = GetHeight(numNodes);
+		uint64_t nextNodeHeight = GetHeight(++numNodes);
+		while (nextNodeHeight > height)
+		{
+			height = nextNodeHeight;
+			nextNodeHeight = GetHeight(++numNodes);
+		}
+
+		return numNodes;
+	}
+
+	static uint64_t GetNumLeaves(const uint64_t lastMMRIndex)
+	{
+		const uint64_t numNodes = GetNumNodes(lastMMRIndex);
+
+		uint64_t numLeaves = 0;
+		uint64_t peakSize = FillOnesToRight(numNodes);
+		uint64_t numLeft = numNodes;
+		while (peakSize != 0)
+		{
+			if (numLeft >= peakSize)
+			{
+				numLeaves += ((peakSize + 1) / 2);
+				numLeft -= peakSize;
+			}
+
+			peakSize >>= 1;
+		}
+
+		return numLeaves;
+	}
+}
+
+static void RequireMatchesLegacy(const uint64_t mmrIndex)
+{
+	REQUIRE(MMRUtil::GetHeight(mmrIndex) == LegacyMMRUtil::GetHeight(mmrIndex));
+	REQUIRE(MMRUtil::GetParentIndex(mmrIndex) == LegacyMMRUtil::GetParentIndex(mmrIndex));
+	REQUIRE(MMRUtil::GetSiblingIndex(mmrIndex) == LegacyMMRUtil::GetSiblingIndex(mmrIndex));
+	REQUIRE(MMRUtil::GetNumNodes(mmrIndex) == LegacyMMRUtil::GetNumNodes(mmrIndex));
+	REQUIRE(MMRUtil::GetNumLeaves(mmrIndex) == LegacyMMRUtil::GetNumLeaves(mmrIndex));
+	REQUIRE(MMRUtil::IsLeaf(mmrIndex) == (LegacyMMRUtil::GetHeight(mmrIndex) == 0));
+	REQUIRE(MMRUtil::GetPeaks(mmrIndex).ToVector() == LegacyMMRUtil::GetPeakIndices(mmrIndex));
+}
+
 TEST_CASE("MMRUtil::GetHeight")
 {
 	REQUIRE(MMRUtil::GetHeight(0) == 0);
@@ -137,4 +269,145 @@ TEST_CASE("MMRUtil::GetNumLeaves")
 	REQUIRE(MMRUtil::GetNumLeaves(8) == 6);
 	REQUIRE(MMRUtil::GetNumLeaves(9) == 6);
 	REQUIRE(MMRUtil::GetNumLeaves(10) == 7);
+}
+
+TEST_CASE("BitUtil")
+{
+	static_assert(BitUtil::CountBitsSet(0) == 0, "CountBitsSet");
+	static_assert(BitUtil::CountBitsSet(UINT64_MAX) == 64, "CountBitsSet");
+	static_assert(BitUtil::BitLength(0) == 0, "BitLength");
+	static_assert(BitUtil::BitLength(0x8000000000000000ULL) == 64, "BitLength");
+	static_assert(BitUtil::CountLeadingZeros(1) == 63, "CountLeadingZeros");
+	static_assert(BitUtil::CountTrailingZeros(8) == 3, "CountTrailingZeros");
+	static_assert(BitUtil::IsAllOnes(7) && !BitUtil::IsAllOnes(8) && !BitUtil::IsAllOnes(0), "IsAllOnes");
+
+	std::mt19937_64 random(1);
+	for (int i = 0; i < 100000; i++)
+	{
+		const uint64_t value = random() >> (random() % 64);
+
+		uint8_t numBitsSet = 0;
+		uint8_t bitLength = 0;
+		for (uint8_t bit = 0; bit < 64; bit++)
+		{
+			if ((value >> bit) & 1)
+			{
+				numBitsSet++;
+				bitLength = bit + 1;
+			}
+		}
+
+		REQUIRE(BitUtil::CountBitsSet(value) == numBitsSet);
+		REQUIRE(BitUtil::BitLength(value) == bitLength);
+	}
+}
+
+TEST_CASE("MMRUtil - Constexpr")
+{
+	static_assert(MMRUtil::GetHeight(30) == 4, "GetHeight");
+	static_assert(MMRUtil::GetParentIndex(14) == 30, "GetParentIndex");
+	static_assert(MMRUtil::GetSiblingIndex(29) == 14, "GetSiblingIndex");
+	static_assert(MMRUtil::GetNumNodes(19) == 22, "GetNumNodes");
+	static_assert(MMRUtil::GetNumLeaves(10) == 7, "GetNumLeaves");
+	static_assert(MMRUtil::GetPeaks(42).size() == 4 && MMRUtil::GetPeaks(42)[1] == 37, "GetPeaks");
+	static_assert(MMRUtil::GetPeaks(9).empty(), "GetPeaks");
+}
+
+TEST_CASE("MMRUtil - Exhaustive equivalence with legacy implementation")
+{
+	for (uint64_t mmrIndex = 0; mmrIndex < (1 << 16); mmrIndex++)
+	{
+		RequireMatchesLegacy(mmrIndex);
+	}
+
+	// Around every power of 2, where the peaks change shape.
+	for (uint64_t bit = 16; bit < 48; bit++)
+	{
+		for (uint64_t offset = 0; offset < 128; offset++)
+		{
+			RequireMatchesLegacy(((uint64_t)1 << bit) + offset - 64);
+		}
+	}
+
+	std::mt19937_64 random(1);
+	for (int i = 0; i < 100000; i++)
+	{
+		RequireMatchesLegacy(random() >> (16 + (random() % 40)));
+	}
+}
+
+TEST_CASE("MMRUtil::GetLevel")
+{
+	for (uint64_t size = 0; size < 2048; size++)
+	{
+		if (size > 0 && MMRUtil::GetPeaks(size).empty())
+		{
+			continue;
+		}
+
+		for (uint64_t height = 0; height < 12; height++)
+		{
+			std::vector<uint64_t> expected;
+			for (uint64_t mmrIndex = 0; mmrIndex < size; mmrIndex++)
+			{
+				if (LegacyMMRUtil::GetHeight(mmrIndex) == height)
+				{
+					expected.push_back(mmrIndex);
+				}
+			}
+
+			std::vector<uint64_t> actual;
+			for (const uint64_t mmrIndex : MMRUtil::GetLevel(height, size))
+			{
+				actual.push_back(mmrIndex);
+			}
+
+			REQUIRE(actual == expected);
+		}
+	}
+
+	std::vector<uint64_t> leaves;
+	for (const uint64_t mmrIndex : MMRUtil::GetLeaves(11))
+	{
+		leaves.push_back(mmrIndex);
+	}
+
+	REQUIRE(leaves == std::vector<uint64_t>({ 0, 1, 3, 4, 7, 8, 10 }));
+}
+
+//
+// Benchmarks are hidden by default. Run with: PMMR_TESTS "[benchmark]"
+//
+template<class F>
+static uint64_t TimeMicros(const F& func)
+{
+	const auto start = std::chrono::steady_clock::now();
+	func();
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+TEST_CASE("MMRUtil - Benchmark", "[.][benchmark]")
+{
+	const uint64_t firstIndex = (uint64_t)1 << 30;
+	const uint64_t numIndices = 1 << 22;
+	uint64_t legacySum = 0;
+	uint64_t sum = 0;
+
+	const uint64_t legacyHeight = TimeMicros([&] { for (uint64_t i = firstIndex; i < firstIndex + numIndices; i++) { legacySum += LegacyMMRUtil::GetHeight(i); } });
+	const uint64_t height = TimeMicros([&] { for (uint64_t i = firstIndex; i < firstIndex + numIndices; i++) { sum += MMRUtil::GetHeight(i); } });
+	WARN("GetHeight: legacy " << legacyHeight << "us, new " << height << "us");
+
+	const uint64_t legacyParent = TimeMicros([&] { for (uint64_t i = firstIndex; i < firstIndex + numIndices; i++) { legacySum += LegacyMMRUtil::GetParentIndex(i); } });
+	const uint64_t parent = TimeMicros([&] { for (uint64_t i = firstIndex; i < firstIndex + numIndices; i++) { sum += MMRUtil::GetParentIndex(i); } });
+	WARN("GetParentIndex: legacy " << legacyParent << "us, new " << parent << "us");
+
+	const uint64_t legacyLeaves = TimeMicros([&] { for (uint64_t i = firstIndex; i < firstIndex + numIndices; i++) { legacySum += LegacyMMRUtil::GetNumLeaves(i); } });
+	const uint64_t leaves = TimeMicros([&] { for (uint64_t i = firstIndex; i < firstIndex + numIndices; i++) { sum += MMRUtil::GetNumLeaves(i); } });
+	WARN("GetNumLeaves: legacy " << legacyLeaves << "us, new " << leaves << "us");
+
+	const uint64_t legacyPeaks = TimeMicros([&] { for (uint64_t i = firstIndex; i < firstIndex + (numIndices / 16); i++) { legacySum += LegacyMMRUtil::GetPeakIndices(i).size(); } });
+	const uint64_t peaks = TimeMicros([&] { for (uint64_t i = firstIndex; i < firstIndex + (numIndices / 16); i++) { sum += MMRUtil::GetPeaks(i).size(); } });
+	WARN("GetPeakIndices: legacy " << legacyPeaks << "us, new " << peaks << "us");
+
+	REQUIRE(sum == legacySum);
 }
\ No newline at end of file
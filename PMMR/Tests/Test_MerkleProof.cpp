@@ -0,0 +1,221 @@
+#include <Catch2/catch.hpp>
+
+#include "../Common/MerkleProofBuilder.h"
+
+#include <Crypto.h>
+#include <set>
+
+//
+// A simple in-memory MMR, with optional pruning of individual nodes.
+//
+class TestMMR : public MMR
+{
+public:
+	void AddLeaf(const Hash& hash)
+	{
+		const uint64_t leafIndex = m_hashes.size();
+		m_hashes.push_back(hash);
+
+		const uint64_t newSize = MMRUtil::GetNumNodes(leafIndex);
+		while (m_hashes.size() < newSize)
+		{
+			const uint64_t parentIndex = m_hashes.size();
+			const Hash& left = m_hashes[MMRUtil::GetSiblingIndex(parentIndex - 1)];
+			m_hashes.push_back(MMRUtil::HashParentWithIndex(left, m_hashes.back(), parentIndex));
+		}
+	}
+
+	void Prune(const uint64_t mmrIndex) { m_pruned.insert(mmrIndex); }
+
+	virtual uint64_t GetSize() const override final { return m_hashes.size(); }
+
+	virtual Hash Root(const uint64_t size) const override final
+	{
+		Hash hash = ZERO_HASH;
+		const MMRPeaks peaks = MMRUtil::GetPeaks(size);
+		for (auto iter = peaks.crbegin(); iter != peaks.crend(); iter++)
+		{
+			hash = (hash == ZERO_HASH) ? m_hashes[*iter] : MMRUtil::HashParentWithIndex(m_hashes[*iter], hash, size);
+		}
+
+		return hash;
+	}
+
+	virtual std::unique_ptr<Hash> GetHashAt(const uint64_t mmrIndex) const override final
+	{
+		return (m_pruned.count(mmrIndex) > 0) ? std::unique_ptr<Hash>(nullptr) : std::make_unique<Hash>(m_hashes[mmrIndex]);
+	}
+
+	virtual std::vector<std::optional<Hash>> GetHashes(const uint64_t firstMMRIndex, const uint64_t numNodes) const override final
+	{
+		m_numReads++;
+
+		std::vector<std::optional<Hash>> hashes;
+		for (uint64_t mmrIndex = firstMMRIndex; mmrIndex < firstMMRIndex + numNodes; mmrIndex++)
+		{
+			hashes.emplace_back((m_pruned.count(mmrIndex) > 0) ? std::nullopt : std::make_optional(m_hashes[mmrIndex]));
+		}
+
+		return hashes;
+	}
+
+	virtual bool Rewind(const uint64_t) override final { return false; }
+	virtual bool Flush() override final { return true; }
+	virtual bool Discard() override final { return true; }
+
+	mutable uint64_t m_numReads = 0;
+
+private:
+	std::vector<Hash> m_hashes;
+	std::set<uint64_t> m_pruned;
+};
+
+static Hash LeafHash(const uint64_t leafIndex)
+{
+	return Hash::ValueOf((uint8_t)(leafIndex + 1));
+}
+
+TEST_CASE("MerkleProofBuilder::Build")
+{
+	TestMMR mmr;
+	for (uint64_t leafIndex = 0; leafIndex < 40; leafIndex++)
+	{
+		mmr.AddLeaf(LeafHash(leafIndex));
+
+		const uint64_t size = mmr.GetSize();
+		const Hash root = mmr.Root(size);
+		for (uint64_t i = 0; i <= leafIndex; i++)
+		{
+			const uint64_t mmrIndex = MMRUtil::GetPMMRIndex(i);
+			std::unique_ptr<MerkleProof> pProof = MerkleProofBuilder::Build(mmr, size, mmrIndex);
+			REQUIRE(pProof != nullptr);
+			REQUIRE(pProof->GetMMRSize() == size);
+			REQUIRE(MerkleProofBuilder::Verify(*pProof, root, LeafHash(i), mmrIndex));
+
+			// A proof for one leaf doesn't prove any other leaf.
+			REQUIRE(!MerkleProofBuilder::Verify(*pProof, root, LeafHash(i + 1), mmrIndex));
+		}
+	}
+
+	// Only leaves can be proven.
+	REQUIRE(MerkleProofBuilder::Build(mmr, mmr.GetSize(), 2) == nullptr);
+	REQUIRE(MerkleProofBuilder::Build(mmr, mmr.GetSize(), mmr.GetSize()) == nullptr);
+}
+
+// Hashes the parent's index (as 8 big-endian bytes) followed by its children, without going through the Serializer or MMRUtil.
+static Hash HashParent(const uint64_t parentIndex, const Hash& left, const Hash& right)
+{
+	std::vector<unsigned char> bytes;
+	for (int i = 7; i >= 0; i--)
+	{
+		bytes.push_back((unsigned char)(parentIndex >> (8 * i)));
+	}
+
+	bytes.insert(bytes.end(), left.GetData().cbegin(), left.GetData().cend());
+	bytes.insert(bytes.end(), right.GetData().cbegin(), right.GetData().cend());
+	return Crypto::Blake2b(bytes);
+}
+
+TEST_CASE("MerkleProofBuilder - Independently calculated root")
+{
+	TestMMR mmr;
+	for (uint64_t leafIndex = 0; leafIndex < 5; leafIndex++)
+	{
+		mmr.AddLeaf(LeafHash(leafIndex));
+	}
+
+	// Leaves are at mmr indices 0, 1, 3, 4 and 7.
+	//
+	// Height 2:            6
+	// Height 1:      2           5
+	// Height 0:   0     1     3     4     7
+	const Hash node2 = HashParent(2, LeafHash(0), LeafHash(1));
+	const Hash node5 = HashParent(5, LeafHash(2), LeafHash(3));
+	const Hash node6 = HashParent(6, node2, node5);
+
+	// The peaks (6 and 7) are bagged from the right, using the MMR size as the index.
+	const Hash root = HashParent(8, node6, LeafHash(4));
+	REQUIRE(mmr.GetSize() == 8);
+	REQUIRE(mmr.Root(8) == root);
+
+	// Leaf 2 (mmr index 3) is proven by its sibling (4), its parent's sibling (2), and the other peak (7).
+	std::unique_ptr<MerkleProof> pProof = MerkleProofBuilder::Build(mmr, 8, 3);
+	REQUIRE(pProof != nullptr);
+	REQUIRE(MerkleProofBuilder::Verify(*pProof, root, LeafHash(2), 3));
+	REQUIRE(!MerkleProofBuilder::Verify(*pProof, root, LeafHash(3), 3));
+
+	// The last leaf is a peak, so only the other peak is needed.
+	pProof = MerkleProofBuilder::Build(mmr, 8, 7);
+	REQUIRE(pProof != nullptr);
+	REQUIRE(pProof->GetPath() == std::vector<Hash>({ node6 }));
+	REQUIRE(MerkleProofBuilder::Verify(*pProof, root, LeafHash(4), 7));
+}
+
+TEST_CASE("MerkleProofBuilder::BuildBatch")
+{
+	TestMMR mmr;
+	for (uint64_t leafIndex = 0; leafIndex < 100; leafIndex++)
+	{
+		mmr.AddLeaf(LeafHash(leafIndex));
+	}
+
+	const uint64_t size = mmr.GetSize();
+	const Hash root = mmr.Root(size);
+
+	std::vector<uint64_t> mmrIndices;
+	for (uint64_t leafIndex = 0; leafIndex < 100; leafIndex += 3)
+	{
+		mmrIndices.push_back(MMRUtil::GetPMMRIndex(leafIndex));
+	}
+
+	// Not a leaf.
+	mmrIndices.push_back(6);
+
+	mmr.m_numReads = 0;
+	const std::vector<std::unique_ptr<MerkleProof>> proofs = MerkleProofBuilder::BuildBatch(mmr, size, mmrIndices);
+	REQUIRE(proofs.size() == mmrIndices.size());
+	REQUIRE(mmr.m_numReads < mmrIndices.size());
+	REQUIRE(proofs.back() == nullptr);
+
+	for (size_t i = 0; i < mmrIndices.size() - 1; i++)
+	{
+		REQUIRE(proofs[i] != nullptr);
+		REQUIRE(MerkleProofBuilder::Verify(*proofs[i], root, LeafHash(i * 3), mmrIndices[i]));
+
+		std::unique_ptr<MerkleProof> pProof = MerkleProofBuilder::Build(mmr, size, mmrIndices[i]);
+		REQUIRE(pProof->GetPath() == proofs[i]->GetPath());
+	}
+}
+
+TEST_CASE("MerkleProofBuilder - Pruned siblings")
+{
+	TestMMR mmr;
+	for (uint64_t leafIndex = 0; leafIndex < 8; leafIndex++)
+	{
+		mmr.AddLeaf(LeafHash(leafIndex));
+	}
+
+	// Leaves 0 and 1 are pruned, leaving their parent (2) as a pruned root.
+	mmr.Prune(0);
+	mmr.Prune(1);
+
+	const uint64_t size = mmr.GetSize();
+	REQUIRE(MerkleProofBuilder::Build(mmr, size, 0) == nullptr);
+
+	std::unique_ptr<MerkleProof> pProof = MerkleProofBuilder::Build(mmr, size, 3);
+	REQUIRE(pProof != nullptr);
+	REQUIRE(MerkleProofBuilder::Verify(*pProof, mmr.Root(size), LeafHash(2), 3));
+}
+
+TEST_CASE("MerkleProof - Serialization")
+{
+	const MerkleProof proof(11, std::vector<Hash>({ LeafHash(1), LeafHash(2), LeafHash(3) }));
+
+	Serializer serializer;
+	proof.Serialize(serializer);
+
+	ByteBuffer byteBuffer(serializer.GetBytes());
+	const MerkleProof deserialized = MerkleProof::Deserialize(byteBuffer);
+	REQUIRE(deserialized.GetMMRSize() == 11);
+	REQUIRE(deserialized.GetPath() == proof.GetPath());
+}
\ No newline at end of file
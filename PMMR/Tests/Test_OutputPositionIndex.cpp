@@ -0,0 +1,126 @@
+#include <Catch2/catch.hpp>
+
+#include "../Common/OutputPositionIndex.h"
+
+#include <filesystem>
+#include <map>
+#include <random>
+
+static Commitment CreateCommitment(std::mt19937_64& random)
+{
+	std::vector<unsigned char> bytes(33);
+	bytes[0] = 0x08 + (random() % 2);
+	for (size_t i = 1; i < bytes.size(); i++)
+	{
+		bytes[i] = (unsigned char)random();
+	}
+
+	return Commitment(CBigInteger<33>(std::move(bytes)));
+}
+
+static void CheckIndex(const OutputPositionIndex& index, const std::map<Commitment, uint64_t>& expected, const std::vector<Commitment>& commitments)
+{
+	REQUIRE(index.GetSize() == expected.size());
+	for (const Commitment& commitment : commitments)
+	{
+		const std::optional<OutputPositionIndex::Entry> entry = index.Find(commitment);
+		auto iter = expected.find(commitment);
+		if (iter == expected.cend())
+		{
+			REQUIRE(!entry.has_value());
+		}
+		else
+		{
+			REQUIRE(entry.has_value());
+			REQUIRE(entry.value().mmrIndex == iter->second);
+			REQUIRE(entry.value().features == ((iter->second % 3 == 0) ? COINBASE_OUTPUT : DEFAULT_OUTPUT));
+		}
+	}
+}
+
+TEST_CASE("OutputPositionIndex - Insert, Erase, Discard")
+{
+	std::mt19937_64 random(42);
+	std::vector<Commitment> commitments;
+	for (size_t i = 0; i < 20000; i++)
+	{
+		commitments.push_back(CreateCommitment(random));
+	}
+
+	OutputPositionIndex index;
+	std::map<Commitment, uint64_t> expected;
+
+	// Enough entries to grow the table several times.
+	for (uint64_t i = 0; i < 10000; i++)
+	{
+		index.Insert(commitments[i], (i % 3 == 0) ? COINBASE_OUTPUT : DEFAULT_OUTPUT, i);
+		expected[commitments[i]] = i;
+	}
+
+	index.Commit();
+	CheckIndex(index, expected, commitments);
+
+	// Erasing leaves no tombstones, so every remaining entry must still be reachable.
+	for (uint64_t i = 0; i < 10000; i += 2)
+	{
+		REQUIRE(index.Erase(commitments[i]));
+		expected.erase(commitments[i]);
+	}
+
+	REQUIRE(!index.Erase(commitments[0]));
+	REQUIRE(!index.Erase(commitments[15000]));
+	CheckIndex(index, expected, commitments);
+	index.Commit();
+
+	// Uncommitted changes, including overwrites and re-inserts, are undone by Discard.
+	const std::map<Commitment, uint64_t> committed = expected;
+	for (uint64_t i = 5000; i < 15000; i++)
+	{
+		if (i % 5 == 0)
+		{
+			index.Erase(commitments[i]);
+			expected.erase(commitments[i]);
+		}
+		else
+		{
+			index.Insert(commitments[i], (i % 3 == 0) ? COINBASE_OUTPUT : DEFAULT_OUTPUT, i);
+			expected[commitments[i]] = i;
+		}
+	}
+
+	CheckIndex(index, expected, commitments);
+
+	index.Discard();
+	CheckIndex(index, committed, commitments);
+}
+
+TEST_CASE("OutputPositionIndex - Snapshot")
+{
+	const std::string path = (std::filesystem::temp_directory_path() / "GrinPlusPlus_output_positions.bin").string();
+
+	std::mt19937_64 random(7);
+	std::vector<Commitment> commitments;
+	std::map<Commitment, uint64_t> expected;
+
+	OutputPositionIndex index;
+	for (uint64_t i = 0; i < 3000; i++)
+	{
+		commitments.push_back(CreateCommitment(random));
+		index.Insert(commitments[i], (i % 3 == 0) ? COINBASE_OUTPUT : DEFAULT_OUTPUT, i);
+		expected[commitments[i]] = i;
+	}
+
+	REQUIRE(index.Save(path, 5999));
+
+	// A snapshot taken at a different MMR size is rejected, and is deleted either way.
+	OutputPositionIndex staleIndex;
+	REQUIRE(!staleIndex.Load(path, 6000));
+	REQUIRE(!std::filesystem::exists(path));
+
+	REQUIRE(index.Save(path, 5999));
+
+	OutputPositionIndex loadedIndex;
+	REQUIRE(loadedIndex.Load(path, 5999));
+	REQUIRE(!std::filesystem::exists(path));
+	CheckIndex(loadedIndex, expected, commitments);
+}
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include <Catch2/catch.hpp>
+
+#include "../Common/PMMR.h"
+#include "../Common/MMRUtil.h"
+
+#include <Serialization/Serializer.h>
+#include <Serialization/ByteBuffer.h>
+#include <Crypto.h>
+#include <filesystem>
+
+// Serializes to fewer bytes than its element size, so the data file records are padded.
+class TestElement
+{
+public:
+	TestElement(const uint64_t value) : m_value(value) { }
+
+	uint64_t GetValue() const { return m_value; }
+
+	void Serialize(Serializer& serializer) const { serializer.Append<uint64_t>(m_value); }
+	static TestElement Deserialize(ByteBuffer& byteBuffer) { return TestElement(byteBuffer.ReadU64()); }
+
+private:
+	uint64_t m_value;
+};
+
+template<bool PRUNABLE>
+class TestPMMR : public PMMR<TestElement, 16, PRUNABLE>
+{
+public:
+	TestPMMR(const std::string& directory) : PMMR<TestElement, 16, PRUNABLE>(directory, "test") { }
+};
+
+static std::string CreateTestDirectory()
+{
+	const std::string directory = (std::filesystem::temp_directory_path() / "GrinPlusPlus_PMMR").string() + "/";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory + "test");
+
+	return directory;
+}
+
+// Calculates every hash of an MMR with the given leaves, without using peaks.
+static std::vector<Hash> CalculateHashes(const std::vector<TestElement>& elements)
+{
+	std::vector<Hash> hashes;
+	for (const TestElement& element : elements)
+	{
+		Serializer serializer;
+		serializer.Append<uint64_t>(hashes.size());
+		element.Serialize(serializer);
+		hashes.push_back(Crypto::Blake2b(serializer.GetBytes()));
+
+		while (MMRUtil::GetHeight(hashes.size()) > 0)
+		{
+			const uint64_t parentIndex = hashes.size();
+			const Hash& left = hashes[MMRUtil::GetSiblingIndex(parentIndex - 1)];
+			hashes.push_back(MMRUtil::HashParentWithIndex(left, hashes.back(), parentIndex));
+		}
+	}
+
+	return hashes;
+}
+
+static Hash CalculateRoot(const std::vector<Hash>& hashes)
+{
+	Hash root = ZERO_HASH;
+	const MMRPeaks peakIndices = MMRUtil::GetPeaks(hashes.size());
+	for (auto iter = peakIndices.crbegin(); iter != peakIndices.crend(); iter++)
+	{
+		root = (root == ZERO_HASH) ? hashes[*iter] : MMRUtil::HashParentWithIndex(hashes[*iter], root, hashes.size());
+	}
+
+	return root;
+}
+
+static std::vector<TestElement> CreateElements(const uint64_t first, const uint64_t numElements)
+{
+	std::vector<TestElement> elements;
+	for (uint64_t i = 0; i < numElements; i++)
+	{
+		elements.emplace_back(TestElement(first + i));
+	}
+
+	return elements;
+}
+
+TEST_CASE("PMMR - Append")
+{
+	const std::string directory = CreateTestDirectory();
+	const std::vector<TestElement> elements = CreateElements(1000, 37);
+	const std::vector<Hash> expectedHashes = CalculateHashes(elements);
+
+	SECTION("One at a time")
+	{
+		TestPMMR<false> mmr(directory);
+		for (size_t i = 0; i < elements.size(); i++)
+		{
+			REQUIRE(mmr.Append(elements[i]) == MMRUtil::GetPMMRIndex(i));
+		}
+
+		REQUIRE(mmr.GetSize() == expectedHashes.size());
+		REQUIRE(mmr.Root(mmr.GetSize()) == CalculateRoot(expectedHashes));
+		for (size_t i = 0; i < expectedHashes.size(); i++)
+		{
+			REQUIRE(mmr.GetHash(i) == expectedHashes[i]);
+		}
+	}
+
+	SECTION("In batches")
+	{
+		TestPMMR<true> mmr(directory);
+		REQUIRE(mmr.Append(std::vector<TestElement>()).empty());
+
+		const std::vector<uint64_t> first = mmr.Append(std::vector<TestElement>(elements.cbegin(), elements.cbegin() + 11));
+		const std::vector<uint64_t> second = mmr.Append(std::vector<TestElement>(elements.cbegin() + 11, elements.cend()));
+		REQUIRE(first.size() == 11);
+		REQUIRE(second.size() == 26);
+		REQUIRE(first.front() == 0);
+		REQUIRE(second.back() == MMRUtil::GetPMMRIndex(36));
+
+		REQUIRE(mmr.GetSize() == expectedHashes.size());
+		REQUIRE(mmr.Flush());
+
+		const std::vector<std::optional<Hash>> hashes = mmr.GetHashes(0, expectedHashes.size());
+		REQUIRE(std::equal(hashes.cbegin(), hashes.cend(), expectedHashes.cbegin(), expectedHashes.cend()));
+
+		for (size_t i = 0; i < elements.size(); i++)
+		{
+			std::unique_ptr<TestElement> pElement = mmr.GetAt(MMRUtil::GetPMMRIndex(i));
+			REQUIRE(pElement != nullptr);
+			REQUIRE(pElement->GetValue() == elements[i].GetValue());
+		}
+	}
+
+	std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("PMMR - Rewind")
+{
+	const std::string directory = CreateTestDirectory();
+	const std::vector<TestElement> elements = CreateElements(0, 20);
+	const std::vector<Hash> expectedHashes = CalculateHashes(std::vector<TestElement>(elements.cbegin(), elements.cbegin() + 10));
+	const uint64_t size = expectedHashes.size();
+
+	TestPMMR<true> mmr(directory);
+	mmr.Append(elements);
+	REQUIRE(mmr.Remove(MMRUtil::GetPMMRIndex(3)));
+	REQUIRE(mmr.Remove(MMRUtil::GetPMMRIndex(15)));
+	REQUIRE_FALSE(mmr.Remove(MMRUtil::GetPMMRIndex(15)));
+	REQUIRE(mmr.GetAt(MMRUtil::GetPMMRIndex(3)) == nullptr);
+	REQUIRE(mmr.Flush());
+
+	// Leaf 3 was spent after the block being rewound to.
+	REQUIRE(mmr.Rewind(size, std::vector<uint64_t>({ MMRUtil::GetPMMRIndex(3) })));
+	REQUIRE(mmr.Flush());
+	REQUIRE(mmr.GetSize() == size);
+	REQUIRE(mmr.Root(size) == CalculateRoot(expectedHashes));
+	REQUIRE(mmr.GetAt(MMRUtil::GetPMMRIndex(3)) != nullptr);
+	REQUIRE(mmr.GetAt(MMRUtil::GetPMMRIndex(9)) != nullptr);
+	REQUIRE(mmr.GetAt(MMRUtil::GetPMMRIndex(10)) == nullptr);
+
+	// Only the records of the remaining 10 leaves are kept.
+	REQUIRE(std::filesystem::file_size(directory + "test/pmmr_data.bin") == 10 * 16);
+	REQUIRE(std::filesystem::file_size(directory + "test/pmmr_hash.bin") == size * 32);
+
+	for (uint64_t i = 0; i < size; i++)
+	{
+		REQUIRE(mmr.GetHash(i) == expectedHashes[i]);
+	}
+
+	std::filesystem::remove_all(directory);
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <Catch2/catch.hpp>
 
 #include "../Common/PruneList.h"
+#include "../Common/MMRUtil.h"
 
 TEST_CASE("PruneList::IsPruned")
 {
@@ -36,6 +37,74 @@ TEST_CASE("PruneList::IsPrunedRoot")
 	REQUIRE(pruneList.IsPrunedRoot(7));
 }
 
+TEST_CASE("PruneList::GetShift")
+{
+	PruneList pruneList = PruneList::Load("C:\\FakeFile.txt");
+	pruneList.Add(0);
+	pruneList.Add(1);
+	REQUIRE(pruneList.GetShift(2) == 2);
+	REQUIRE(pruneList.GetLeafShift(2) == 2);
+
+	// Pruning leaf 10 appends a new root.
+	pruneList.Add(10);
+	REQUIRE(pruneList.GetShift(10) == 2);
+	REQUIRE(pruneList.GetLeafShift(10) == 2);
+
+	// Pruning leaves 3 and 4 merges everything up to node 6, which shifts every later root.
+	pruneList.Add(3);
+	pruneList.Add(4);
+	REQUIRE(pruneList.GetShift(6) == 6);
+	REQUIRE(pruneList.GetLeafShift(6) == 4);
+	REQUIRE(pruneList.GetShift(10) == 6);
+	REQUIRE(pruneList.GetLeafShift(10) == 4);
+	REQUIRE(pruneList.GetTotalShift() == 6);
+}
+
+TEST_CASE("PruneList::Discard")
+{
+	PruneList pruneList = PruneList::Load("C:\\FakeFile.txt");
+	pruneList.Add(0);
+	pruneList.Add(1);
+	pruneList.Add(10);
+	pruneList.Discard();
+	REQUIRE(!pruneList.IsPruned(0));
+	REQUIRE(!pruneList.IsPruned(2));
+	REQUIRE(pruneList.GetShift(10) == 0);
+	REQUIRE(pruneList.GetLeafShift(10) == 0);
+
+	pruneList.Add(3);
+	REQUIRE(pruneList.IsPrunedRoot(3));
+	REQUIRE(pruneList.GetShift(10) == 0);
+}
+
+TEST_CASE("PruneList - 64-bit positions")
+{
+	// Leaves 2^32 and 2^32 + 1 are siblings, so pruning both prunes their parent.
+	const uint64_t leafIndex = (uint64_t)1 << 32;
+	const uint64_t leftIndex = MMRUtil::GetPMMRIndex(leafIndex);
+	const uint64_t rightIndex = MMRUtil::GetPMMRIndex(leafIndex + 1);
+	const uint64_t parentIndex = MMRUtil::GetParentIndex(leftIndex);
+	REQUIRE(leftIndex > UINT32_MAX);
+
+	PruneList pruneList = PruneList::Load("C:\\FakeFile.txt");
+	pruneList.Add(0);
+	pruneList.Add(leftIndex);
+	pruneList.Add(rightIndex);
+	REQUIRE(pruneList.IsPruned(leftIndex));
+	REQUIRE(pruneList.IsPruned(rightIndex));
+	REQUIRE(pruneList.IsPrunedRoot(parentIndex));
+	REQUIRE(!pruneList.IsPrunedRoot(leftIndex));
+	REQUIRE(!pruneList.IsPruned(parentIndex + 1));
+
+	// Nodes in the lower 2^32 are unaffected.
+	REQUIRE(pruneList.IsPrunedRoot(0));
+	REQUIRE(!pruneList.IsPruned(1));
+	REQUIRE(pruneList.GetShift(leftIndex - 1) == 0);
+	REQUIRE(pruneList.GetShift(parentIndex) == 2);
+	REQUIRE(pruneList.GetLeafShift(parentIndex) == 2);
+	REQUIRE(pruneList.GetTotalShift() == 2);
+}
+
 //TEST_CASE("PruneList::PMMR_PRUN")
 //{
 //	Config config;
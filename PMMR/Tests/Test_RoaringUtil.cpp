@@ -0,0 +1,115 @@
+#include <Catch2/catch.hpp>
+
+#include "../Common/RoaringUtil.h"
+
+#include <chrono>
+
+TEST_CASE("RoaringUtil::AddRange")
+{
+	Roaring64Map bitmap;
+	RoaringUtil::AddRange(bitmap, 5, 10);
+	REQUIRE(bitmap.cardinality() == 5);
+	REQUIRE(bitmap.minimum() == 5);
+	REQUIRE(bitmap.maximum() == 9);
+
+	// Ranges spanning a 2^32 boundary include the last value of each chunk.
+	const uint64_t boundary = (uint64_t)1 << 32;
+	Roaring64Map spanning;
+	RoaringUtil::AddRange(spanning, boundary - 2, boundary + 2);
+	REQUIRE(spanning.cardinality() == 4);
+	REQUIRE(spanning.contains(boundary - 1));
+	REQUIRE(spanning.contains(boundary));
+	REQUIRE(!spanning.contains(boundary + 2));
+
+	// Existing values are kept, not flipped.
+	RoaringUtil::AddRange(bitmap, 8, 12);
+	REQUIRE(bitmap.cardinality() == 7);
+	REQUIRE(bitmap.contains((uint64_t)8));
+}
+
+TEST_CASE("RoaringUtil - 32-bit compatible serialization")
+{
+	Roaring bitmap32;
+	Roaring64Map bitmap64;
+	for (uint32_t i = 1; i < 100000; i += 3)
+	{
+		bitmap32.add(i);
+		bitmap64.add((uint64_t)i);
+	}
+
+	bitmap32.runOptimize();
+	std::vector<unsigned char> expected(bitmap32.getSizeInBytes());
+	bitmap32.write((char*)&expected[0]);
+
+	// Bitmaps that fit in 32 bits are written exactly as before.
+	const std::vector<unsigned char> serialized = RoaringUtil::Serialize(bitmap64);
+	REQUIRE(serialized == expected);
+
+	// Existing 32-bit files are still readable.
+	const Roaring64Map deserialized = RoaringUtil::Deserialize(expected);
+	REQUIRE(deserialized.cardinality() == bitmap32.cardinality());
+	REQUIRE(deserialized.contains((uint64_t)99997));
+	REQUIRE(!deserialized.contains((uint64_t)99998));
+
+	Roaring64Map empty;
+	REQUIRE(RoaringUtil::Deserialize(RoaringUtil::Serialize(empty)).isEmpty());
+}
+
+TEST_CASE("RoaringUtil - 64-bit serialization")
+{
+	const uint64_t large = ((uint64_t)1 << 32) + 7;
+
+	Roaring64Map bitmap;
+	bitmap.add((uint64_t)3);
+	bitmap.add(large);
+
+	const Roaring64Map deserialized = RoaringUtil::Deserialize(RoaringUtil::Serialize(bitmap));
+	REQUIRE(deserialized.cardinality() == 2);
+	REQUIRE(deserialized.contains((uint64_t)3));
+	REQUIRE(deserialized.contains(large));
+	REQUIRE(deserialized.maximum() == large);
+}
+
+//
+// Compares the per-operation cost of the 64-bit bitmaps against the 32-bit ones they replaced.
+// Benchmarks are hidden by default. Run with: PMMR_TESTS "[benchmark]"
+//
+template<class F>
+static uint64_t TimeMicros(const F& func)
+{
+	const auto start = std::chrono::steady_clock::now();
+	func();
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+TEST_CASE("RoaringUtil - Benchmark", "[.][benchmark]")
+{
+	const uint32_t numPositions = 1 << 22;
+	Roaring bitmap32;
+	Roaring64Map bitmap64;
+	uint64_t sum32 = 0;
+	uint64_t sum64 = 0;
+
+	const uint64_t add32 = TimeMicros([&] { for (uint32_t i = 1; i < numPositions; i += 2) { bitmap32.add(i); } });
+	const uint64_t add64 = TimeMicros([&] { for (uint64_t i = 1; i < numPositions; i += 2) { bitmap64.add(i); } });
+	WARN("add: 32-bit " << add32 << "us, 64-bit " << add64 << "us");
+
+	const uint64_t contains32 = TimeMicros([&] { for (uint32_t i = 0; i < numPositions; i++) { sum32 += bitmap32.contains(i) ? 1 : 0; } });
+	const uint64_t contains64 = TimeMicros([&] { for (uint64_t i = 0; i < numPositions; i++) { sum64 += bitmap64.contains(i) ? 1 : 0; } });
+	WARN("contains: 32-bit " << contains32 << "us, 64-bit " << contains64 << "us");
+
+	const uint64_t rank32 = TimeMicros([&] { for (uint32_t i = 0; i < numPositions; i += 16) { sum32 += bitmap32.rank(i); } });
+	const uint64_t rank64 = TimeMicros([&] { for (uint64_t i = 0; i < numPositions; i += 16) { sum64 += bitmap64.rank(i); } });
+	WARN("rank: 32-bit " << rank32 << "us, 64-bit " << rank64 << "us");
+
+	const uint64_t serialize32 = TimeMicros([&] {
+		bitmap32.runOptimize();
+		std::vector<unsigned char> buffer(bitmap32.getSizeInBytes());
+		bitmap32.write((char*)&buffer[0]);
+		sum32 += buffer.size();
+	});
+	const uint64_t serialize64 = TimeMicros([&] { sum64 += RoaringUtil::Serialize(bitmap64).size(); });
+	WARN("serialize: 32-bit " << serialize32 << "us, 64-bit " << serialize64 << "us");
+
+	REQUIRE(sum32 == sum64);
+}
\ No newline at end of file
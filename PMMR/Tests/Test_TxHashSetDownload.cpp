@@ -0,0 +1,95 @@
+#include <Catch2/catch.hpp>
+
+#include "../TxHashSetDownload.h"
+#include "../Zip/ZipWriter.h"
+
+#include <BlockChainServer.h>
+#include <Config/Genesis.h>
+#include <HexUtil.h>
+#include <filesystem>
+#include <fstream>
+
+// Only the header lookups are used while validating, and there are no headers.
+class TestBlockChainServer : public IBlockChainServer
+{
+public:
+	virtual uint64_t GetHeight(const EChainType) const override final { return 0; }
+	virtual uint64_t GetTotalDifficulty(const EChainType) const override final { return 0; }
+	virtual EBlockChainStatus AddBlock(const FullBlock&) override final { return EBlockChainStatus::UNKNOWN_ERROR; }
+	virtual EBlockChainStatus AddCompactBlock(const CompactBlock&) override final { return EBlockChainStatus::UNKNOWN_ERROR; }
+	virtual bool HasOrphan(const Hash&) const override final { return false; }
+	virtual EBlockChainStatus ProcessTransactionHashSet(const Hash&, const std::string&) override final { return EBlockChainStatus::UNKNOWN_ERROR; }
+	virtual std::unique_ptr<ITxHashSetDownload> StartTxHashSetDownload(const Hash&) override final { return std::unique_ptr<ITxHashSetDownload>(nullptr); }
+	virtual EBlockChainStatus FinishTxHashSetDownload(const Hash&, std::unique_ptr<ITxHashSetDownload>) override final { return EBlockChainStatus::UNKNOWN_ERROR; }
+	virtual EBlockChainStatus AddTransaction(const Transaction&) override final { return EBlockChainStatus::UNKNOWN_ERROR; }
+	virtual std::unique_ptr<BlockHeader> GetTxHashSetArchive(std::string&) const override final { return std::unique_ptr<BlockHeader>(nullptr); }
+	virtual EBlockChainStatus AddBlockHeader(const BlockHeader&) override final { return EBlockChainStatus::UNKNOWN_ERROR; }
+	virtual EBlockChainStatus AddBlockHeaders(const std::vector<BlockHeader>&) override final { return EBlockChainStatus::UNKNOWN_ERROR; }
+	virtual std::unique_ptr<BlockHeader> GetBlockHeaderByHeight(const uint64_t, const EChainType) const override final { return std::unique_ptr<BlockHeader>(nullptr); }
+	virtual std::unique_ptr<BlockHeader> GetBlockHeaderByHash(const Hash&) const override final { return std::unique_ptr<BlockHeader>(nullptr); }
+	virtual std::shared_ptr<const BlockHeader> GetSharedBlockHeaderByHeight(const uint64_t, const EChainType) const override final { return std::shared_ptr<const BlockHeader>(nullptr); }
+	virtual std::shared_ptr<const BlockHeader> GetSharedBlockHeaderByHash(const Hash&) const override final { return std::shared_ptr<const BlockHeader>(nullptr); }
+	virtual std::unique_ptr<BlockHeader> GetBlockHeaderByCommitment(const Hash&) const override final { return std::unique_ptr<BlockHeader>(nullptr); }
+	virtual std::vector<BlockHeader> GetBlockHeadersByHash(const std::vector<Hash>&) const override final { return std::vector<BlockHeader>(); }
+};
+
+//
+// Downloads a zip whose output leaf set is corrupt, so deserializing it throws while the output MMR is validated.
+// The download must just be invalid, rather than rethrowing (and terminating when it's destroyed).
+//
+TEST_CASE("TxHashSetDownload - Corrupt leaf set")
+{
+	const std::string dataDirectory = (std::filesystem::temp_directory_path() / "GrinPlusPlus_TxHashSetDownload").string() + "/";
+	const Config config(EClientMode::FAST_SYNC, Environment(Genesis::FLOONET_GENESIS), dataDirectory, DandelionConfig(10, 30, 10, 90), P2PConfig(), ChainConfig());
+	const BlockHeader& header = Genesis::FLOONET_GENESIS.GetBlockHeader();
+	const std::string leafFile = "pmmr_leaf.bin." + HexUtil::ConvertHash(header.GetHash());
+
+	// Starts with CRoaring's cookie, but claims far more containers than follow it.
+	const std::vector<unsigned char> corruptLeafSet = { 0x3A, 0x30, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x7F, 0x01, 0x02, 0x03 };
+
+	std::filesystem::create_directories(dataDirectory);
+	const std::string zipPath = dataDirectory + "txhashset.zip";
+	ZipWriter zipWriter(zipPath);
+	REQUIRE(zipWriter.Open() == EZipFileStatus::SUCCESS);
+	REQUIRE(zipWriter.AddData("kernel/pmmr_hash.bin", std::vector<unsigned char>()) == EZipFileStatus::SUCCESS);
+	REQUIRE(zipWriter.AddData("kernel/pmmr_data.bin", std::vector<unsigned char>()) == EZipFileStatus::SUCCESS);
+	for (const std::string& folder : { std::string("output"), std::string("rangeproof") })
+	{
+		REQUIRE(zipWriter.AddData(folder + "/pmmr_hash.bin", std::vector<unsigned char>()) == EZipFileStatus::SUCCESS);
+		REQUIRE(zipWriter.AddData(folder + "/pmmr_data.bin", std::vector<unsigned char>()) == EZipFileStatus::SUCCESS);
+		REQUIRE(zipWriter.AddData(folder + "/pmmr_prun.bin", std::vector<unsigned char>()) == EZipFileStatus::SUCCESS);
+		REQUIRE(zipWriter.AddData(folder + "/" + leafFile, folder == "output" ? corruptLeafSet : std::vector<unsigned char>()) == EZipFileStatus::SUCCESS);
+	}
+	REQUIRE(zipWriter.Close() == EZipFileStatus::SUCCESS);
+
+	std::ifstream zipFile(zipPath, std::ios::in | std::ios::binary);
+	const std::vector<unsigned char> zipBytes((std::istreambuf_iterator<char>(zipFile)), std::istreambuf_iterator<char>());
+	zipFile.close();
+	std::filesystem::remove(zipPath);
+
+	TestBlockChainServer blockChainServer;
+
+	SECTION("Finish fails")
+	{
+		TxHashSetDownload download(config, header, blockChainServer);
+		REQUIRE(download.Initialize());
+		REQUIRE(download.Write(zipBytes.data(), zipBytes.size()));
+
+		Commitment outputSum(CBigInteger<33>::ValueOf(0));
+		Commitment kernelSum(CBigInteger<33>::ValueOf(0));
+		REQUIRE_FALSE(download.Finish(outputSum, kernelSum));
+		REQUIRE(download.Install() == nullptr);
+	}
+
+	SECTION("Destroyed without finishing")
+	{
+		std::unique_ptr<TxHashSetDownload> pDownload = std::make_unique<TxHashSetDownload>(config, header, blockChainServer);
+		REQUIRE(pDownload->Initialize());
+		REQUIRE(pDownload->Write(zipBytes.data(), zipBytes.size()));
+
+		// Waits for the failed validation.
+		pDownload.reset();
+	}
+
+	std::filesystem::remove_all(dataDirectory);
+}
\ No newline at end of file
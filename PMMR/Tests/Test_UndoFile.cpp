@@ -0,0 +1,96 @@
+#include <Catch2/catch.hpp>
+
+#include "../Common/UndoFile.h"
+
+#include <filesystem>
+#include <fstream>
+
+static std::string CreateUndoFile(const std::string& name, const uint64_t numBlocks)
+{
+	const std::string directory = (std::filesystem::temp_directory_path() / "GrinPlusPlus_UndoFile").string() + "/";
+	std::filesystem::create_directories(directory);
+
+	const std::string path = directory + name;
+	std::filesystem::remove(path);
+	std::filesystem::remove(path + ".trim");
+
+	UndoFile undoFile(path);
+	undoFile.Load();
+	for (uint64_t height = 1; height <= numBlocks; height++)
+	{
+		undoFile.AddBlockUndo(BlockUndo(height, height * 10, std::vector<uint64_t>({ height, height + 100 })));
+	}
+
+	undoFile.Flush();
+	return path;
+}
+
+TEST_CASE("UndoFile::PrepareTrim - Removes records at or below height")
+{
+	const std::string path = CreateUndoFile("undo_trim.bin", 10);
+
+	UndoFile undoFile(path);
+	undoFile.Load();
+	const uint64_t originalSize = undoFile.GetFile().GetSize();
+
+	CommitJournal journal(path + ".journal");
+	REQUIRE(undoFile.PrepareTrim(4, journal));
+
+	// Nothing changes until the trim is committed.
+	REQUIRE(undoFile.GetFile().GetSize() == originalSize);
+	REQUIRE(undoFile.GetBlockUndosAfter(0).size() == 10);
+
+	REQUIRE(undoFile.CommitTrim());
+	REQUIRE(undoFile.GetFile().GetSize() < originalSize);
+
+	const std::vector<BlockUndo> blockUndos = undoFile.GetBlockUndosAfter(0);
+	REQUIRE(blockUndos.size() == 6);
+	REQUIRE(blockUndos.front().GetHeight() == 10);
+	REQUIRE(blockUndos.back().GetHeight() == 5);
+	REQUIRE(blockUndos.back().GetOutputMMRSize() == 50);
+	REQUIRE(blockUndos.back().GetSpentPositions() == std::vector<uint64_t>({ 5, 105 }));
+
+	// The trimmed file can still be popped, and appended to.
+	std::unique_ptr<BlockUndo> pBlockUndo = undoFile.PopBlockUndo();
+	REQUIRE(pBlockUndo != nullptr);
+	REQUIRE(pBlockUndo->GetHeight() == 10);
+
+	undoFile.AddBlockUndo(BlockUndo(10, 100, std::vector<uint64_t>()));
+	undoFile.Flush();
+	REQUIRE(undoFile.GetBlockUndosAfter(4).size() == 6);
+}
+
+TEST_CASE("UndoFile::PrepareTrim - Nothing to trim")
+{
+	const std::string path = CreateUndoFile("undo_untrimmed.bin", 10);
+
+	UndoFile undoFile(path);
+	undoFile.Load();
+
+	CommitJournal journal(path + ".journal");
+	REQUIRE(!undoFile.PrepareTrim(0, journal));
+
+	// Uncommitted changes must be committed or discarded first.
+	undoFile.AddBlockUndo(BlockUndo(11, 110, std::vector<uint64_t>()));
+	REQUIRE(!undoFile.PrepareTrim(5, journal));
+}
+
+TEST_CASE("UndoFile::PopBlockUndo - Corrupt record")
+{
+	const std::string path = CreateUndoFile("undo_corrupt.bin", 3);
+
+	// A record too short to be a BlockUndo, followed by its size.
+	{
+		std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::app);
+		const unsigned char record[12] = { 1, 2, 3, 4, 0, 0, 0, 0, 0, 0, 0, 4 };
+		file.write((const char*)record, sizeof(record));
+	}
+
+	UndoFile undoFile(path);
+	undoFile.Load();
+	const uint64_t size = undoFile.GetFile().GetSize();
+
+	REQUIRE(undoFile.PopBlockUndo() == nullptr);
+	REQUIRE(undoFile.GetFile().GetSize() == size);
+	REQUIRE(undoFile.GetBlockUndosAfter(0).empty());
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include <Catch2/catch.hpp>
+
+#include "../Zip/ZipStreamReader.h"
+#include "../Zip/ZipWriter.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <map>
+
+class TestListener : public IZipStreamListener
+{
+public:
+	virtual bool OnEntryStarted(const std::string& path) override final
+	{
+		m_currentPath = path;
+		m_entries[path] = std::vector<unsigned char>();
+		return true;
+	}
+
+	virtual bool OnEntryData(const unsigned char* pData, const size_t numBytes) override final
+	{
+		std::vector<unsigned char>& entry = m_entries[m_currentPath];
+		entry.insert(entry.end(), pData, pData + numBytes);
+		return true;
+	}
+
+	virtual bool OnEntryFinished(const std::string& path) override final
+	{
+		m_numFinished++;
+		return path == m_currentPath;
+	}
+
+	std::map<std::string, std::vector<unsigned char>> m_entries;
+	std::string m_currentPath;
+	size_t m_numFinished = 0;
+};
+
+static std::vector<unsigned char> ReadFile(const std::string& path)
+{
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+	return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+//
+// Writes a zip with ZipWriter, then extracts it with a ZipStreamReader, a few random bytes at a time.
+//
+TEST_CASE("ZipStreamReader")
+{
+	std::mt19937_64 random(42);
+
+	std::map<std::string, std::vector<unsigned char>> entries;
+	entries["kernel/pmmr_hash.bin"] = std::vector<unsigned char>(100000);
+	entries["kernel/pmmr_data.bin"] = std::vector<unsigned char>(3000000, 7);
+	entries["output/pmmr_prun.bin"] = std::vector<unsigned char>();
+	for (unsigned char& byte : entries["kernel/pmmr_hash.bin"])
+	{
+		byte = (unsigned char)random();
+	}
+
+	const std::string zipPath = (std::filesystem::temp_directory_path() / "GrinPlusPlus_ZipStreamReader.zip").string();
+	ZipWriter zipWriter(zipPath);
+	REQUIRE(zipWriter.Open() == EZipFileStatus::SUCCESS);
+	for (const auto& entry : entries)
+	{
+		REQUIRE(zipWriter.AddData(entry.first, entry.second) == EZipFileStatus::SUCCESS);
+	}
+	REQUIRE(zipWriter.Close() == EZipFileStatus::SUCCESS);
+
+	std::vector<unsigned char> zipBytes = ReadFile(zipPath);
+	std::filesystem::remove(zipPath);
+
+	SECTION("Extracts every entry")
+	{
+		TestListener listener;
+		ZipStreamReader zipReader(listener);
+
+		size_t offset = 0;
+		while (offset < zipBytes.size())
+		{
+			const size_t numBytes = (std::min)((size_t)(1 + random() % 50000), zipBytes.size() - offset);
+			REQUIRE(zipReader.Write(&zipBytes[offset], numBytes));
+			offset += numBytes;
+		}
+
+		REQUIRE(zipReader.IsFinished());
+		REQUIRE(listener.m_numFinished == entries.size());
+		REQUIRE(listener.m_entries == entries);
+	}
+
+	SECTION("Rejects corrupted data")
+	{
+		zipBytes[zipBytes.size() / 3] ^= 0x55;
+
+		TestListener listener;
+		ZipStreamReader zipReader(listener);
+		REQUIRE_FALSE(zipReader.Write(zipBytes.data(), zipBytes.size()));
+		REQUIRE_FALSE(zipReader.IsFinished());
+		REQUIRE_FALSE(zipReader.Write(zipBytes.data(), zipBytes.size()));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Common/PMMRCompaction.h"
+
+#include <TxHashSet.h>
+#include <memory>
+
+class TxHashSetCompaction : public ITxHashSetCompaction
+{
+public:
+	TxHashSetCompaction(const uint64_t horizonHeight, std::unique_ptr<PMMRCompaction>&& pOutputCompaction, std::unique_ptr<PMMRCompaction>&& pRangeProofCompaction)
+		: m_horizonHeight(horizonHeight), m_pOutputCompaction(std::move(pOutputCompaction)), m_pRangeProofCompaction(std::move(pRangeProofCompaction)), m_rewritten(false)
+	{
+
+	}
+
+	virtual bool Run() override final
+	{
+		m_rewritten = m_pOutputCompaction->Rewrite() && m_pRangeProofCompaction->Rewrite();
+		return m_rewritten;
+	}
+
+	inline uint64_t GetHorizonHeight() const { return m_horizonHeight; }
+	inline bool IsRewritten() const { return m_rewritten; }
+	inline PMMRCompaction& GetOutputCompaction() { return *m_pOutputCompaction; }
+	inline PMMRCompaction& GetRangeProofCompaction() { return *m_pRangeProofCompaction; }
+
+private:
+	const uint64_t m_horizonHeight;
+	std::unique_ptr<PMMRCompaction> m_pOutputCompaction;
+	std::unique_ptr<PMMRCompaction> m_pRangeProofCompaction;
+	bool m_rewritten;
+};
\ No newline at end of file
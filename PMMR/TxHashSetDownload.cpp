@@ -0,0 +1,326 @@
+#include "TxHashSetDownload.h"
+#include "TxHashSetImpl.h"
+#include "TxHashSetValidator.h"
+
+#include <HexUtil.h>
+#include <FileUtil.h>
+#include <Infrastructure/Logger.h>
+#include <filesystem>
+#include <algorithm>
+
+// The files are validated as they were sent, so a corrupt file can make validation throw (ie. when deserializing its leaf set).
+// That just means the download is invalid, so it's logged and treated as a failure, rather than being rethrown by WaitForValidation.
+template<typename VALIDATE>
+static bool CatchExceptions(const std::string& description, const VALIDATE& validate)
+{
+	try
+	{
+		return validate();
+	}
+	catch (const std::exception& e)
+	{
+		LoggerAPI::LogError("TxHashSetDownload - Exception thrown while validating " + description + ": " + e.what());
+	}
+	catch (...)
+	{
+		LoggerAPI::LogError("TxHashSetDownload - Unknown exception thrown while validating " + description + ".");
+	}
+
+	return false;
+}
+
+TxHashSetDownload::TxHashSetDownload(const Config& config, const BlockHeader& header, const IBlockChainServer& blockChainServer)
+	: m_config(config), m_header(header), m_blockChainServer(blockChainServer), m_stagingDirectory(config.GetTxHashSetDirectory() + "download/"), m_validated(false), m_zipReader(*this)
+{
+	const std::string& txHashSetDir = m_stagingDirectory;
+	const std::string leafFile = "pmmr_leaf.bin." + HexUtil::ConvertHash(header.GetHash());
+
+	m_destinations["kernel/pmmr_hash.bin"] = txHashSetDir + "kernel/pmmr_hash.bin";
+	m_destinations["kernel/pmmr_data.bin"] = txHashSetDir + "kernel/pmmr_data.bin";
+
+	for (const std::string& folder : { std::string("output"), std::string("rangeproof") })
+	{
+		m_destinations[folder + "/pmmr_hash.bin"] = txHashSetDir + folder + "/pmmr_hash.bin";
+		m_destinations[folder + "/pmmr_data.bin"] = txHashSetDir + folder + "/pmmr_data.bin";
+		m_destinations[folder + "/pmmr_prun.bin"] = txHashSetDir + folder + "/pmmr_prun.bin";
+
+		// The leaf set is named after the block in the zip.
+		m_destinations[folder + "/" + leafFile] = txHashSetDir + folder + "/pmmr_leaf.bin";
+	}
+
+	m_pendingFolders = { "kernel", "output", "rangeproof" };
+}
+
+TxHashSetDownload::~TxHashSetDownload()
+{
+	// The tasks still reference this download.
+	WaitForValidation();
+
+	// Anything that wasn't installed is discarded.
+	m_file.close();
+	m_pKernelMMR.reset();
+	m_pOutputPMMR.reset();
+	m_pRangeProofPMMR.reset();
+
+	std::error_code errorCode;
+	std::filesystem::remove_all(m_stagingDirectory, errorCode);
+}
+
+bool TxHashSetDownload::Initialize()
+{
+	std::error_code errorCode;
+	const uint64_t removedFiles = std::filesystem::remove_all(m_stagingDirectory, errorCode);
+	LoggerAPI::LogDebug("TxHashSetDownload::Initialize - " + std::to_string(removedFiles) + " files removed from " + m_stagingDirectory + " with error_code " + std::to_string(errorCode.value()));
+
+	for (const std::string& folder : m_pendingFolders)
+	{
+		const std::filesystem::path folderPath(m_stagingDirectory + folder);
+		if (!std::filesystem::create_directories(folderPath, errorCode))
+		{
+			LoggerAPI::LogError("TxHashSetDownload::Initialize - Failed to create " + folder + " folder.");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool TxHashSetDownload::Write(const unsigned char* pData, const size_t numBytes)
+{
+	return m_zipReader.Write(pData, numBytes);
+}
+
+bool TxHashSetDownload::Finish(Commitment& outputSumOut, Commitment& kernelSumOut)
+{
+	const bool extracted = m_zipReader.IsFinished() && m_pendingFolders.empty();
+	if (!extracted)
+	{
+		LoggerAPI::LogError("TxHashSetDownload::Finish - TxHashSet zip is incomplete.");
+	}
+
+	// Always wait, since the tasks may still be running.
+	const bool validated = WaitForValidation();
+	if (!extracted || !validated)
+	{
+		return false;
+	}
+
+	LoggerAPI::LogInfo("TxHashSetDownload::Finish - MMRs validated. Validating kernel sums.");
+
+	const TxHashSetValidationResult result = TxHashSetValidator(m_blockChainServer).ValidateKernelSums(*m_pKernelMMR, *m_pOutputPMMR, m_header);
+
+	// The files must be closed before their folders can be moved by Install().
+	m_pKernelMMR.reset();
+	m_pOutputPMMR.reset();
+	m_pRangeProofPMMR.reset();
+
+	if (!result.Successful())
+	{
+		return false;
+	}
+
+	outputSumOut = result.GetOutputSum();
+	kernelSumOut = result.GetKernelSum();
+	m_validated = true;
+
+	LoggerAPI::LogInfo("TxHashSetDownload::Finish - Successfully validated TxHashSet for block " + HexUtil::ConvertHash(m_header.GetHash()));
+	return true;
+}
+
+ITxHashSet* TxHashSetDownload::Install()
+{
+	if (!m_validated)
+	{
+		LoggerAPI::LogError("TxHashSetDownload::Install - TxHashSet has not been validated.");
+		return nullptr;
+	}
+
+	const std::string txHashSetDirectory = m_config.GetTxHashSetDirectory();
+	const std::string replacedDirectory = m_stagingDirectory + "replaced/";
+
+	// The existing folders are moved aside first, so they can be restored if the new ones can't be moved into place.
+	if (!MoveFolders(txHashSetDirectory, replacedDirectory) || !MoveFolders(m_stagingDirectory, txHashSetDirectory))
+	{
+		LoggerAPI::LogError("TxHashSetDownload::Install - Failed to install TxHashSet. Restoring existing files.");
+		MoveFolders(replacedDirectory, txHashSetDirectory);
+		return nullptr;
+	}
+
+	// Any unfinished commit, undo data, and output positions belong to the replaced TxHashSet.
+	FileUtil::RemoveFile(TxHashSet::GetJournalPath(m_config));
+	FileUtil::RemoveFile(TxHashSet::GetUndoPath(m_config));
+	FileUtil::RemoveFile(TxHashSet::GetOutputPositionsPath(m_config));
+
+	std::error_code errorCode;
+	std::filesystem::remove_all(m_stagingDirectory, errorCode);
+
+	return TxHashSetAPI::Open(m_config);
+}
+
+bool TxHashSetDownload::OnEntryStarted(const std::string& path)
+{
+	auto iter = m_destinations.find(path);
+	if (iter == m_destinations.end())
+	{
+		LoggerAPI::LogDebug("TxHashSetDownload::OnEntryStarted - Skipping unexpected file " + path);
+		return true;
+	}
+
+	m_file.open(iter->second, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!m_file.is_open())
+	{
+		LoggerAPI::LogError("TxHashSetDownload::OnEntryStarted - Failed to open " + iter->second);
+		return false;
+	}
+
+	return true;
+}
+
+bool TxHashSetDownload::OnEntryData(const unsigned char* pData, const size_t numBytes)
+{
+	if (m_file.is_open())
+	{
+		m_file.write((const char*)pData, numBytes);
+		return m_file.good();
+	}
+
+	return true;
+}
+
+bool TxHashSetDownload::OnEntryFinished(const std::string& path)
+{
+	if (!m_file.is_open())
+	{
+		return true;
+	}
+
+	m_file.close();
+	if (m_file.fail())
+	{
+		LoggerAPI::LogError("TxHashSetDownload::OnEntryFinished - Failed to write " + path);
+		return false;
+	}
+
+	m_destinations.erase(path);
+
+	// Start validating any folder that's now complete.
+	auto folderIter = m_pendingFolders.begin();
+	while (folderIter != m_pendingFolders.end())
+	{
+		const std::string folderPrefix = *folderIter + "/";
+		const bool complete = std::none_of(m_destinations.cbegin(), m_destinations.cend(),
+			[&folderPrefix](const std::pair<const std::string, std::string>& destination) { return destination.first.compare(0, folderPrefix.size(), folderPrefix) == 0; }
+		);
+
+		if (complete)
+		{
+			StartValidation(*folderIter);
+			folderIter = m_pendingFolders.erase(folderIter);
+		}
+		else
+		{
+			folderIter++;
+		}
+	}
+
+	return true;
+}
+
+void TxHashSetDownload::StartValidation(const std::string& folder)
+{
+	LoggerAPI::LogInfo("TxHashSetDownload::StartValidation - Extracted " + folder + " folder. Validating now.");
+
+	if (folder == "kernel")
+	{
+		m_kernelTask = async::spawn([this] {
+			return CatchExceptions("kernel MMR", [this] {
+				m_pKernelMMR = std::unique_ptr<KernelMMR>(KernelMMR::Load(m_stagingDirectory));
+				m_pKernelMMR->Rewind(m_header.GetKernelMMRSize());
+				m_pKernelMMR->Flush();
+
+				return TxHashSetValidator(m_blockChainServer).ValidateKernelMMR(*m_pKernelMMR, m_header);
+			});
+		});
+	}
+	else if (folder == "output")
+	{
+		m_outputTask = async::spawn([this] {
+			return CatchExceptions("output MMR", [this] {
+				m_pOutputPMMR = std::unique_ptr<OutputPMMR>(OutputPMMR::Load(m_stagingDirectory));
+				m_pOutputPMMR->Rewind(m_header.GetOutputMMRSize());
+				m_pOutputPMMR->Flush();
+
+				return TxHashSetValidator(m_blockChainServer).ValidateOutputPMMR(*m_pOutputPMMR, m_header);
+			});
+		});
+	}
+	else if (folder == "rangeproof")
+	{
+		m_rangeProofTask = async::spawn([this] {
+			return CatchExceptions("rangeproof MMR", [this] {
+				m_pRangeProofPMMR = std::unique_ptr<RangeProofPMMR>(RangeProofPMMR::Load(m_stagingDirectory));
+				m_pRangeProofPMMR->Rewind(m_header.GetOutputMMRSize());
+				m_pRangeProofPMMR->Flush();
+
+				return TxHashSetValidator(m_blockChainServer).ValidateRangeProofPMMR(*m_pRangeProofPMMR, m_header);
+			});
+		});
+	}
+
+	// The rangeproofs can be validated once both the output and rangeproof MMRs are loaded.
+	if (m_outputTask.valid() && m_rangeProofTask.valid())
+	{
+		m_rangeProofsTask = async::when_all(std::move(m_outputTask), std::move(m_rangeProofTask)).then(
+			[this](std::tuple<async::task<bool>, async::task<bool>> results) -> bool {
+			return CatchExceptions("rangeproofs", [this, &results] {
+				const bool outputValid = std::get<0>(results).get();
+				const bool rangeProofValid = std::get<1>(results).get();
+
+				return outputValid && rangeProofValid && TxHashSetValidator(m_blockChainServer).ValidateRangeProofs(*m_pOutputPMMR, *m_pRangeProofPMMR);
+			});
+		});
+	}
+}
+
+// Waits for every validation task that has been started. Returns false if any of them failed.
+// Never throws, since it's called by the destructor.
+bool TxHashSetDownload::WaitForValidation()
+{
+	bool valid = true;
+	for (async::task<bool>* pTask : { &m_kernelTask, &m_outputTask, &m_rangeProofTask, &m_rangeProofsTask })
+	{
+		if (pTask->valid())
+		{
+			valid = CatchExceptions("TxHashSet", [pTask] { return pTask->get(); }) && valid;
+		}
+	}
+
+	return valid;
+}
+
+// Moves the kernel, output, and rangeproof folders (those that exist) between directories, replacing any already at the destination.
+bool TxHashSetDownload::MoveFolders(const std::string& fromDirectory, const std::string& toDirectory) const
+{
+	std::error_code errorCode;
+	std::filesystem::create_directories(toDirectory, errorCode);
+
+	for (const std::string& folder : { std::string("kernel"), std::string("output"), std::string("rangeproof") })
+	{
+		const std::filesystem::path fromPath(fromDirectory + folder);
+		if (!std::filesystem::exists(fromPath, errorCode))
+		{
+			continue;
+		}
+
+		const std::filesystem::path toPath(toDirectory + folder);
+		std::filesystem::remove_all(toPath, errorCode);
+		std::filesystem::rename(fromPath, toPath, errorCode);
+		if (errorCode)
+		{
+			LoggerAPI::LogError("TxHashSetDownload::MoveFolders - Failed to move " + fromDirectory + folder + " with error_code " + std::to_string(errorCode.value()));
+			return false;
+		}
+	}
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "KernelMMR.h"
+#include "OutputPMMR.h"
+#include "RangeProofPMMR.h"
+#include "Zip/ZipStreamReader.h"
+
+#include <TxHashSet.h>
+#include <Core/BlockHeader.h>
+#include <Config/Config.h>
+#include <async++.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+// Forward Declarations
+class IBlockChainServer;
+
+//
+// Extracts a TxHashSet zip straight into staging kernel, output, and rangeproof folders as it's downloaded,
+// so the zip itself is never written to disk, and the existing TxHashSet stays intact until Install().
+// As soon as every file of a folder has been extracted, that MMR is loaded and validated in the background:
+// the kernel MMR (hashes, roots, kernel history, and signatures) as soon as the kernel folder is complete,
+// each of the output and rangeproof MMRs (hashes and roots) as soon as its own folder is complete,
+// and then the rangeproofs of all unspent outputs once both of those are complete.
+// Only the kernel sums, which need all 3 MMRs, are left for Finish().
+//
+class TxHashSetDownload : public ITxHashSetDownload, public IZipStreamListener
+{
+public:
+	TxHashSetDownload(const Config& config, const BlockHeader& header, const IBlockChainServer& blockChainServer);
+	~TxHashSetDownload();
+
+	//
+	// Deletes anything left in the staging folder by an earlier download, and creates empty kernel, output, and rangeproof folders to extract into.
+	//
+	bool Initialize();
+
+	virtual bool Write(const unsigned char* pData, const size_t numBytes) override final;
+	virtual bool Finish(Commitment& outputSumOut, Commitment& kernelSumOut) override final;
+	virtual ITxHashSet* Install() override final;
+
+	virtual bool OnEntryStarted(const std::string& path) override final;
+	virtual bool OnEntryData(const unsigned char* pData, const size_t numBytes) override final;
+	virtual bool OnEntryFinished(const std::string& path) override final;
+
+private:
+	void StartValidation(const std::string& folder);
+	bool WaitForValidation();
+	bool MoveFolders(const std::string& fromDirectory, const std::string& toDirectory) const;
+
+	const Config& m_config;
+	const BlockHeader m_header;
+	const IBlockChainServer& m_blockChainServer;
+
+	// The files are extracted here, and only moved into the TxHashSet directory by Install().
+	const std::string m_stagingDirectory;
+
+	// Set once Finish() has validated the download.
+	bool m_validated;
+
+	ZipStreamReader m_zipReader;
+
+	// The destination of each file (by its path in the zip) that hasn't been extracted yet.
+	std::map<std::string, std::string> m_destinations;
+
+	// The folders whose files haven't all been extracted yet, so their validation hasn't started.
+	std::vector<std::string> m_pendingFolders;
+
+	// The file currently being extracted. Not open while skipping unexpected entries.
+	std::ofstream m_file;
+
+	// The MMRs are loaded by their validation tasks, and closed by Finish() so their folders can be moved.
+	std::unique_ptr<KernelMMR> m_pKernelMMR;
+	std::unique_ptr<OutputPMMR> m_pOutputPMMR;
+	std::unique_ptr<RangeProofPMMR> m_pRangeProofPMMR;
+
+	async::task<bool> m_kernelTask;
+	async::task<bool> m_outputTask;
+	async::task<bool> m_rangeProofTask;
+
+	// Validates the rangeproofs once both the output and rangeproof tasks have finished. Takes over both of those tasks.
+	async::task<bool> m_rangeProofsTask;
+};
\ No newline at end of file
@@ -1,45 +1,65 @@
 #include "TxHashSetImpl.h"
 #include "TxHashSetValidator.h"
-#include "Zip/TxHashSetZip.h"
+#include "TxHashSetDownload.h"
+#include "Zip/TxHashSetArchive.h"
 
 #include <HexUtil.h>
 #include <FileUtil.h>
 #include <StringUtil.h>
 #include <BlockChainServer.h>
-#include <Database/BlockDb.h>
 #include <Infrastructure/Logger.h>
 
-TxHashSet::TxHashSet(IBlockDB& blockDB, KernelMMR* pKernelMMR, OutputPMMR* pOutputPMMR, RangeProofPMMR* pRangeProofPMMR)
-	: m_blockDB(blockDB), m_pKernelMMR(pKernelMMR), m_pOutputPMMR(pOutputPMMR), m_pRangeProofPMMR(pRangeProofPMMR)
+TxHashSet::TxHashSet(const Config& config, KernelMMR* pKernelMMR, OutputPMMR* pOutputPMMR, RangeProofPMMR* pRangeProofPMMR, UndoFile&& undoFile)
+	: m_config(config), m_pKernelMMR(pKernelMMR), m_pOutputPMMR(pOutputPMMR), m_pRangeProofPMMR(pRangeProofPMMR), m_undoFile(std::move(undoFile))
 {
-
+	if (!m_outputPositions.Load(GetOutputPositionsPath(m_config), m_pOutputPMMR->GetSize()))
+	{
+		BuildOutputPositions();
+	}
 }
 
 TxHashSet::~TxHashSet()
 {
+	// Only committed changes belong in the snapshot.
+	Discard();
+	if (!m_outputPositions.Save(GetOutputPositionsPath(m_config), m_pOutputPMMR->GetSize()))
+	{
+		LoggerAPI::LogWarning("TxHashSet::~TxHashSet - Failed to save output positions. They will be rebuilt on the next start.");
+	}
+
+	delete m_pKernelMMR;
 	delete m_pOutputPMMR;
+	delete m_pRangeProofPMMR;
 }
 
+// The output position index only holds unspent outputs, so this never has to read the output MMR.
 bool TxHashSet::IsUnspent(const OutputIdentifier& output) const
 {
-	const std::optional<uint64_t> mmrIndex = m_blockDB.GetOutputPosition(output.GetCommitment());
-	if (mmrIndex.has_value())
+	const std::optional<OutputPositionIndex::Entry> entry = m_outputPositions.Find(output.GetCommitment());
+
+	return entry.has_value() && entry.value().features == output.GetFeatures();
+}
+
+//
+// Indexes every unspent output in the output MMR. Only needed when there's no valid snapshot,
+// ie. on first use, after loading from a zip, or after a crash.
+//
+void TxHashSet::BuildOutputPositions()
+{
+	LoggerAPI::LogInfo("TxHashSet::BuildOutputPositions - Building output position index.");
+
+	const std::vector<std::pair<uint64_t, OutputIdentifier>> unspentOutputs = m_pOutputPMMR->GetUnspentOutputs(0);
+
+	m_outputPositions.Clear();
+	m_outputPositions.Reserve(unspentOutputs.size());
+	for (const auto& unspentOutput : unspentOutputs)
 	{
-		std::unique_ptr<Hash> pMMRHash = m_pOutputPMMR->GetHashAt(mmrIndex.value());
-		if (pMMRHash != nullptr)
-		{
-			Serializer serializer;
-			output.Serialize(serializer);
-			const Hash outputHash = Crypto::Blake2b(serializer.GetBytes());
-
-			if (outputHash == *pMMRHash)
-			{
-				return true;
-			}
-		}
+		m_outputPositions.Insert(unspentOutput.second.GetCommitment(), unspentOutput.second.GetFeatures(), unspentOutput.first);
 	}
 
-	return false;
+	m_outputPositions.Commit();
+
+	LoggerAPI::LogInfo(StringUtil::Format("TxHashSet::BuildOutputPositions - Indexed %llu unspent outputs.", m_outputPositions.GetSize()));
 }
 
 bool TxHashSet::Validate(const BlockHeader& header, const IBlockChainServer& blockChainServer, Commitment& outputSumOut, Commitment& kernelSumOut)
@@ -57,117 +77,363 @@ bool TxHashSet::Validate(const BlockHeader& header, const IBlockChainServer& blo
 	return false;
 }
 
+// Applies the block to the MMRs in memory. Nothing is written to disk until Commit() is called.
 bool TxHashSet::ApplyBlock(const FullBlock& block)
 {
+	const uint64_t outputMMRSize = m_pOutputPMMR->GetSize();
+
+	// Spend inputs
+	std::vector<uint64_t> spentPositions;
+	spentPositions.reserve(block.GetTransactionBody().GetInputs().size());
 	for (const TransactionInput& input : block.GetTransactionBody().GetInputs())
 	{
+		const std::optional<OutputPositionIndex::Entry> entry = m_outputPositions.Find(input.GetCommitment());
+		if (!entry.has_value() || !m_pOutputPMMR->Remove(entry.value().mmrIndex))
+		{
+			LoggerAPI::LogWarning("TxHashSet::ApplyBlock - Input not found or already spent in block " + block.GetBlockHeader().FormatHash());
+			return false;
+		}
 
+		m_pRangeProofPMMR->Remove(entry.value().mmrIndex);
+		m_outputPositions.Erase(input.GetCommitment());
+		spentPositions.push_back(entry.value().mmrIndex);
 	}
 
-	for (const TransactionOutput& output : block.GetTransactionBody().GetOutputs())
+	// Append new outputs and rangeproofs, each in a single batch
+	const std::vector<TransactionOutput>& outputs = block.GetTransactionBody().GetOutputs();
+	std::vector<OutputIdentifier> outputIdentifiers;
+	outputIdentifiers.reserve(outputs.size());
+	std::vector<RangeProof> rangeProofs;
+	rangeProofs.reserve(outputs.size());
+	for (const TransactionOutput& output : outputs)
 	{
-		
+		outputIdentifiers.emplace_back(OutputIdentifier(output.GetFeatures(), Commitment(output.GetCommitment())));
+		rangeProofs.push_back(output.GetRangeProof());
 	}
 
-	for (const TransactionKernel& kernels : block.GetTransactionBody().GetKernels())
+	const std::vector<uint64_t> mmrIndices = m_pOutputPMMR->Append(outputIdentifiers);
+	m_pRangeProofPMMR->Append(rangeProofs);
+	for (size_t i = 0; i < outputs.size(); i++)
 	{
-
+		m_outputPositions.Insert(outputs[i].GetCommitment(), outputs[i].GetFeatures(), mmrIndices[i]);
 	}
 
+	// Append new kernels
+	m_pKernelMMR->Append(block.GetTransactionBody().GetKernels());
+
+	m_undoFile.AddBlockUndo(BlockUndo(block.GetBlockHeader().GetHeight(), outputMMRSize, std::move(spentPositions)));
+
 	return true;
 }
 
-bool TxHashSet::SaveOutputPositions()
+std::unique_ptr<MerkleProof> TxHashSet::GetOutputMerkleProof(const uint64_t mmrIndex) const
+{
+	return m_pOutputPMMR->GetMerkleProof(mmrIndex);
+}
+
+std::vector<std::unique_ptr<MerkleProof>> TxHashSet::GetOutputMerkleProofs(const std::vector<uint64_t>& mmrIndices) const
+{
+	return m_pOutputPMMR->GetMerkleProofs(mmrIndices);
+}
+
+std::unique_ptr<MerkleProof> TxHashSet::GetKernelMerkleProof(const uint64_t mmrIndex) const
+{
+	return m_pKernelMMR->GetMerkleProof(mmrIndex);
+}
+
+std::vector<std::unique_ptr<MerkleProof>> TxHashSet::GetKernelMerkleProofs(const std::vector<uint64_t>& mmrIndices) const
+{
+	return m_pKernelMMR->GetMerkleProofs(mmrIndices);
+}
+
+bool TxHashSet::RebuildHashFiles(const BlockHeader& header)
 {
-	const uint64_t size = m_pOutputPMMR->GetSize();
-	for (uint64_t mmrIndex = 0; mmrIndex < size; mmrIndex++)
+	bool success = true;
+	if (m_pKernelMMR->Root(header.GetKernelMMRSize()) != header.GetKernelRoot())
 	{
-		std::unique_ptr<OutputIdentifier> pOutput = m_pOutputPMMR->GetOutputAt(mmrIndex);
-		if (pOutput != nullptr)
-		{
-			m_blockDB.AddOutputPosition(pOutput->GetCommitment(), mmrIndex);
-		}
+		LoggerAPI::LogWarning("TxHashSet::RebuildHashFiles - Kernel root mismatch. Rebuilding hash file.");
+		success = m_pKernelMMR->RebuildHashFile(header.GetKernelMMRSize(), header.GetKernelRoot()) && success;
 	}
 
-	return true;
+	if (m_pOutputPMMR->Root(header.GetOutputMMRSize()) != header.GetOutputRoot())
+	{
+		LoggerAPI::LogWarning("TxHashSet::RebuildHashFiles - Output root mismatch. Rebuilding hash file.");
+		success = m_pOutputPMMR->RebuildHashFile(header.GetOutputMMRSize(), header.GetOutputRoot()) && success;
+	}
+
+	if (m_pRangeProofPMMR->Root(header.GetOutputMMRSize()) != header.GetRangeProofRoot())
+	{
+		LoggerAPI::LogWarning("TxHashSet::RebuildHashFiles - RangeProof root mismatch. Rebuilding hash file.");
+		success = m_pRangeProofPMMR->RebuildHashFile(header.GetOutputMMRSize(), header.GetRangeProofRoot()) && success;
+	}
+
+	return success;
 }
 
-bool TxHashSet::Snapshot(const BlockHeader& header)
+std::unique_ptr<ITxHashSetArchive> TxHashSet::PrepareArchive(const BlockHeader& header) const
 {
-	return true;
+	if (header.GetOutputMMRSize() > m_pOutputPMMR->GetSize() || header.GetKernelMMRSize() > m_pKernelMMR->GetSize())
+	{
+		LoggerAPI::LogWarning("TxHashSet::PrepareArchive - Block " + header.FormatHash() + " is after the current block.");
+		return std::unique_ptr<ITxHashSetArchive>(nullptr);
+	}
+
+	std::vector<uint64_t> leavesToAdd;
+	uint64_t outputMMRSize = m_pOutputPMMR->GetSize();
+	for (const BlockUndo& blockUndo : m_undoFile.GetBlockUndosAfter(header.GetHeight()))
+	{
+		const std::vector<uint64_t>& spentPositions = blockUndo.GetSpentPositions();
+		leavesToAdd.insert(leavesToAdd.end(), spentPositions.cbegin(), spentPositions.cend());
+		outputMMRSize = blockUndo.GetOutputMMRSize();
+	}
+
+	if (outputMMRSize != header.GetOutputMMRSize())
+	{
+		LoggerAPI::LogWarning("TxHashSet::PrepareArchive - Undo data not available to rewind to block " + header.FormatHash());
+		return std::unique_ptr<ITxHashSetArchive>(nullptr);
+	}
+
+	std::unique_ptr<TxHashSetArchive> pArchive = std::make_unique<TxHashSetArchive>();
+	m_pKernelMMR->AddToArchive(*pArchive, header.GetKernelMMRSize(), std::vector<uint64_t>(), header.GetHash());
+	m_pOutputPMMR->AddToArchive(*pArchive, header.GetOutputMMRSize(), leavesToAdd, header.GetHash());
+	m_pRangeProofPMMR->AddToArchive(*pArchive, header.GetOutputMMRSize(), leavesToAdd, header.GetHash());
+
+	return std::unique_ptr<ITxHashSetArchive>(pArchive.release());
 }
 
+//
+// Rewinds the MMRs to the state they were in after the given block was applied.
+// Hashes and data are simply truncated, and leaves spent since then are restored using the undo record of each block being rewound.
+// The output position index is updated to match, which only reads the outputs created or spent by the rewound blocks.
+// Like ApplyBlock, this only modifies the MMRs in memory.
+//
 bool TxHashSet::Rewind(const BlockHeader& header)
 {
-	m_pKernelMMR->Rewind(header.GetKernelMMRSize());
-	m_pOutputPMMR->Rewind(header.GetOutputMMRSize());
-	m_pRangeProofPMMR->Rewind(header.GetOutputMMRSize());
-	return true;
+	std::vector<uint64_t> leavesToAdd;
+
+	uint64_t outputMMRSize = m_pOutputPMMR->GetSize();
+	while (outputMMRSize > header.GetOutputMMRSize())
+	{
+		std::unique_ptr<BlockUndo> pBlockUndo = m_undoFile.PopBlockUndo();
+		if (pBlockUndo == nullptr)
+		{
+			LoggerAPI::LogError("TxHashSet::Rewind - Undo data not available to rewind to block " + header.FormatHash());
+			return false;
+		}
+
+		const std::vector<uint64_t>& spentPositions = pBlockUndo->GetSpentPositions();
+		leavesToAdd.insert(leavesToAdd.end(), spentPositions.cbegin(), spentPositions.cend());
+		outputMMRSize = pBlockUndo->GetOutputMMRSize();
+	}
+
+	if (outputMMRSize != header.GetOutputMMRSize())
+	{
+		LoggerAPI::LogError("TxHashSet::Rewind - Undo data does not match block " + header.FormatHash());
+		return false;
+	}
+
+	for (const auto& unspentOutput : m_pOutputPMMR->GetUnspentOutputs(header.GetOutputMMRSize()))
+	{
+		m_outputPositions.Erase(unspentOutput.second.GetCommitment());
+	}
+
+	const bool kernelRewind = m_pKernelMMR->Rewind(header.GetKernelMMRSize());
+	const bool outputRewind = m_pOutputPMMR->Rewind(header.GetOutputMMRSize(), leavesToAdd);
+	const bool rangeProofRewind = m_pRangeProofPMMR->Rewind(header.GetOutputMMRSize(), leavesToAdd);
+
+	// Leaves created and spent by the rewound blocks are gone, so GetAt only returns the restored outputs.
+	for (const uint64_t mmrIndex : leavesToAdd)
+	{
+		std::unique_ptr<OutputIdentifier> pOutput = m_pOutputPMMR->GetAt(mmrIndex);
+		if (pOutput != nullptr)
+		{
+			m_outputPositions.Insert(pOutput->GetCommitment(), pOutput->GetFeatures(), mmrIndex);
+		}
+	}
+
+	return kernelRewind && outputRewind && rangeProofRewind;
 }
 
+//
+// Commits all changes to the 3 MMRs as a single unit.
+// The changes are first written to a journal, so if we die part-way through flushing,
+// the journal is replayed the next time the TxHashSet is opened.
+//
 bool TxHashSet::Commit()
 {
-	m_pKernelMMR->Flush();
-	m_pOutputPMMR->Flush();
-	m_pRangeProofPMMR->Flush();
-	return true;
+	CommitJournal journal(GetJournalPath(m_config));
+	m_pKernelMMR->AddToJournal(journal);
+	m_pOutputPMMR->AddToJournal(journal);
+	m_pRangeProofPMMR->AddToJournal(journal);
+	journal.AddFile(m_undoFile.GetFile());
+
+	if (!journal.Write())
+	{
+		LoggerAPI::LogError("TxHashSet::Commit - Failed to write journal.");
+		return false;
+	}
+
+	// The index now matches the MMRs. If flushing fails, the journal will be replayed on restart, and the index rebuilt.
+	m_outputPositions.Commit();
+
+	const bool kernelFlush = m_pKernelMMR->Flush();
+	const bool outputFlush = m_pOutputPMMR->Flush();
+	const bool rangeProofFlush = m_pRangeProofPMMR->Flush();
+	const bool undoFlush = m_undoFile.Flush();
+	if (!kernelFlush || !outputFlush || !rangeProofFlush || !undoFlush)
+	{
+		LoggerAPI::LogError("TxHashSet::Commit - Failed to flush MMRs. Journal will be replayed on restart.");
+		return false;
+	}
+
+	return journal.Remove();
 }
 
 bool TxHashSet::Discard()
 {
-	//m_pKernelMMR->Discard();
-	//m_pOutputPMMR->Discard();
-	//m_pRangeProofPMMR->Discard();
-	return true;
+	const bool kernelDiscard = m_pKernelMMR->Discard();
+	const bool outputDiscard = m_pOutputPMMR->Discard();
+	const bool rangeProofDiscard = m_pRangeProofPMMR->Discard();
+	const bool undoDiscard = m_undoFile.Discard();
+	m_outputPositions.Discard();
+
+	return kernelDiscard && outputDiscard && rangeProofDiscard && undoDiscard;
 }
 
-bool TxHashSet::Compact()
+//
+// Determines which spent outputs and rangeproofs can be removed from disk.
+// Leaves spent after the horizon are kept, so the TxHashSet can still be rewound to the horizon.
+// If the undo records don't reach back to the horizon (ie. after loading from a zip), we can only rewind as far as the oldest record anyway,
+// so that's used as the cutoff instead.
+//
+std::shared_ptr<ITxHashSetCompaction> TxHashSet::PrepareCompaction(const uint64_t horizonHeight)
 {
-	return true;
+	if (!m_pCompaction.expired())
+	{
+		LoggerAPI::LogWarning("TxHashSet::PrepareCompaction - Compaction already in progress.");
+		return std::shared_ptr<ITxHashSetCompaction>(nullptr);
+	}
+
+	Roaring64Map rewindRmPos;
+	uint64_t cutoffSize = m_pOutputPMMR->GetSize();
+	for (const BlockUndo& blockUndo : m_undoFile.GetBlockUndosAfter(horizonHeight))
+	{
+		for (const uint64_t position : blockUndo.GetSpentPositions())
+		{
+			rewindRmPos.add(position + 1);
+		}
+
+		cutoffSize = blockUndo.GetOutputMMRSize();
+	}
+
+	std::unique_ptr<PMMRCompaction> pOutputCompaction = m_pOutputPMMR->PrepareCompaction(cutoffSize, rewindRmPos);
+	if (pOutputCompaction == nullptr)
+	{
+		LoggerAPI::LogDebug("TxHashSet::PrepareCompaction - Nothing to compact.");
+		return std::shared_ptr<ITxHashSetCompaction>(nullptr);
+	}
+
+	std::unique_ptr<PMMRCompaction> pRangeProofCompaction = m_pRangeProofPMMR->PrepareCompaction(
+		cutoffSize,
+		pOutputCompaction->GetLeavesToRemove(),
+		pOutputCompaction->GetNodesToRemove()
+	);
+	if (pRangeProofCompaction == nullptr)
+	{
+		return std::shared_ptr<ITxHashSetCompaction>(nullptr);
+	}
+
+	LoggerAPI::LogInfo(StringUtil::Format("TxHashSet::PrepareCompaction - Removing %llu leaves before output MMR size %llu.", pOutputCompaction->GetLeavesToRemove().cardinality(), cutoffSize));
+
+	std::shared_ptr<TxHashSetCompaction> pCompaction = std::make_shared<TxHashSetCompaction>(horizonHeight, std::move(pOutputCompaction), std::move(pRangeProofCompaction));
+	m_pCompaction = pCompaction;
+	return pCompaction;
 }
 
-namespace TxHashSetAPI
+//
+// Swaps in the compacted files, and updates the prune lists to match, as a single journaled unit.
+// Anything committed since the compaction was prepared is copied to the end of the compacted files first.
+// The undo records at or below the horizon are trimmed in the same unit, since nothing can be rewound past the horizon anymore.
+//
+bool TxHashSet::FinishCompaction(ITxHashSetCompaction& compaction)
 {
-	TXHASHSET_API ITxHashSet* Open(const Config& config, IBlockDB& blockDB)
+	if (&compaction != m_pCompaction.lock().get())
 	{
-		KernelMMR* pKernelMMR = KernelMMR::Load(config);
-		OutputPMMR* pOutputPMMR = OutputPMMR::Load(config);
-		RangeProofPMMR* pRangeProofPMMR = RangeProofPMMR::Load(config);
+		LoggerAPI::LogWarning("TxHashSet::FinishCompaction - Compaction was not prepared by this TxHashSet.");
+		return false;
+	}
 
-		return new TxHashSet(blockDB, pKernelMMR, pOutputPMMR, pRangeProofPMMR);
+	m_pCompaction.reset();
+
+	TxHashSetCompaction& txHashSetCompaction = static_cast<TxHashSetCompaction&>(compaction);
+	if (!txHashSetCompaction.IsRewritten())
+	{
+		LoggerAPI::LogError("TxHashSet::FinishCompaction - Failed to rewrite compacted files.");
+		return false;
 	}
 
-	TXHASHSET_API ITxHashSet* LoadFromZip(const Config& config, IBlockDB& blockDB, const std::string& zipFilePath, const BlockHeader& header)
+	PMMRCompaction& outputCompaction = txHashSetCompaction.GetOutputCompaction();
+	PMMRCompaction& rangeProofCompaction = txHashSetCompaction.GetRangeProofCompaction();
+
+	CommitJournal journal(GetJournalPath(m_config));
+	if (!m_pOutputPMMR->ApplyCompaction(outputCompaction, journal) || !m_pRangeProofPMMR->ApplyCompaction(rangeProofCompaction, journal))
 	{
-		const TxHashSetZip zip(config);
-		if (zip.Extract(zipFilePath, header))
-		{
-			LoggerAPI::LogInfo(StringUtil::Format("TxHashSetAPI::LoadFromZip - %s extracted successfully.", zipFilePath.c_str()));
-			FileUtil::RemoveFile(zipFilePath);
+		LoggerAPI::LogError("TxHashSet::FinishCompaction - Failed to apply compaction.");
+		Discard();
+		return false;
+	}
 
-			KernelMMR* pKernelMMR = KernelMMR::Load(config);
-			pKernelMMR->Rewind(header.GetKernelMMRSize());
-			pKernelMMR->Flush();
+	const bool undoTrimmed = m_undoFile.PrepareTrim(txHashSetCompaction.GetHorizonHeight(), journal);
+	if (!journal.Write())
+	{
+		LoggerAPI::LogError("TxHashSet::FinishCompaction - Failed to write journal.");
+		Discard();
+		return false;
+	}
 
-			OutputPMMR* pOutputPMMR = OutputPMMR::Load(config);
-			pOutputPMMR->Rewind(header.GetOutputMMRSize());
-			pOutputPMMR->Flush();
+	outputCompaction.MarkJournaled();
+	rangeProofCompaction.MarkJournaled();
 
-			RangeProofPMMR* pRangeProofPMMR = RangeProofPMMR::Load(config);
-			pRangeProofPMMR->Rewind(header.GetOutputMMRSize());
-			pRangeProofPMMR->Flush();
+	const bool outputCommit = m_pOutputPMMR->CommitCompaction(outputCompaction);
+	const bool rangeProofCommit = m_pRangeProofPMMR->CommitCompaction(rangeProofCompaction);
+	const bool undoCommit = !undoTrimmed || m_undoFile.CommitTrim();
+	if (!outputCommit || !rangeProofCommit || !undoCommit)
+	{
+		LoggerAPI::LogError("TxHashSet::FinishCompaction - Failed to swap compacted files. Journal will be replayed on restart.");
+		return false;
+	}
 
-			return new TxHashSet(blockDB, pKernelMMR, pOutputPMMR, pRangeProofPMMR); // TODO: Just call Rewind(BlockHeader) on TxHashSet instead of each MMR
-		}
-		else
+	return journal.Remove();
+}
+
+namespace TxHashSetAPI
+{
+	TXHASHSET_API ITxHashSet* Open(const Config& config)
+	{
+		if (!CommitJournal::Recover(TxHashSet::GetJournalPath(config)))
 		{
+			LoggerAPI::LogError("TxHashSetAPI::Open - Failed to recover from incomplete commit.");
 			return nullptr;
 		}
+
+		KernelMMR* pKernelMMR = KernelMMR::Load(config.GetTxHashSetDirectory());
+		OutputPMMR* pOutputPMMR = OutputPMMR::Load(config.GetTxHashSetDirectory());
+		RangeProofPMMR* pRangeProofPMMR = RangeProofPMMR::Load(config.GetTxHashSetDirectory());
+
+		UndoFile undoFile(TxHashSet::GetUndoPath(config));
+		undoFile.Load();
+
+		return new TxHashSet(config, pKernelMMR, pOutputPMMR, pRangeProofPMMR, std::move(undoFile));
 	}
 
-	TXHASHSET_API void Close(ITxHashSet* pITxHashSet)
+	TXHASHSET_API std::unique_ptr<ITxHashSetDownload> StartDownload(const Config& config, const BlockHeader& header, const IBlockChainServer& blockChainServer)
 	{
-		TxHashSet* pTxHashSet = (TxHashSet*)pITxHashSet;
-		delete pITxHashSet;
+		std::unique_ptr<TxHashSetDownload> pDownload = std::make_unique<TxHashSetDownload>(config, header, blockChainServer);
+		if (!pDownload->Initialize())
+		{
+			return std::unique_ptr<ITxHashSetDownload>(nullptr);
+		}
+
+		return pDownload;
 	}
 }
\ No newline at end of file
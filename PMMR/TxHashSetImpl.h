@@ -3,6 +3,9 @@
 #include "KernelMMR.h"
 #include "OutputPMMR.h"
 #include "RangeProofPMMR.h"
+#include "Common/UndoFile.h"
+#include "Common/OutputPositionIndex.h"
+#include "TxHashSetCompaction.h"
 
 #include <TxHashSet.h>
 #include <Config/Config.h>
@@ -11,28 +14,51 @@
 class TxHashSet : public ITxHashSet
 {
 public:
-	TxHashSet(IBlockDB& blockDB, KernelMMR* pKernelMMR, OutputPMMR* pOutputPMMR, RangeProofPMMR* pRangeProofPMMR);
+	TxHashSet(const Config& config, KernelMMR* pKernelMMR, OutputPMMR* pOutputPMMR, RangeProofPMMR* pRangeProofPMMR, UndoFile&& undoFile);
 	~TxHashSet();
 
 	virtual bool IsUnspent(const OutputIdentifier& output) const override final;
 	virtual bool Validate(const BlockHeader& header, const IBlockChainServer& blockChainServer, Commitment& outputSumOut, Commitment& kernelSumOut) override final;
 	virtual bool ApplyBlock(const FullBlock& block) override final;
-	virtual bool SaveOutputPositions() override final;
 
-	virtual bool Snapshot(const BlockHeader& header) override final;
+	virtual std::unique_ptr<MerkleProof> GetOutputMerkleProof(const uint64_t mmrIndex) const override final;
+	virtual std::vector<std::unique_ptr<MerkleProof>> GetOutputMerkleProofs(const std::vector<uint64_t>& mmrIndices) const override final;
+	virtual std::unique_ptr<MerkleProof> GetKernelMerkleProof(const uint64_t mmrIndex) const override final;
+	virtual std::vector<std::unique_ptr<MerkleProof>> GetKernelMerkleProofs(const std::vector<uint64_t>& mmrIndices) const override final;
+
+	virtual bool RebuildHashFiles(const BlockHeader& header) override final;
+
+	virtual std::unique_ptr<ITxHashSetArchive> PrepareArchive(const BlockHeader& header) const override final;
 	virtual bool Rewind(const BlockHeader& header) override final;
 	virtual bool Commit() override final;
 	virtual bool Discard() override final;
-	virtual bool Compact() override final;
+	virtual std::shared_ptr<ITxHashSetCompaction> PrepareCompaction(const uint64_t horizonHeight) override final;
+	virtual bool FinishCompaction(ITxHashSetCompaction& compaction) override final;
 
 	KernelMMR* GetKernelMMR() { return m_pKernelMMR; }
 	OutputPMMR* GetOutputPMMR() { return m_pOutputPMMR; }
 	RangeProofPMMR* GetRangeProofPMMR() { return m_pRangeProofPMMR; }
 
+	static std::string GetJournalPath(const Config& config) { return config.GetTxHashSetDirectory() + "txhashset.journal"; }
+	static std::string GetUndoPath(const Config& config) { return config.GetTxHashSetDirectory() + "undo.bin"; }
+	static std::string GetOutputPositionsPath(const Config& config) { return config.GetTxHashSetDirectory() + "output_positions.bin"; }
+
 private:
-	IBlockDB& m_blockDB;
+	void BuildOutputPositions();
+
+	const Config& m_config;
 
 	KernelMMR* m_pKernelMMR;
 	OutputPMMR* m_pOutputPMMR;
 	RangeProofPMMR* m_pRangeProofPMMR;
+
+	// One record per applied block, used to restore spent leaves when rewinding.
+	UndoFile m_undoFile;
+
+	// The features and mmr index of every unspent output. Kept in step with the output MMR, and snapshotted to disk when closed.
+	OutputPositionIndex m_outputPositions;
+
+	// The compaction that has been prepared, but not yet finished. Owned by the caller of PrepareCompaction,
+	// so it expires if the caller drops it without finishing it.
+	std::weak_ptr<TxHashSetCompaction> m_pCompaction;
 };
\ No newline at end of file
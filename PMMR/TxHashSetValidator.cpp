@@ -1,6 +1,8 @@
 #include "TxHashSetValidator.h"
 #include "TxHashSetImpl.h"
 #include "KernelMMR.h"
+#include "OutputPMMR.h"
+#include "RangeProofPMMR.h"
 #include "Common/MMR.h"
 #include "Common/MMRUtil.h"
 #include "KernelSumValidator.h"
@@ -9,7 +11,10 @@
 #include <HexUtil.h>
 #include <Infrastructure/Logger.h>
 #include <BlockChainServer.h>
+#include <Crypto.h>
 #include <async++.h>
+#include <atomic>
+#include <algorithm>
 
 TxHashSetValidator::TxHashSetValidator(const IBlockChainServer& blockChainServer)
 	: m_blockChainServer(blockChainServer)
@@ -24,152 +29,365 @@ TxHashSetValidationResult TxHashSetValidator::Validate(TxHashSet& txHashSet, con
 	const OutputPMMR& outputPMMR = *txHashSet.GetOutputPMMR();
 	const RangeProofPMMR& rangeProofPMMR = *txHashSet.GetRangeProofPMMR();
 
-	// Validate size of each MMR matches blockHeader
-	//if (!ValidateSizes(txHashSet, blockHeader))
-	//{
-	//	return TxHashSetValidationResult::Fail();
-	//}
+	// Validate each MMR in parallel
+	async::task<bool> kernelTask = async::spawn([this, &kernelMMR, &blockHeader] { return this->ValidateKernelMMR(kernelMMR, blockHeader); });
+	async::task<bool> outputTask = async::spawn([this, &outputPMMR, &blockHeader] { return this->ValidateOutputPMMR(outputPMMR, blockHeader); });
+	async::task<bool> rangeProofTask = async::spawn([this, &rangeProofPMMR, &blockHeader] { return this->ValidateRangeProofPMMR(rangeProofPMMR, blockHeader); });
+	async::task<bool> rangeProofsTask = async::spawn([this, &outputPMMR, &rangeProofPMMR] { return this->ValidateRangeProofs(outputPMMR, rangeProofPMMR); });
 
-	// Validate MMR hashes in parallel
-	async::task<bool> kernelTask = async::spawn([this, &kernelMMR] { return this->ValidateMMRHashes(kernelMMR); });
-	async::task<bool> outputTask = async::spawn([this, &outputPMMR] { return this->ValidateMMRHashes(outputPMMR); });
-	async::task<bool> rangeProofTask = async::spawn([this, &rangeProofPMMR] { return this->ValidateMMRHashes(rangeProofPMMR); });
-
-	const bool mmrHashesValidated = async::when_all(kernelTask, outputTask, rangeProofTask).then(
-		[](std::tuple<async::task<bool>, async::task<bool>, async::task<bool>> results) -> bool {
-		return std::get<0>(results).get() && std::get<1>(results).get() && std::get<2>(results).get();
+	const bool mmrsValidated = async::when_all(std::move(kernelTask), std::move(outputTask), std::move(rangeProofTask), std::move(rangeProofsTask)).then(
+		[](std::tuple<async::task<bool>, async::task<bool>, async::task<bool>, async::task<bool>> results) -> bool {
+		return std::get<0>(results).get() && std::get<1>(results).get() && std::get<2>(results).get() && std::get<3>(results).get();
 	}).get();
-	
-	if (!mmrHashesValidated)
+
+	if (!mmrsValidated)
 	{
 		return TxHashSetValidationResult::Fail();
 	}
 
-	// Validate root for each MMR matches blockHeader
-	if (!ValidateRoots(txHashSet, blockHeader))
+	return ValidateKernelSums(kernelMMR, outputPMMR, blockHeader);
+}
+
+// Validates the hashes and root of the kernel MMR, the kernel root of every header, and every kernel signature.
+bool TxHashSetValidator::ValidateKernelMMR(const KernelMMR& kernelMMR, const BlockHeader& blockHeader) const
+{
+	if (!ValidateMMRHashes(kernelMMR) || !ValidateRoot(kernelMMR, blockHeader.GetKernelMMRSize(), blockHeader.GetKernelRoot()))
 	{
-		return TxHashSetValidationResult::Fail();
+		LoggerAPI::LogError("TxHashSetValidator::ValidateKernelMMR - Kernel MMR invalid for header " + HexUtil::ConvertHash(blockHeader.GetHash()));
+		return false;
 	}
 
 	// Validate the full kernel history (kernel MMR root for every block header).
-	if (!ValidateKernelHistory(*txHashSet.GetKernelMMR(), blockHeader))
+	if (!ValidateKernelHistory(kernelMMR, blockHeader))
 	{
-		return TxHashSetValidationResult::Fail();
+		return false;
 	}
 
-	// Validate kernel sums
-	const std::unique_ptr<BlockHeader> pGenesisHeader = m_blockChainServer.GetBlockHeaderByHeight(0, EChainType::CANDIDATE);
-	const bool genesisHasReward = pGenesisHeader->GetKernelMMRSize() > 0;
-	Commitment outputSum(CBigInteger<33>::ValueOf(0));
-	Commitment kernelSum(CBigInteger<33>::ValueOf(0));
-	if (!KernelSumValidator().ValidateKernelSums(txHashSet, blockHeader, genesisHasReward, outputSum, kernelSum))
+	// Validate kernel signatures
+	if (!KernelSignatureValidator().ValidateKernelSignatures(kernelMMR))
 	{
-		// TODO: return TxHashSetValidationResult::Fail();
+		LoggerAPI::LogError("TxHashSetValidator::ValidateKernelMMR - Invalid kernel signature for header " + HexUtil::ConvertHash(blockHeader.GetHash()));
+		return false;
 	}
 
-	// Validate the rangeproof associated with each unspent output.
+	return true;
+}
 
-	// Validate kernel signatures
-	if (!KernelSignatureValidator().ValidateKernelSignatures(*txHashSet.GetKernelMMR()))
+bool TxHashSetValidator::ValidateOutputPMMR(const OutputPMMR& outputPMMR, const BlockHeader& blockHeader) const
+{
+	if (!ValidateMMRHashes(outputPMMR) || !ValidateRoot(outputPMMR, blockHeader.GetOutputMMRSize(), blockHeader.GetOutputRoot()))
 	{
-		return TxHashSetValidationResult::Fail();
+		LoggerAPI::LogError("TxHashSetValidator::ValidateOutputPMMR - Output MMR invalid for header " + HexUtil::ConvertHash(blockHeader.GetHash()));
+		return false;
+	}
+
+	return true;
+}
+
+bool TxHashSetValidator::ValidateRangeProofPMMR(const RangeProofPMMR& rangeProofPMMR, const BlockHeader& blockHeader) const
+{
+	if (!ValidateMMRHashes(rangeProofPMMR) || !ValidateRoot(rangeProofPMMR, blockHeader.GetOutputMMRSize(), blockHeader.GetRangeProofRoot()))
+	{
+		LoggerAPI::LogError("TxHashSetValidator::ValidateRangeProofPMMR - RangeProof MMR invalid for header " + HexUtil::ConvertHash(blockHeader.GetHash()));
+		return false;
+	}
+
+	return true;
+}
+
+// Number of rangeproofs verified together in a single batch (and task).
+static const size_t RANGE_PROOF_BATCH_SIZE = 1000;
+
+//
+// Validates the rangeproof associated with each unspent output.
+// Rangeproofs are verified in batches, which are much cheaper than individual verification, and the batches are verified in parallel.
+//
+bool TxHashSetValidator::ValidateRangeProofs(const OutputPMMR& outputPMMR, const RangeProofPMMR& rangeProofPMMR) const
+{
+	const std::vector<std::pair<uint64_t, OutputIdentifier>> unspentOutputs = outputPMMR.GetUnspentOutputs(0);
+
+	std::vector<size_t> batchStarts;
+	for (size_t batchStart = 0; batchStart < unspentOutputs.size(); batchStart += RANGE_PROOF_BATCH_SIZE)
+	{
+		batchStarts.push_back(batchStart);
 	}
 
+	std::atomic_bool valid(true);
+	async::parallel_for(batchStarts, [&unspentOutputs, &rangeProofPMMR, &valid](const size_t batchStart)
+	{
+		const size_t batchEnd = (std::min)(batchStart + RANGE_PROOF_BATCH_SIZE, unspentOutputs.size());
+
+		std::vector<Commitment> commitments;
+		std::vector<RangeProof> rangeProofs;
+		commitments.reserve(batchEnd - batchStart);
+		rangeProofs.reserve(batchEnd - batchStart);
+		for (size_t i = batchStart; valid && i < batchEnd; i++)
+		{
+			std::unique_ptr<RangeProof> pRangeProof = rangeProofPMMR.GetAt(unspentOutputs[i].first);
+			if (pRangeProof == nullptr)
+			{
+				LoggerAPI::LogError("TxHashSetValidator::ValidateRangeProofs - Rangeproof missing at index " + std::to_string(unspentOutputs[i].first));
+				valid = false;
+				return;
+			}
+
+			commitments.push_back(unspentOutputs[i].second.GetCommitment());
+			rangeProofs.emplace_back(std::move(*pRangeProof));
+		}
+
+		if (valid && !Crypto::VerifyRangeProofs(commitments, rangeProofs))
+		{
+			LoggerAPI::LogError("TxHashSetValidator::ValidateRangeProofs - Invalid rangeproof in batch starting at index " + std::to_string(unspentOutputs[batchStart].first));
+			valid = false;
+		}
+	});
+
+	return valid;
+}
+
+TxHashSetValidationResult TxHashSetValidator::ValidateKernelSums(const KernelMMR& kernelMMR, const OutputPMMR& outputPMMR, const BlockHeader& blockHeader) const
+{
+	const std::shared_ptr<const BlockHeader> pGenesisHeader = m_blockChainServer.GetSharedBlockHeaderByHeight(0, EChainType::CANDIDATE);
+	const bool genesisHasReward = pGenesisHeader->GetKernelMMRSize() > 0;
+	Commitment outputSum(CBigInteger<33>::ValueOf(0));
+	Commitment kernelSum(CBigInteger<33>::ValueOf(0));
+	if (!KernelSumValidator().ValidateKernelSums(kernelMMR, outputPMMR, blockHeader, genesisHasReward, outputSum, kernelSum))
+	{
+		// TODO: return TxHashSetValidationResult::Fail();
+	}
 
 	return TxHashSetValidationResult(true, std::move(outputSum), std::move(kernelSum));
 }
 
-bool TxHashSetValidator::ValidateSizes(TxHashSet& txHashSet, const BlockHeader& blockHeader) const
+// Subtrees of this height (8191 nodes, 256KB of hashes) are validated as independent tasks.
+static const uint64_t SUBTREE_HEIGHT = 12;
+
+//
+// Splits the MMR into perfect subtrees of at most SUBTREE_HEIGHT, and validates them in parallel.
+// Each subtree is read with a single sequential read of the hash file, and every parent is checked against the child hashes already read.
+// The few nodes above those subtrees are then validated individually.
+//
+bool TxHashSetValidator::ValidateMMRHashes(const MMR& mmr) const
 {
-	if (txHashSet.GetKernelMMR()->GetSize() != blockHeader.GetKernelMMRSize())
+	const uint64_t size = mmr.GetSize();
+	const MMRPeaks peakIndices = MMRUtil::GetPeaks(size);
+	if (size > 0 && peakIndices.empty())
 	{
-		LoggerAPI::LogError("TxHashSetValidator::ValidateSizes - Kernel size not matching for header " + HexUtil::ConvertHash(blockHeader.GetHash()));
+		LoggerAPI::LogError("TxHashSetValidator::ValidateMMRHashes - Invalid MMR size " + std::to_string(size));
 		return false;
 	}
 
-	if (txHashSet.GetOutputPMMR()->GetSize() != blockHeader.GetOutputMMRSize())
+	// Walk down from each peak until reaching subtrees small enough to be validated as one task.
+	std::vector<std::pair<uint64_t, uint64_t>> subtrees; // (rootIndex, height)
+	std::vector<std::pair<uint64_t, uint64_t>> upperNodes; // (mmrIndex, height)
+
+	std::vector<std::pair<uint64_t, uint64_t>> nodesToSplit;
+	for (const uint64_t peakIndex : peakIndices)
 	{
-		LoggerAPI::LogError("TxHashSetValidator::ValidateSizes - Output size not matching for header " + HexUtil::ConvertHash(blockHeader.GetHash()));
-		return false;
+		nodesToSplit.emplace_back(std::make_pair(peakIndex, MMRUtil::GetHeight(peakIndex)));
 	}
 
-	if (txHashSet.GetRangeProofPMMR()->GetSize() != blockHeader.GetOutputMMRSize())
+	while (!nodesToSplit.empty())
+	{
+		const std::pair<uint64_t, uint64_t> node = nodesToSplit.back();
+		nodesToSplit.pop_back();
+
+		const uint64_t mmrIndex = node.first;
+		const uint64_t height = node.second;
+		if (height <= SUBTREE_HEIGHT)
+		{
+			subtrees.emplace_back(node);
+		}
+		else
+		{
+			upperNodes.emplace_back(node);
+			nodesToSplit.emplace_back(std::make_pair(MMRUtil::GetLeftChildIndex(mmrIndex, height), height - 1));
+			nodesToSplit.emplace_back(std::make_pair(MMRUtil::GetRightChildIndex(mmrIndex), height - 1));
+		}
+	}
+
+	std::atomic_bool valid(true);
+	async::parallel_for(subtrees, [this, &mmr, &valid](const std::pair<uint64_t, uint64_t>& subtree)
+	{
+		if (valid && !this->ValidateSubtreeHashes(mmr, subtree.first, subtree.second))
+		{
+			valid = false;
+		}
+	});
+
+	if (!valid)
 	{
-		LoggerAPI::LogError("TxHashSetValidator::ValidateSizes - RangeProof size not matching for header " + HexUtil::ConvertHash(blockHeader.GetHash()));
 		return false;
 	}
 
+	for (const std::pair<uint64_t, uint64_t>& upperNode : upperNodes)
+	{
+		if (!ValidateParentHash(mmr, upperNode.first, upperNode.second))
+		{
+			return false;
+		}
+	}
+
 	return true;
 }
 
-bool TxHashSetValidator::ValidateMMRHashes(const MMR& mmr) const
+bool TxHashSetValidator::ValidateSubtreeHashes(const MMR& mmr, const uint64_t rootIndex, const uint64_t height) const
 {
-	const uint64_t size = mmr.GetSize();
-	for (uint64_t i = 0; i < size; i++)
+	const uint64_t numNodes = ((uint64_t)2 << height) - 1;
+	const uint64_t firstIndex = rootIndex + 1 - numNodes;
+
+	const std::vector<std::optional<Hash>> hashes = mmr.GetHashes(firstIndex, numNodes);
+	if (hashes.size() != numNodes)
 	{
-		const uint64_t height = MMRUtil::GetHeight(i);
-		if (height > 0)
-		{
-			const std::unique_ptr<Hash> pParentHash = mmr.GetHashAt(i);
-			if (pParentHash != nullptr)
-			{
-				const uint64_t leftIndex = MMRUtil::GetLeftChildIndex(i, height);
-				const std::unique_ptr<Hash> pLeftHash = mmr.GetHashAt(leftIndex);
+		LoggerAPI::LogError("TxHashSetValidator::ValidateSubtreeHashes - Failed to read hashes for subtree at index " + std::to_string(rootIndex));
+		return false;
+	}
+
+	// Nodes are visited in postorder, so a node is a parent exactly when the top 2 entries of the stack have the same height.
+	// Those entries are its left and right children.
+	std::vector<std::pair<uint64_t, const std::optional<Hash>*>> stack; // (height, hash)
+	stack.reserve(height + 2);
 
-				const uint64_t rightIndex = MMRUtil::GetRightChildIndex(i);
-				const std::unique_ptr<Hash> pRightHash = mmr.GetHashAt(rightIndex);
+	for (uint64_t i = 0; i < numNodes; i++)
+	{
+		const std::optional<Hash>& hash = hashes[i];
+		const size_t stackSize = stack.size();
+		if (stackSize >= 2 && stack[stackSize - 1].first == stack[stackSize - 2].first)
+		{
+			const std::optional<Hash>& leftHash = *stack[stackSize - 2].second;
+			const std::optional<Hash>& rightHash = *stack[stackSize - 1].second;
+			const uint64_t parentHeight = stack[stackSize - 1].first + 1;
 
-				if (pLeftHash != nullptr && pRightHash != nullptr)
+			// Pruned roots are kept, but their children are not, so they can't be validated here.
+			if (hash.has_value() && leftHash.has_value() && rightHash.has_value())
+			{
+				const uint64_t parentIndex = firstIndex + i;
+				if (hash.value() != MMRUtil::HashParentWithIndex(leftHash.value(), rightHash.value(), parentIndex))
 				{
-					const Hash expectedHash = MMRUtil::HashParentWithIndex(*pLeftHash, *pRightHash, i);
-					if (*pParentHash != expectedHash)
-					{
-						LoggerAPI::LogError("TxHashSetValidator::ValidateMMRHashes - Invalid parent hash at index " + std::to_string(i));
-						return false;
-					}
+					LoggerAPI::LogError("TxHashSetValidator::ValidateSubtreeHashes - Invalid parent hash at index " + std::to_string(parentIndex));
+					return false;
 				}
 			}
+
+			stack.pop_back();
+			stack.back() = std::make_pair(parentHeight, &hash);
+		}
+		else
+		{
+			stack.emplace_back(std::make_pair(0, &hash));
 		}
 	}
 
 	return true;
 }
 
-bool TxHashSetValidator::ValidateRoots(TxHashSet& txHashSet, const BlockHeader& blockHeader) const
+bool TxHashSetValidator::ValidateParentHash(const MMR& mmr, const uint64_t parentIndex, const uint64_t height) const
 {
-	if (txHashSet.GetKernelMMR()->Root(blockHeader.GetKernelMMRSize()) != blockHeader.GetKernelRoot())
+	const std::unique_ptr<Hash> pParentHash = mmr.GetHashAt(parentIndex);
+	if (pParentHash != nullptr)
 	{
-		LoggerAPI::LogError("TxHashSetValidator::ValidateRoots - Kernel root not matching for header " + HexUtil::ConvertHash(blockHeader.GetHash()));
-		return false;
-	}
+		const std::unique_ptr<Hash> pLeftHash = mmr.GetHashAt(MMRUtil::GetLeftChildIndex(parentIndex, height));
+		const std::unique_ptr<Hash> pRightHash = mmr.GetHashAt(MMRUtil::GetRightChildIndex(parentIndex));
 
-	if (txHashSet.GetOutputPMMR()->Root(blockHeader.GetOutputMMRSize()) != blockHeader.GetOutputRoot())
-	{
-		LoggerAPI::LogError("TxHashSetValidator::ValidateRoots - Output root not matching for header " + HexUtil::ConvertHash(blockHeader.GetHash()));
-		return false;
+		if (pLeftHash != nullptr && pRightHash != nullptr)
+		{
+			const Hash expectedHash = MMRUtil::HashParentWithIndex(*pLeftHash, *pRightHash, parentIndex);
+			if (*pParentHash != expectedHash)
+			{
+				LoggerAPI::LogError("TxHashSetValidator::ValidateParentHash - Invalid parent hash at index " + std::to_string(parentIndex));
+				return false;
+			}
+		}
 	}
 
-	if (txHashSet.GetRangeProofPMMR()->Root(blockHeader.GetOutputMMRSize()) != blockHeader.GetRangeProofRoot())
+	return true;
+}
+
+bool TxHashSetValidator::ValidateRoot(const MMR& mmr, const uint64_t size, const Hash& expectedRoot) const
+{
+	if (mmr.Root(size) != expectedRoot)
 	{
-		LoggerAPI::LogError("TxHashSetValidator::ValidateRoots - RangeProof root not matching for header " + HexUtil::ConvertHash(blockHeader.GetHash()));
+		LoggerAPI::LogError("TxHashSetValidator::ValidateRoot - Root not matching at MMR size " + std::to_string(size));
 		return false;
 	}
 
 	return true;
 }
 
+//
+// Validates the kernel root of every header in a single pass over the kernel MMR.
+// The hash file is read sequentially in chunks, while maintaining the peaks of the MMR read so far,
+// so each header's root can be bagged from the peaks at its kernel MMR size, without re-reading the file.
+//
 bool TxHashSetValidator::ValidateKernelHistory(const KernelMMR& kernelMMR, const BlockHeader& blockHeader) const
 {
+	static const uint64_t CHUNK_SIZE = 65536;
+
+	const uint64_t mmrSize = kernelMMR.GetSize();
+	std::vector<std::pair<uint64_t, Hash>> peaks; // (height, hash)
+	std::vector<std::optional<Hash>> chunk;
+	uint64_t chunkStart = 0;
+	uint64_t numNodesRead = 0;
+
 	for (uint64_t height = 0; height <= blockHeader.GetHeight(); height++)
 	{
-		std::unique_ptr<BlockHeader> pHeader = m_blockChainServer.GetBlockHeaderByHeight(height, EChainType::CANDIDATE);
+		std::shared_ptr<const BlockHeader> pHeader = m_blockChainServer.GetSharedBlockHeaderByHeight(height, EChainType::CANDIDATE);
 		if (pHeader == nullptr)
 		{
 			LoggerAPI::LogError("TxHashSetValidator::ValidateKernelHistory - No header found at height " + std::to_string(height));
 			return false;
 		}
 
-		if (kernelMMR.Root(pHeader->GetKernelMMRSize()) != pHeader->GetKernelRoot())
+		const uint64_t kernelMMRSize = pHeader->GetKernelMMRSize();
+		if (kernelMMRSize < numNodesRead || kernelMMRSize > mmrSize)
+		{
+			LoggerAPI::LogError("TxHashSetValidator::ValidateKernelHistory - Invalid kernel MMR size for header at height " + std::to_string(height));
+			return false;
+		}
+
+		// Add the nodes up to the header's kernel MMR size to the peaks.
+		while (numNodesRead < kernelMMRSize)
+		{
+			if (numNodesRead == chunkStart + chunk.size())
+			{
+				chunkStart = numNodesRead;
+				chunk = kernelMMR.GetHashes(chunkStart, (std::min)(CHUNK_SIZE, mmrSize - chunkStart));
+				if (chunk.empty())
+				{
+					LoggerAPI::LogError("TxHashSetValidator::ValidateKernelHistory - Failed to read kernel hashes at index " + std::to_string(chunkStart));
+					return false;
+				}
+			}
+
+			Hash& hash = chunk[numNodesRead - chunkStart].value();
+			const size_t numPeaks = peaks.size();
+			if (numPeaks >= 2 && peaks[numPeaks - 1].first == peaks[numPeaks - 2].first)
+			{
+				// The node is the parent of the top 2 peaks.
+				const uint64_t parentHeight = peaks[numPeaks - 1].first + 1;
+				peaks.pop_back();
+				peaks.back() = std::make_pair(parentHeight, std::move(hash));
+			}
+			else
+			{
+				peaks.emplace_back(std::make_pair(0, std::move(hash)));
+			}
+
+			numNodesRead++;
+		}
+
+		// Bag the peaks from right to left, the same way KernelMMR::Root does.
+		Hash root = ZERO_HASH;
+		if (!peaks.empty())
+		{
+			root = peaks.back().second;
+			for (auto iter = peaks.crbegin() + 1; iter != peaks.crend(); iter++)
+			{
+				root = MMRUtil::HashParentWithIndex(iter->second, root, kernelMMRSize);
+			}
+		}
+
+		if (root != pHeader->GetKernelRoot())
 		{
 			LoggerAPI::LogError("TxHashSetValidator::ValidateKernelHistory - Kernel root not matching for header at height " + std::to_string(height));
 			return false;
@@ -3,11 +3,15 @@
 #include "TxHashSetValidationResult.h"
 
 #include <Core/BlockHeader.h>
+#include <vector>
+#include <stdint.h>
 
 // Forward Declarations
 class HashFile;
 class TxHashSet;
 class KernelMMR;
+class OutputPMMR;
+class RangeProofPMMR;
 class IBlockChainServer;
 class MMR;
 class Commitment;
@@ -19,14 +23,23 @@ public:
 
 	TxHashSetValidationResult Validate(TxHashSet& txHashSet, const BlockHeader& blockHeader, Commitment& outputSumOut, Commitment& kernelSumOut) const;
 
+	//
+	// Each MMR can be validated on its own, as soon as its files are available (see TxHashSetDownload).
+	// Validate() runs all of them in parallel, followed by ValidateKernelSums.
+	//
+	bool ValidateKernelMMR(const KernelMMR& kernelMMR, const BlockHeader& blockHeader) const;
+	bool ValidateOutputPMMR(const OutputPMMR& outputPMMR, const BlockHeader& blockHeader) const;
+	bool ValidateRangeProofPMMR(const RangeProofPMMR& rangeProofPMMR, const BlockHeader& blockHeader) const;
+	bool ValidateRangeProofs(const OutputPMMR& outputPMMR, const RangeProofPMMR& rangeProofPMMR) const;
+	TxHashSetValidationResult ValidateKernelSums(const KernelMMR& kernelMMR, const OutputPMMR& outputPMMR, const BlockHeader& blockHeader) const;
+
 private:
-	bool ValidateSizes(TxHashSet& txHashSet, const BlockHeader& blockHeader) const;
 	bool ValidateMMRHashes(const MMR& mmr) const;
-	bool ValidateRoots(TxHashSet& txHashSet, const BlockHeader& blockHeader) const;
+	bool ValidateSubtreeHashes(const MMR& mmr, const uint64_t rootIndex, const uint64_t height) const;
+	bool ValidateParentHash(const MMR& mmr, const uint64_t parentIndex, const uint64_t height) const;
+	bool ValidateRoot(const MMR& mmr, const uint64_t size, const Hash& expectedRoot) const;
 
 	bool ValidateKernelHistory(const KernelMMR& kernelMMR, const BlockHeader& blockHeader) const;
-	bool ValidateRangeProofs(TxHashSet& txHashSet, const BlockHeader& blockHeader) const;
-	bool ValidateKernelSignatures(TxHashSet& txHashSet, const BlockHeader& blockHeader) const;
 
 	const IBlockChainServer& m_blockChainServer;
 };
\ No newline at end of file
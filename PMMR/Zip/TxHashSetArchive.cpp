@@ -0,0 +1,48 @@
+#include "TxHashSetArchive.h"
+#include "ZipWriter.h"
+
+#include <FileUtil.h>
+#include <Infrastructure/Logger.h>
+
+void TxHashSetArchive::AddFile(const std::string& path, const std::string& sourcePath, const uint64_t numBytes)
+{
+	m_files.emplace_back(FileEntry{ path, sourcePath, numBytes });
+}
+
+void TxHashSetArchive::AddData(const std::string& path, std::vector<unsigned char>&& data)
+{
+	m_data.emplace_back(DataEntry{ path, std::move(data) });
+}
+
+// Written to a temporary file first, so a partially written zip is never served.
+bool TxHashSetArchive::Write(const std::string& zipPath) const
+{
+	const std::string tmpPath = zipPath + ".tmp";
+
+	ZipWriter zipWriter(tmpPath);
+	if (zipWriter.Open() != EZipFileStatus::SUCCESS)
+	{
+		return false;
+	}
+
+	bool success = true;
+	for (const FileEntry& file : m_files)
+	{
+		success = success && (zipWriter.AddFile(file.path, file.sourcePath, file.numBytes) == EZipFileStatus::SUCCESS);
+	}
+
+	for (const DataEntry& data : m_data)
+	{
+		success = success && (zipWriter.AddData(data.path, data.data) == EZipFileStatus::SUCCESS);
+	}
+
+	success = (zipWriter.Close() == EZipFileStatus::SUCCESS) && success;
+	if (!success)
+	{
+		LoggerAPI::LogError("TxHashSetArchive::Write - Failed to write " + zipPath);
+		FileUtil::RemoveFile(tmpPath);
+		return false;
+	}
+
+	return FileUtil::RenameFile(tmpPath, zipPath);
+}
\ No newline at end of file
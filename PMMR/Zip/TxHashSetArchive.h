@@ -0,0 +1,37 @@
+#pragma once
+
+#include <TxHashSet.h>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+//
+// The contents of a TxHashSet zip, captured while holding the chain lock.
+// Hash and data files are append-only below the block's MMR sizes, so they're only referenced (by path and length),
+// and read when the zip is written. Everything else (leaf sets & prune lists) is captured in memory.
+//
+class TxHashSetArchive : public ITxHashSetArchive
+{
+public:
+	void AddFile(const std::string& path, const std::string& sourcePath, const uint64_t numBytes);
+	void AddData(const std::string& path, std::vector<unsigned char>&& data);
+
+	virtual bool Write(const std::string& zipPath) const override final;
+
+private:
+	struct FileEntry
+	{
+		std::string path;
+		std::string sourcePath;
+		uint64_t numBytes;
+	};
+
+	struct DataEntry
+	{
+		std::string path;
+		std::vector<unsigned char> data;
+	};
+
+	std::vector<FileEntry> m_files;
+	std::vector<DataEntry> m_data;
+};
\ No newline at end of file
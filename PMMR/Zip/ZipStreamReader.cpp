@@ -0,0 +1,376 @@
+#include "ZipStreamReader.h"
+
+#include <Infrastructure/Logger.h>
+#include <algorithm>
+
+static const uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+static const uint32_t DATA_DESCRIPTOR_SIGNATURE = 0x08074b50;
+static const uint32_t CENTRAL_DIRECTORY_SIGNATURE = 0x02014b50;
+static const uint32_t END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06054b50;
+static const size_t LOCAL_HEADER_SIZE = 30;
+
+static const uint16_t FLAG_ENCRYPTED = 0x0001;
+static const uint16_t FLAG_DATA_DESCRIPTOR = 0x0008;
+static const uint16_t METHOD_STORED = 0;
+static const uint16_t METHOD_DEFLATED = 8;
+static const uint16_t ZIP64_EXTRA_FIELD = 0x0001;
+static const uint32_t ZIP64_SIZE_MARKER = 0xFFFFFFFF;
+
+// Extracted data is passed to the listener in chunks of up to 1MB.
+static const size_t INFLATE_BUFFER_SIZE = 1024 * 1024;
+
+static uint16_t ReadUInt16(const unsigned char* pData)
+{
+	return (uint16_t)pData[0] | ((uint16_t)pData[1] << 8);
+}
+
+static uint32_t ReadUInt32(const unsigned char* pData)
+{
+	return (uint32_t)ReadUInt16(pData) | ((uint32_t)ReadUInt16(pData + 2) << 16);
+}
+
+static uint64_t ReadUInt64(const unsigned char* pData)
+{
+	return (uint64_t)ReadUInt32(pData) | ((uint64_t)ReadUInt32(pData + 4) << 32);
+}
+
+ZipStreamReader::ZipStreamReader(IZipStreamListener& listener)
+	: m_listener(listener),
+	m_state(EState::LOCAL_HEADER),
+	m_inflateBuffer(INFLATE_BUFFER_SIZE),
+	m_flags(0),
+	m_zip64(false),
+	m_expectedCRC(0),
+	m_compressedSize(0),
+	m_uncompressedSize(0),
+	m_compressedBytesRead(0),
+	m_bytesExtracted(0),
+	m_crc(0)
+{
+	m_zStream = z_stream();
+
+	// Zip entries are raw deflate streams, without a zlib header.
+	if (inflateInit2(&m_zStream, -MAX_WBITS) != Z_OK)
+	{
+		Fail("ZipStreamReader::ZipStreamReader - Failed to initialize zlib.");
+	}
+}
+
+ZipStreamReader::~ZipStreamReader()
+{
+	inflateEnd(&m_zStream);
+}
+
+bool ZipStreamReader::Write(const unsigned char* pData, size_t numBytes)
+{
+	while (numBytes > 0 && m_state != EState::FINISHED && m_state != EState::FAILED)
+	{
+		size_t bytesRead = 0;
+		switch (m_state)
+		{
+			case EState::LOCAL_HEADER:
+				bytesRead = ReadLocalHeader(pData, numBytes);
+				break;
+			case EState::STORED_DATA:
+				bytesRead = ReadStoredData(pData, numBytes);
+				break;
+			case EState::DEFLATED_DATA:
+				bytesRead = ReadDeflatedData(pData, numBytes);
+				break;
+			case EState::DATA_DESCRIPTOR:
+				bytesRead = ReadDataDescriptor(pData, numBytes);
+				break;
+			default:
+				break;
+		}
+
+		pData += bytesRead;
+		numBytes -= bytesRead;
+	}
+
+	// Anything after the last entry (ie. the central directory) is ignored.
+	return m_state != EState::FAILED;
+}
+
+size_t ZipStreamReader::ReadLocalHeader(const unsigned char* pData, const size_t numBytes)
+{
+	size_t bytesRead = BufferBytes(pData, numBytes, 4);
+	if (m_headerBuffer.size() < 4)
+	{
+		return bytesRead;
+	}
+
+	const uint32_t signature = ReadUInt32(&m_headerBuffer[0]);
+	if (signature == CENTRAL_DIRECTORY_SIGNATURE || signature == END_OF_CENTRAL_DIRECTORY_SIGNATURE)
+	{
+		m_headerBuffer.clear();
+		m_state = EState::FINISHED;
+		return numBytes;
+	}
+	else if (signature != LOCAL_HEADER_SIGNATURE)
+	{
+		Fail("ZipStreamReader::ReadLocalHeader - Invalid local header signature.");
+		return 0;
+	}
+
+	bytesRead += BufferBytes(pData + bytesRead, numBytes - bytesRead, LOCAL_HEADER_SIZE);
+	if (m_headerBuffer.size() < LOCAL_HEADER_SIZE)
+	{
+		return bytesRead;
+	}
+
+	const size_t headerSize = LOCAL_HEADER_SIZE + ReadUInt16(&m_headerBuffer[26]) + ReadUInt16(&m_headerBuffer[28]);
+	bytesRead += BufferBytes(pData + bytesRead, numBytes - bytesRead, headerSize);
+	if (m_headerBuffer.size() < headerSize)
+	{
+		return bytesRead;
+	}
+
+	ParseLocalHeader();
+	m_headerBuffer.clear();
+
+	return bytesRead;
+}
+
+size_t ZipStreamReader::ReadStoredData(const unsigned char* pData, const size_t numBytes)
+{
+	const size_t bytesToRead = (size_t)(std::min)((uint64_t)(std::min)(numBytes, INFLATE_BUFFER_SIZE), m_compressedSize - m_compressedBytesRead);
+	m_compressedBytesRead += bytesToRead;
+
+	if (WriteEntryData(pData, bytesToRead) && m_compressedBytesRead == m_compressedSize)
+	{
+		FinishEntry();
+	}
+
+	return bytesToRead;
+}
+
+size_t ZipStreamReader::ReadDeflatedData(const unsigned char* pData, const size_t numBytes)
+{
+	size_t bytesToRead = (std::min)(numBytes, INFLATE_BUFFER_SIZE);
+	if ((m_flags & FLAG_DATA_DESCRIPTOR) == 0)
+	{
+		bytesToRead = (size_t)(std::min)((uint64_t)bytesToRead, m_compressedSize - m_compressedBytesRead);
+		if (bytesToRead == 0)
+		{
+			Fail("ZipStreamReader::ReadDeflatedData - Deflated data of " + m_path + " is longer than its compressed size.");
+			return 0;
+		}
+	}
+
+	m_zStream.next_in = (Bytef*)pData;
+	m_zStream.avail_in = (uInt)bytesToRead;
+
+	int result = Z_OK;
+	do
+	{
+		m_zStream.next_out = (Bytef*)m_inflateBuffer.data();
+		m_zStream.avail_out = (uInt)m_inflateBuffer.size();
+
+		result = inflate(&m_zStream, Z_NO_FLUSH);
+		if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR)
+		{
+			Fail("ZipStreamReader::ReadDeflatedData - Failed to inflate " + m_path + " with error " + std::to_string(result));
+			return 0;
+		}
+
+		const size_t bytesInflated = m_inflateBuffer.size() - m_zStream.avail_out;
+		if (bytesInflated > 0 && !WriteEntryData(m_inflateBuffer.data(), bytesInflated))
+		{
+			return 0;
+		}
+	} while (result == Z_OK && (m_zStream.avail_in > 0 || m_zStream.avail_out == 0));
+
+	const size_t bytesRead = bytesToRead - m_zStream.avail_in;
+	m_compressedBytesRead += bytesRead;
+
+	if (result == Z_STREAM_END)
+	{
+		if ((m_flags & FLAG_DATA_DESCRIPTOR) != 0)
+		{
+			m_state = EState::DATA_DESCRIPTOR;
+		}
+		else if (m_compressedBytesRead != m_compressedSize)
+		{
+			Fail("ZipStreamReader::ReadDeflatedData - Deflated data of " + m_path + " is shorter than its compressed size.");
+		}
+		else
+		{
+			FinishEntry();
+		}
+	}
+
+	return bytesRead;
+}
+
+size_t ZipStreamReader::ReadDataDescriptor(const unsigned char* pData, const size_t numBytes)
+{
+	size_t bytesRead = BufferBytes(pData, numBytes, 4);
+	if (m_headerBuffer.size() < 4)
+	{
+		return bytesRead;
+	}
+
+	// The signature is optional.
+	const size_t signatureSize = (ReadUInt32(&m_headerBuffer[0]) == DATA_DESCRIPTOR_SIGNATURE) ? 4 : 0;
+	const size_t descriptorSize = signatureSize + (m_zip64 ? 20 : 12);
+	bytesRead += BufferBytes(pData + bytesRead, numBytes - bytesRead, descriptorSize);
+	if (m_headerBuffer.size() < descriptorSize)
+	{
+		return bytesRead;
+	}
+
+	const unsigned char* pDescriptor = &m_headerBuffer[signatureSize];
+	m_expectedCRC = ReadUInt32(pDescriptor);
+	m_compressedSize = m_zip64 ? ReadUInt64(pDescriptor + 4) : ReadUInt32(pDescriptor + 4);
+	m_uncompressedSize = m_zip64 ? ReadUInt64(pDescriptor + 12) : ReadUInt32(pDescriptor + 8);
+	m_headerBuffer.clear();
+
+	if (m_compressedSize != m_compressedBytesRead)
+	{
+		Fail("ZipStreamReader::ReadDataDescriptor - Compressed size of " + m_path + " not matching.");
+		return 0;
+	}
+
+	FinishEntry();
+	return bytesRead;
+}
+
+// Appends bytes to the header buffer, until it holds totalBytes.
+size_t ZipStreamReader::BufferBytes(const unsigned char* pData, const size_t numBytes, const size_t totalBytes)
+{
+	const size_t bytesToCopy = (m_headerBuffer.size() < totalBytes) ? (std::min)(numBytes, totalBytes - m_headerBuffer.size()) : 0;
+	m_headerBuffer.insert(m_headerBuffer.end(), pData, pData + bytesToCopy);
+
+	return bytesToCopy;
+}
+
+bool ZipStreamReader::ParseLocalHeader()
+{
+	const unsigned char* pHeader = m_headerBuffer.data();
+	m_flags = ReadUInt16(pHeader + 6);
+	const uint16_t method = ReadUInt16(pHeader + 8);
+	m_expectedCRC = ReadUInt32(pHeader + 14);
+	m_compressedSize = ReadUInt32(pHeader + 18);
+	m_uncompressedSize = ReadUInt32(pHeader + 22);
+
+	const size_t pathLength = ReadUInt16(pHeader + 26);
+	const size_t extraLength = ReadUInt16(pHeader + 28);
+	m_path = std::string((const char*)pHeader + LOCAL_HEADER_SIZE, pathLength);
+
+	// Sizes of 4GB or more are stored in the zip64 extra field instead.
+	m_zip64 = false;
+	size_t offset = LOCAL_HEADER_SIZE + pathLength;
+	const size_t extraEnd = offset + extraLength;
+	while (offset + 4 <= extraEnd)
+	{
+		const uint16_t fieldId = ReadUInt16(pHeader + offset);
+		const size_t fieldEnd = offset + 4 + ReadUInt16(pHeader + offset + 2);
+		if (fieldEnd > extraEnd)
+		{
+			break;
+		}
+
+		if (fieldId == ZIP64_EXTRA_FIELD)
+		{
+			m_zip64 = true;
+
+			size_t fieldOffset = offset + 4;
+			if (m_uncompressedSize == ZIP64_SIZE_MARKER && fieldOffset + 8 <= fieldEnd)
+			{
+				m_uncompressedSize = ReadUInt64(pHeader + fieldOffset);
+				fieldOffset += 8;
+			}
+
+			if (m_compressedSize == ZIP64_SIZE_MARKER && fieldOffset + 8 <= fieldEnd)
+			{
+				m_compressedSize = ReadUInt64(pHeader + fieldOffset);
+			}
+		}
+
+		offset = fieldEnd;
+	}
+
+	if ((m_flags & FLAG_ENCRYPTED) != 0)
+	{
+		Fail("ZipStreamReader::ParseLocalHeader - Encrypted entries are not supported: " + m_path);
+		return false;
+	}
+
+	if (method != METHOD_STORED && method != METHOD_DEFLATED)
+	{
+		Fail("ZipStreamReader::ParseLocalHeader - Unsupported compression method " + std::to_string(method) + " for " + m_path);
+		return false;
+	}
+
+	// Without the size, there's no way to tell where stored data ends.
+	if (method == METHOD_STORED && (m_flags & FLAG_DATA_DESCRIPTOR) != 0)
+	{
+		Fail("ZipStreamReader::ParseLocalHeader - Stored entries must have their size in the local header: " + m_path);
+		return false;
+	}
+
+	m_compressedBytesRead = 0;
+	m_bytesExtracted = 0;
+	m_crc = crc32(0, Z_NULL, 0);
+
+	if (!m_listener.OnEntryStarted(m_path))
+	{
+		Fail("ZipStreamReader::ParseLocalHeader - Failed to start " + m_path);
+		return false;
+	}
+
+	if (method == METHOD_DEFLATED)
+	{
+		inflateReset(&m_zStream);
+		m_state = EState::DEFLATED_DATA;
+	}
+	else if (m_compressedSize > 0)
+	{
+		m_state = EState::STORED_DATA;
+	}
+	else
+	{
+		return FinishEntry();
+	}
+
+	return true;
+}
+
+bool ZipStreamReader::WriteEntryData(const unsigned char* pData, const size_t numBytes)
+{
+	m_crc = crc32(m_crc, (const Bytef*)pData, (uInt)numBytes);
+	m_bytesExtracted += numBytes;
+
+	if (!m_listener.OnEntryData(pData, numBytes))
+	{
+		Fail("ZipStreamReader::WriteEntryData - Failed to write " + m_path);
+		return false;
+	}
+
+	return true;
+}
+
+bool ZipStreamReader::FinishEntry()
+{
+	if (m_crc != m_expectedCRC || m_bytesExtracted != m_uncompressedSize)
+	{
+		Fail("ZipStreamReader::FinishEntry - CRC or size not matching for " + m_path);
+		return false;
+	}
+
+	if (!m_listener.OnEntryFinished(m_path))
+	{
+		Fail("ZipStreamReader::FinishEntry - Failed to finish " + m_path);
+		return false;
+	}
+
+	m_state = EState::LOCAL_HEADER;
+	return true;
+}
+
+void ZipStreamReader::Fail(const std::string& message)
+{
+	LoggerAPI::LogError(message);
+	m_state = EState::FAILED;
+}
\ No newline at end of file
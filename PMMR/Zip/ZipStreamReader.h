@@ -0,0 +1,85 @@
+#pragma once
+
+#include <zlib.h>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+//
+// Receives the entries of a zip file as they're extracted by a ZipStreamReader.
+// Returning false from any of these stops the extraction.
+//
+class IZipStreamListener
+{
+public:
+	virtual ~IZipStreamListener() = default;
+
+	virtual bool OnEntryStarted(const std::string& path) = 0;
+	virtual bool OnEntryData(const unsigned char* pData, const size_t numBytes) = 0;
+	virtual bool OnEntryFinished(const std::string& path) = 0;
+};
+
+//
+// Extracts a zip file as its bytes arrive (eg. from a socket), without ever needing the whole file.
+// Entries are read from their local headers, so the central directory at the end of the file is never needed, and is ignored.
+// Only stored and deflated entries are supported, and the CRC and size of every entry are checked.
+//
+class ZipStreamReader
+{
+public:
+	ZipStreamReader(IZipStreamListener& listener);
+	~ZipStreamReader();
+
+	//
+	// Extracts as much as possible from the next bytes of the zip file.
+	// Returns false if the zip is malformed, or the listener stopped the extraction. Once false is returned, all further bytes are rejected.
+	//
+	bool Write(const unsigned char* pData, size_t numBytes);
+
+	//
+	// True once the last entry has been extracted (ie. the central directory has been reached).
+	//
+	bool IsFinished() const { return m_state == EState::FINISHED; }
+
+private:
+	enum class EState
+	{
+		LOCAL_HEADER,
+		STORED_DATA,
+		DEFLATED_DATA,
+		DATA_DESCRIPTOR,
+		FINISHED,
+		FAILED
+	};
+
+	size_t ReadLocalHeader(const unsigned char* pData, const size_t numBytes);
+	size_t ReadStoredData(const unsigned char* pData, const size_t numBytes);
+	size_t ReadDeflatedData(const unsigned char* pData, const size_t numBytes);
+	size_t ReadDataDescriptor(const unsigned char* pData, const size_t numBytes);
+	size_t BufferBytes(const unsigned char* pData, const size_t numBytes, const size_t totalBytes);
+
+	bool ParseLocalHeader();
+	bool WriteEntryData(const unsigned char* pData, const size_t numBytes);
+	bool FinishEntry();
+	void Fail(const std::string& message);
+
+	IZipStreamListener& m_listener;
+	EState m_state;
+
+	// Partially received headers and descriptors.
+	std::vector<unsigned char> m_headerBuffer;
+
+	z_stream m_zStream;
+	std::vector<unsigned char> m_inflateBuffer;
+
+	// The entry currently being extracted.
+	std::string m_path;
+	uint16_t m_flags;
+	bool m_zip64;
+	uint32_t m_expectedCRC;
+	uint64_t m_compressedSize;
+	uint64_t m_uncompressedSize;
+	uint64_t m_compressedBytesRead;
+	uint64_t m_bytesExtracted;
+	uint32_t m_crc;
+};
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "ZipWriter.h"
+
+#include <Infrastructure/Logger.h>
+#include <fstream>
+
+static const size_t BUFFER_SIZE = 1024 * 1024;
+
+ZipWriter::ZipWriter(const std::string& zipFilePath)
+	: m_zipFilePath(zipFilePath), m_zipFile(NULL)
+{
+}
+
+EZipFileStatus ZipWriter::Open()
+{
+	m_zipFile = zipOpen64(m_zipFilePath.c_str(), APPEND_STATUS_CREATE);
+	if (m_zipFile == NULL)
+	{
+		LoggerAPI::LogError("ZipWriter::Open - Zip file (" + m_zipFilePath + ") failed to open.");
+		return EZipFileStatus::NOT_FOUND;
+	}
+
+	return EZipFileStatus::SUCCESS;
+}
+
+EZipFileStatus ZipWriter::Close()
+{
+	if (m_zipFile == NULL)
+	{
+		return EZipFileStatus::NOT_OPEN;
+	}
+
+	// The central directory is only written on close, so the zip is unreadable if this fails.
+	const int closeResult = zipClose(m_zipFile, NULL);
+	m_zipFile = NULL;
+
+	return (closeResult == ZIP_OK) ? EZipFileStatus::SUCCESS : EZipFileStatus::WRITE_FAILED;
+}
+
+EZipFileStatus ZipWriter::AddFile(const std::string& path, const std::string& sourcePath, const uint64_t numBytes)
+{
+	std::ifstream sourceFile(sourcePath, std::ios::in | std::ios::binary);
+	if (!sourceFile.is_open())
+	{
+		LoggerAPI::LogWarning("ZipWriter::AddFile - Failed to open source (" + sourcePath + ").");
+		return EZipFileStatus::NOT_FOUND;
+	}
+
+	const EZipFileStatus openStatus = OpenEntry(path, numBytes);
+	if (openStatus != EZipFileStatus::SUCCESS)
+	{
+		return openStatus;
+	}
+
+	std::vector<char> buffer(BUFFER_SIZE);
+	uint64_t bytesRemaining = numBytes;
+	while (bytesRemaining > 0)
+	{
+		const size_t bytesToRead = (size_t)std::min<uint64_t>(bytesRemaining, BUFFER_SIZE);
+		if (!sourceFile.read(&buffer[0], bytesToRead) || zipWriteInFileInZip(m_zipFile, &buffer[0], (unsigned int)bytesToRead) != ZIP_OK)
+		{
+			LoggerAPI::LogError("ZipWriter::AddFile - Failed to write path (" + path + ") to zip file (" + m_zipFilePath + ").");
+			zipCloseFileInZip(m_zipFile);
+			return EZipFileStatus::WRITE_FAILED;
+		}
+
+		bytesRemaining -= bytesToRead;
+	}
+
+	return (zipCloseFileInZip(m_zipFile) == ZIP_OK) ? EZipFileStatus::SUCCESS : EZipFileStatus::WRITE_FAILED;
+}
+
+EZipFileStatus ZipWriter::AddData(const std::string& path, const std::vector<unsigned char>& data)
+{
+	const EZipFileStatus openStatus = OpenEntry(path, data.size());
+	if (openStatus != EZipFileStatus::SUCCESS)
+	{
+		return openStatus;
+	}
+
+	if (!data.empty() && zipWriteInFileInZip(m_zipFile, &data[0], (unsigned int)data.size()) != ZIP_OK)
+	{
+		LoggerAPI::LogError("ZipWriter::AddData - Failed to write path (" + path + ") to zip file (" + m_zipFilePath + ").");
+		zipCloseFileInZip(m_zipFile);
+		return EZipFileStatus::WRITE_FAILED;
+	}
+
+	return (zipCloseFileInZip(m_zipFile) == ZIP_OK) ? EZipFileStatus::SUCCESS : EZipFileStatus::WRITE_FAILED;
+}
+
+EZipFileStatus ZipWriter::OpenEntry(const std::string& path, const uint64_t numBytes)
+{
+	if (m_zipFile == NULL)
+	{
+		LoggerAPI::LogWarning("ZipWriter::OpenEntry - Zip file (" + m_zipFilePath + ") is not open.");
+		return EZipFileStatus::NOT_OPEN;
+	}
+
+	zip_fileinfo fileInfo = {};
+	const int zip64 = (numBytes >= 0xFFFFFFFF) ? 1 : 0;
+	if (zipOpenNewFileInZip64(m_zipFile, path.c_str(), &fileInfo, NULL, 0, NULL, 0, NULL, Z_DEFLATED, Z_DEFAULT_COMPRESSION, zip64) != ZIP_OK)
+	{
+		LoggerAPI::LogError("ZipWriter::OpenEntry - Failed to add path (" + path + ") to zip file (" + m_zipFilePath + ").");
+		return EZipFileStatus::WRITE_FAILED;
+	}
+
+	return EZipFileStatus::SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "ZipFile.h"
+#include "minizip/zip.h"
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/*
+ * Thin wrapper on minizip's zip library, for writing a new zip file one entry at a time.
+ */
+class ZipWriter
+{
+private:
+	std::string m_zipFilePath;
+	zipFile m_zipFile;
+
+	EZipFileStatus OpenEntry(const std::string& path, const uint64_t numBytes);
+
+public:
+	ZipWriter(const std::string& zipFilePath);
+
+	EZipFileStatus Open();
+	EZipFileStatus Close();
+
+	// Compresses the first numBytes of the source file into the entry at the given path.
+	EZipFileStatus AddFile(const std::string& path, const std::string& sourcePath, const uint64_t numBytes);
+	EZipFileStatus AddData(const std::string& path, const std::vector<unsigned char>& data);
+};
\ No newline at end of file
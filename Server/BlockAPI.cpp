@@ -22,7 +22,7 @@ int BlockAPI::GetHeader_Handler(struct mg_connection* conn, void* pBlockChainSer
 	
 	const std::string requestURI(req_info->request_uri);
 	const std::string requestedHeader = requestURI.substr(12, requestURI.size() - 12);
-	std::unique_ptr<BlockHeader> pBlockHeader = GetHeader(requestedHeader, (IBlockChainServer*)pBlockChainServer);
+	std::shared_ptr<const BlockHeader> pBlockHeader = GetHeader(requestedHeader, (IBlockChainServer*)pBlockChainServer);
 
 	if (nullptr != pBlockHeader)
 	{
@@ -58,14 +58,14 @@ int BlockAPI::GetHeader_Handler(struct mg_connection* conn, void* pBlockChainSer
 	}
 }
 
-std::unique_ptr<BlockHeader> BlockAPI::GetHeader(const std::string& requestedHeader, IBlockChainServer* pBlockChainServer)
+std::shared_ptr<const BlockHeader> BlockAPI::GetHeader(const std::string& requestedHeader, IBlockChainServer* pBlockChainServer)
 {
 	if (requestedHeader.length() == 64 && HexUtil::IsValidHex(requestedHeader))
 	{
 		try
 		{
 			const Hash hash = Hash::FromHex(requestedHeader);
-			std::unique_ptr<BlockHeader> pHeader = pBlockChainServer->GetBlockHeaderByHash(hash);
+			std::shared_ptr<const BlockHeader> pHeader = pBlockChainServer->GetSharedBlockHeaderByHash(hash);
 			if (pHeader != nullptr)
 			{
 				LoggerAPI::LogInfo(StringUtil::Format("BlockAPI::GetHeader - Found header with hash %s.", requestedHeader.c_str()));
@@ -93,7 +93,7 @@ std::unique_ptr<BlockHeader> BlockAPI::GetHeader(const std::string& requestedHea
 			std::string::size_type sz = 0;
 			const uint64_t height = std::stoull(requestedHeader, &sz, 0);
 
-			std::unique_ptr<BlockHeader> pHeader = pBlockChainServer->GetBlockHeaderByHeight(height, EChainType::CANDIDATE);
+			std::shared_ptr<const BlockHeader> pHeader = pBlockChainServer->GetSharedBlockHeaderByHeight(height, EChainType::CANDIDATE);
 			if (pHeader != nullptr)
 			{
 				LoggerAPI::LogInfo(StringUtil::Format("BlockAPI::GetHeader - Found header at height %s.", requestedHeader.c_str()));
@@ -110,7 +110,7 @@ std::unique_ptr<BlockHeader> BlockAPI::GetHeader(const std::string& requestedHea
 		}
 	}
 
-	return std::unique_ptr<BlockHeader>(nullptr);
+	return std::shared_ptr<const BlockHeader>(nullptr);
 }
 
 std::string BlockAPI::BuildHeaderJSON(const BlockHeader& header)
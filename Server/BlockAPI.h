@@ -11,6 +11,6 @@ public:
 	static int GetHeader_Handler(struct mg_connection* conn, void* pBlockChainServer);
 
 private:
-	static std::unique_ptr<BlockHeader> GetHeader(const std::string& requestedHeader, IBlockChainServer* pBlockChainServer);
+	static std::shared_ptr<const BlockHeader> GetHeader(const std::string& requestedHeader, IBlockChainServer* pBlockChainServer);
 	static std::string BuildHeaderJSON(const BlockHeader& header);
 };
\ No newline at end of file
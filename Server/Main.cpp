@@ -16,7 +16,7 @@ void TestTxHashSet()
 	IDatabase* pDatabase = DatabaseAPI::OpenDatabase(config);
 	IBlockChainServer* pBlockChainServer = BlockChainAPI::StartBlockChainServer(config, *pDatabase);
 	std::unique_ptr<BlockHeader> pHeader = pBlockChainServer->GetBlockHeaderByHeight(82172, EChainType::CANDIDATE);
-	ITxHashSet* pTxHashSet = TxHashSetAPI::Open(config, pDatabase->GetBlockDB());
+	ITxHashSet* pTxHashSet = TxHashSetAPI::Open(config);
 	Commitment outputSum(CBigInteger<33>::ValueOf(0));
 	Commitment kernelSum(CBigInteger<33>::ValueOf(0));
 	pTxHashSet->Validate(*pHeader, *pBlockChainServer, outputSum, kernelSum);
@@ -29,7 +29,7 @@ void TestTxHashSetZip()
 	IBlockChainServer* pBlockChainServer = BlockChainAPI::StartBlockChainServer(config, *pDatabase);
 	std::unique_ptr<BlockHeader> pHeader = pBlockChainServer->GetBlockHeaderByHeight(82172, EChainType::CANDIDATE); //57519
 
-	//ITxHashSet* pTxHashSet = TxHashSetAPI::LoadFromZip(config, pDatabase->GetBlockDB(), config.GetDataDirectory() + "txhashset_snapshot_10427.zip", *pHeader);
+	//ITxHashSet* pTxHashSet = TxHashSetAPI::LoadFromZip(config, config.GetDataDirectory() + "txhashset_snapshot_10427.zip", *pHeader);
 	//if (pTxHashSet != nullptr)
 	//{
 	//	Commitment outputSum(CBigInteger<33>::ValueOf(0));
@@ -53,7 +53,7 @@ bool TestMMR()
 	const uint64_t totalHeight = pBlockChainServer->GetHeight(EChainType::CANDIDATE);
 	for (uint64_t i = 0; i <= totalHeight; i++)
 	{
-		std::unique_ptr<BlockHeader> pHeader = pBlockChainServer->GetBlockHeaderByHeight(i, EChainType::CANDIDATE);
+		std::shared_ptr<const BlockHeader> pHeader = pBlockChainServer->GetSharedBlockHeaderByHeight(i, EChainType::CANDIDATE);
 		//headerMMR.Rewind(i);
 		//const Hash root = headerMMR.Root();
 		//headerMMR.Rollback();
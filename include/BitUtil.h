@@ -4,7 +4,7 @@
 
 namespace BitUtil
 {
-	static uint64_t FillOnesToRight(const uint64_t input)
+	static constexpr uint64_t FillOnesToRight(const uint64_t input)
 	{
 		uint64_t x = input;
 		x = x | (x >> 1);
@@ -16,16 +16,38 @@ namespace BitUtil
 		return x;
 	}
 
-	static uint8_t CountBitsSet(const uint64_t input)
+	// Branch-free popcount (SWAR). Compilers reduce this to a single popcnt instruction where available.
+	static constexpr uint8_t CountBitsSet(const uint64_t input)
 	{
-		uint64_t n = input;
-		uint8_t count = 0;
-		while (n)
-		{
-			count += n & 1;
-			n >>= 1;
-		}
+		uint64_t x = input;
+		x = x - ((x >> 1) & 0x5555555555555555ULL);
+		x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+		x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+		return (uint8_t)((x * 0x0101010101010101ULL) >> 56);
+	}
+
+	//
+	// Returns the number of bits needed to represent the input (ie. 64 - count of leading zeros).
+	// BitLength(0) == 0.
+	//
+	static constexpr uint8_t BitLength(const uint64_t input)
+	{
+		return CountBitsSet(FillOnesToRight(input));
+	}
+
+	static constexpr uint8_t CountLeadingZeros(const uint64_t input)
+	{
+		return 64 - BitLength(input);
+	}
+
+	static constexpr uint8_t CountTrailingZeros(const uint64_t input)
+	{
+		return (input == 0) ? 64 : CountBitsSet((input & (0 - input)) - 1);
+	}
 
-		return count;
+	// True if the input is of the form 2^n - 1, for some n > 0.
+	static constexpr bool IsAllOnes(const uint64_t input)
+	{
+		return input != 0 && (input & (input + 1)) == 0;
 	}
 }
\ No newline at end of file
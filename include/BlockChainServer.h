@@ -21,6 +21,7 @@
 // Forward Declarations
 class Config;
 class IDatabase;
+class ITxHashSetDownload;
 
 #ifdef MW_BLOCK_CHAIN
 #define BLOCK_CHAIN_API __declspec(dllexport)
@@ -41,9 +42,31 @@ public:
 	virtual EBlockChainStatus AddBlock(const FullBlock& block) = 0;
 	virtual EBlockChainStatus AddCompactBlock(const CompactBlock& compactBlock) = 0;
 
+	//
+	// Returns true if the block was received, but is waiting in the orphan pool for its parent to be confirmed.
+	// Such blocks don't need to be requested again.
+	//
+	virtual bool HasOrphan(const Hash& blockHash) const = 0;
+
 	virtual EBlockChainStatus ProcessTransactionHashSet(const Hash& blockHash, const std::string& path) = 0;
+
+	//
+	// Replaces the TxHashSet with the one for the given block, extracting and validating it while it's still downloading.
+	// StartTxHashSetDownload returns null if the block is not a candidate block ahead of the confirmed chain. Otherwise,
+	// the zip's bytes should be written to the download as they arrive, before passing it to FinishTxHashSetDownload.
+	// The existing TxHashSet is only replaced once the download is valid.
+	//
+	virtual std::unique_ptr<ITxHashSetDownload> StartTxHashSetDownload(const Hash& blockHash) = 0;
+	virtual EBlockChainStatus FinishTxHashSetDownload(const Hash& blockHash, std::unique_ptr<ITxHashSetDownload> pDownload) = 0;
+
 	virtual EBlockChainStatus AddTransaction(const Transaction& transaction) = 0;
 
+	//
+	// Returns the header of the block whose TxHashSet is archived for syncing peers, and the path of the zip file.
+	// This will be null if no archive has been built yet.
+	//
+	virtual std::unique_ptr<BlockHeader> GetTxHashSetArchive(std::string& zipPathOut) const = 0;
+
 	virtual EBlockChainStatus AddBlockHeader(const BlockHeader& blockHeader) = 0;
 
 	//
@@ -54,17 +77,24 @@ public:
 	virtual EBlockChainStatus AddBlockHeaders(const std::vector<BlockHeader>& blockHeaders) = 0;
 
 	//
-	// Returns the block header at the given height.
+	// Returns a copy of the block header at the given height.
 	// This will be null if no matching block header is found.
 	//
 	virtual std::unique_ptr<BlockHeader> GetBlockHeaderByHeight(const uint64_t height, const EChainType chainType) const = 0;
 
 	//
-	// Returns the block header matching the given hash.
+	// Returns a copy of the block header matching the given hash.
 	// This will be null if no matching block header is found.
 	//
 	virtual std::unique_ptr<BlockHeader> GetBlockHeaderByHash(const Hash& blockHeaderHash) const = 0;
 
+	//
+	// Same as GetBlockHeaderByHeight and GetBlockHeaderByHash, but returns a shared handle to the stored header, rather than copying it.
+	// Prefer these when the header is only read.
+	//
+	virtual std::shared_ptr<const BlockHeader> GetSharedBlockHeaderByHeight(const uint64_t height, const EChainType chainType) const = 0;
+	virtual std::shared_ptr<const BlockHeader> GetSharedBlockHeaderByHash(const Hash& blockHeaderHash) const = 0;
+
 	//
 	// Returns the block header containing the output commitment.
 	// This will be null if the output commitment is not found.
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+
+class ChainConfig
+{
+public:
+	ChainConfig() : ChainConfig(64, 32)
+	{
+
+	}
+
+	ChainConfig(const uint32_t headerCacheMB, const uint32_t orphanPoolMB)
+		: m_headerCacheMB(headerCacheMB), m_orphanPoolMB(orphanPoolMB)
+	{
+
+	}
+
+	// The memory (in MB) used to cache block headers older than the cut-through horizon.
+	// Headers within the horizon are always kept in memory, and aren't counted.
+	inline uint32_t GetHeaderCacheMB() const { return m_headerCacheMB; }
+
+	// The memory (in MB) used to hold blocks that arrive before their parent is confirmed.
+	inline uint32_t GetOrphanPoolMB() const { return m_orphanPoolMB; }
+
+private:
+	uint32_t m_headerCacheMB;
+	uint32_t m_orphanPoolMB;
+};
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Config/DandelionConfig.h>
+#include <Config/ChainConfig.h>
 #include <Config/ClientMode.h>
 #include <Config/P2PConfig.h>
 #include <Config/Environment.h>
@@ -11,8 +12,8 @@
 class Config
 {
 public:
-	Config(const EClientMode clientMode, const Environment& environment, const std::string& dataPath, const DandelionConfig& dandelionConfig, const P2PConfig& p2pConfig)
-		: m_clientMode(clientMode), m_environment(environment), m_dataPath(dataPath), m_dandelionConfig(dandelionConfig), m_p2pConfig(p2pConfig)
+	Config(const EClientMode clientMode, const Environment& environment, const std::string& dataPath, const DandelionConfig& dandelionConfig, const P2PConfig& p2pConfig, const ChainConfig& chainConfig)
+		: m_clientMode(clientMode), m_environment(environment), m_dataPath(dataPath), m_dandelionConfig(dandelionConfig), m_p2pConfig(p2pConfig), m_chainConfig(chainConfig)
 	{
 		std::filesystem::create_directories(m_dataPath + m_txHashSetPath);
 		std::filesystem::create_directories(m_dataPath + m_txHashSetPath + "kernel/");
@@ -30,6 +31,7 @@ public:
 	inline const Environment& GetEnvironment() const { return m_environment; }
 	inline const DandelionConfig& GetDandelionConfig() const { return m_dandelionConfig; }
 	inline const P2PConfig& GetP2PConfig() const { return m_p2pConfig; }
+	inline const ChainConfig& GetChainConfig() const { return m_chainConfig; }
 	inline const EClientMode GetClientMode() const { return EClientMode::FAST_SYNC; }
 
 private:
@@ -41,5 +43,6 @@ private:
 	
 	DandelionConfig m_dandelionConfig;
 	P2PConfig m_p2pConfig;
+	ChainConfig m_chainConfig;
 	Environment m_environment;
 };
\ No newline at end of file
@@ -6,7 +6,9 @@
 // Author: David Burkett (davidburkett38@gmail.com)
 //
 
+#include <Consensus/BlockTime.h>
 #include <stdint.h>
+#include <algorithm>
 
 // See: https://github.com/mimblewimble/grin/blob/master/core/src/consensus.rs
 namespace Consensus
@@ -40,85 +42,71 @@ namespace Consensus
 	// in one block interval)
 	static const uint64_t INITIAL_DIFFICULTY = 1000000;
 
-	// Computes the proof-of-work difficulty that the next block should comply
-	// with. Takes an iterator over past blocks, from latest (highest height) to
-	// oldest (lowest height). The iterator produces pairs of timestamp and
-	// difficulty for each block.
+	// Clamp factor to use for difficulty adjustment. Limit value to within this factor of goal.
+	static const uint64_t CLAMP_FACTOR = 2;
+
+	// Dampening factor to use for difficulty adjustment
+	static const uint64_t DIFFICULTY_DAMP_FACTOR = 3;
+
+	// Dampening factor to use for AR scale calculation.
+	static const uint64_t AR_SCALE_DAMP_FACTOR = 13;
+
+	// Minimum difficulty, enforced in diff retargetting.
+	// Avoids getting stuck when trying to increase difficulty subject to dampening.
+	static const uint64_t MIN_DIFFICULTY = DIFFICULTY_DAMP_FACTOR;
+
+	// Minimum scaling factor for AR pow, enforced in diff retargetting.
+	// Avoids getting stuck when trying to increase ar_scale subject to dampening.
+	static const uint64_t MIN_AR_SCALE = AR_SCALE_DAMP_FACTOR;
+
+	// Graph weight of the secondary PoW at launch. Used as the scaling of the simulated pre-genesis blocks.
+	static const uint32_t INITIAL_GRAPH_WEIGHT = (uint32_t)((((uint64_t)2) << (SECOND_POW_EDGE_BITS - BASE_EDGE_BITS)) * SECOND_POW_EDGE_BITS);
+
+	// Move value linearly toward a goal.
+	static uint64_t Damp(const uint64_t actual, const uint64_t goal, const uint64_t dampFactor)
+	{
+		return (actual + (dampFactor - 1) * goal) / dampFactor;
+	}
+
+	// Limit value to be within some factor from a goal.
+	static uint64_t Clamp(const uint64_t actual, const uint64_t goal, const uint64_t clampFactor)
+	{
+		return std::max(goal / clampFactor, std::min(actual, goal * clampFactor));
+	}
+
+	// Ratio the secondary proof of work should take over the primary, as a function of block height (time).
+	// Starts at 90% losing a percent approximately every week. Represented as an integer between 0 and 100.
+	static uint64_t GetSecondaryPoWRatio(const uint64_t height)
+	{
+		const uint64_t decrease = height / (2 * YEAR_HEIGHT / 90);
+		return decrease < 90 ? (90 - decrease) : 0;
+	}
+
+	// Computes the proof-of-work difficulty that the next block should comply with,
+	// given the time spanned by the last DIFFICULTY_ADJUST_WINDOW blocks and the sum of their difficulties.
 	//
-	// The difficulty calculation is based on both Digishield and GravityWave
-	// family of difficulty computation, coming to something very close to Zcash.
-	// The reference difficulty is an average of the difficulty over a window of
-	// DIFFICULTY_ADJUST_WINDOW blocks. The corresponding timespan is calculated
-	// by using the difference between the median timestamps at the beginning
-	// and the end of the window.
-	// TODO: Implement this
-	/*pub fn next_difficulty<T>(cursor: T)->Result<Difficulty, TargetError>
-		where
-		T: IntoIterator<Item = Result<(u64, Difficulty), TargetError>>,
+	// The time span is moved toward the goal of BLOCK_TIME_WINDOW, subject to dampening and clamping.
+	static uint64_t CalculateNextDifficulty(const uint64_t timestampDelta, const uint64_t difficultySum)
 	{
-		// Create vector of difficulty data running from earliest
-		// to latest, and pad with simulated pre-genesis data to allow earlier
-		// adjustment if there isn't enough window data
-		// length will be DIFFICULTY_ADJUST_WINDOW+MEDIAN_TIME_WINDOW
-		let diff_data = global::difficulty_data_to_vector(cursor);
-
-		// Obtain the median window for the earlier time period
-		// the first MEDIAN_TIME_WINDOW elements
-		let mut window_earliest : Vec<u64> = diff_data
-			.iter()
-			.take(MEDIAN_TIME_WINDOW as usize)
-			.map(| n | n.clone().unwrap().0)
-			.collect();
-		// pick median
-		window_earliest.sort();
-		let earliest_ts = window_earliest[MEDIAN_TIME_INDEX as usize];
-
-		// Obtain the median window for the latest time period
-		// i.e. the last MEDIAN_TIME_WINDOW elements
-		let mut window_latest : Vec<u64> = diff_data
-			.iter()
-			.skip(DIFFICULTY_ADJUST_WINDOW as usize)
-			.map(| n | n.clone().unwrap().0)
-			.collect();
-		// pick median
-		window_latest.sort();
-		let latest_ts = window_latest[MEDIAN_TIME_INDEX as usize];
-
-		// median time delta
-		let ts_delta = latest_ts - earliest_ts;
-
-		// Get the difficulty sum of the last DIFFICULTY_ADJUST_WINDOW elements
-		let diff_sum = diff_data
-			.iter()
-			.skip(MEDIAN_TIME_WINDOW as usize)
-			.fold(0, | sum, d | sum + d.clone().unwrap().1.to_num());
-
-		// Apply dampening except when difficulty is near 1
-		if (diff_sum < DAMP_FACTOR * DIFFICULTY_ADJUST_WINDOW)
-		{
-			ts_damp = ts_delta;
-		}
-		else 
-		{
-			ts_damp = (1 * ts_delta + (DAMP_FACTOR - 1) * BLOCK_TIME_WINDOW) / DAMP_FACTOR;
-		}
-
-		// Apply time bounds
-		if (ts_damp < LOWER_TIME_BOUND)
-		{
-			adj_ts = LOWER_TIME_BOUND;
-		}
-		else if (ts_damp > UPPER_TIME_BOUND)
-		{
-			adj_ts = UPPER_TIME_BOUND;
-		}
-		else
-		{
-			adj_ts = ts_damp;
-		}
-
-		let difficulty = diff_sum * BLOCK_TIME_SEC / adj_ts;
-
-		Ok(Difficulty::from_num(max(difficulty, 1)))
-	}*/
+		const uint64_t adjustedTimestampDelta = Clamp(Damp(timestampDelta, BLOCK_TIME_WINDOW, DIFFICULTY_DAMP_FACTOR), BLOCK_TIME_WINDOW, CLAMP_FACTOR);
+
+		// Minimum difficulty avoids getting stuck due to dampening.
+		return std::max(MIN_DIFFICULTY, difficultySum * BLOCK_TIME_SEC / adjustedTimestampDelta);
+	}
+
+	// Computes the secondary PoW scaling factor the next block should comply with, given the sum of the scaling factors
+	// and the number of secondary PoW blocks among the last DIFFICULTY_ADJUST_WINDOW blocks.
+	//
+	// The secondary count is moved toward the goal for the height, subject to dampening and clamping.
+	static uint32_t CalculateSecondaryScaling(const uint64_t height, const uint64_t scalingSum, const uint64_t numSecondary)
+	{
+		const uint64_t targetPct = GetSecondaryPoWRatio(height);
+		const uint64_t targetCount = DIFFICULTY_ADJUST_WINDOW * targetPct;
+
+		const uint64_t adjustedCount = Clamp(Damp(100 * numSecondary, targetCount, AR_SCALE_DAMP_FACTOR), targetCount, CLAMP_FACTOR);
+		const uint64_t scale = scalingSum * targetPct / std::max((uint64_t)1, adjustedCount);
+
+		// Minimum AR scale avoids getting stuck due to dampening.
+		return (uint32_t)std::max(MIN_AR_SCALE, scale);
+	}
 }
\ No newline at end of file
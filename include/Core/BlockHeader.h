@@ -71,6 +71,9 @@ public:
 	void Serialize(Serializer& serializer) const;
 	static BlockHeader Deserialize(ByteBuffer& byteBuffer);
 
+	// The serialized header, up to and including the nonce (everything but the cuckoo cycle). Its hash seeds the header's cuckoo graph.
+	std::vector<unsigned char> GetPreProofOfWork() const;
+
 	//
 	// Hashing
 	//
@@ -78,6 +81,8 @@ public:
 	inline const std::string FormatHash() const { return HexUtil::ConvertHash(GetHash()); }
 
 private:
+	void SerializePreProofOfWork(Serializer& serializer) const;
+
 	uint16_t m_version;
 	uint64_t m_height;
 	int64_t m_timestamp;
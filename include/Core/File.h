@@ -11,11 +11,21 @@
 #include <stdint.h>
 #include <string>
 #include <vector>
+#include <shared_mutex>
+#include <mutex>
 
+//
+// A file that's appended to and rewound in memory, and written to disk by Flush.
+// Committed bytes are read from a memory mapping, which is replaced whenever the file is flushed or replaced.
+// A single thread may modify the file, while any number of threads read it concurrently.
+//
 class File
 {
 public:
 	File(const std::string& path);
+	File(File&& other) noexcept;
+	File(const File&) = delete;
+	File& operator=(const File&) = delete;
 
 	bool Load();
 	bool Flush();
@@ -25,10 +35,29 @@ public:
 	bool Rewind(const uint64_t nextPosition);
 	bool Discard();
 
+	//
+	// Atomically replaces this file with the (already flushed) file at the given path, and reloads it.
+	// Any uncommitted changes are dropped.
+	//
+	bool ReplaceWith(const std::string& path);
+
 	uint64_t GetSize() const;
 	bool Read(const uint64_t position, const uint64_t numBytes, std::vector<unsigned char>& data) const;
 
+	//
+	// Uncommitted changes: On the next Flush, the file will be truncated to GetFlushPosition(), and GetPendingData() will be appended.
+	//
+	inline const std::string& GetPath() const { return m_path; }
+	inline uint64_t GetFlushPosition() const { return m_bufferIndex; }
+	inline const std::vector<unsigned char>& GetPendingData() const { return m_buffer; }
+	inline bool IsDirty() const { return m_bufferIndex != m_fileSize || !m_buffer.empty(); }
+
 private:
+	bool LoadInternal();
+
+	// Held shared by readers, and exclusively while the buffer or mapping changes, so a mapping is never released while it's being read.
+	mutable std::shared_mutex m_mutex;
+
 	const std::string m_path;
 	uint64_t m_bufferIndex;
 	uint64_t m_fileSize;
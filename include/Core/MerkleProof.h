@@ -0,0 +1,60 @@
+#pragma once
+
+//
+// This code is free for all purposes without any express guarantee it works.
+//
+// Author: David Burkett (davidburkett38@gmail.com)
+//
+
+#include <Hash.h>
+#include <Serialization/ByteBuffer.h>
+#include <Serialization/Serializer.h>
+#include <stdint.h>
+#include <vector>
+
+//
+// Proves that a leaf is included in an MMR with the given size.
+// The path is the sibling hashes from the leaf up to its peak, followed by
+// the bagged hash of all peaks to the right (if any), and then each peak to the left, from right to left.
+//
+class MerkleProof
+{
+public:
+	//
+	// Constructors
+	//
+	MerkleProof(const uint64_t mmrSize, std::vector<Hash>&& path);
+	MerkleProof(const MerkleProof& other) = default;
+	MerkleProof(MerkleProof&& other) noexcept = default;
+	MerkleProof() = default;
+
+	//
+	// Destructor
+	//
+	~MerkleProof() = default;
+
+	//
+	// Operators
+	//
+	MerkleProof& operator=(const MerkleProof& other) = default;
+	MerkleProof& operator=(MerkleProof&& other) noexcept = default;
+
+	//
+	// Getters
+	//
+	inline uint64_t GetMMRSize() const { return m_mmrSize; }
+	inline const std::vector<Hash>& GetPath() const { return m_path; }
+
+	//
+	// Serialization/Deserialization
+	//
+	void Serialize(Serializer& serializer) const;
+	static MerkleProof Deserialize(ByteBuffer& byteBuffer);
+
+private:
+	// The size of the MMR at the time the proof was created.
+	uint64_t m_mmrSize;
+
+	// The sibling path from the leaf up to the final sibling hashing to the root.
+	std::vector<Hash> m_path;
+};
\ No newline at end of file
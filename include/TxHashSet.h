@@ -1,7 +1,10 @@
 #pragma once
 
 #include <ImportExport.h>
+#include <memory>
 #include <string>
+#include <vector>
+#include <stdint.h>
 
 // Forward Declarations
 class Config;
@@ -10,7 +13,7 @@ class BlockHeader;
 class Commitment;
 class OutputIdentifier;
 class IBlockChainServer;
-class IBlockDB;
+class MerkleProof;
 
 #ifdef MW_PMMR
 #define TXHASHSET_API __declspec(dllexport)
@@ -18,24 +21,122 @@ class IBlockDB;
 #define TXHASHSET_API __declspec(dllimport)
 #endif
 
+//
+// A compaction that has been prepared, but whose files have not yet been rewritten.
+//
+class ITxHashSetCompaction
+{
+public:
+	virtual ~ITxHashSetCompaction() = default;
+
+	//
+	// Rewrites the output and rangeproof files without the spent data. This does all of the slow I/O,
+	// so it must NOT be called while holding the chain lock.
+	//
+	virtual bool Run() = 0;
+};
+
+//
+// A snapshot of the TxHashSet at a block, whose zip file has not yet been written.
+//
+class ITxHashSetArchive
+{
+public:
+	virtual ~ITxHashSetArchive() = default;
+
+	//
+	// Writes the zip file that's sent to syncing peers. This does all of the slow I/O, so it must NOT be called while holding the chain lock.
+	// The hash and data files are read directly, so this must finish before the TxHashSet is next compacted.
+	//
+	virtual bool Write(const std::string& zipPath) const = 0;
+};
+
+//
+// ApplyBlock and Rewind only modify the TxHashSet in memory, so blocks can be validated speculatively.
+// Changes are written to disk atomically by Commit(), or dropped by Discard().
+//
 class ITxHashSet
 {
 public:
+	virtual ~ITxHashSet() = default;
+
 	virtual bool IsUnspent(const OutputIdentifier& output) const = 0;
 	virtual bool Validate(const BlockHeader& header, const IBlockChainServer& blockChainServer, Commitment& outputSumOut, Commitment& kernelSumOut) = 0;
 	virtual bool ApplyBlock(const FullBlock& block) = 0;
-	virtual bool SaveOutputPositions() = 0;
 
-	virtual bool Snapshot(const BlockHeader& header) = 0;
+	//
+	// Proves that the output or kernel at the given mmr index is included in the current output or kernel MMR.
+	// Returns nullptr if the index is not a leaf, or the proof needs a hash that has been pruned.
+	// The batch versions share hash reads between proofs, and return one (possibly null) proof per index, in the same order.
+	//
+	virtual std::unique_ptr<MerkleProof> GetOutputMerkleProof(const uint64_t mmrIndex) const = 0;
+	virtual std::vector<std::unique_ptr<MerkleProof>> GetOutputMerkleProofs(const std::vector<uint64_t>& mmrIndices) const = 0;
+	virtual std::unique_ptr<MerkleProof> GetKernelMerkleProof(const uint64_t mmrIndex) const = 0;
+	virtual std::vector<std::unique_ptr<MerkleProof>> GetKernelMerkleProofs(const std::vector<uint64_t>& mmrIndices) const = 0;
+
+	//
+	// Checks the root of each MMR against the given header (which the TxHashSet must currently be at),
+	// and regenerates the hash file of any MMR that doesn't match from its data file.
+	// Returns false if a hash file could not be rebuilt to match the header.
+	//
+	virtual bool RebuildHashFiles(const BlockHeader& header) = 0;
+
+	//
+	// Captures the TxHashSet as of the given block, which must not be after the current block.
+	// Only the leaf sets are actually rewound (using the undo data). The hash and data files are archived up to the block's MMR sizes.
+	// Returns nullptr if the undo data doesn't reach back to the block.
+	//
+	virtual std::unique_ptr<ITxHashSetArchive> PrepareArchive(const BlockHeader& header) const = 0;
+
 	virtual bool Rewind(const BlockHeader& header) = 0;
 	virtual bool Commit() = 0;
 	virtual bool Discard() = 0;
-	virtual bool Compact() = 0;
+
+	//
+	// Compaction physically removes outputs and rangeproofs spent beyond the horizon from disk, in 3 steps:
+	// PrepareCompaction (under the chain lock) determines what can be removed, Run() rewrites the files without any lock held,
+	// and FinishCompaction (under the chain lock again) atomically swaps the compacted files in.
+	// Only one compaction can be pending at a time. Returns nullptr when there's nothing to compact.
+	//
+	virtual std::shared_ptr<ITxHashSetCompaction> PrepareCompaction(const uint64_t horizonHeight) = 0;
+	virtual bool FinishCompaction(ITxHashSetCompaction& compaction) = 0;
+};
+
+//
+// A zipped TxHashSet being downloaded from a peer. Files are extracted into a staging folder as the zip's bytes arrive,
+// and each MMR is validated in the background as soon as its files are complete, so validation overlaps with the rest of the download.
+// The existing TxHashSet is left untouched until the download has been validated and is installed.
+//
+class ITxHashSetDownload
+{
+public:
+	virtual ~ITxHashSetDownload() = default;
+
+	//
+	// Extracts the next bytes of the zip. Returns false if the zip is malformed, or a file could not be written.
+	//
+	virtual bool Write(const unsigned char* pData, const size_t numBytes) = 0;
+
+	//
+	// Waits for the background validation, and validates the kernel sums.
+	// Returns false if the zip was incomplete, or the TxHashSet is invalid.
+	//
+	virtual bool Finish(Commitment& outputSumOut, Commitment& kernelSumOut) = 0;
+
+	//
+	// Replaces the existing TxHashSet files with the validated download, and opens the new TxHashSet.
+	// The existing TxHashSet must already be closed. Returns nullptr (with the existing files restored) if the files could not be moved.
+	//
+	virtual ITxHashSet* Install() = 0;
 };
 
 namespace TxHashSetAPI
 {
-	TXHASHSET_API ITxHashSet* Open(const Config& config, IBlockDB& blockDB);
-	TXHASHSET_API ITxHashSet* LoadFromZip(const Config& config, IBlockDB& blockDB, const std::string& zipFilePath, const BlockHeader& header);
-	TXHASHSET_API void Close(ITxHashSet* pTxHashSet);
+	TXHASHSET_API ITxHashSet* Open(const Config& config);
+
+	//
+	// Starts downloading the TxHashSet for the given block into a staging folder. The existing TxHashSet can stay open until Install().
+	// Returns nullptr if the staging folder could not be created.
+	//
+	TXHASHSET_API std::unique_ptr<ITxHashSetDownload> StartDownload(const Config& config, const BlockHeader& header, const IBlockChainServer& blockChainServer);
 }
\ No newline at end of file